@@ -15,7 +15,7 @@ layout(set = 0, binding = 0) uniform LucyCamera {
 
 layout (push_constant) uniform LocalPushConstant {
 	mat4 u_ModelMatrix;
-	float u_MaterialID;
+	uint u_MaterialID;
 };
 
 layout (location = 0) out vec3 a_IDOut;
@@ -14,24 +14,40 @@ layout (location = 2) out vec3 a_NormalsOut;
 
 layout (location = 3) out float a_Depth;
 
+layout (location = 4) out vec3 a_ObjectNormalsOut;
+layout (location = 5) flat out uint a_MaterialIDOut;
+
+struct DrawData {
+	mat4 ModelMatrix;
+	uint MaterialID;
+	float _padding0;
+	float _padding1;
+	float _padding2;
+};
+
 layout (set = 0, binding = 0) uniform LucyCamera {
 	mat4 u_ViewMatrix;
 	mat4 u_ProjMatrix;
 	vec4 u_CamPos;
 };
 
-layout (push_constant) uniform LocalPushConstant {
-	mat4 u_ModelMatrix;
-	float u_MaterialID;
+//indexed by the firstInstance of the indirect draws, that the cluster culling (LucyClusterCull.comp) generates
+layout (set = 0, binding = 5) readonly buffer LucyClusterDrawData {
+	DrawData b_DrawData[];
 };
 
 void main() {
-	a_PosOut = a_Pos;
+	DrawData drawData = b_DrawData[gl_InstanceIndex];
+	vec4 worldPos = drawData.ModelMatrix * vec4(a_Pos, 1.0f);
+
+	a_PosOut = worldPos.xyz;
 	a_TextureCoordsOut = a_TextureCoords;
-	a_NormalsOut = a_Normals;
+	a_NormalsOut = mat3(drawData.ModelMatrix) * a_Normals;
+	a_ObjectNormalsOut = a_Normals;
+	a_MaterialIDOut = drawData.MaterialID;
 
-	a_Depth = (u_ViewMatrix * u_ModelMatrix * vec4(a_Pos, 1.0f)).z;
-	gl_Position = u_ProjMatrix * u_ViewMatrix * u_ModelMatrix * vec4(a_Pos, 1.0f);
+	a_Depth = (u_ViewMatrix * worldPos).z;
+	gl_Position = u_ProjMatrix * u_ViewMatrix * worldPos;
 }
 
 //type fragment
@@ -41,12 +57,15 @@ void main() {
 
 #include "LucySamplingUtilities"
 
-layout (location = 0) in vec3 a_Pos;
+layout (location = 0) in vec3 a_Pos; //world space
 layout (location = 1) in vec2 a_TextureCoords;
-layout (location = 2) in vec3 a_Normals;
+layout (location = 2) in vec3 a_Normals; //world space
 
 layout (location = 3) in float a_Depth;
 
+layout (location = 4) in vec3 a_ObjectNormals;
+layout (location = 5) flat in uint a_MaterialID;
+
 layout (location = 0) out vec4 a_Color;
 
 const uint ROUGHNESS_MASK = 0x00000001u;
@@ -87,11 +106,6 @@ struct DirectionalLight {
 	vec4 DirLightShadowCascadeSplits; //x = 0, y = 1, z = 2, w = 3
 };
 
-layout (push_constant) uniform LocalPushConstant {
-	mat4 u_ModelMatrix;
-	float u_MaterialID;
-};
-
 layout (set = 0, binding = 0) uniform LucyCamera {
 	mat4 u_ViewMatrix;
 	mat4 u_ProjMatrix;
@@ -109,11 +123,12 @@ layout (set = 0, binding = 2) readonly buffer LucyMaterialAttributes {
 layout (set = 0, binding = 3) uniform samplerCube u_IrradianceMap;
 layout (set = 0, binding = 4) uniform sampler2DArray u_ShadowMap;
 
+//every material texture, indexed by the slots of the material attributes (bound once per frame)
 layout (set = 1, binding = 0) uniform sampler2D u_Textures[];
 
 void GetAttributeColor(int slot, vec4 baseColor, out vec4 outColor) {
 	if (slot != NULL_TEXTURE_SLOT)									
-		outColor = texture(u_Textures[slot], a_TextureCoords);
+		outColor = texture(u_Textures[nonuniformEXT(slot)], a_TextureCoords);
 	else														
 		outColor = baseColor;
 }
@@ -122,13 +137,13 @@ void GetAttributeValue(int slot, float baseValue, out float outValue, uint mask)
 	if (slot != NULL_TEXTURE_SLOT) {
 		switch (mask) {															
 			case ROUGHNESS_MASK:												
-				outValue = texture(u_Textures[slot], a_TextureCoords).r;		
+				outValue = texture(u_Textures[nonuniformEXT(slot)], a_TextureCoords).r;		
 				break;
 			case METALLIC_MASK:												
-				outValue = texture(u_Textures[slot], a_TextureCoords).g;		
+				outValue = texture(u_Textures[nonuniformEXT(slot)], a_TextureCoords).g;		
 				break;
 			case AO_MASK:												
-				outValue = texture(u_Textures[slot], a_TextureCoords).b;		
+				outValue = texture(u_Textures[nonuniformEXT(slot)], a_TextureCoords).b;		
 				break;
 		}
 	} else {											
@@ -233,7 +248,7 @@ vec4 ShadowContribution(vec4 modelWorldPos) {
 void main() {
 
 	float alpha = 1.0f;
-	MaterialAttributes attributes = b_MaterialAttributes[int(u_MaterialID)];
+	MaterialAttributes attributes = b_MaterialAttributes[a_MaterialID];
 
 	int albedoSlot			= int(attributes.AlbedoSlot);
 	int normalSlot			= int(attributes.NormalSlot);
@@ -255,8 +270,8 @@ void main() {
 	if (alpha < 0.5f)
 		discard;
 
-	vec4 modelWorldPos = u_ModelMatrix * vec4(a_Pos, 1.0f);
-	vec3 modelNormalNormalized = normalize(mat3(u_ModelMatrix) * a_Normals);
+	vec4 modelWorldPos = vec4(a_Pos, 1.0f);
+	vec3 modelNormalNormalized = normalize(a_Normals);
 	vec4 viewDirCamera = normalize(u_CamPos - modelWorldPos);
 
 	vec3 F0 = vec3(0.04f);
@@ -266,7 +281,7 @@ void main() {
 	vec3 specularContribution = BRDF(viewDirectionLight, viewDirCamera.xyz, modelNormalNormalized, F0, 
 							metallicValue, roughnessValue, albedoColor.rgb, u_DirectionalLight.Color);
 
-	vec3 ambientContribution = texture(u_IrradianceMap, normalize(a_Normals)).rgb;
+	vec3 ambientContribution = texture(u_IrradianceMap, normalize(a_ObjectNormals)).rgb;
 
 	vec3 directLighting = specularContribution * ShadowContribution(modelWorldPos).r;
 	vec3 ambient = ambientContribution * aoValue;
@@ -136,7 +136,7 @@ namespace Lucy {
 					ImGui::TableSetColumnIndex(1);
 					UI::TransformControl("Scale Control", scale.x, scale.y, scale.z, 1.0f, 0.1f);
 
-					t.CalculateMatrix();
+					entityContext.PatchComponent<TransformComponent>([](TransformComponent& transform) { transform.CalculateMatrix(); });
 
 					ImGui::EndTable();
 				}
@@ -173,7 +173,7 @@ namespace Lucy {
 				ImGui::Text("Path");
 				ImGui::SameLine();
 				if (ImGui::InputText("##hideLabel MeshPath", buf, sizeof(buf), ImGuiInputTextFlags_EnterReturnsTrue)) {
-					c.LoadMesh(buf);
+					entityContext.PatchComponent<MeshComponent>([&](MeshComponent& meshComponent) { meshComponent.LoadMesh(buf); });
 					entityContext.GetComponent<TagComponent>().SetTag(c.GetMesh()->GetName());
 				}
 
@@ -183,7 +183,7 @@ namespace Lucy {
 					std::string outPath;
 					Utils::OpenDialog(outPath, Utils::MeshFilterList, 1, "Assets/");
 					if (!outPath.empty()) {
-						c.LoadMesh(outPath);
+						entityContext.PatchComponent<MeshComponent>([&](MeshComponent& meshComponent) { meshComponent.LoadMesh(outPath); });
 						entityContext.GetComponent<TagComponent>().SetTag(c.GetMesh()->GetName());
 					}
 				}
@@ -229,19 +229,23 @@ namespace Lucy {
 							ImGui::EndCombo();
 						}
 
-						float& roughness = material->GetRoughnessValue();
-						float& metallic = material->GetMetallicValue();
-						float& ao = material->GetAOContribution();
+						float roughness = material->GetRoughnessValue();
+						float metallic = material->GetMetallicValue();
+						float ao = material->GetAOContribution();
 
+						//the setters mark the material as dirty, so only edited materials are uploaded again
 						ImGui::Text("Roughness");
 						ImGui::SameLine();
-						ImGui::DragFloat("##hidelabel roughness", &roughness, 0.001f, 0.0f, 1.0f, nullptr, 1.0f);
+						if (ImGui::DragFloat("##hidelabel roughness", &roughness, 0.001f, 0.0f, 1.0f, nullptr, 1.0f))
+							material->SetRoughnessValue(roughness);
 						ImGui::Text("Metallic");
 						ImGui::SameLine();
-						ImGui::DragFloat("##hidelabel metallic", &metallic, 0.001f, 0.0f, 1.0f, nullptr, 1.0f);
+						if (ImGui::DragFloat("##hidelabel metallic", &metallic, 0.001f, 0.0f, 1.0f, nullptr, 1.0f))
+							material->SetMetallicValue(metallic);
 						ImGui::Text("AO");
 						ImGui::SameLine();
-						ImGui::DragFloat("##hidelabel ao", &ao, 0.001f, 0.0f, 1.0f, nullptr, 1.0f);
+						if (ImGui::DragFloat("##hidelabel ao", &ao, 0.001f, 0.0f, 1.0f, nullptr, 1.0f))
+							material->SetAOContribution(ao);
 
 						ImGui::PopID();
 					}
@@ -16,9 +16,10 @@ namespace Lucy {
 			if (viewportPanel.IsOverAnyGizmo() || !viewportPanel.IsViewportActive()) return;
 
 			if (e == MouseCode::Button0) {
-				Entity entity{};
-				EventHandler::DispatchImmediateEvent<EntityPickedEvent>(entity, m_Scene.get(), viewportPanel.GetViewportMouseX(), viewportPanel.GetViewportMouseY());
-				SetEntityContext(entity);
+				EventHandler::DispatchImmediateEvent<EntityPickedEvent>(m_Scene.get(), viewportPanel.GetViewportMouseX(), viewportPanel.GetViewportMouseY(),
+																		viewportPanel.GetViewportWidth(), viewportPanel.GetViewportHeight(), [this](Entity entity) {
+					SetEntityContext(entity);
+				});
 			}
 		});
 	}
@@ -97,6 +97,9 @@ namespace Lucy {
 			t.GetPosition().x = matrixTranslation[0]; t.GetPosition().y = matrixTranslation[1]; t.GetPosition().z = matrixTranslation[2];
 			t.GetRotation().x = matrixRotation[0]; t.GetRotation().y = matrixRotation[1]; t.GetRotation().z = matrixRotation[2];
 			t.GetScale().x = matrixScale[0]; t.GetScale().y = matrixScale[1]; t.GetScale().z = matrixScale[2];
+			//the matrix has been changed by the gizmo
+			if (ImGuizmo::IsUsing())
+				e.PatchComponent<TransformComponent>();
 		}
 
 		ImGui::End();
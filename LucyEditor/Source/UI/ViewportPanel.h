@@ -29,6 +29,8 @@ namespace Lucy {
 
 		inline float GetViewportMouseX() const { return m_ViewportMouseX; }
 		inline float GetViewportMouseY() const { return m_ViewportMouseY; }
+		inline float GetViewportWidth() const { return m_Size.x; }
+		inline float GetViewportHeight() const { return m_Size.y; }
 
 		void OnEvent(Event& e) final override;
 	private:
@@ -64,10 +64,29 @@ static void LucyVulkanAssert(int32_t result, const std::source_location& locatio
 #define LUCY_PROFILE_NEW_FRAME(Name)								FrameMarkNamed(Name)
 #define LUCY_PROFILE_NEW_THREAD(Name)								(void)0;
 #define LUCY_PROFILE_NEW_EVENT(Name)								ZoneScopedN(Name)
+#define LUCY_PROFILE_PLOT(Name, Value)								TracyPlot(Name, Value)
 #define LUCY_PROFILE_DESTROY()										(void)0;
 
 #define IMGUI_DEFINE_MATH_OPERATORS
 
 #define USE_COMPUTE_FOR_CUBEMAP_GEN 1
 
+//backface cone culling of meshlets. Only applied, if the geometry pipeline culls back faces as well (the PBR pipeline renders double sided)
+#define USE_CLUSTER_CONE_CULLING 0
+
+//two phase Hi-Z occlusion culling of meshlets (early: against the depth of the last frame, late: against the depth of the early phase)
+#define USE_HIZ_OCCLUSION_CULLING 1
+
+//mouse picking with the ID pass (rendered on demand, only into the picked pixel) instead of a ray cast against the BVH and the triangles of the scene
+#define USE_GPU_PICKING 0
+
+//material textures are BC7 compressed on their first load and cached as KTX2 files (Assets/Textures/Cached/)
+#define USE_BLOCK_COMPRESSED_TEXTURES 1
+
+//only the low mips of the cached material textures are loaded, the finer ones are streamed in by their screen size (and evicted within a VRAM budget)
+#define USE_TEXTURE_STREAMING 1
+
+//mip chains are generated by a single compute dispatch (LucyMipGen.comp) instead of a blit per level and layer
+#define USE_COMPUTE_FOR_MIPMAP_GEN 1
+
 #define USE_INTEGRATED_GRAPHICS 0
\ No newline at end of file
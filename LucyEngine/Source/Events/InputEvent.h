@@ -121,23 +121,31 @@ namespace Lucy {
 		GLFWwindow* m_Window;
 	};
 
+	//called with the picked entity (invalid, if nothing has been hit).
+	//depending on the picking method, this happens immediately or some frames later
+	using EntityPickedFunc = std::function<void(Entity)>;
+
 	struct EntityPickedEvent : public Event {
 		inline static constexpr const EventType EventType = EventType::EntityPickedEvent;
 
-		EntityPickedEvent(Entity& entity, Scene* scene, float viewportMouseX, float viewportMouseY) 
-			: Event(EventType), m_Scene(scene), m_Entity(entity), m_ViewportMouseX(viewportMouseX), m_ViewportMouseY(viewportMouseY) {
+		EntityPickedEvent(Scene* scene, float viewportMouseX, float viewportMouseY, float viewportWidth, float viewportHeight, EntityPickedFunc&& onPicked)
+			: Event(EventType), m_Scene(scene), m_OnPicked(std::move(onPicked)), m_ViewportMouseX(viewportMouseX), m_ViewportMouseY(viewportMouseY),
+			m_ViewportWidth(viewportWidth), m_ViewportHeight(viewportHeight) {
 		}
 		virtual ~EntityPickedEvent() = default;
 
 		inline Scene* GetScene() const { return m_Scene; }
-		inline Entity& GetEntity() const { return m_Entity; }
+		inline const EntityPickedFunc& GetOnPickedFunc() const { return m_OnPicked; }
 
 		inline float GetViewportMouseX() const { return m_ViewportMouseX; }
 		inline float GetViewportMouseY() const { return m_ViewportMouseY; }
+		inline float GetViewportWidth() const { return m_ViewportWidth; }
+		inline float GetViewportHeight() const { return m_ViewportHeight; }
 	private:
 		Scene* m_Scene = nullptr;
-		Entity& m_Entity;
+		EntityPickedFunc m_OnPicked;
 
 		float m_ViewportMouseX = 0, m_ViewportMouseY = 0;
+		float m_ViewportWidth = 0, m_ViewportHeight = 0;
 	};
 }
\ No newline at end of file
@@ -10,6 +10,7 @@
 #include "Renderer/Pipeline/ComputePipeline.h"
 
 #include "Renderer/Image/VulkanImage.h"
+#include "Renderer/Memory/Buffer/Vulkan/VulkanSharedStorageBuffer.h"
 
 namespace Lucy {
 
@@ -178,6 +179,13 @@ namespace Lucy {
 		m_RenderDevice->DrawIndexed(m_PrimaryCommandPool, indexCount, instanceCount, firstIndex, vertexOffset, firstInstance);
 	}
 
+	void RenderCommand::DrawIndexedIndirectCount(Ref<Mesh> mesh, Ref<SharedStorageBuffer> commandBuffer, uint64_t commandOffset,
+												 Ref<SharedStorageBuffer> countBuffer, uint64_t countOffset, uint32_t maxDrawCount) {
+		LUCY_ASSERT(m_BoundedGraphicsPipeline, "DrawIndexedIndirectCount failed, bounded pipeline is nullptr.");
+		BindBuffers(mesh);
+		m_RenderDevice->DrawIndexedIndirectCount(m_PrimaryCommandPool, commandBuffer, commandOffset, countBuffer, countOffset, maxDrawCount);
+	}
+
 	void RenderCommand::DispatchCompute(uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ) {
 		LUCY_ASSERT(m_BoundedComputePipeline, "DispatchCompute failed, bounded pipeline is nullptr.");
 		m_RenderDevice->DispatchCompute(m_PrimaryCommandPool, m_BoundedComputePipeline, groupCountX, groupCountY, groupCountZ);
@@ -191,6 +199,31 @@ namespace Lucy {
 			(VkImageLayout)newLayout, baseMipLevel, baseArrayLayer, levelCount, layerCount);
 	}
 
+	void RenderCommand::SetBufferBarrier(Ref<SharedStorageBuffer> buffer, uint32_t srcAccessMask, uint32_t dstAccessMask, uint32_t srcStage, uint32_t dstStage) {
+		if (Renderer::GetRenderArchitecture() != RenderArchitecture::Vulkan)
+			return;
+		const auto& vulkanBuffer = buffer->As<VulkanSharedStorageBuffer>();
+		BufferMemoryBarrier barrier({
+			.BufferHandle = vulkanBuffer->GetVulkanBufferHandle(Renderer::GetCurrentFrameIndex()),
+			.SrcAccessMask = (VkAccessFlags)srcAccessMask,
+			.DstAccessMask = (VkAccessFlags)dstAccessMask,
+			.SrcStage = (VkPipelineStageFlags)srcStage,
+			.DstStage = (VkPipelineStageFlags)dstStage,
+		});
+		barrier.RunBarrier((VkCommandBuffer)m_PrimaryCommandPool->GetCurrentFrameCommandBuffer());
+	}
+
+	void RenderCommand::SetMemoryBarrier(uint32_t srcAccessMask, uint32_t dstAccessMask, uint32_t srcStage, uint32_t dstStage) {
+		if (Renderer::GetRenderArchitecture() != RenderArchitecture::Vulkan)
+			return;
+		VkMemoryBarrier barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		barrier.srcAccessMask = (VkAccessFlags)srcAccessMask;
+		barrier.dstAccessMask = (VkAccessFlags)dstAccessMask;
+		vkCmdPipelineBarrier((VkCommandBuffer)m_PrimaryCommandPool->GetCurrentFrameCommandBuffer(), (VkPipelineStageFlags)srcStage, (VkPipelineStageFlags)dstStage,
+							 0, 1, &barrier, 0, nullptr, 0, nullptr);
+	}
+
 	void RenderCommand::CopyImageToImage(Ref<Image> srcImage, Ref<Image> destImage, const std::vector<VkImageCopy>& regions) {
 		if (Renderer::GetRenderArchitecture() != RenderArchitecture::Vulkan)
 			return;
@@ -229,6 +262,13 @@ namespace Lucy {
 		m_DynamicClearColor = clearColor;
 	}
 
+	void RenderCommand::SetScissor(int32_t x, int32_t y, uint32_t width, uint32_t height) {
+		if (Renderer::GetRenderArchitecture() != RenderArchitecture::Vulkan)
+			return;
+		const VkRect2D scissor = { { x, y }, { width, height } };
+		vkCmdSetScissor((VkCommandBuffer)m_PrimaryCommandPool->GetCurrentFrameCommandBuffer(), 0, 1, &scissor);
+	}
+
 	void RenderCommand::SetDepthWriteEnable(bool depthWriteEnable) {
 		m_DynamicDepthConfig.DepthWriteEnable = depthWriteEnable;
 	}
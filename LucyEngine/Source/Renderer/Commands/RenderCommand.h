@@ -22,6 +22,7 @@ namespace Lucy {
 
 	class VertexBuffer;
 	class IndexBuffer;
+	class SharedStorageBuffer;
 
 	class RenderCommand final {
 	public:
@@ -35,6 +36,8 @@ namespace Lucy {
 		void SetPolygonMode(PolygonMode polygonMode);
 
 		void SetClearColor(ClearColor clearColor);
+		//recorded immediately, overrides the scissor of the render pass (the whole viewport) for the following draws
+		void SetScissor(int32_t x, int32_t y, uint32_t width, uint32_t height);
 #pragma endregion Rasterization
 #pragma region DepthConfiguration
 		void SetDepthWriteEnable(bool depthWriteEnable);
@@ -50,6 +53,11 @@ namespace Lucy {
 		void CopyBufferToImage(Ref<ByteBuffer> srcBuffer, Ref<Image> destImage);
 		void CopyImageToBuffer(Ref<Image> srcImage, Ref<ByteBuffer> destBuffer);
 #pragma endregion Image
+#pragma region Buffer
+		void SetBufferBarrier(Ref<SharedStorageBuffer> buffer, uint32_t srcAccessMask, uint32_t dstAccessMask, uint32_t srcStage, uint32_t dstStage);
+		//global barrier, for resources that are accessed by another stage without a layout transition (e.g. a depth attachment that is sampled in a compute shader)
+		void SetMemoryBarrier(uint32_t srcAccessMask, uint32_t dstAccessMask, uint32_t srcStage, uint32_t dstStage);
+#pragma endregion Buffer
 
 		void BindBuffers(Ref<Mesh> mesh);
 		void BindBuffers(Ref<VertexBuffer> vertexBuffer, Ref<IndexBuffer> indexBuffer);
@@ -70,6 +78,9 @@ namespace Lucy {
 		void DrawMeshWithPushConstant(Ref<Mesh> mesh);
 
 		void DrawIndexed(uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex, int32_t vertexOffset, uint32_t firstInstance);
+		//the draw commands and the draw count are expected to be written by the GPU (e.g. cluster culling)
+		void DrawIndexedIndirectCount(Ref<Mesh> mesh, Ref<SharedStorageBuffer> commandBuffer, uint64_t commandOffset,
+									  Ref<SharedStorageBuffer> countBuffer, uint64_t countOffset, uint32_t maxDrawCount);
 		void DispatchCompute(uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ);
 
 		inline double GetRenderTime(const std::vector<uint64_t>& renderTimes) const { return (double)(renderTimes[m_EndTimestampIndex] - renderTimes[m_BeginTimestampIndex]); }
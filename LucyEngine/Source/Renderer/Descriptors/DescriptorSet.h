@@ -6,10 +6,8 @@ namespace Lucy {
 
 #if USE_INTEGRATED_GRAPHICS
 	constexpr uint32_t MAX_DYNAMIC_DESCRIPTOR_COUNT = 32u;
-	constexpr uint32_t MAX_DYNAMICALLY_ALLOCATED_BUFFER_SIZE = 1024u * 10u;
 #else
 	constexpr uint32_t MAX_DYNAMIC_DESCRIPTOR_COUNT = 1024u;
-	constexpr uint32_t MAX_DYNAMICALLY_ALLOCATED_BUFFER_SIZE = MAX_DYNAMIC_DESCRIPTOR_COUNT * 10u; //10 kilobytes
 #endif
 
 	struct DescriptorSetCreateInfo {
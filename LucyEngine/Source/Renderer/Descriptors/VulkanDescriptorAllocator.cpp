@@ -0,0 +1,266 @@
+#include "lypch.h"
+#include "VulkanDescriptorAllocator.h"
+
+#include "Renderer/Renderer.h"
+
+#include "Utilities/Utilities.h"
+
+namespace Lucy {
+
+	//the descriptors of each type per set, that a new pool is created with (in addition to what the layout it has been created for needs)
+	static constexpr std::array<VkDescriptorPoolSize, 6> s_DescriptorsPerSet = {{
+		{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 2 },
+		{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 2 },
+		{ VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 4 },
+		{ VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1 },
+		{ VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, 1 },
+		{ VK_DESCRIPTOR_TYPE_SAMPLER, 1 }
+	}};
+
+	//the shader sets are written after they have been bound (bindless), the sets of a destroyed shader are freed individually
+	static constexpr VkDescriptorPoolCreateFlags s_PersistentPoolFlags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
+
+	void VulkanDescriptorAllocator::Init(VkDevice logicalDevice) {
+		m_LogicalDevice = logicalDevice;
+	}
+
+	void VulkanDescriptorAllocator::Destroy() {
+		//the sets are freed together with their pools
+		for (const Ref<VulkanDescriptorPool>& pool : m_PersistentPools.Pools)
+			pool->RTDestroyResource();
+		m_PersistentPools.Pools.clear();
+
+		for (PoolList& poolList : m_FramePools) {
+			for (const Ref<VulkanDescriptorPool>& pool : poolList.Pools)
+				pool->RTDestroyResource();
+		}
+		m_FramePools.clear();
+		m_FrameSetCaches.clear();
+
+		for (const CachedLayout& cachedLayout : m_Layouts | std::views::values)
+			s_DestroyDescriptorSetLayout(m_LogicalDevice, cachedLayout.Layout, nullptr);
+		m_Layouts.clear();
+		m_LayoutPoolSizes.clear();
+	}
+
+	VkDescriptorSetLayout VulkanDescriptorAllocator::RTGetLayout(const std::vector<VkDescriptorSetLayoutBinding>& bindings, const std::vector<VkDescriptorBindingFlags>& bindingFlags) {
+		LUCY_ASSERT(Renderer::IsOnRenderThread());
+		LUCY_ASSERT(bindings.size() == bindingFlags.size());
+
+		const auto IsSameBinding = [](const VkDescriptorSetLayoutBinding& lhs, const VkDescriptorSetLayoutBinding& rhs) {
+			return lhs.binding == rhs.binding && lhs.descriptorType == rhs.descriptorType && lhs.descriptorCount == rhs.descriptorCount &&
+				lhs.stageFlags == rhs.stageFlags && lhs.pImmutableSamplers == rhs.pImmutableSamplers;
+		};
+
+		const size_t hash = HashLayout(bindings, bindingFlags);
+		auto [begin, end] = m_Layouts.equal_range(hash);
+		for (auto it = begin; it != end; it++) {
+			const CachedLayout& cachedLayout = it->second;
+			if (cachedLayout.BindingFlags == bindingFlags && std::ranges::equal(cachedLayout.Bindings, bindings, IsSameBinding))
+				return cachedLayout.Layout;
+		}
+
+		VkDescriptorSetLayoutCreateInfo descriptorLayoutInfo = VulkanAPI::DescriptorSetCreateInfo((uint32_t)bindings.size(), bindings.data());
+		VkDescriptorSetLayoutBindingFlagsCreateInfo extendedLayoutInfo = VulkanAPI::DescriptorSetLayoutBindingFlagsCreateInfo((uint32_t)bindings.size(), bindingFlags.data());
+		descriptorLayoutInfo.pNext = &extendedLayoutInfo;
+
+		VkDescriptorSetLayout layout = VK_NULL_HANDLE;
+		LUCY_VK_ASSERT(s_CreateDescriptorSetLayout(m_LogicalDevice, &descriptorLayoutInfo, nullptr, &layout));
+		m_Layouts.emplace(hash, CachedLayout{ bindings, bindingFlags, layout });
+
+		std::vector<VkDescriptorPoolSize>& poolSizes = m_LayoutPoolSizes[layout];
+		for (const VkDescriptorSetLayoutBinding& binding : bindings) {
+			auto it = std::ranges::find(poolSizes, binding.descriptorType, &VkDescriptorPoolSize::type);
+			if (it == poolSizes.end())
+				poolSizes.push_back({ binding.descriptorType, binding.descriptorCount });
+			else
+				it->descriptorCount += binding.descriptorCount;
+		}
+		return layout;
+	}
+
+	VkDescriptorPool VulkanDescriptorAllocator::RTAllocatePersistent(VkDescriptorSetLayout layout, uint32_t count, VkDescriptorSet* descriptorSets, uint32_t variableDescriptorCount) {
+		LUCY_ASSERT(Renderer::IsOnRenderThread());
+
+		VkDescriptorPool pool = RTAllocate(m_PersistentPools, s_PersistentPoolFlags, layout, count, descriptorSets, variableDescriptorCount);
+		m_PersistentSetCount += count;
+		return pool;
+	}
+
+	void VulkanDescriptorAllocator::RTFreePersistent(VkDescriptorPool pool, uint32_t count, const VkDescriptorSet* descriptorSets) {
+		LUCY_ASSERT(Renderer::IsOnRenderThread());
+
+		//the pools might have been destroyed in the meantime (shutdown), together with their sets
+		if (std::ranges::none_of(m_PersistentPools.Pools, [pool](const Ref<VulkanDescriptorPool>& p) { return p->GetVulkanHandle() == pool; }))
+			return;
+
+		s_FreeDescriptorSets(m_LogicalDevice, pool, count, descriptorSets);
+		m_PersistentSetCount -= count;
+	}
+
+	VkDescriptorSet VulkanDescriptorAllocator::RTAllocateFrameSet(uint32_t frameIndex, VkDescriptorSetLayout layout, std::span<VkWriteDescriptorSet> writes) {
+		LUCY_ASSERT(Renderer::IsOnRenderThread());
+		LUCY_PROFILE_NEW_EVENT("VulkanDescriptorAllocator::RTAllocateFrameSet");
+
+		if (m_FramePools.size() <= frameIndex) {
+			m_FramePools.resize(frameIndex + 1);
+			m_FrameSetCaches.resize(frameIndex + 1);
+		}
+
+		std::vector<FrameSetDescriptor> descriptors = GetFrameSetDescriptors(writes);
+		const size_t hash = HashFrameSet(layout, descriptors);
+
+		auto& frameSetCache = m_FrameSetCaches[frameIndex];
+		auto [begin, end] = frameSetCache.equal_range(hash);
+		for (auto it = begin; it != end; it++) {
+			const CachedFrameSet& cachedFrameSet = it->second;
+			if (cachedFrameSet.Layout == layout && cachedFrameSet.Descriptors == descriptors) {
+				m_FrameSetCacheHits++;
+				return cachedFrameSet.Set;
+			}
+		}
+
+		VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+		RTAllocate(m_FramePools[frameIndex], 0, layout, 1, &descriptorSet, 0);
+		m_FrameSetCount++;
+
+		for (VkWriteDescriptorSet& write : writes)
+			write.dstSet = descriptorSet;
+		s_UpdateDescriptorSets(m_LogicalDevice, (uint32_t)writes.size(), writes.data(), 0, nullptr);
+
+		frameSetCache.emplace(hash, CachedFrameSet{ layout, std::move(descriptors), descriptorSet });
+		return descriptorSet;
+	}
+
+	void VulkanDescriptorAllocator::RTResetFramePools(uint32_t frameIndex) {
+		LUCY_ASSERT(Renderer::IsOnRenderThread());
+
+		m_FrameSetCount = 0;
+		m_FrameSetCacheHits = 0;
+		if (m_FramePools.size() <= frameIndex)
+			return;
+
+		for (const Ref<VulkanDescriptorPool>& pool : m_FramePools[frameIndex].Pools)
+			s_ResetDescriptorPool(m_LogicalDevice, pool->GetVulkanHandle(), 0);
+		m_FrameSetCaches[frameIndex].clear();
+	}
+
+	VulkanDescriptorAllocatorStats VulkanDescriptorAllocator::GetStats() const {
+		VulkanDescriptorAllocatorStats stats;
+		stats.PersistentPoolCount = (uint32_t)m_PersistentPools.Pools.size();
+		stats.PersistentSetCount = m_PersistentSetCount;
+		for (const PoolList& poolList : m_FramePools)
+			stats.FramePoolCount += (uint32_t)poolList.Pools.size();
+		stats.FrameSetCount = m_FrameSetCount;
+		stats.FrameSetCacheHits = m_FrameSetCacheHits;
+		stats.LayoutCount = (uint32_t)m_Layouts.size();
+		return stats;
+	}
+
+	VkDescriptorPool VulkanDescriptorAllocator::RTAllocate(PoolList& poolList, VkDescriptorPoolCreateFlags poolFlags, VkDescriptorSetLayout layout, uint32_t count,
+														   VkDescriptorSet* descriptorSets, uint32_t variableDescriptorCount) {
+		std::vector<VkDescriptorSetLayout> layouts(count, layout);
+		std::vector<uint32_t> variableDescriptorCounts(count, variableDescriptorCount);
+		VkDescriptorSetVariableDescriptorCountAllocateInfo variableCountAllocInfo = VulkanAPI::DescriptorSetVariableDescriptorCountAllocateInfo(count, variableDescriptorCounts.data());
+
+		const auto TryAllocate = [&](VkDescriptorPool pool) {
+			VkDescriptorSetAllocateInfo allocInfo = VulkanAPI::DescriptorSetAllocateInfo(count, layouts.data(), pool);
+			if (variableDescriptorCount != 0)
+				allocInfo.pNext = &variableCountAllocInfo;
+			return s_AllocateDescriptorSets(m_LogicalDevice, &allocInfo, descriptorSets);
+		};
+
+		if (!poolList.Pools.empty()) {
+			VkDescriptorPool pool = poolList.Pools.back()->GetVulkanHandle();
+			VkResult result = TryAllocate(pool);
+			if (result == VK_SUCCESS)
+				return pool;
+			LUCY_ASSERT(result == VK_ERROR_OUT_OF_POOL_MEMORY || result == VK_ERROR_FRAGMENTED_POOL, "Descriptor set allocation failed!");
+		}
+
+		RTCreatePool(poolList, poolFlags, layout, count, variableDescriptorCount);
+
+		VkDescriptorPool pool = poolList.Pools.back()->GetVulkanHandle();
+		LUCY_VK_ASSERT(TryAllocate(pool));
+		return pool;
+	}
+
+	void VulkanDescriptorAllocator::RTCreatePool(PoolList& poolList, VkDescriptorPoolCreateFlags poolFlags, VkDescriptorSetLayout layout, uint32_t setCount, uint32_t variableDescriptorCount) {
+		//the previous pools stay alive until they are reset or destroyed, the new one takes twice as many sets
+		if (!poolList.Pools.empty())
+			poolList.SetsPerPool = glm::min(poolList.SetsPerPool * 2, s_MaxSetsPerPool);
+		const uint32_t maxSets = glm::max(poolList.SetsPerPool, setCount);
+
+		std::vector<VkDescriptorPoolSize> poolSizes(s_DescriptorsPerSet.begin(), s_DescriptorsPerSet.end());
+		for (VkDescriptorPoolSize& poolSize : poolSizes)
+			poolSize.descriptorCount *= maxSets;
+
+		//a pool fits every set of the layout, that it is created for (e.g. the storage images of the mip generation exceed the default sizes).
+		//Bindless layouts are sized by their upper bound, the pool only fits the sets, that it is created for
+		const uint32_t layoutSetCount = variableDescriptorCount != 0 ? setCount : maxSets;
+		for (VkDescriptorPoolSize layoutPoolSize : m_LayoutPoolSizes.at(layout)) {
+			layoutPoolSize.descriptorCount *= layoutSetCount;
+
+			auto it = std::ranges::find(poolSizes, layoutPoolSize.type, &VkDescriptorPoolSize::type);
+			if (it == poolSizes.end())
+				poolSizes.push_back(layoutPoolSize);
+			else
+				it->descriptorCount = glm::max(it->descriptorCount, layoutPoolSize.descriptorCount);
+		}
+
+		VulkanDescriptorPoolCreateInfo poolCreateInfo;
+		poolCreateInfo.PoolSizesVector = std::move(poolSizes);
+		poolCreateInfo.MaxSet = maxSets;
+		poolCreateInfo.PoolFlags = poolFlags;
+		poolCreateInfo.LogicalDevice = m_LogicalDevice;
+		poolList.Pools.push_back(Memory::CreateRef<VulkanDescriptorPool>(poolCreateInfo));
+	}
+
+	size_t VulkanDescriptorAllocator::HashLayout(const std::vector<VkDescriptorSetLayoutBinding>& bindings, const std::vector<VkDescriptorBindingFlags>& bindingFlags) {
+		size_t hash = 0;
+		for (size_t i = 0; i < bindings.size(); i++) {
+			Utils::HashCombine(hash, bindings[i].binding);
+			Utils::HashCombine(hash, (size_t)bindings[i].descriptorType);
+			Utils::HashCombine(hash, bindings[i].descriptorCount);
+			Utils::HashCombine(hash, bindings[i].stageFlags);
+			Utils::HashCombine(hash, bindingFlags[i]);
+		}
+		return hash;
+	}
+
+	std::vector<VulkanDescriptorAllocator::FrameSetDescriptor> VulkanDescriptorAllocator::GetFrameSetDescriptors(std::span<const VkWriteDescriptorSet> writes) {
+		std::vector<FrameSetDescriptor> descriptors;
+		for (const VkWriteDescriptorSet& write : writes) {
+			for (uint32_t i = 0; i < write.descriptorCount; i++) {
+				FrameSetDescriptor& descriptor = descriptors.emplace_back();
+				descriptor.Binding = write.dstBinding;
+				descriptor.ArrayElement = write.dstArrayElement + i;
+				descriptor.Type = write.descriptorType;
+
+				if (write.pImageInfo) {
+					descriptor.Resource = (uint64_t)write.pImageInfo[i].imageView;
+					descriptor.SamplerOrOffset = (uint64_t)write.pImageInfo[i].sampler;
+					descriptor.LayoutOrRange = (uint64_t)write.pImageInfo[i].imageLayout;
+				} else if (write.pBufferInfo) {
+					descriptor.Resource = (uint64_t)write.pBufferInfo[i].buffer;
+					descriptor.SamplerOrOffset = write.pBufferInfo[i].offset;
+					descriptor.LayoutOrRange = write.pBufferInfo[i].range;
+				}
+			}
+		}
+		return descriptors;
+	}
+
+	size_t VulkanDescriptorAllocator::HashFrameSet(VkDescriptorSetLayout layout, const std::vector<FrameSetDescriptor>& descriptors) {
+		size_t hash = std::hash<uint64_t>{}((uint64_t)layout);
+		for (const FrameSetDescriptor& descriptor : descriptors) {
+			Utils::HashCombine(hash, descriptor.Binding);
+			Utils::HashCombine(hash, descriptor.ArrayElement);
+			Utils::HashCombine(hash, (size_t)descriptor.Type);
+			Utils::HashCombine(hash, descriptor.Resource);
+			Utils::HashCombine(hash, descriptor.SamplerOrOffset);
+			Utils::HashCombine(hash, descriptor.LayoutOrRange);
+		}
+		return hash;
+	}
+}
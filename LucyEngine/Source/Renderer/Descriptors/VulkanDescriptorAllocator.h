@@ -0,0 +1,112 @@
+#pragma once
+
+#include <span>
+
+#include "Renderer/Descriptors/VulkanDescriptorPool.h"
+
+namespace Lucy {
+
+	struct VulkanDescriptorAllocatorStats {
+		uint32_t PersistentPoolCount = 0;
+		uint32_t PersistentSetCount = 0; //currently allocated
+		uint32_t FramePoolCount = 0; //of every frame in flight
+		uint32_t FrameSetCount = 0; //allocated in the current frame
+		uint32_t FrameSetCacheHits = 0; //in the current frame
+		uint32_t LayoutCount = 0;
+	};
+
+	/*
+	* Owns every descriptor set layout and the pools of the shader descriptor sets and the transient sets of a frame (e.g. the mip generation).
+	* Layouts are cached by their bindings, so shaders with the same set layout share a single VkDescriptorSetLayout.
+	* Both pool lists grow instead of failing: a new pool (with twice the sets of the last one) is created once the last one is exhausted.
+	* The frame pools are reset as a whole once the fence of their frame has been waited on, frame sets with the same layout and writes are
+	* allocated (and written) only once per frame.
+	* Persistent sets are not shared: each one belongs to a shader, which writes its own buffers into it in place (VulkanDescriptorSet::RTUpdate).
+	*/
+	class VulkanDescriptorAllocator final {
+	public:
+		VulkanDescriptorAllocator() = default;
+		~VulkanDescriptorAllocator() = default;
+
+		void Init(VkDevice logicalDevice);
+		void Destroy();
+
+		//the layouts live as long as the allocator, they must not be destroyed by the caller
+		VkDescriptorSetLayout RTGetLayout(const std::vector<VkDescriptorSetLayoutBinding>& bindings, const std::vector<VkDescriptorBindingFlags>& bindingFlags);
+
+		//variableDescriptorCount is the size of the bindless binding of each set, 0 if the layout has none. Returns the pool, that the sets have to be freed with
+		VkDescriptorPool RTAllocatePersistent(VkDescriptorSetLayout layout, uint32_t count, VkDescriptorSet* descriptorSets, uint32_t variableDescriptorCount = 0);
+		void RTFreePersistent(VkDescriptorPool pool, uint32_t count, const VkDescriptorSet* descriptorSets);
+
+		//the set is valid until the pools of the frame are reset. The dstSet of the writes is ignored, they are only applied if there is no cached set with the same writes
+		VkDescriptorSet RTAllocateFrameSet(uint32_t frameIndex, VkDescriptorSetLayout layout, std::span<VkWriteDescriptorSet> writes);
+		//expects the fence of the frame to be signaled
+		void RTResetFramePools(uint32_t frameIndex);
+
+		VulkanDescriptorAllocatorStats GetStats() const;
+
+		static constexpr uint32_t s_InitialSetsPerPool = 64;
+		static constexpr uint32_t s_MaxSetsPerPool = 4096;
+
+		//replaceable, so that the pools and sets can be tracked without a device (see VulkanDescriptorPool for the pools themselves)
+		static inline PFN_vkCreateDescriptorSetLayout s_CreateDescriptorSetLayout = vkCreateDescriptorSetLayout;
+		static inline PFN_vkDestroyDescriptorSetLayout s_DestroyDescriptorSetLayout = vkDestroyDescriptorSetLayout;
+		static inline PFN_vkAllocateDescriptorSets s_AllocateDescriptorSets = vkAllocateDescriptorSets;
+		static inline PFN_vkFreeDescriptorSets s_FreeDescriptorSets = vkFreeDescriptorSets;
+		static inline PFN_vkResetDescriptorPool s_ResetDescriptorPool = vkResetDescriptorPool;
+		static inline PFN_vkUpdateDescriptorSets s_UpdateDescriptorSets = vkUpdateDescriptorSets;
+	private:
+		struct CachedLayout {
+			std::vector<VkDescriptorSetLayoutBinding> Bindings;
+			std::vector<VkDescriptorBindingFlags> BindingFlags;
+			VkDescriptorSetLayout Layout = VK_NULL_HANDLE;
+		};
+
+		//a single descriptor of a frame set write, the resource is the image view and sampler or the buffer
+		struct FrameSetDescriptor {
+			uint32_t Binding = 0;
+			uint32_t ArrayElement = 0;
+			VkDescriptorType Type = VK_DESCRIPTOR_TYPE_MAX_ENUM;
+			uint64_t Resource = 0;
+			uint64_t SamplerOrOffset = 0;
+			uint64_t LayoutOrRange = 0;
+
+			bool operator==(const FrameSetDescriptor& other) const = default;
+		};
+
+		//the frame sets are compared by their key on a hash hit, the handles can't be reused within the frame (destruction is deferred)
+		struct CachedFrameSet {
+			VkDescriptorSetLayout Layout = VK_NULL_HANDLE;
+			std::vector<FrameSetDescriptor> Descriptors;
+			VkDescriptorSet Set = VK_NULL_HANDLE;
+		};
+
+		struct PoolList {
+			std::vector<Ref<VulkanDescriptorPool>> Pools; //only the last pool is allocated from
+			uint32_t SetsPerPool = s_InitialSetsPerPool;
+		};
+
+		//allocates from the last pool of the list and appends a new one, if it is exhausted
+		VkDescriptorPool RTAllocate(PoolList& poolList, VkDescriptorPoolCreateFlags poolFlags, VkDescriptorSetLayout layout, uint32_t count,
+									VkDescriptorSet* descriptorSets, uint32_t variableDescriptorCount);
+		//the bindless bindings are sized by the upper bound of the layout
+		void RTCreatePool(PoolList& poolList, VkDescriptorPoolCreateFlags poolFlags, VkDescriptorSetLayout layout, uint32_t setCount, uint32_t variableDescriptorCount);
+
+		static size_t HashLayout(const std::vector<VkDescriptorSetLayoutBinding>& bindings, const std::vector<VkDescriptorBindingFlags>& bindingFlags);
+		static std::vector<FrameSetDescriptor> GetFrameSetDescriptors(std::span<const VkWriteDescriptorSet> writes);
+		static size_t HashFrameSet(VkDescriptorSetLayout layout, const std::vector<FrameSetDescriptor>& descriptors);
+
+		VkDevice m_LogicalDevice = VK_NULL_HANDLE;
+
+		std::unordered_multimap<size_t, CachedLayout> m_Layouts;
+		std::unordered_map<VkDescriptorSetLayout, std::vector<VkDescriptorPoolSize>> m_LayoutPoolSizes; //the descriptors of a single set
+
+		PoolList m_PersistentPools;
+		uint32_t m_PersistentSetCount = 0;
+
+		std::vector<PoolList> m_FramePools; //per frame in flight
+		std::vector<std::unordered_multimap<size_t, CachedFrameSet>> m_FrameSetCaches;
+		uint32_t m_FrameSetCount = 0;
+		uint32_t m_FrameSetCacheHits = 0;
+	};
+}
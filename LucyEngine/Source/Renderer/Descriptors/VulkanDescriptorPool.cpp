@@ -15,11 +15,11 @@ namespace Lucy {
 		VkDescriptorPoolCreateInfo info = VulkanAPI::DescriptorPoolCreateInfo((uint32_t)m_CreateInfo.PoolSizesVector.size(), m_CreateInfo.PoolSizesVector.data(), 
 																			  m_CreateInfo.MaxSet, m_CreateInfo.PoolFlags);
 
-		LUCY_VK_ASSERT(vkCreateDescriptorPool(m_CreateInfo.LogicalDevice, &info, nullptr, &m_DescriptorPool));
+		LUCY_VK_ASSERT(s_CreateDescriptorPool(m_CreateInfo.LogicalDevice, &info, nullptr, &m_DescriptorPool));
 	}
 
 	void VulkanDescriptorPool::RTDestroyResource() {
 		LUCY_ASSERT(Renderer::IsOnRenderThread());
-		vkDestroyDescriptorPool(m_CreateInfo.LogicalDevice, m_DescriptorPool, nullptr);
+		s_DestroyDescriptorPool(m_CreateInfo.LogicalDevice, m_DescriptorPool, nullptr);
 	}
 }
\ No newline at end of file
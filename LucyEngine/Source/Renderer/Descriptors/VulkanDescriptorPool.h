@@ -19,6 +19,10 @@ namespace Lucy {
 		void RTDestroyResource();
 
 		inline VkDescriptorPool GetVulkanHandle() const noexcept { return m_DescriptorPool; }
+
+		//replaceable, so that the pools can be tracked without a device (see VulkanDescriptorAllocator)
+		static inline PFN_vkCreateDescriptorPool s_CreateDescriptorPool = vkCreateDescriptorPool;
+		static inline PFN_vkDestroyDescriptorPool s_DestroyDescriptorPool = vkDestroyDescriptorPool;
 	private:
 		void RTCreate();
 
@@ -28,8 +28,9 @@ namespace Lucy {
 					createInfo.Name = block.Name;
 					createInfo.Binding = block.Binding;
 					createInfo.Type = block.Type;
-					createInfo.BufferSize = MAX_DYNAMICALLY_ALLOCATED_BUFFER_SIZE;
+					createInfo.BufferSize = block.BufferSize;
 					createInfo.ArraySize = block.ArraySize;
+					createInfo.IsWrittenByShader = block.IsWrittenByShader;
 					createInfo.ShaderMemberVariables = block.Members;
 
 					AddSharedStorageBuffer(createInfo.Name, m_VulkanDevice->CreateSharedStorageBuffer(createInfo));
@@ -65,11 +66,11 @@ namespace Lucy {
 		vkCmdBindDescriptorSets(bindInfo.CommandBuffer, bindInfo.PipelineBindPoint, bindInfo.PipelineLayout, m_CreateInfo.SetIndex, 1, &m_DescriptorSets[Renderer::GetCurrentFrameIndex()], 0, nullptr);
 	}
 
-	void VulkanDescriptorSet::RTBake(const Ref<VulkanDescriptorPool>& descriptorPool) {
+	void VulkanDescriptorSet::RTBake() {
 		LUCY_ASSERT(Renderer::IsOnRenderThread());
 		
 		const uint32_t maxFramesInFlight = Renderer::GetMaxFramesInFlight();
-		VkDevice device = m_VulkanDevice->GetLogicalDevice();
+		VulkanDescriptorAllocator& descriptorAllocator = m_VulkanDevice->GetDescriptorAllocator();
 
 		std::vector<VkDescriptorSetLayoutBinding> layoutBindings;
 		std::vector<bool> isBindlessVector;
@@ -86,8 +87,6 @@ namespace Lucy {
 			layoutBindings.push_back(binding);
 		}
 
-		VkDescriptorSetLayoutCreateInfo descriptorLayoutInfo = VulkanAPI::DescriptorSetCreateInfo((uint32_t)layoutBindings.size(), layoutBindings.data());
-
 		/*
 		* indicates that this is a variable-sized descriptor binding whose size will be specified when a descriptor set is allocated using this layout.
 		* The value of descriptorCount is treated as an upper bound on the size of the binding.
@@ -103,10 +102,8 @@ namespace Lucy {
 			bindlessDescriptorFlags.push_back(0); //yes, we really need the 0.
 		}
 
-		VkDescriptorSetLayoutBindingFlagsCreateInfo extendedLayoutInfo = VulkanAPI::DescriptorSetLayoutBindingFlagsCreateInfo((uint32_t)layoutBindings.size(), bindlessDescriptorFlags.data());
-		descriptorLayoutInfo.pNext = &extendedLayoutInfo;
-
-		LUCY_VK_ASSERT(vkCreateDescriptorSetLayout(device, &descriptorLayoutInfo, nullptr, &m_DescriptorSetLayout));
+		//shaders with the same bindings share the layout
+		m_DescriptorSetLayout = descriptorAllocator.RTGetLayout(layoutBindings, bindlessDescriptorFlags);
 
 		/*
 		* if any of the bindings are bindless.
@@ -115,24 +112,9 @@ namespace Lucy {
 		*/
 		bool bindless = std::ranges::any_of(isBindlessVector.begin(), isBindlessVector.end(), [](bool out) { return out; });
 
-		std::vector<VkDescriptorSetLayout> layouts(maxFramesInFlight, m_DescriptorSetLayout);
-
-		VkDescriptorSetAllocateInfo allocInfo = VulkanAPI::DescriptorSetAllocateInfo(maxFramesInFlight, layouts.data(), descriptorPool->GetVulkanHandle());
-
-		/*
-		* cant summarize these since these are stack allocated
-		*
-		* indicates that this is a variable-sized descriptor binding whose size will be specified when a descriptor set is allocated using this layout.
-		* The value of descriptorCount is treated as an upper bound on the size of the binding.
-		*/
-		std::vector<uint32_t> variableDescCount(allocInfo.descriptorSetCount, MAX_DYNAMIC_DESCRIPTOR_COUNT);
-		VkDescriptorSetVariableDescriptorCountAllocateInfo variableCountAllocInfo = VulkanAPI::DescriptorSetVariableDescriptorCountAllocateInfo(allocInfo.descriptorSetCount, variableDescCount.data());
-
-		if (bindless)
-			allocInfo.pNext = &variableCountAllocInfo;
-
 		m_DescriptorSets.resize(maxFramesInFlight);
-		LUCY_VK_ASSERT(vkAllocateDescriptorSets(device, &allocInfo, m_DescriptorSets.data()));
+		m_DescriptorPool = descriptorAllocator.RTAllocatePersistent(m_DescriptorSetLayout, maxFramesInFlight, m_DescriptorSets.data(), bindless ? MAX_DYNAMIC_DESCRIPTOR_COUNT : 0);
+		m_WriteCache.Reset(maxFramesInFlight);
 	}
 
 	void VulkanDescriptorSet::RTUpdate() {
@@ -145,6 +127,17 @@ namespace Lucy {
 
 		VkDevice device = m_VulkanDevice->GetLogicalDevice();
 
+		//the writes point into this vector, so it must not reallocate
+		std::vector<VkDescriptorBufferInfo> bufferInfos;
+		bufferInfos.reserve(GetAllUniformBufferHandles().size() + GetAllSharedStorageBufferHandles().size());
+
+		std::vector<VkWriteDescriptorSet> setWrites;
+		setWrites.reserve(bufferInfos.capacity() + m_UniformImageSamplers.size());
+
+		//one per buffer write and one per image info of the image writes
+		std::vector<uint64_t> resourceIDs;
+		resourceIDs.reserve(bufferInfos.capacity());
+
 		for (RenderResourceHandle bufferHandle : GetAllUniformBufferHandles() | std::views::values) {
 			const auto& uniformBuffer = Renderer::AccessResource<VulkanUniformBuffer>(bufferHandle);
 			if (!uniformBuffer)
@@ -157,14 +150,13 @@ namespace Lucy {
 				case DescriptorType::Buffer: {
 					const uint32_t arraySize = uniformBuffer->GetArraySize();
 
-					VkDescriptorBufferInfo bufferInfo = VulkanAPI::DescriptorBufferInfo(uniformBuffer->GetVulkanBufferHandle(frameIndex), 0, VK_WHOLE_SIZE);
-					VkWriteDescriptorSet setWrite = VulkanAPI::WriteDescriptorSet(m_DescriptorSets[frameIndex], 0, 
+					const VkDescriptorBufferInfo& bufferInfo = bufferInfos.emplace_back(VulkanAPI::DescriptorBufferInfo(uniformBuffer->GetVulkanBufferHandle(frameIndex), 0, VK_WHOLE_SIZE));
+					resourceIDs.push_back(uniformBuffer->GetVulkanBufferID(frameIndex));
+					setWrites.emplace_back(VulkanAPI::WriteDescriptorSet(m_DescriptorSets[frameIndex], 0, 
 						uniformBuffer->GetBinding(), arraySize == 0 ? 1 : arraySize, 
-						(VkDescriptorType)ConvertDescriptorType(descriptorType), &bufferInfo);
-
-					vkUpdateDescriptorSets(device, 1, &setWrite, 0, nullptr);
+						(VkDescriptorType)ConvertDescriptorType(descriptorType), &bufferInfo));
 
-					uniformBuffer->Clear();
+					uniformBuffer->BeginRewrite();
 					break;
 				}
 				case DescriptorType::Undefined:
@@ -173,16 +165,23 @@ namespace Lucy {
 			}
 		}
 
-		for (RenderResourceHandle bufferHandle : GetAllSharedStorageBufferHandles() | std::views::values) {
-			const auto& ssbo = m_VulkanDevice->AccessResource<SharedStorageBuffer>(bufferHandle)->As<VulkanSharedStorageBuffer>();
+		for (const auto& [name, bufferHandle] : GetAllSharedStorageBufferHandles()) {
+			Ref<VulkanSharedStorageBuffer> ssbo = m_VulkanDevice->AccessResource<SharedStorageBuffer>(bufferHandle)->As<VulkanSharedStorageBuffer>();
 			ssbo->RTLoadToDevice();
+			if (!ssbo->KeepsContent())
+				ssbo->BeginRewrite();
+
+			//the data of the bound buffer is owned (and uploaded) by the other shader
+			if (auto it = m_BoundSharedStorageBuffers.find(name); it != m_BoundSharedStorageBuffers.end())
+				ssbo = it->second;
 
 			const uint32_t arraySize = ssbo->GetArraySize();
 
-			VkDescriptorBufferInfo bufferInfo = VulkanAPI::DescriptorBufferInfo(ssbo->GetVulkanBufferHandle(frameIndex), 0, VK_WHOLE_SIZE);
+			const VkDescriptorBufferInfo& bufferInfo = bufferInfos.emplace_back(VulkanAPI::DescriptorBufferInfo(ssbo->GetVulkanBufferHandle(frameIndex), 0, VK_WHOLE_SIZE));
+			resourceIDs.push_back(ssbo->GetVulkanBufferID(frameIndex));
 
-			VkWriteDescriptorSet setWrite = VulkanAPI::WriteDescriptorSet(m_DescriptorSets[frameIndex], 0, ssbo->GetBinding(), arraySize == 0 ? 1 : arraySize, VK_DESCRIPTOR_TYPE_MAX_ENUM,
-																		  &bufferInfo);
+			VkWriteDescriptorSet& setWrite = setWrites.emplace_back(VulkanAPI::WriteDescriptorSet(m_DescriptorSets[frameIndex], 0, ssbo->GetBinding(), arraySize == 0 ? 1 : arraySize, 
+																								  VK_DESCRIPTOR_TYPE_MAX_ENUM, &bufferInfo));
 			switch (ssbo->GetDescriptorType()) {
 				case DescriptorType::SSBO:
 					setWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
@@ -195,24 +194,27 @@ namespace Lucy {
 					LUCY_ASSERT(false, "Descriptor type is undefined!");
 					break;
 			}
-
-			vkUpdateDescriptorSets(device, 1, &setWrite, 0, nullptr);
-			ssbo->Clear();
 		}
-
-		if (m_UniformImageSamplers.empty())
-			return;
+		m_BoundSharedStorageBuffers.clear();
 
 		for (const Ref<VulkanUniformImageSampler>& sampler : m_UniformImageSamplers | std::views::values) {
 			auto& imageInfos = sampler->ImageInfos;
 			if (imageInfos.empty())
-				break;
+				continue;
+
+			setWrites.emplace_back(VulkanAPI::WriteDescriptorSet(m_DescriptorSets[frameIndex], 0, sampler->Binding, (uint32_t)imageInfos.size(), (VkDescriptorType)ConvertDescriptorType(sampler->DescriptorType),
+																 nullptr, imageInfos.data()));
+			resourceIDs.insert(resourceIDs.end(), sampler->ImageViewIDs.begin(), sampler->ImageViewIDs.end());
+		}
 
-			VkWriteDescriptorSet setWrite = VulkanAPI::WriteDescriptorSet(m_DescriptorSets[frameIndex], 0, sampler->Binding, (uint32_t)imageInfos.size(), (VkDescriptorType)ConvertDescriptorType(sampler->DescriptorType),
-																		  nullptr, imageInfos.data());
-			vkUpdateDescriptorSets(device, 1, &setWrite, 0, nullptr);
+		//the set of this frame still holds the descriptors of its last update, writing the same resources again is a no-op
+		if (m_WriteCache.RTWrite(device, frameIndex, setWrites, resourceIDs))
+			s_UpdateCount++;
 
-			imageInfos.clear();
+		//only cleared after the update, since the writes point into them
+		for (const Ref<VulkanUniformImageSampler>& sampler : m_UniformImageSamplers | std::views::values) {
+			sampler->ImageInfos.clear();
+			sampler->ImageViewIDs.clear();
 		}
 	}
 
@@ -222,6 +224,13 @@ namespace Lucy {
 		return m_UniformImageSamplers.at(imageBufferName);
 	}
 
+	bool VulkanDescriptorSet::BindSharedStorageBuffer(const std::string& name, const Ref<VulkanSharedStorageBuffer>& ssbo) {
+		if (!GetAllSharedStorageBufferHandles().contains(name))
+			return false;
+		m_BoundSharedStorageBuffers.insert_or_assign(name, ssbo);
+		return true;
+	}
+
 	void VulkanDescriptorSet::RTDestroyResource() {
 		LUCY_ASSERT(Renderer::IsOnRenderThread());
 
@@ -230,6 +239,9 @@ namespace Lucy {
 		for (auto bufferHandle : GetAllSharedStorageBufferHandles() | std::views::values)
 			m_VulkanDevice->RTDestroyResource(bufferHandle);
 
-		vkDestroyDescriptorSetLayout(m_VulkanDevice->GetLogicalDevice(), m_DescriptorSetLayout, nullptr);
+		//the layout is owned by the descriptor allocator
+		if (!m_DescriptorSets.empty())
+			m_VulkanDevice->GetDescriptorAllocator().RTFreePersistent(m_DescriptorPool, (uint32_t)m_DescriptorSets.size(), m_DescriptorSets.data());
+		m_DescriptorSets.clear();
 	}
 }
\ No newline at end of file
@@ -3,10 +3,12 @@
 #include "DescriptorSet.h"
 
 #include "Renderer/Descriptors/VulkanDescriptorPool.h"
+#include "Renderer/Descriptors/VulkanDescriptorWriteCache.h"
 
 namespace Lucy {
 
 	struct VulkanUniformImageSampler;
+	class VulkanSharedStorageBuffer;
 
 	struct VulkanDescriptorSetCreateInfo {
 		VkDescriptorSetLayout Layout = VK_NULL_HANDLE;
@@ -25,19 +27,29 @@ namespace Lucy {
 		virtual ~VulkanDescriptorSet() = default;
 
 		void RTBind(const VulkanDescriptorSetBindInfo& bindInfo);
-		void RTBake(const Ref<VulkanDescriptorPool>& descriptorPool);
+		void RTBake();
 		void RTUpdate() final override;
 		
 		Ref<VulkanUniformImageSampler> GetVulkanImageSampler(const std::string& imageBufferName);
+		//the SSBO of another shader is used instead of the own one, until the next update. returns false, if there is no SSBO with that name
+		bool BindSharedStorageBuffer(const std::string& name, const Ref<VulkanSharedStorageBuffer>& ssbo);
 
 		inline VkDescriptorSetLayout GetDescriptorSetLayout() const { return m_DescriptorSetLayout; }
+
+		//the vkUpdateDescriptorSets calls of every set since the last call (for the profiler)
+		static inline uint32_t ConsumeUpdateCount() { return std::exchange(s_UpdateCount, 0); }
 	private:
 		void RTCreate();
 		void RTDestroyResource() final override;
 
 		std::unordered_map<std::string, Ref<VulkanUniformImageSampler>> m_UniformImageSamplers;
+		std::unordered_map<std::string, Ref<VulkanSharedStorageBuffer>> m_BoundSharedStorageBuffers;
 		std::vector<VkDescriptorSet> m_DescriptorSets;
-		VkDescriptorSetLayout m_DescriptorSetLayout;
+		VulkanDescriptorWriteCache m_WriteCache; //the descriptors, that the set of each frame in flight holds
+		VkDescriptorSetLayout m_DescriptorSetLayout = VK_NULL_HANDLE; //cached by the descriptor allocator
+		VkDescriptorPool m_DescriptorPool = VK_NULL_HANDLE; //that the sets have been allocated from
+
+		static inline uint32_t s_UpdateCount = 0; //only updated on the render thread
 
 		Ref<VulkanRenderDevice> m_VulkanDevice = nullptr;
 	};
@@ -0,0 +1,40 @@
+#include "lypch.h"
+#include "VulkanDescriptorWriteCache.h"
+
+namespace Lucy {
+
+	void VulkanDescriptorWriteCache::Reset(uint32_t frameCount) {
+		m_FrameDescriptors.assign(frameCount, {});
+	}
+
+	bool VulkanDescriptorWriteCache::RTWrite(VkDevice device, uint32_t frameIndex, std::span<const VkWriteDescriptorSet> writes, std::span<const uint64_t> resourceIDs) {
+		LUCY_ASSERT(frameIndex < m_FrameDescriptors.size(), "The write cache has not been reset for frame {0}.", frameIndex);
+		if (writes.empty())
+			return false;
+
+		m_Descriptors.clear();
+		size_t resourceIndex = 0;
+		for (const VkWriteDescriptorSet& write : writes) {
+			if (write.pBufferInfo) {
+				m_Descriptors.push_back(VulkanWrittenDescriptor{ write.dstBinding, write.dstArrayElement, write.descriptorCount, write.descriptorType,
+																 resourceIDs[resourceIndex++], write.pBufferInfo->offset, write.pBufferInfo->range });
+				continue;
+			}
+
+			for (uint32_t i = 0; i < write.descriptorCount; i++) {
+				const VkDescriptorImageInfo& imageInfo = write.pImageInfo[i];
+				m_Descriptors.push_back(VulkanWrittenDescriptor{ write.dstBinding, write.dstArrayElement + i, 1, write.descriptorType,
+																 resourceIDs[resourceIndex++], (uint64_t)imageInfo.sampler, (uint64_t)imageInfo.imageLayout });
+			}
+		}
+		LUCY_ASSERT(resourceIndex == resourceIDs.size(), "Every buffer and image info needs a resource ID.");
+
+		std::vector<VulkanWrittenDescriptor>& frameDescriptors = m_FrameDescriptors[frameIndex];
+		if (m_Descriptors == frameDescriptors)
+			return false;
+
+		s_UpdateDescriptorSets(device, (uint32_t)writes.size(), writes.data(), 0, nullptr);
+		std::swap(frameDescriptors, m_Descriptors);
+		return true;
+	}
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <span>
+
+#include "vulkan/vulkan.h"
+
+namespace Lucy {
+
+	//a single descriptor of a set write. The buffers and image views are identified by their IDs instead of their handles,
+	//a recreated buffer (storage buffers grow) or image view can get the handle of the one it replaced
+	struct VulkanWrittenDescriptor {
+		uint32_t Binding = 0;
+		uint32_t ArrayElement = 0;
+		uint32_t Count = 1; //the arrays of buffers share a single buffer info
+		VkDescriptorType Type = VK_DESCRIPTOR_TYPE_MAX_ENUM;
+		uint64_t ResourceID = 0;
+		uint64_t SamplerOrOffset = 0;
+		uint64_t LayoutOrRange = 0;
+
+		bool operator==(const VulkanWrittenDescriptor& other) const = default;
+	};
+
+	/*
+	* Remembers the descriptors, that the set of each frame in flight has last been written with.
+	* The set of a frame still holds them on its next update, so writing the same descriptors again is skipped.
+	* The descriptors are compared one by one: on a hash collision, the set would keep pointing at a buffer or image view, that is destroyed after the frame.
+	*/
+	class VulkanDescriptorWriteCache final {
+	public:
+		VulkanDescriptorWriteCache() = default;
+		~VulkanDescriptorWriteCache() = default;
+
+		//the sets have been (re)allocated and are empty
+		void Reset(uint32_t frameCount);
+
+		//resourceIDs has one entry per buffer write and one per image info of the image writes, in the order of the writes.
+		//Returns whether vkUpdateDescriptorSets has been called
+		bool RTWrite(VkDevice device, uint32_t frameIndex, std::span<const VkWriteDescriptorSet> writes, std::span<const uint64_t> resourceIDs);
+
+		//replaceable, so that the updates can be counted without a device
+		static inline PFN_vkUpdateDescriptorSets s_UpdateDescriptorSets = vkUpdateDescriptorSets;
+	private:
+		std::vector<std::vector<VulkanWrittenDescriptor>> m_FrameDescriptors;
+		std::vector<VulkanWrittenDescriptor> m_Descriptors; //of the current write, swapped in once the set has been written
+	};
+}
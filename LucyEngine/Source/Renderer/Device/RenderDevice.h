@@ -22,6 +22,7 @@ namespace Lucy {
 	class FrameBuffer;
 	class VertexBuffer;
 	class IndexBuffer;
+	class SharedStorageBuffer;
 	class VulkanImage2D;
 
 	class RenderPass;
@@ -122,6 +123,8 @@ namespace Lucy {
 
 		virtual void DrawIndexed(Ref<CommandPool> cmdPool, uint32_t indexCount, uint32_t instanceCount,
 								 uint32_t firstIndex, int32_t vertexOffset, uint32_t firstInstance) = 0;
+		virtual void DrawIndexedIndirectCount(Ref<CommandPool> cmdPool, Ref<SharedStorageBuffer> commandBuffer, uint64_t commandOffset,
+											  Ref<SharedStorageBuffer> countBuffer, uint64_t countOffset, uint32_t maxDrawCount) = 0;
 		virtual void DispatchCompute(Ref<CommandPool> cmdPool, Ref<ComputePipeline> computePipeline, uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ) = 0;
 
 		virtual void BeginRenderPass(Ref<RenderPass> renderPass, Ref<FrameBuffer> frameBuffer, Ref<CommandPool> cmdPool) = 0;
@@ -12,6 +12,7 @@
 #include "Renderer/Memory/Buffer/Vulkan/VulkanVertexBuffer.h"
 #include "Renderer/Memory/Buffer/Vulkan/VulkanIndexBuffer.h"
 #include "Renderer/Memory/Buffer/Vulkan/VulkanFrameBuffer.h"
+#include "Renderer/Memory/Buffer/Vulkan/VulkanSharedStorageBuffer.h"
 #include "Renderer/Memory/VulkanAllocator.h"
 
 #include "Renderer/Renderer.h"
@@ -41,6 +42,8 @@ namespace Lucy {
 		vkGetDeviceQueue(m_LogicalDevice, m_QueueFamilyIndices.TransferFamily, 0, &m_TransferQueue);
 
 		m_Allocator.Init(instance, m_LogicalDevice, m_PhysicalDevice, apiVersion);
+		m_StagingRing.Init(m_Allocator, m_LogicalDevice, m_TransferQueue, m_QueueFamilyIndices.GraphicsFamily, m_QueueFamilyIndices.TransferFamily);
+		m_DescriptorAllocator.Init(m_LogicalDevice);
 
 		m_ImmediateCommandFence = Memory::CreateUnique<Fence>(this);
 	}
@@ -151,8 +154,14 @@ namespace Lucy {
 		vulkan12Features.descriptorBindingPartiallyBound = VK_TRUE;
 		vulkan12Features.descriptorBindingVariableDescriptorCount = VK_TRUE;
 		vulkan12Features.runtimeDescriptorArray = VK_TRUE;
+		//the materials of a draw index their textures with a per vertex material id
+		vulkan12Features.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
 		//for query pool reset
 		vulkan12Features.hostQueryReset = VK_TRUE;
+		//for the cluster culling (GPU driven draw counts)
+		vulkan12Features.drawIndirectCount = VK_TRUE;
+		//for the handoff of the staging copies from the transfer queue
+		vulkan12Features.timelineSemaphore = VK_TRUE;
 		vulkan12Features.pNext = &multiViewFeatures;
 
 		//For compute shaders/pipeline
@@ -168,6 +177,9 @@ namespace Lucy {
 		features.features.samplerAnisotropy = VK_TRUE;
 		features.features.geometryShader = VK_TRUE;
 		features.features.multiViewport = VK_TRUE;
+		features.features.multiDrawIndirect = VK_TRUE;
+		features.features.drawIndirectFirstInstance = VK_TRUE;
+		features.features.shaderStorageImageWriteWithoutFormat = VK_TRUE; //for the mip generation, its storage images have no format qualifier
 		features.pNext = &vulkan13Features; //extending this structure
 
 		VkDeviceCreateInfo deviceCreateInfo{};
@@ -283,13 +295,13 @@ namespace Lucy {
 		return allFormatIsSupported;
 	}
 
-	void VulkanRenderDevice::SubmitWorkToGPU(VkQueue queueHandle, size_t commandBufferCount, VkCommandBuffer* commandBuffers, Fence* currentFrameFence, Semaphore* currentFrameWaitSemaphore, Semaphore* currentFrameSignalSemaphore) const {
+	void VulkanRenderDevice::SubmitWorkToGPU(VkQueue queueHandle, size_t commandBufferCount, VkCommandBuffer* commandBuffers, Fence* currentFrameFence, Semaphore* currentFrameWaitSemaphore, Semaphore* currentFrameSignalSemaphore) {
 		LUCY_PROFILE_NEW_EVENT("VulkanRenderDevice::SubmitWorkToGPU");
 
-		VkPipelineStageFlags imageWaitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
+		VkPipelineStageFlags imageWaitStage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
 
 		if (queueHandle == m_ComputeQueue) {
-			imageWaitStages[0] = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+			imageWaitStage = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
 		}
 
 		bool noWaiting = currentFrameWaitSemaphore == nullptr;
@@ -297,13 +309,41 @@ namespace Lucy {
 
 		bool noSyncNeeded = noWaiting && noSignaling;
 
-		VkSubmitInfo submitInfo = VulkanAPI::QueueSubmitInfo((uint32_t)commandBufferCount, commandBuffers, noSyncNeeded ? 0 : 1, 
-			noSyncNeeded ? nullptr : &currentFrameWaitSemaphore->GetSemaphore(), imageWaitStages, noSyncNeeded ? 0 : 1,
+		VkSemaphore waitSemaphores[2] = {};
+		VkPipelineStageFlags waitStages[2] = {};
+		uint64_t waitValues[2] = {}; //ignored for binary semaphores
+		uint32_t waitSemaphoreCount = 0;
+
+		if (!noSyncNeeded) {
+			waitSemaphores[waitSemaphoreCount] = currentFrameWaitSemaphore->GetSemaphore();
+			waitStages[waitSemaphoreCount++] = imageWaitStage;
+		}
+
+		//the staging copies, that have been submitted to the transfer queue for this frame
+		VkSemaphore transferSemaphore = VK_NULL_HANDLE;
+		uint64_t transferValue = 0;
+		bool waitForTransfer = queueHandle == m_GraphicsQueue && m_StagingRing.RTConsumeTransferWait(transferSemaphore, transferValue);
+		if (waitForTransfer) {
+			waitSemaphores[waitSemaphoreCount] = transferSemaphore;
+			waitValues[waitSemaphoreCount] = transferValue;
+			waitStages[waitSemaphoreCount++] = VulkanStagingRing::s_DstStageMask;
+		}
+
+		VkSubmitInfo submitInfo = VulkanAPI::QueueSubmitInfo((uint32_t)commandBufferCount, commandBuffers, waitSemaphoreCount, 
+			waitSemaphoreCount == 0 ? nullptr : waitSemaphores, waitStages, noSyncNeeded ? 0 : 1,
 			noSyncNeeded ? nullptr : &currentFrameSignalSemaphore->GetSemaphore());
+
+		VkTimelineSemaphoreSubmitInfo timelineSubmitInfo{};
+		if (waitForTransfer) {
+			timelineSubmitInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+			timelineSubmitInfo.waitSemaphoreValueCount = waitSemaphoreCount;
+			timelineSubmitInfo.pWaitSemaphoreValues = waitValues;
+			submitInfo.pNext = &timelineSubmitInfo;
+		}
 		LUCY_VK_ASSERT(vkQueueSubmit(queueHandle, 1, &submitInfo, currentFrameFence->GetFence()));
 	}
 
-	void VulkanRenderDevice::SubmitWorkToGPU(VkQueue queueHandle, VkCommandBuffer currentCommandBuffer, Fence* currentFrameFence, Semaphore* currentFrameWaitSemaphore, Semaphore* currentFrameSignalSemaphore) const {
+	void VulkanRenderDevice::SubmitWorkToGPU(VkQueue queueHandle, VkCommandBuffer currentCommandBuffer, Fence* currentFrameFence, Semaphore* currentFrameWaitSemaphore, Semaphore* currentFrameSignalSemaphore) {
 		SubmitWorkToGPU(queueHandle, 1, &currentCommandBuffer, currentFrameFence, currentFrameWaitSemaphore, currentFrameSignalSemaphore);
 	}
 
@@ -392,6 +432,8 @@ namespace Lucy {
 		LUCY_PROFILE_DESTROY();
 		m_ImmediateCommandFence->Destroy(shared_from_this()->As<RenderDevice>());
 
+		m_DescriptorAllocator.Destroy();
+		m_StagingRing.Destroy();
 		m_Allocator.Destroy();
 		vkDestroyDevice(m_LogicalDevice, nullptr);
 	}
@@ -539,6 +581,16 @@ namespace Lucy {
 		vkCmdDrawIndexed((VkCommandBuffer)cmdPool->GetCurrentFrameCommandBuffer(), indexCount, instanceCount, firstIndex, vertexOffset, firstInstance);
 	}
 
+	void VulkanRenderDevice::DrawIndexedIndirectCount(Ref<CommandPool> cmdPool, Ref<SharedStorageBuffer> commandBuffer, uint64_t commandOffset,
+													  Ref<SharedStorageBuffer> countBuffer, uint64_t countOffset, uint32_t maxDrawCount) {
+		const uint32_t frameIndex = Renderer::GetCurrentFrameIndex();
+		VkBuffer vulkanCommandBuffer = commandBuffer->As<VulkanSharedStorageBuffer>()->GetVulkanBufferHandle(frameIndex);
+		VkBuffer vulkanCountBuffer = countBuffer->As<VulkanSharedStorageBuffer>()->GetVulkanBufferHandle(frameIndex);
+
+		vkCmdDrawIndexedIndirectCount((VkCommandBuffer)cmdPool->GetCurrentFrameCommandBuffer(), vulkanCommandBuffer, commandOffset,
+									  vulkanCountBuffer, countOffset, maxDrawCount, sizeof(VkDrawIndexedIndirectCommand));
+	}
+
 	void VulkanRenderDevice::DispatchCompute(Ref<CommandPool> cmdPool, Ref<ComputePipeline> computePipeline, uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ) {
 		computePipeline->As<VulkanComputePipeline>()->RTDispatch(cmdPool->GetCurrentFrameCommandBuffer(), groupCountX, groupCountY, groupCountZ);
 	}
@@ -2,6 +2,8 @@
 
 #include "RenderDevice.h"
 #include "Renderer/Memory/VulkanAllocator.h"
+#include "Renderer/Memory/VulkanStagingRing.h"
+#include "Renderer/Descriptors/VulkanDescriptorAllocator.h"
 
 #include "Renderer/Memory/Buffer/PushConstant.h"
 
@@ -66,6 +68,8 @@ namespace Lucy {
 
 		void DrawIndexed(Ref<CommandPool> cmdPool, uint32_t indexCount, uint32_t instanceCount,
 						 uint32_t firstIndex, int32_t vertexOffset, uint32_t firstInstance) final override;
+		void DrawIndexedIndirectCount(Ref<CommandPool> cmdPool, Ref<SharedStorageBuffer> commandBuffer, uint64_t commandOffset,
+									  Ref<SharedStorageBuffer> countBuffer, uint64_t countOffset, uint32_t maxDrawCount) final override;
 		void DispatchCompute(Ref<CommandPool> cmdPool, Ref<ComputePipeline> computePipeline, uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ) final override;
 		
 		void BeginRenderPass(Ref<RenderPass> renderPass, Ref<FrameBuffer> frameBuffer, Ref<CommandPool> cmdPool) final override;
@@ -96,14 +100,19 @@ namespace Lucy {
 		inline VkQueue GetPresentQueue() const { return m_PresentQueue; }
 		inline VkQueue GetComputeQueue() const { return m_ComputeQueue; }
 		inline VkQueue GetTransferQueue() const { return m_TransferQueue; }
+		//false on devices with a single queue family (e.g. lavapipe), the transfer family falls back to the graphics family
+		inline bool HasDedicatedTransferQueue() const { return m_QueueFamilyIndices.TransferFamily != m_QueueFamilyIndices.GraphicsFamily; }
 
 		inline VulkanAllocator& GetAllocator() { return m_Allocator; }
+		inline VulkanStagingRing& GetStagingRing() { return m_StagingRing; }
+		inline VulkanDescriptorAllocator& GetDescriptorAllocator() { return m_DescriptorAllocator; }
 
 		inline uint32_t GetMinUniformBufferOffsetAlignment() const { return m_DeviceInfo.MinUniformBufferAlignment; }
 		inline float GetTimestampPeriod() const { return m_DeviceInfo.TimestampPeriod; }
 	private:
-		void SubmitWorkToGPU(VkQueue queueHandle, size_t commandBufferCount, VkCommandBuffer* commandBuffers, Fence* currentFrameFence, Semaphore* currentFrameWaitSemaphore, Semaphore* currentFrameSignalSemaphore) const;
-		void SubmitWorkToGPU(VkQueue queueHandle, VkCommandBuffer currentCommandBuffer, Fence* currentFrameFence, Semaphore* currentFrameWaitSemaphore, Semaphore* currentFrameSignalSemaphore) const;
+		//the first graphics submission after the staging copies waits on them, if they have been submitted to the transfer queue
+		void SubmitWorkToGPU(VkQueue queueHandle, size_t commandBufferCount, VkCommandBuffer* commandBuffers, Fence* currentFrameFence, Semaphore* currentFrameWaitSemaphore, Semaphore* currentFrameSignalSemaphore);
+		void SubmitWorkToGPU(VkQueue queueHandle, VkCommandBuffer currentCommandBuffer, Fence* currentFrameFence, Semaphore* currentFrameWaitSemaphore, Semaphore* currentFrameSignalSemaphore);
 		void SubmitWorkToGPU(VkQueue queueHandle, size_t commandBufferCount, void* commandBufferHandles) const;
 
 		void PickDeviceByRanking(const std::vector<VkPhysicalDevice>& devices);
@@ -137,6 +146,8 @@ namespace Lucy {
 		};
 
 		VulkanAllocator m_Allocator;
+		VulkanStagingRing m_StagingRing;
+		VulkanDescriptorAllocator m_DescriptorAllocator;
 		VulkanDeviceInfo m_DeviceInfo;
 		QueueFamilyIndices m_QueueFamilyIndices;
 			
@@ -0,0 +1,91 @@
+#include "lypch.h"
+#include "FrustumCuller.h"
+
+#include <xmmintrin.h>
+#include <bit>
+
+namespace Lucy {
+
+	static constexpr size_t s_SIMDWidth = 4;
+
+	void FrustumCuller::Clear() {
+		m_MinX.clear(); m_MinY.clear(); m_MinZ.clear();
+		m_MaxX.clear(); m_MaxY.clear(); m_MaxZ.clear();
+		m_Count = 0;
+	}
+
+	void FrustumCuller::Reserve(size_t count) {
+		const size_t paddedCount = (count + s_SIMDWidth - 1) / s_SIMDWidth * s_SIMDWidth;
+		m_MinX.reserve(paddedCount); m_MinY.reserve(paddedCount); m_MinZ.reserve(paddedCount);
+		m_MaxX.reserve(paddedCount); m_MaxY.reserve(paddedCount); m_MaxZ.reserve(paddedCount);
+	}
+
+	uint32_t FrustumCuller::Add(const Maths::AABB& aabb) {
+		//an infinite box is on the positive side of every plane
+		const Maths::AABB box = aabb.IsValid() ? aabb : Maths::AABB{ glm::vec3(-FLT_MAX), glm::vec3(FLT_MAX) };
+
+		if (m_Count % s_SIMDWidth == 0) {
+			const size_t paddedCount = m_Count + s_SIMDWidth;
+			m_MinX.resize(paddedCount, 0.0f); m_MinY.resize(paddedCount, 0.0f); m_MinZ.resize(paddedCount, 0.0f);
+			m_MaxX.resize(paddedCount, 0.0f); m_MaxY.resize(paddedCount, 0.0f); m_MaxZ.resize(paddedCount, 0.0f);
+		}
+
+		m_MinX[m_Count] = box.Min.x; m_MinY[m_Count] = box.Min.y; m_MinZ[m_Count] = box.Min.z;
+		m_MaxX[m_Count] = box.Max.x; m_MaxY[m_Count] = box.Max.y; m_MaxZ[m_Count] = box.Max.z;
+		return (uint32_t)m_Count++;
+	}
+
+	void FrustumCuller::Cull(const Maths::Frustum& frustum, std::vector<uint32_t>& outVisibleIndices) const {
+		LUCY_PROFILE_NEW_EVENT("FrustumCuller::Cull");
+
+		outVisibleIndices.clear();
+
+		//the corner that is the furthest along the plane normal only depends on the sign of the normal,
+		//so the arrays can be chosen once per plane instead of once per box
+		struct PlaneSIMD {
+			__m128 NormalX, NormalY, NormalZ, Distance;
+			const float* X;
+			const float* Y;
+			const float* Z;
+		} planes[Maths::Frustum::PlaneCount];
+
+		for (uint32_t p = 0; p < Maths::Frustum::PlaneCount; p++) {
+			const glm::vec4& plane = frustum.Planes[p];
+			planes[p] = {
+				_mm_set1_ps(plane.x), _mm_set1_ps(plane.y), _mm_set1_ps(plane.z), _mm_set1_ps(plane.w),
+				plane.x >= 0.0f ? m_MaxX.data() : m_MinX.data(),
+				plane.y >= 0.0f ? m_MaxY.data() : m_MinY.data(),
+				plane.z >= 0.0f ? m_MaxZ.data() : m_MinZ.data(),
+			};
+		}
+
+		const __m128 zero = _mm_setzero_ps();
+		for (size_t i = 0; i < m_Count; i += s_SIMDWidth) {
+			__m128 outside = zero;
+			for (const PlaneSIMD& plane : planes) {
+				__m128 distance = _mm_mul_ps(plane.NormalX, _mm_loadu_ps(plane.X + i));
+				distance = _mm_add_ps(distance, _mm_mul_ps(plane.NormalY, _mm_loadu_ps(plane.Y + i)));
+				distance = _mm_add_ps(distance, _mm_mul_ps(plane.NormalZ, _mm_loadu_ps(plane.Z + i)));
+				distance = _mm_add_ps(distance, plane.Distance);
+				outside = _mm_or_ps(outside, _mm_cmplt_ps(distance, zero));
+			}
+
+			uint32_t visibleMask = ~(uint32_t)_mm_movemask_ps(outside) & 0xF;
+			while (visibleMask) {
+				const size_t index = i + std::countr_zero(visibleMask);
+				visibleMask &= visibleMask - 1;
+				if (index < m_Count) //padding
+					outVisibleIndices.push_back((uint32_t)index);
+			}
+		}
+	}
+
+	void FrustumCuller::CullReference(const Maths::Frustum& frustum, std::vector<uint32_t>& outVisibleIndices) const {
+		outVisibleIndices.clear();
+		for (size_t i = 0; i < m_Count; i++) {
+			const Maths::AABB aabb = { glm::vec3(m_MinX[i], m_MinY[i], m_MinZ[i]), glm::vec3(m_MaxX[i], m_MaxY[i], m_MaxZ[i]) };
+			if (Maths::AABBInFrustum(frustum, aabb))
+				outVisibleIndices.push_back((uint32_t)i);
+		}
+	}
+}
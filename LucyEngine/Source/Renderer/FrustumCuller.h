@@ -0,0 +1,33 @@
+#pragma once
+
+#include "Utilities/Utilities.h"
+
+namespace Lucy {
+
+	/*
+	* Frustum vs. AABB culling of many objects at once.
+	* The boxes are stored as SoA and tested 4 at a time with SSE, the visible indices refer to the order in which the boxes were added.
+	* Fill it once per frame and cull once per view (camera, shadow cascades...).
+	*/
+	class FrustumCuller final {
+	public:
+		FrustumCuller() = default;
+		~FrustumCuller() = default;
+
+		void Clear();
+		void Reserve(size_t count);
+		//invalid boxes are never culled
+		uint32_t Add(const Maths::AABB& aabb);
+
+		void Cull(const Maths::Frustum& frustum, std::vector<uint32_t>& outVisibleIndices) const;
+		//scalar reference of Cull, has to produce the exact same result
+		void CullReference(const Maths::Frustum& frustum, std::vector<uint32_t>& outVisibleIndices) const;
+
+		inline size_t GetCount() const { return m_Count; }
+	private:
+		//padded to a multiple of 4
+		std::vector<float> m_MinX, m_MinY, m_MinZ;
+		std::vector<float> m_MaxX, m_MaxY, m_MaxZ;
+		size_t m_Count = 0;
+	};
+}
@@ -0,0 +1,125 @@
+#include "lypch.h"
+#include "HiZPyramid.h"
+
+namespace Lucy {
+
+	uint32_t HiZPyramid::GetMipCount(uint32_t depthWidth, uint32_t depthHeight) {
+		uint32_t mipCount = 1;
+		glm::uvec2 size = GetMipSize(depthWidth, depthHeight, 0);
+		while (size.x > 1 || size.y > 1) {
+			size = (size + 1u) / 2u;
+			mipCount++;
+		}
+		return mipCount;
+	}
+
+	glm::uvec2 HiZPyramid::GetMipSize(uint32_t depthWidth, uint32_t depthHeight, uint32_t level) {
+		//level 0 is already the first downsample of the depth buffer
+		const uint32_t texelSize = 2u << level;
+		return glm::uvec2((depthWidth + texelSize - 1) / texelSize, (depthHeight + texelSize - 1) / texelSize);
+	}
+
+	size_t HiZPyramid::GetMipOffset(uint32_t depthWidth, uint32_t depthHeight, uint32_t level) {
+		size_t offset = 0;
+		for (uint32_t i = 0; i < level; i++) {
+			const glm::uvec2 size = GetMipSize(depthWidth, depthHeight, i);
+			offset += (size_t)size.x * size.y;
+		}
+		return offset;
+	}
+
+	size_t HiZPyramid::GetTexelCount(uint32_t depthWidth, uint32_t depthHeight) {
+		return GetMipOffset(depthWidth, depthHeight, GetMipCount(depthWidth, depthHeight));
+	}
+
+	void HiZPyramid::Build(const float* depth, uint32_t depthWidth, uint32_t depthHeight) {
+		LUCY_PROFILE_NEW_EVENT("HiZPyramid::Build");
+
+		m_DepthWidth = depthWidth;
+		m_DepthHeight = depthHeight;
+		m_MipCount = GetMipCount(depthWidth, depthHeight);
+		m_Texels.assign(GetTexelCount(depthWidth, depthHeight), 0.0f);
+
+		//every level is reduced from the one below it, the depth buffer is the level below level 0
+		const float* source = depth;
+		glm::uvec2 sourceSize = glm::uvec2(depthWidth, depthHeight);
+
+		for (uint32_t level = 0; level < m_MipCount; level++) {
+			const glm::uvec2 size = GetMipSize(depthWidth, depthHeight, level);
+			float* destination = m_Texels.data() + GetMipOffset(depthWidth, depthHeight, level);
+
+			for (uint32_t y = 0; y < size.y; y++) {
+				for (uint32_t x = 0; x < size.x; x++) {
+					float maxDepth = 0.0f;
+					for (uint32_t j = 0; j < 2; j++) {
+						for (uint32_t i = 0; i < 2; i++) {
+							const uint32_t sx = x * 2 + i;
+							const uint32_t sy = y * 2 + j;
+							if (sx < sourceSize.x && sy < sourceSize.y)
+								maxDepth = glm::max(maxDepth, source[sy * sourceSize.x + sx]);
+						}
+					}
+					destination[y * size.x + x] = maxDepth;
+				}
+			}
+
+			source = destination;
+			sourceSize = size;
+		}
+	}
+
+	bool HiZPyramid::IsOccluded(const Maths::AABB& aabb, const glm::mat4& viewProjection) const {
+		if (m_Texels.empty() || !aabb.IsValid())
+			return false;
+
+		glm::vec2 uvMin = glm::vec2(1.0f);
+		glm::vec2 uvMax = glm::vec2(0.0f);
+		float minDepth = 1.0f;
+
+		for (uint32_t i = 0; i < 8; i++) {
+			const glm::vec3 corner = glm::vec3(i & 1 ? aabb.Max.x : aabb.Min.x, i & 2 ? aabb.Max.y : aabb.Min.y, i & 4 ? aabb.Max.z : aabb.Min.z);
+			const glm::vec4 clip = viewProjection * glm::vec4(corner, 1.0f);
+			//behind the camera, the projected rectangle would be wrong
+			if (clip.w <= FLT_EPSILON)
+				return false;
+
+			const glm::vec3 ndc = glm::vec3(clip) / clip.w;
+			uvMin = glm::min(uvMin, glm::vec2(ndc) * 0.5f + 0.5f);
+			uvMax = glm::max(uvMax, glm::vec2(ndc) * 0.5f + 0.5f);
+			minDepth = glm::min(minDepth, ndc.z);
+		}
+
+		//crosses the near plane
+		if (minDepth <= 0.0f)
+			return false;
+
+		const glm::ivec2 depthSize = glm::ivec2(m_DepthWidth, m_DepthHeight);
+		const glm::ivec2 pixelMin = glm::clamp(glm::ivec2(glm::clamp(uvMin, 0.0f, 1.0f) * glm::vec2(depthSize)), glm::ivec2(0), depthSize - 1);
+		const glm::ivec2 pixelMax = glm::clamp(glm::ivec2(glm::clamp(uvMax, 0.0f, 1.0f) * glm::vec2(depthSize)), glm::ivec2(0), depthSize - 1);
+
+		//the finest level, in which the rectangle covers at most 2x2 texels
+		uint32_t level = 0;
+		while (level + 1 < m_MipCount) {
+			const glm::ivec2 span = (pixelMax >> (int32_t)(level + 1)) - (pixelMin >> (int32_t)(level + 1));
+			if (span.x <= 1 && span.y <= 1)
+				break;
+			level++;
+		}
+
+		const glm::ivec2 texelMin = pixelMin >> (int32_t)(level + 1);
+		const glm::ivec2 texelMax = pixelMax >> (int32_t)(level + 1);
+
+		float maxDepth = 0.0f;
+		for (int32_t y = texelMin.y; y <= texelMax.y; y++) {
+			for (int32_t x = texelMin.x; x <= texelMax.x; x++)
+				maxDepth = glm::max(maxDepth, GetTexel(level, x, y));
+		}
+		return minDepth > maxDepth;
+	}
+
+	float HiZPyramid::GetTexel(uint32_t level, uint32_t x, uint32_t y) const {
+		LUCY_ASSERT(level < m_MipCount, "Level {0} is out of range, the pyramid has {1} levels.", level, m_MipCount);
+		const glm::uvec2 size = GetMipSize(m_DepthWidth, m_DepthHeight, level);
+		return m_Texels[GetMipOffset(m_DepthWidth, m_DepthHeight, level) + (size_t)y * size.x + x];
+	}
+}
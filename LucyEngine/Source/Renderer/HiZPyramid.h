@@ -0,0 +1,39 @@
+#pragma once
+
+#include "Utilities/Utilities.h"
+
+namespace Lucy {
+
+	/*
+	* Hierarchical depth (Hi-Z) pyramid.
+	* CPU reference of LucyHiZ.comp and of the occlusion test in LucyClusterCull.comp, keep them in sync.
+	* Level 0 has half the resolution of the depth buffer (rounded up), every texel stores the maximum (furthest) depth of the 2x2 texels below it.
+	* Texels outside of the depth buffer count as 0, so that they never contribute to the maximum.
+	* The levels are tightly packed one after another, which is also the layout of the SSBO on the GPU.
+	*/
+	class HiZPyramid final {
+	public:
+		HiZPyramid() = default;
+		~HiZPyramid() = default;
+
+		static uint32_t GetMipCount(uint32_t depthWidth, uint32_t depthHeight);
+		static glm::uvec2 GetMipSize(uint32_t depthWidth, uint32_t depthHeight, uint32_t level);
+		static size_t GetMipOffset(uint32_t depthWidth, uint32_t depthHeight, uint32_t level);
+		static size_t GetTexelCount(uint32_t depthWidth, uint32_t depthHeight);
+
+		//depth range [0, 1], near = 0
+		void Build(const float* depth, uint32_t depthWidth, uint32_t depthHeight);
+		//conservative, boxes that cross the near plane are never occluded
+		bool IsOccluded(const Maths::AABB& aabb, const glm::mat4& viewProjection) const;
+
+		float GetTexel(uint32_t level, uint32_t x, uint32_t y) const;
+
+		inline uint32_t GetMipCount() const { return m_MipCount; }
+		inline const std::vector<float>& GetTexels() const { return m_Texels; }
+	private:
+		std::vector<float> m_Texels;
+		uint32_t m_DepthWidth = 0;
+		uint32_t m_DepthHeight = 0;
+		uint32_t m_MipCount = 0;
+	};
+}
@@ -48,7 +48,17 @@ namespace Lucy {
 		R32G32_SFLOAT,
 
 		R32_SFLOAT,
-		R32_UINT
+		R32_UINT,
+
+		//block compressed (4x4 texel blocks)
+		BC1_RGBA_UNORM,
+		BC1_RGBA_SRGB,
+		BC3_UNORM,
+		BC3_SRGB,
+		BC4_UNORM,
+		BC5_UNORM,
+		BC7_UNORM,
+		BC7_SRGB
 	};
 
 	enum class ImageUsage : uint8_t {
@@ -58,6 +68,7 @@ namespace Lucy {
 		AsColorStorageTransferAttachment = 1 << 4,
 		AsDepthAttachment = 1 << 5,
 		AsTransientColorAttachment = 1 << 6,
+		AsSampledTexture = 1 << 7, //only sampled and written by transfers (block compressed formats can't be attachments)
 	};
 
 	//to be implemented by CLIENT
@@ -85,6 +96,8 @@ namespace Lucy {
 		bool GenerateSampler = false;
 		bool GenerateMipmap = false;
 		bool ImGuiUsage = false;
+		//only the low mips are loaded first, the others are streamed in and out by the TextureStreamer (precomputed mip chains only, e.g. KTX2)
+		bool StreamMips = false;
 	};
 
 	//Vulkan: Descriptor Set
@@ -106,6 +119,17 @@ namespace Lucy {
 		inline uint32_t GetMaxMipLevel() const { return m_MaxMipLevel; }
 
 		ImageImGuiID GetImGuiID() const { return m_ImGuiID; }
+		//false, while an image that is loaded from a file has not been uploaded yet (it must not be sampled then)
+		inline bool IsReady() const { return m_IsReady; }
+
+		//the levels of the full mip chain, that is streamed. Only the levels from the resident mip on are in memory
+		inline bool IsStreamed() const { return !m_StreamedLevelSizes.empty(); }
+		inline uint32_t GetResidentMip() const { return m_ResidentMip; }
+		inline const std::vector<size_t>& GetStreamedLevelSizes() const { return m_StreamedLevelSizes; }
+
+		virtual bool IsResidencyChangePending() const { return false; }
+		//the levels finer than mip are dropped, the missing ones up to mip are loaded
+		virtual void RTRequestResidentMip([[maybe_unused]] uint32_t mip) {}
 	protected:
 		//Creates an empty image
 		Image(const ImageCreateInfo& createInfo)
@@ -125,6 +149,10 @@ namespace Lucy {
 		uint32_t m_MaxMipLevel = 1;
 
 		ImageImGuiID m_ImGuiID = 0;
+		bool m_IsReady = true;
+
+		std::vector<size_t> m_StreamedLevelSizes;
+		uint32_t m_ResidentMip = 0;
 
 		std::filesystem::path m_Path;
 	};
@@ -0,0 +1,251 @@
+#include "lypch.h"
+#include "KTX2.h"
+
+namespace Lucy {
+
+	static constexpr uint8_t s_KTX2Identifier[12] = { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+
+	struct KTX2Header {
+		uint32_t VkFormat;
+		uint32_t TypeSize;
+		uint32_t PixelWidth;
+		uint32_t PixelHeight;
+		uint32_t PixelDepth;
+		uint32_t LayerCount;
+		uint32_t FaceCount;
+		uint32_t LevelCount;
+		uint32_t SupercompressionScheme;
+	};
+
+	struct KTX2Index {
+		uint32_t DFDByteOffset;
+		uint32_t DFDByteLength;
+		uint32_t KVDByteOffset;
+		uint32_t KVDByteLength;
+		uint64_t SGDByteOffset;
+		uint64_t SGDByteLength;
+	};
+	static_assert(sizeof(KTX2Header) == 36 && sizeof(KTX2Index) == 32, "KTX2 header must not be padded.");
+
+	struct KTX2LevelIndex {
+		uint64_t ByteOffset;
+		uint64_t ByteLength;
+		uint64_t UncompressedByteLength;
+	};
+
+	//see the Khronos Data Format Specification, KHR_DF_MODEL_BC*
+	static uint32_t GetDFDColorModel(ImageFormat format) {
+		switch (format) {
+			case ImageFormat::BC1_RGBA_UNORM:
+			case ImageFormat::BC1_RGBA_SRGB:
+				return 128;
+			case ImageFormat::BC3_UNORM:
+			case ImageFormat::BC3_SRGB:
+				return 130;
+			case ImageFormat::BC4_UNORM:
+				return 131;
+			case ImageFormat::BC5_UNORM:
+				return 132;
+			case ImageFormat::BC7_UNORM:
+			case ImageFormat::BC7_SRGB:
+				return 134;
+			default:
+				LUCY_ASSERT(false);
+				return 0;
+		}
+	}
+
+	//the basic data format descriptor block
+	static std::vector<uint32_t> CreateDFD(ImageFormat format) {
+		struct Sample {
+			uint32_t BitOffset;
+			uint32_t ChannelID;
+		};
+
+		std::vector<Sample> samples;
+		switch (format) {
+			case ImageFormat::BC1_RGBA_UNORM:
+			case ImageFormat::BC1_RGBA_SRGB:
+				samples = { { 0, 1 } }; //KHR_DF_CHANNEL_BC1A_ALPHAPRESENT
+				break;
+			case ImageFormat::BC3_UNORM:
+			case ImageFormat::BC3_SRGB:
+				samples = { { 0, 15 }, { 64, 0 } }; //alpha, color
+				break;
+			case ImageFormat::BC4_UNORM:
+				samples = { { 0, 0 } };
+				break;
+			case ImageFormat::BC5_UNORM:
+				samples = { { 0, 0 }, { 64, 1 } }; //red, green
+				break;
+			default:
+				samples = { { 0, 0 } };
+				break;
+		}
+
+		const uint32_t blockSize = TextureCompressor::GetBlockSize(format);
+		const uint32_t sampleBitLength = blockSize * 8 / (uint32_t)samples.size();
+		const uint32_t descriptorBlockSize = 24 + 16 * (uint32_t)samples.size();
+		const uint32_t transferFunction = TextureCompressor::IsSRGB(format) ? 2 : 1;
+
+		std::vector<uint32_t> dfd;
+		dfd.push_back(4 + descriptorBlockSize); //dfdTotalSize
+		dfd.push_back(0); //vendorId, descriptorType
+		dfd.push_back(2 | descriptorBlockSize << 16); //versionNumber, descriptorBlockSize
+		dfd.push_back(GetDFDColorModel(format) | 1 << 8 | transferFunction << 16); //colorModel, colorPrimaries (BT709), transferFunction, flags
+		dfd.push_back(3 | 3 << 8); //texelBlockDimension (4x4x1x1, stored minus one)
+		dfd.push_back(blockSize); //bytesPlane0
+		dfd.push_back(0);
+
+		for (const Sample& sample : samples) {
+			dfd.push_back(sample.BitOffset | (sampleBitLength - 1) << 16 | sample.ChannelID << 24);
+			dfd.push_back(0); //samplePosition
+			dfd.push_back(0); //sampleLower
+			dfd.push_back(UINT32_MAX); //sampleUpper
+		}
+		return dfd;
+	}
+
+	size_t KTX2Info::GetDataSize() const {
+		size_t size = 0;
+		for (const CompressedLevel& level : Levels)
+			size += level.Size;
+		return size;
+	}
+
+	bool KTX2::ReadInfo(const std::filesystem::path& path, KTX2Info& outInfo) {
+		std::ifstream file(path, std::ios::in | std::ios::binary | std::ios::ate);
+		if (!file.is_open())
+			return false;
+		const uint64_t fileSize = (uint64_t)file.tellg();
+		file.seekg(0);
+
+		uint8_t identifier[12];
+		KTX2Header header;
+		KTX2Index index;
+		if (!file.read((char*)identifier, sizeof(identifier)) || memcmp(identifier, s_KTX2Identifier, sizeof(identifier)) != 0 ||
+			!file.read((char*)&header, sizeof(header)) || !file.read((char*)&index, sizeof(index))) {
+			LUCY_WARN("{0} is not a KTX2 file.", path.generic_string());
+			return false;
+		}
+
+		const ImageFormat format = GetLucyImageFormat(header.VkFormat);
+		if (!TextureCompressor::IsBlockCompressed(format) || header.SupercompressionScheme != 0 || header.PixelWidth == 0 || header.PixelHeight == 0 ||
+			header.PixelDepth > 1 || header.LayerCount > 1 || header.FaceCount != 1) {
+			LUCY_WARN("KTX2 file {0} is not supported, only block compressed 2D textures without supercompression can be loaded.", path.generic_string());
+			return false;
+		}
+
+		const uint32_t levelCount = glm::max(header.LevelCount, 1u);
+		std::vector<KTX2LevelIndex> levelIndices(levelCount);
+		if (!file.read((char*)levelIndices.data(), levelCount * sizeof(KTX2LevelIndex)))
+			return false;
+
+		outInfo.Format = format;
+		outInfo.Width = header.PixelWidth;
+		outInfo.Height = header.PixelHeight;
+		outInfo.Levels.clear();
+		outInfo.Levels.reserve(levelCount);
+
+		for (uint32_t level = 0; level < levelCount; level++) {
+			const uint32_t levelWidth = glm::max(header.PixelWidth >> level, 1u);
+			const uint32_t levelHeight = glm::max(header.PixelHeight >> level, 1u);
+			const KTX2LevelIndex& levelIndex = levelIndices[level];
+
+			//the copy into the image expects tightly packed blocks
+			if (levelIndex.ByteLength != TextureCompressor::GetLevelSize(format, levelWidth, levelHeight) || levelIndex.ByteOffset + levelIndex.ByteLength > fileSize) {
+				LUCY_WARN("KTX2 file {0} has an invalid level {1}.", path.generic_string(), level);
+				return false;
+			}
+			outInfo.Levels.push_back(CompressedLevel{ .Width = levelWidth, .Height = levelHeight, .Offset = (size_t)levelIndex.ByteOffset, .Size = (size_t)levelIndex.ByteLength });
+		}
+		return true;
+	}
+
+	bool KTX2::ReadLevels(const std::filesystem::path& path, const KTX2Info& info, uint8_t* destination) {
+		LUCY_PROFILE_NEW_EVENT("KTX2::ReadLevels");
+
+		std::ifstream file(path, std::ios::in | std::ios::binary);
+		if (!file.is_open())
+			return false;
+
+		for (const CompressedLevel& level : info.Levels) {
+			file.seekg(level.Offset);
+			if (!file.read((char*)destination, level.Size))
+				return false;
+			destination += level.Size;
+		}
+		return true;
+	}
+
+	bool KTX2::Write(const std::filesystem::path& path, const CompressedTexture& texture) {
+		LUCY_PROFILE_NEW_EVENT("KTX2::Write");
+
+		const uint32_t levelCount = (uint32_t)texture.Levels.size();
+		const std::vector<uint32_t> dfd = CreateDFD(texture.Format);
+
+		KTX2Header header{
+			.VkFormat = GetAPIImageFormat(texture.Format),
+			.TypeSize = 1,
+			.PixelWidth = texture.Width,
+			.PixelHeight = texture.Height,
+			.PixelDepth = 0,
+			.LayerCount = 0,
+			.FaceCount = 1,
+			.LevelCount = levelCount,
+			.SupercompressionScheme = 0
+		};
+
+		KTX2Index index{
+			.DFDByteOffset = (uint32_t)(sizeof(s_KTX2Identifier) + sizeof(KTX2Header) + sizeof(KTX2Index) + levelCount * sizeof(KTX2LevelIndex)),
+			.DFDByteLength = (uint32_t)(dfd.size() * sizeof(uint32_t)),
+			.KVDByteOffset = 0,
+			.KVDByteLength = 0,
+			.SGDByteOffset = 0,
+			.SGDByteLength = 0
+		};
+
+		//the smallest level comes first in the file, every level is aligned to the block size
+		const uint64_t alignment = TextureCompressor::GetBlockSize(texture.Format);
+		std::vector<KTX2LevelIndex> levelIndices(levelCount);
+		uint64_t offset = index.DFDByteOffset + index.DFDByteLength;
+		for (int32_t level = (int32_t)levelCount - 1; level >= 0; level--) {
+			offset = (offset + alignment - 1) / alignment * alignment;
+			levelIndices[level] = KTX2LevelIndex{ .ByteOffset = offset, .ByteLength = texture.Levels[level].Size, .UncompressedByteLength = texture.Levels[level].Size };
+			offset += texture.Levels[level].Size;
+		}
+
+		std::error_code errorCode;
+		std::filesystem::create_directories(path.parent_path(), errorCode);
+
+		//written next to the target first, so that a reader never sees a half written file (one per thread, two loads might compress the same texture)
+		std::filesystem::path temporaryPath = path;
+		temporaryPath += std::format(".{}.tmp", std::hash<std::thread::id>{}(std::this_thread::get_id()));
+		{
+			std::ofstream file(temporaryPath, std::ios::out | std::ios::binary | std::ios::trunc);
+			if (!file.is_open())
+				return false;
+
+			file.write((const char*)s_KTX2Identifier, sizeof(s_KTX2Identifier));
+			file.write((const char*)&header, sizeof(header));
+			file.write((const char*)&index, sizeof(index));
+			file.write((const char*)levelIndices.data(), levelIndices.size() * sizeof(KTX2LevelIndex));
+			file.write((const char*)dfd.data(), index.DFDByteLength);
+
+			for (int32_t level = (int32_t)levelCount - 1; level >= 0; level--) {
+				const std::streamoff padding = (std::streamoff)levelIndices[level].ByteOffset - file.tellp();
+				static constexpr char s_Zero[16] = {};
+				file.write(s_Zero, padding);
+				file.write((const char*)texture.Data.data() + texture.Levels[level].Offset, texture.Levels[level].Size);
+			}
+
+			if (!file.good())
+				return false;
+		}
+
+		std::filesystem::rename(temporaryPath, path, errorCode);
+		if (errorCode)
+			std::filesystem::remove(temporaryPath, errorCode);
+		return std::filesystem::exists(path, errorCode);
+	}
+}
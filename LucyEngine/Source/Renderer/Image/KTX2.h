@@ -0,0 +1,33 @@
+#pragma once
+
+#include "TextureCompressor.h"
+
+namespace Lucy {
+
+	struct KTX2Info {
+		ImageFormat Format = ImageFormat::Unknown;
+		uint32_t Width = 0, Height = 0;
+		//level 0 first, Offset is the offset into the file
+		std::vector<CompressedLevel> Levels;
+
+		size_t GetDataSize() const;
+	};
+
+	/*
+	* Minimal KTX2 (Khronos Texture 2.0) reader and writer, for 2D textures with precomputed mips in one of the block compressed formats.
+	* Supercompression (Basis Universal, Zstandard) is not supported, neither are arrays, cubemaps or 3D textures.
+	* The reader only relies on vkFormat, the data format descriptor is written for other tools.
+	*/
+	class KTX2 final {
+	private:
+		KTX2() = delete;
+		~KTX2() = delete;
+	public:
+		//reads the header and the level index only
+		static bool ReadInfo(const std::filesystem::path& path, KTX2Info& outInfo);
+		//reads the levels tightly packed (level 0 first) into destination, which must hold KTX2Info::GetDataSize bytes
+		static bool ReadLevels(const std::filesystem::path& path, const KTX2Info& info, uint8_t* destination);
+
+		static bool Write(const std::filesystem::path& path, const CompressedTexture& texture);
+	};
+}
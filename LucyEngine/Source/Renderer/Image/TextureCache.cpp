@@ -0,0 +1,237 @@
+#include "lypch.h"
+#include "TextureCache.h"
+
+#include "Renderer/Renderer.h"
+#include "Renderer/Shader/Shader.h"
+#include "Renderer/Descriptors/DescriptorSet.h"
+#include "TextureCompressor.h"
+
+#include "Utilities/Utilities.h"
+
+namespace Lucy {
+
+	bool TextureCache::TextureKey::operator==(const TextureKey& other) const {
+		return CanonicalPath == other.CanonicalPath && Format == other.Format && Usage == other.Usage &&
+			Parameter.U == other.Parameter.U && Parameter.V == other.Parameter.V && Parameter.W == other.Parameter.W &&
+			Parameter.Min == other.Parameter.Min && Parameter.Mag == other.Parameter.Mag &&
+			GenerateMipmap == other.GenerateMipmap && GenerateSampler == other.GenerateSampler && StreamMips == other.StreamMips;
+	}
+
+	size_t TextureCache::TextureKeyHash::operator()(const TextureKey& key) const {
+		//the sampling state fits into a single integer
+		const uint64_t state = (uint64_t)key.Format | (uint64_t)key.Usage << 8 |
+			(uint64_t)key.Parameter.U << 16 | (uint64_t)key.Parameter.V << 20 | (uint64_t)key.Parameter.W << 24 |
+			(uint64_t)key.Parameter.Min << 28 | (uint64_t)key.Parameter.Mag << 32 |
+			(uint64_t)key.GenerateMipmap << 36 | (uint64_t)key.GenerateSampler << 37 | (uint64_t)key.StreamMips << 38;
+
+		size_t hash = std::hash<std::string>{}(key.CanonicalPath);
+		Utils::HashCombine(hash, state);
+		return hash;
+	}
+
+	//of the uncompressed formats, that an image can be loaded with
+	static size_t GetTexelSize(ImageFormat format) {
+		switch (format) {
+			case ImageFormat::R8G8B8A8_UNORM:
+			case ImageFormat::R8G8B8A8_UINT:
+			case ImageFormat::R8G8B8A8_SRGB:
+			case ImageFormat::B8G8R8A8_UNORM:
+			case ImageFormat::B8G8R8A8_UINT:
+			case ImageFormat::B8G8R8A8_SRGB:
+				return 4;
+			case ImageFormat::R16G16B16A16_SFLOAT:
+			case ImageFormat::R16G16B16A16_UINT:
+			case ImageFormat::R16G16B16A16_UNORM:
+				return 8;
+			case ImageFormat::R32G32B32A32_SFLOAT:
+			case ImageFormat::R32G32B32A32_UINT:
+				return 16;
+			default:
+				LUCY_ASSERT(false, "Format is not supported by the texture cache.");
+				return 0;
+		}
+	}
+
+	TextureCache::TextureCache(const Ref<RenderDevice>& device, size_t memoryBudget)
+		: m_MemoryBudget(memoryBudget), m_RenderDevice(device) {
+	}
+
+	TextureCache::TextureKey TextureCache::CreateKey(const std::filesystem::path& path, const ImageCreateInfo& createInfo) {
+		//different spellings of the same file (e.g. "../Textures/a.png" and "Textures/a.png") have the same canonical path
+		std::error_code errorCode;
+		std::filesystem::path canonicalPath = std::filesystem::weakly_canonical(path, errorCode);
+		if (errorCode)
+			canonicalPath = path.lexically_normal();
+
+		return TextureKey{
+			.CanonicalPath = canonicalPath.generic_string(),
+			.Format = createInfo.Format,
+			.Usage = createInfo.ImageUsage,
+			.Parameter = createInfo.Parameter,
+			.GenerateMipmap = createInfo.GenerateMipmap,
+			.GenerateSampler = createInfo.GenerateSampler,
+			.StreamMips = createInfo.StreamMips
+		};
+	}
+
+	RenderResourceHandle TextureCache::RTAcquire(const std::filesystem::path& path, const ImageCreateInfo& createInfo) {
+		LUCY_PROFILE_NEW_EVENT("TextureCache::RTAcquire");
+
+		TextureKey key = CreateKey(path, createInfo);
+
+		std::scoped_lock lock(m_Mutex);
+		if (auto it = m_Entries.find(key); it != m_Entries.end()) {
+			TextureEntry& entry = it->second;
+			if (entry.RefCount++ == 0)
+				m_UnreferencedImages.erase(entry.UnreferencedIt);
+			return entry.ImageHandle;
+		}
+
+		RenderResourceHandle imageHandle = RTCreateImage(path, createInfo);
+		if (imageHandle == InvalidRenderResourceHandle)
+			return InvalidRenderResourceHandle;
+		m_UploadCount++;
+
+		const size_t memorySize = GetImageMemorySize(imageHandle);
+		m_MemorySize += memorySize;
+
+		const uint32_t bindlessIndex = RequestBindlessIndex(imageHandle);
+		m_KeysByHandle.try_emplace(imageHandle, key);
+		m_Entries.try_emplace(std::move(key), TextureEntry{ .ImageHandle = imageHandle, .RefCount = 1, .BindlessIndex = bindlessIndex, .MemorySize = memorySize });
+		RTEvictOverBudget();
+		return imageHandle;
+	}
+
+	void TextureCache::RTRelease(RenderResourceHandle handle) {
+		LUCY_PROFILE_NEW_EVENT("TextureCache::RTRelease");
+		if (handle == InvalidRenderResourceHandle)
+			return;
+
+		std::scoped_lock lock(m_Mutex);
+		auto keyIt = m_KeysByHandle.find(handle);
+		LUCY_ASSERT(keyIt != m_KeysByHandle.end(), "Releasing an image that is not owned by the texture cache!");
+
+		TextureEntry& entry = m_Entries.at(keyIt->second);
+		LUCY_ASSERT(entry.RefCount > 0, "Releasing an image that has no references!");
+		if (--entry.RefCount > 0)
+			return;
+
+		entry.UnreferencedIt = m_UnreferencedImages.insert(m_UnreferencedImages.end(), handle);
+		RTEvictOverBudget();
+	}
+
+	void TextureCache::DestroyAll() {
+		std::scoped_lock lock(m_Mutex);
+		for (TextureEntry& entry : m_Entries | std::views::values)
+			RTDestroyImage(entry.ImageHandle);
+		m_Entries.clear();
+		m_KeysByHandle.clear();
+		m_UnreferencedImages.clear();
+		m_MemorySize = 0;
+		m_BindlessTextures.clear();
+		m_FreeBindlessIndices.clear();
+	}
+
+	void TextureCache::RTSetMemoryBudget(size_t memoryBudget) {
+		std::scoped_lock lock(m_Mutex);
+		m_MemoryBudget = memoryBudget;
+		RTEvictOverBudget();
+	}
+
+	void TextureCache::RTEvict(RenderResourceHandle handle) {
+		auto keyIt = m_KeysByHandle.find(handle);
+		auto entryIt = m_Entries.find(keyIt->second);
+		const TextureEntry& entry = entryIt->second;
+		LUCY_ASSERT(entry.RefCount == 0, "Evicting an image that is still referenced!");
+
+		RTDestroyImage(handle);
+		m_MemorySize -= entry.MemorySize;
+		m_UnreferencedImages.erase(entry.UnreferencedIt);
+		//the descriptor of the index is overwritten with the blank image by the next bind
+		m_BindlessTextures[entry.BindlessIndex] = InvalidRenderResourceHandle;
+		m_FreeBindlessIndices.push_back(entry.BindlessIndex);
+		m_Entries.erase(entryIt);
+		m_KeysByHandle.erase(keyIt);
+	}
+
+	void TextureCache::RTEvictOverBudget() {
+		while (m_MemorySize > m_MemoryBudget && !m_UnreferencedImages.empty())
+			RTEvict(m_UnreferencedImages.front());
+	}
+
+	uint32_t TextureCache::RequestBindlessIndex(RenderResourceHandle imageHandle) {
+		//the unreferenced images give up their index, before the array overflows
+		if (m_FreeBindlessIndices.empty() && m_BindlessTextures.size() == MAX_DYNAMIC_DESCRIPTOR_COUNT && !m_UnreferencedImages.empty())
+			RTEvict(m_UnreferencedImages.front());
+
+		if (!m_FreeBindlessIndices.empty()) {
+			const uint32_t bindlessIndex = m_FreeBindlessIndices.back();
+			m_FreeBindlessIndices.pop_back();
+			m_BindlessTextures[bindlessIndex] = imageHandle;
+			return bindlessIndex;
+		}
+
+		const uint32_t bindlessIndex = (uint32_t)m_BindlessTextures.size();
+		LUCY_ASSERT(bindlessIndex < MAX_DYNAMIC_DESCRIPTOR_COUNT, "The bindless texture array is full ({0} textures)!", MAX_DYNAMIC_DESCRIPTOR_COUNT);
+		m_BindlessTextures.push_back(imageHandle);
+		return bindlessIndex;
+	}
+
+	RenderResourceHandle TextureCache::RTCreateImage(const std::filesystem::path& path, const ImageCreateInfo& createInfo) {
+		RenderResourceHandle imageHandle = m_RenderDevice->CreateImage(path, createInfo);
+		if (!Renderer::IsValidRenderResource(imageHandle))
+			return InvalidRenderResourceHandle;
+
+		//only images, that have been loaded from a KTX2 file, stream their levels
+		if (const Ref<Image>& image = Renderer::AccessResource<Image>(imageHandle); image->IsStreamed())
+			Renderer::GetTextureStreamer()->Register(imageHandle, image->GetWidth(), image->GetHeight(), image->GetStreamedLevelSizes(), image->GetResidentMip());
+		return imageHandle;
+	}
+
+	void TextureCache::RTDestroyImage(RenderResourceHandle handle) {
+		Renderer::GetTextureStreamer()->Unregister(handle);
+		Renderer::EnqueueResourceDestroy(handle);
+	}
+
+	size_t TextureCache::GetImageMemorySize(RenderResourceHandle handle) {
+		const Ref<Image>& image = Renderer::AccessResource<Image>(handle);
+		if (image->IsStreamed()) {
+			const std::vector<size_t>& levelSizes = image->GetStreamedLevelSizes();
+			return std::accumulate(levelSizes.begin() + image->GetResidentMip(), levelSizes.end(), (size_t)0);
+		}
+
+		if (TextureCompressor::IsBlockCompressed(image->GetFormat()))
+			return TextureCompressor::GetTextureSize(image->GetFormat(), (uint32_t)image->GetWidth(), (uint32_t)image->GetHeight(), image->GetMaxMipLevel());
+
+		size_t memorySize = 0;
+		for (uint32_t level = 0; level < image->GetMaxMipLevel(); level++)
+			memorySize += (size_t)glm::max(image->GetWidth() >> level, 1) * glm::max(image->GetHeight() >> level, 1) * GetTexelSize(image->GetFormat());
+		return memorySize;
+	}
+
+	uint32_t TextureCache::GetBindlessIndex(RenderResourceHandle handle) {
+		std::scoped_lock lock(m_Mutex);
+		auto keyIt = m_KeysByHandle.find(handle);
+		if (keyIt == m_KeysByHandle.end())
+			return InvalidBindlessIndex;
+		return m_Entries.at(keyIt->second).BindlessIndex;
+	}
+
+	void TextureCache::BindBindlessTextures(const Ref<Shader>& shader, const std::string& imageBufferName) {
+		BindBindlessTextures(shader, shader->GetBindingHandle(imageBufferName));
+	}
+
+	void TextureCache::BindBindlessTextures(const Ref<Shader>& shader, ShaderBindingHandle bindingHandle) {
+		LUCY_PROFILE_NEW_EVENT("TextureCache::BindBindlessTextures");
+
+		std::scoped_lock lock(m_Mutex);
+		const Ref<Image>& blankImage = Renderer::GetBlankImage();
+		for (uint32_t bindlessIndex = 0; RenderResourceHandle imageHandle : m_BindlessTextures) {
+			Ref<Image> image = imageHandle != InvalidRenderResourceHandle ? Renderer::AccessResource<Image>(imageHandle) : nullptr;
+			if (!image || !image->IsReady())
+				image = blankImage;
+
+			shader->BindImageHandleTo(bindingHandle, image, bindlessIndex++);
+		}
+	}
+}
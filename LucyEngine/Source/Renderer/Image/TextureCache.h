@@ -0,0 +1,101 @@
+#pragma once
+
+#include <list>
+#include <mutex>
+
+#include "Image.h"
+
+namespace Lucy {
+
+	class RenderDevice;
+	class Shader;
+	struct ShaderBindingHandle;
+
+	/*
+	* Deduplicates images that are loaded from a file (e.g. material textures).
+	* An image is keyed by its canonical path and the parameters, that change the uploaded image or its sampler.
+	* The first request decodes and uploads it, every further request only increases the reference count.
+	* An image, whose last reference has been released, stays cached (a reloaded scene doesn't upload it again), until the cached images exceed
+	* the memory budget. Then the least recently released ones are evicted (destroyed), referenced images are never evicted.
+	* The memory size of an image is taken at its creation, the levels that are streamed in later are budgeted by the TextureStreamer.
+	* Every cached image gets an index into the bindless texture array of the materials (u_Textures), which is freed and reused with the eviction.
+	*/
+	class TextureCache {
+	public:
+		TextureCache(const Ref<RenderDevice>& device, size_t memoryBudget = s_DefaultMemoryBudget);
+		virtual ~TextureCache() = default;
+
+		RenderResourceHandle RTAcquire(const std::filesystem::path& path, const ImageCreateInfo& createInfo);
+		void RTRelease(RenderResourceHandle handle);
+		void DestroyAll();
+
+		//InvalidBindlessIndex, if the image is not owned by the cache
+		uint32_t GetBindlessIndex(RenderResourceHandle handle);
+		//binds every cached image at its index, once per frame. Free indices and images that are still loading are bound to the blank image
+		void BindBindlessTextures(const Ref<Shader>& shader, const std::string& imageBufferName);
+		void BindBindlessTextures(const Ref<Shader>& shader, ShaderBindingHandle bindingHandle);
+
+		//how many images have actually been created from a file
+		inline size_t GetUploadCount() const { return m_UploadCount; }
+		//including the unreferenced ones
+		inline size_t GetCachedTextureCount() const { return m_Entries.size(); }
+
+		//evicts unreferenced images right away, if the cached ones exceed the new budget
+		void RTSetMemoryBudget(size_t memoryBudget);
+		inline size_t GetMemoryBudget() const { return m_MemoryBudget; }
+		inline size_t GetMemorySize() const { return m_MemorySize; }
+
+		static constexpr uint32_t InvalidBindlessIndex = UINT32_MAX;
+		static constexpr size_t s_DefaultMemoryBudget = 512ull * 1024ull * 1024ull;
+	private:
+		//the device side, overridden by the tests
+		virtual RenderResourceHandle RTCreateImage(const std::filesystem::path& path, const ImageCreateInfo& createInfo);
+		virtual void RTDestroyImage(RenderResourceHandle handle);
+		virtual size_t GetImageMemorySize(RenderResourceHandle handle);
+
+		struct TextureKey {
+			std::string CanonicalPath;
+			ImageFormat Format = ImageFormat::Unknown;
+			ImageUsage Usage = ImageUsage::Unknown;
+			ImageParameter Parameter;
+			bool GenerateMipmap = false;
+			bool GenerateSampler = false;
+			bool StreamMips = false;
+
+			bool operator==(const TextureKey& other) const;
+		};
+
+		struct TextureKeyHash {
+			size_t operator()(const TextureKey& key) const;
+		};
+
+		struct TextureEntry {
+			RenderResourceHandle ImageHandle = InvalidRenderResourceHandle;
+			uint32_t RefCount = 0;
+			uint32_t BindlessIndex = InvalidBindlessIndex;
+			size_t MemorySize = 0;
+			std::list<RenderResourceHandle>::iterator UnreferencedIt; //only valid without references
+		};
+
+		static TextureKey CreateKey(const std::filesystem::path& path, const ImageCreateInfo& createInfo);
+
+		void RTEvict(RenderResourceHandle handle);
+		//evicts the least recently released images, until the cached images fit into the budget again (or none is left without references)
+		void RTEvictOverBudget();
+		uint32_t RequestBindlessIndex(RenderResourceHandle imageHandle);
+
+		std::unordered_map<TextureKey, TextureEntry, TextureKeyHash> m_Entries;
+		std::unordered_map<RenderResourceHandle, TextureKey> m_KeysByHandle;
+		std::list<RenderResourceHandle> m_UnreferencedImages; //the least recently released first
+		size_t m_UploadCount = 0;
+		size_t m_MemorySize = 0;
+		size_t m_MemoryBudget = s_DefaultMemoryBudget;
+
+		std::vector<RenderResourceHandle> m_BindlessTextures; //by bindless index, InvalidRenderResourceHandle for the free ones
+		std::vector<uint32_t> m_FreeBindlessIndices;
+
+		std::mutex m_Mutex;
+
+		Ref<RenderDevice> m_RenderDevice = nullptr;
+	};
+}
@@ -0,0 +1,469 @@
+#include "lypch.h"
+#include "TextureCompressor.h"
+
+#include "Utilities/Utilities.h"
+
+namespace Lucy {
+
+	static constexpr uint32_t s_BC7Weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+	//writes the bits starting from the least significant bit of the block
+	struct BlockBitWriter {
+		uint8_t* Data = nullptr;
+		uint32_t Offset = 0;
+
+		void Write(uint32_t value, uint32_t bitCount) {
+			for (uint32_t i = 0; i < bitCount; i++, Offset++) {
+				if (value & (1u << i))
+					Data[Offset / 8] |= (uint8_t)(1u << (Offset % 8));
+			}
+		}
+	};
+
+	static float SRGBToLinear(float value) {
+		return value <= 0.04045f ? value / 12.92f : glm::pow((value + 0.055f) / 1.055f, 2.4f);
+	}
+
+	static float LinearToSRGB(float value) {
+		return value <= 0.0031308f ? value * 12.92f : 1.055f * glm::pow(value, 1.0f / 2.4f) - 0.055f;
+	}
+
+	//the axis, along which the colors of the block vary the most (power iteration on the covariance matrix)
+	template <glm::length_t TLength>
+	static glm::vec<TLength, float> GetPrincipalAxis(const glm::vec<TLength, float>* values, uint32_t count, const glm::vec<TLength, float>& mean) {
+		using Vec = glm::vec<TLength, float>;
+
+		float covariance[TLength][TLength] = {};
+		for (uint32_t i = 0; i < count; i++) {
+			const Vec delta = values[i] - mean;
+			for (glm::length_t r = 0; r < TLength; r++) {
+				for (glm::length_t c = 0; c < TLength; c++)
+					covariance[r][c] += delta[r] * delta[c];
+			}
+		}
+
+		Vec axis = Vec(1.0f);
+		for (uint32_t iteration = 0; iteration < 8; iteration++) {
+			Vec next = Vec(0.0f);
+			for (glm::length_t r = 0; r < TLength; r++) {
+				for (glm::length_t c = 0; c < TLength; c++)
+					next[r] += covariance[r][c] * axis[c];
+			}
+
+			const float length = glm::length(next);
+			if (length < FLT_EPSILON)
+				break;
+			axis = next / length;
+		}
+		return axis;
+	}
+
+	static uint16_t PackRGB565(const glm::vec3& color) {
+		const glm::vec3 clamped = glm::clamp(color, 0.0f, 255.0f);
+		const uint32_t r = (uint32_t)glm::round(clamped.r * 31.0f / 255.0f);
+		const uint32_t g = (uint32_t)glm::round(clamped.g * 63.0f / 255.0f);
+		const uint32_t b = (uint32_t)glm::round(clamped.b * 31.0f / 255.0f);
+		return (uint16_t)(r << 11 | g << 5 | b);
+	}
+
+	static glm::vec3 UnpackRGB565(uint16_t color) {
+		const uint32_t r = (color >> 11) & 31;
+		const uint32_t g = (color >> 5) & 63;
+		const uint32_t b = color & 31;
+		return glm::vec3((float)(r << 3 | r >> 2), (float)(g << 2 | g >> 4), (float)(b << 3 | b >> 2));
+	}
+
+	bool TextureCompressor::IsBlockCompressed(ImageFormat format) {
+		switch (format) {
+			case ImageFormat::BC1_RGBA_UNORM:
+			case ImageFormat::BC1_RGBA_SRGB:
+			case ImageFormat::BC3_UNORM:
+			case ImageFormat::BC3_SRGB:
+			case ImageFormat::BC4_UNORM:
+			case ImageFormat::BC5_UNORM:
+			case ImageFormat::BC7_UNORM:
+			case ImageFormat::BC7_SRGB:
+				return true;
+			default:
+				return false;
+		}
+	}
+
+	bool TextureCompressor::IsSRGB(ImageFormat format) {
+		return format == ImageFormat::BC1_RGBA_SRGB || format == ImageFormat::BC3_SRGB || format == ImageFormat::BC7_SRGB;
+	}
+
+	uint32_t TextureCompressor::GetBlockSize(ImageFormat format) {
+		switch (format) {
+			case ImageFormat::BC1_RGBA_UNORM:
+			case ImageFormat::BC1_RGBA_SRGB:
+			case ImageFormat::BC4_UNORM:
+				return 8;
+			case ImageFormat::BC3_UNORM:
+			case ImageFormat::BC3_SRGB:
+			case ImageFormat::BC5_UNORM:
+			case ImageFormat::BC7_UNORM:
+			case ImageFormat::BC7_SRGB:
+				return 16;
+			default:
+				LUCY_ASSERT(false, "Format is not block compressed.");
+				return 0;
+		}
+	}
+
+	size_t TextureCompressor::GetLevelSize(ImageFormat format, uint32_t width, uint32_t height) {
+		return (size_t)((width + 3) / 4) * ((height + 3) / 4) * GetBlockSize(format);
+	}
+
+	uint32_t TextureCompressor::GetLevelCount(uint32_t width, uint32_t height, bool generateMipmap) {
+		if (!generateMipmap)
+			return 1;
+		return (uint32_t)glm::floor(glm::log2((float)glm::max(width, height))) + 1u;
+	}
+
+	size_t TextureCompressor::GetTextureSize(ImageFormat format, uint32_t width, uint32_t height, uint32_t levelCount) {
+		size_t size = 0;
+		for (uint32_t level = 0; level < levelCount; level++)
+			size += GetLevelSize(format, glm::max(width >> level, 1u), glm::max(height >> level, 1u));
+		return size;
+	}
+
+	CompressedTexture TextureCompressor::Compress(const uint8_t* rgba, uint32_t width, uint32_t height, ImageFormat format, uint32_t levelCount) {
+		LUCY_PROFILE_NEW_EVENT("TextureCompressor::Compress");
+		LUCY_ASSERT(IsBlockCompressed(format), "Format is not block compressed.");
+
+		CompressedTexture texture{ .Format = format, .Width = width, .Height = height };
+		texture.Data.resize(GetTextureSize(format, width, height, levelCount));
+		texture.Levels.reserve(levelCount);
+
+		std::vector<uint8_t> mip;
+		const uint8_t* source = rgba;
+		size_t offset = 0;
+
+		for (uint32_t level = 0; level < levelCount; level++) {
+			const uint32_t levelWidth = glm::max(width >> level, 1u);
+			const uint32_t levelHeight = glm::max(height >> level, 1u);
+			const size_t levelSize = GetLevelSize(format, levelWidth, levelHeight);
+
+			CompressLevel(source, levelWidth, levelHeight, format, texture.Data.data() + offset);
+			texture.Levels.push_back(CompressedLevel{ .Width = levelWidth, .Height = levelHeight, .Offset = offset, .Size = levelSize });
+			offset += levelSize;
+
+			if (level + 1 < levelCount) {
+				mip = Downsample(source, levelWidth, levelHeight, IsSRGB(format));
+				source = mip.data();
+			}
+		}
+		return texture;
+	}
+
+	std::filesystem::path TextureCompressor::GetCachePath(const std::filesystem::path& sourcePath, ImageFormat format) {
+		std::error_code errorCode;
+		std::filesystem::path canonicalPath = std::filesystem::weakly_canonical(sourcePath, errorCode);
+		if (errorCode)
+			canonicalPath = sourcePath.lexically_normal();
+
+		//a changed source image gets a new cache entry
+		const auto lastWriteTime = std::filesystem::last_write_time(sourcePath, errorCode);
+		const uint64_t timeStamp = errorCode ? 0 : (uint64_t)lastWriteTime.time_since_epoch().count();
+
+		//the hashes are part of the file names, they have to be the same on every run
+		const std::string pathInString = canonicalPath.generic_string();
+		const uint32_t formatValue = (uint32_t)format;
+		uint64_t sourceHash = Utils::HashBytes(pathInString.data(), pathInString.size());
+		sourceHash = Utils::HashBytes(&formatValue, sizeof(formatValue), sourceHash);
+
+		uint64_t contentHash = Utils::HashBytes(&timeStamp, sizeof(timeStamp));
+		contentHash = Utils::HashBytes(&s_EncoderVersion, sizeof(s_EncoderVersion), contentHash);
+
+		return s_CacheFolder / std::format("{}_{:016x}_{:016x}.ktx2", sourcePath.stem().string(), sourceHash, contentHash);
+	}
+
+	void TextureCompressor::RemoveStaleCacheEntries(const std::filesystem::path& cachePath) {
+		//everything up to the content hash
+		const std::string fileName = cachePath.filename().string();
+		const std::string prefix = fileName.substr(0, fileName.find_last_of('_') + 1);
+
+		std::error_code errorCode;
+		for (std::filesystem::directory_iterator it(cachePath.parent_path(), errorCode), end; !errorCode && it != end; it.increment(errorCode)) {
+			const std::string entryName = it->path().filename().string();
+			if (entryName == fileName || !entryName.starts_with(prefix) || it->path().extension() != ".ktx2")
+				continue;
+
+			//an image loaded before the source changed might still stream from it, removing it fails on Windows then
+			std::error_code removeErrorCode;
+			if (!std::filesystem::remove(it->path(), removeErrorCode) || removeErrorCode)
+				LUCY_WARN("Failed to remove the stale texture cache entry {0}.", it->path().generic_string());
+		}
+	}
+
+	void TextureCompressor::CompressLevel(const uint8_t* rgba, uint32_t width, uint32_t height, ImageFormat format, uint8_t* destination) {
+		const uint32_t blockSize = GetBlockSize(format);
+		const uint32_t blockCountX = (width + 3) / 4;
+		const uint32_t blockCountY = (height + 3) / 4;
+
+		uint8_t block[16 * 4];
+		for (uint32_t by = 0; by < blockCountY; by++) {
+			for (uint32_t bx = 0; bx < blockCountX; bx++) {
+				//levels smaller than a block repeat their edge texels
+				for (uint32_t y = 0; y < 4; y++) {
+					for (uint32_t x = 0; x < 4; x++) {
+						const uint32_t sx = glm::min(bx * 4 + x, width - 1);
+						const uint32_t sy = glm::min(by * 4 + y, height - 1);
+						memcpy(block + (y * 4 + x) * 4, rgba + ((size_t)sy * width + sx) * 4, 4);
+					}
+				}
+
+				uint8_t* blockDestination = destination + ((size_t)by * blockCountX + bx) * blockSize;
+				memset(blockDestination, 0, blockSize);
+
+				switch (format) {
+					case ImageFormat::BC1_RGBA_UNORM:
+					case ImageFormat::BC1_RGBA_SRGB:
+						CompressBlockBC1(block, blockDestination, true);
+						break;
+					case ImageFormat::BC3_UNORM:
+					case ImageFormat::BC3_SRGB:
+						CompressBlockBC4(block + 3, 4, blockDestination);
+						CompressBlockBC1(block, blockDestination + 8, false);
+						break;
+					case ImageFormat::BC4_UNORM:
+						CompressBlockBC4(block, 4, blockDestination);
+						break;
+					case ImageFormat::BC5_UNORM:
+						CompressBlockBC4(block, 4, blockDestination);
+						CompressBlockBC4(block + 1, 4, blockDestination + 8);
+						break;
+					case ImageFormat::BC7_UNORM:
+					case ImageFormat::BC7_SRGB:
+						CompressBlockBC7(block, blockDestination);
+						break;
+					default:
+						LUCY_ASSERT(false);
+						break;
+				}
+			}
+		}
+	}
+
+	std::vector<uint8_t> TextureCompressor::Downsample(const uint8_t* rgba, uint32_t width, uint32_t height, bool isSRGB) {
+		static const auto s_SRGBToLinearTable = []() {
+			std::array<float, 256> table;
+			for (uint32_t i = 0; i < 256; i++)
+				table[i] = SRGBToLinear((float)i / 255.0f);
+			return table;
+		}();
+
+		const uint32_t mipWidth = glm::max(width / 2, 1u);
+		const uint32_t mipHeight = glm::max(height / 2, 1u);
+		std::vector<uint8_t> mip((size_t)mipWidth * mipHeight * 4);
+
+		for (uint32_t y = 0; y < mipHeight; y++) {
+			for (uint32_t x = 0; x < mipWidth; x++) {
+				glm::vec4 sum = glm::vec4(0.0f);
+				for (uint32_t j = 0; j < 2; j++) {
+					for (uint32_t i = 0; i < 2; i++) {
+						const uint32_t sx = glm::min(x * 2 + i, width - 1);
+						const uint32_t sy = glm::min(y * 2 + j, height - 1);
+						const uint8_t* texel = rgba + ((size_t)sy * width + sx) * 4;
+						for (uint32_t c = 0; c < 3; c++)
+							sum[c] += isSRGB ? s_SRGBToLinearTable[texel[c]] : (float)texel[c] / 255.0f;
+						sum.a += (float)texel[3] / 255.0f;
+					}
+				}
+				sum *= 0.25f;
+
+				uint8_t* destination = mip.data() + ((size_t)y * mipWidth + x) * 4;
+				for (uint32_t c = 0; c < 4; c++) {
+					const float value = isSRGB && c < 3 ? LinearToSRGB(sum[c]) : sum[c];
+					destination[c] = (uint8_t)glm::round(glm::clamp(value, 0.0f, 1.0f) * 255.0f);
+				}
+			}
+		}
+		return mip;
+	}
+
+	void TextureCompressor::CompressBlockBC1(const uint8_t* block, uint8_t* destination, bool allowTransparency) {
+		glm::vec3 colors[16];
+		bool isTransparent[16] = {};
+		uint32_t opaqueCount = 0;
+		glm::vec3 mean = glm::vec3(0.0f);
+
+		for (uint32_t i = 0; i < 16; i++) {
+			isTransparent[i] = allowTransparency && block[i * 4 + 3] < 128;
+			if (isTransparent[i])
+				continue;
+			colors[opaqueCount] = glm::vec3(block[i * 4 + 0], block[i * 4 + 1], block[i * 4 + 2]);
+			mean += colors[opaqueCount++];
+		}
+
+		//three color mode (color0 <= color1), index 3 is transparent black
+		const bool hasTransparency = opaqueCount < 16;
+		if (opaqueCount == 0) {
+			memset(destination, 0, 4);
+			memset(destination + 4, 0xFF, 4);
+			return;
+		}
+		mean /= (float)opaqueCount;
+
+		const glm::vec3 axis = GetPrincipalAxis<3>(colors, opaqueCount, mean);
+		float minProjection = FLT_MAX, maxProjection = -FLT_MAX;
+		for (uint32_t i = 0; i < opaqueCount; i++) {
+			const float projection = glm::dot(colors[i] - mean, axis);
+			minProjection = glm::min(minProjection, projection);
+			maxProjection = glm::max(maxProjection, projection);
+		}
+
+		uint16_t color0 = PackRGB565(mean + axis * maxProjection);
+		uint16_t color1 = PackRGB565(mean + axis * minProjection);
+		if (hasTransparency ? color0 > color1 : color0 < color1)
+			std::swap(color0, color1);
+
+		glm::vec3 palette[4];
+		palette[0] = UnpackRGB565(color0);
+		palette[1] = UnpackRGB565(color1);
+		if (hasTransparency) {
+			palette[2] = (palette[0] + palette[1]) * 0.5f;
+		} else {
+			palette[2] = (palette[0] * 2.0f + palette[1]) / 3.0f;
+			palette[3] = (palette[0] + palette[1] * 2.0f) / 3.0f;
+		}
+		const uint32_t paletteSize = hasTransparency ? 3 : 4;
+
+		uint32_t indices = 0;
+		for (uint32_t i = 0; i < 16; i++) {
+			uint32_t bestIndex = 3;
+			if (!isTransparent[i]) {
+				const glm::vec3 color = glm::vec3(block[i * 4 + 0], block[i * 4 + 1], block[i * 4 + 2]);
+				float bestError = FLT_MAX;
+				for (uint32_t p = 0; p < paletteSize; p++) {
+					const glm::vec3 delta = color - palette[p];
+					const float error = glm::dot(delta, delta);
+					if (error < bestError) {
+						bestError = error;
+						bestIndex = p;
+					}
+				}
+			}
+			indices |= bestIndex << (i * 2);
+		}
+
+		memcpy(destination, &color0, 2);
+		memcpy(destination + 2, &color1, 2);
+		memcpy(destination + 4, &indices, 4);
+	}
+
+	void TextureCompressor::CompressBlockBC4(const uint8_t* block, uint32_t stride, uint8_t* destination) {
+		uint8_t minValue = 255, maxValue = 0;
+		for (uint32_t i = 0; i < 16; i++) {
+			minValue = glm::min(minValue, block[i * stride]);
+			maxValue = glm::max(maxValue, block[i * stride]);
+		}
+
+		//eight value mode (value0 > value1), a uniform block only uses value0
+		destination[0] = maxValue;
+		destination[1] = minValue;
+		if (maxValue == minValue)
+			return;
+
+		float palette[8];
+		palette[0] = (float)maxValue;
+		palette[1] = (float)minValue;
+		for (uint32_t p = 2; p < 8; p++)
+			palette[p] = ((float)(8 - p) * maxValue + (float)(p - 1) * minValue) / 7.0f;
+
+		uint64_t indices = 0;
+		for (uint32_t i = 0; i < 16; i++) {
+			uint64_t bestIndex = 0;
+			float bestError = FLT_MAX;
+			for (uint32_t p = 0; p < 8; p++) {
+				const float error = glm::abs((float)block[i * stride] - palette[p]);
+				if (error < bestError) {
+					bestError = error;
+					bestIndex = p;
+				}
+			}
+			indices |= bestIndex << (i * 3);
+		}
+		memcpy(destination + 2, &indices, 6);
+	}
+
+	void TextureCompressor::CompressBlockBC7(const uint8_t* block, uint8_t* destination) {
+		glm::vec4 colors[16];
+		glm::vec4 mean = glm::vec4(0.0f);
+		for (uint32_t i = 0; i < 16; i++) {
+			colors[i] = glm::vec4(block[i * 4 + 0], block[i * 4 + 1], block[i * 4 + 2], block[i * 4 + 3]);
+			mean += colors[i];
+		}
+		mean /= 16.0f;
+
+		const glm::vec4 axis = GetPrincipalAxis<4>(colors, 16, mean);
+		float minProjection = FLT_MAX, maxProjection = -FLT_MAX;
+		for (uint32_t i = 0; i < 16; i++) {
+			const float projection = glm::dot(colors[i] - mean, axis);
+			minProjection = glm::min(minProjection, projection);
+			maxProjection = glm::max(maxProjection, projection);
+		}
+
+		//7 bit endpoints, the p-bit is the shared least significant bit of all channels of an endpoint
+		const auto QuantizeEndpoint = [](const glm::vec4& endpoint, glm::uvec4& quantized, uint32_t& pBit) {
+			float bestError = FLT_MAX;
+			for (uint32_t p = 0; p < 2; p++) {
+				glm::uvec4 candidate;
+				float error = 0.0f;
+				for (uint32_t c = 0; c < 4; c++) {
+					candidate[c] = (uint32_t)glm::clamp(glm::round((glm::clamp(endpoint[c], 0.0f, 255.0f) - (float)p) * 0.5f), 0.0f, 127.0f);
+					const float delta = (float)(candidate[c] << 1 | p) - endpoint[c];
+					error += delta * delta;
+				}
+				if (error < bestError) {
+					bestError = error;
+					quantized = candidate;
+					pBit = p;
+				}
+			}
+		};
+
+		glm::uvec4 endpoints[2];
+		uint32_t pBits[2];
+		QuantizeEndpoint(mean + axis * minProjection, endpoints[0], pBits[0]);
+		QuantizeEndpoint(mean + axis * maxProjection, endpoints[1], pBits[1]);
+
+		const glm::vec4 endpoint0 = glm::vec4(endpoints[0] << 1u | glm::uvec4(pBits[0]));
+		const glm::vec4 endpoint1 = glm::vec4(endpoints[1] << 1u | glm::uvec4(pBits[1]));
+
+		uint32_t indices[16];
+		for (uint32_t i = 0; i < 16; i++) {
+			float bestError = FLT_MAX;
+			for (uint32_t w = 0; w < 16; w++) {
+				const glm::vec4 interpolated = glm::floor((endpoint0 * (float)(64 - s_BC7Weights[w]) + endpoint1 * (float)s_BC7Weights[w] + 32.0f) / 64.0f);
+				const glm::vec4 delta = colors[i] - interpolated;
+				const float error = glm::dot(delta, delta);
+				if (error < bestError) {
+					bestError = error;
+					indices[i] = w;
+				}
+			}
+		}
+
+		//the most significant bit of the first (anchor) index is implicitly 0
+		if (indices[0] & 8) {
+			std::swap(endpoints[0], endpoints[1]);
+			std::swap(pBits[0], pBits[1]);
+			for (uint32_t i = 0; i < 16; i++)
+				indices[i] = 15 - indices[i];
+		}
+
+		BlockBitWriter writer{ .Data = destination };
+		writer.Write(1u << 6, 7); //mode 6
+		for (uint32_t c = 0; c < 4; c++) {
+			writer.Write(endpoints[0][c], 7);
+			writer.Write(endpoints[1][c], 7);
+		}
+		writer.Write(pBits[0], 1);
+		writer.Write(pBits[1], 1);
+		writer.Write(indices[0], 3);
+		for (uint32_t i = 1; i < 16; i++)
+			writer.Write(indices[i], 4);
+	}
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "Image.h"
+
+namespace Lucy {
+
+	struct CompressedLevel {
+		uint32_t Width = 0, Height = 0;
+		size_t Offset = 0; //into CompressedTexture::Data
+		size_t Size = 0;
+	};
+
+	//the levels are tightly packed one after another, starting with level 0 (which is also the layout of the staging buffer)
+	struct CompressedTexture {
+		ImageFormat Format = ImageFormat::Unknown;
+		uint32_t Width = 0, Height = 0;
+		std::vector<CompressedLevel> Levels;
+		std::vector<uint8_t> Data;
+	};
+
+	/*
+	* CPU block compression (BC1, BC3, BC4, BC5 and BC7) of 8 bit RGBA images, including the box filtered mip chain.
+	* The encoders favour speed over quality, they only run once per texture, the result is cached as a KTX2 file (see KTX2).
+	* BC7 only uses mode 6 (one subset, RGBA endpoints with p-bits, 4 bit indices).
+	*/
+	class TextureCompressor final {
+	private:
+		TextureCompressor() = delete;
+		~TextureCompressor() = delete;
+	public:
+		static bool IsBlockCompressed(ImageFormat format);
+		static bool IsSRGB(ImageFormat format);
+		//bytes of a 4x4 block
+		static uint32_t GetBlockSize(ImageFormat format);
+		static size_t GetLevelSize(ImageFormat format, uint32_t width, uint32_t height);
+		static uint32_t GetLevelCount(uint32_t width, uint32_t height, bool generateMipmap);
+		static size_t GetTextureSize(ImageFormat format, uint32_t width, uint32_t height, uint32_t levelCount);
+
+		//the mips are filtered in linear space for sRGB formats
+		static CompressedTexture Compress(const uint8_t* rgba, uint32_t width, uint32_t height, ImageFormat format, uint32_t levelCount);
+
+		//the compressed version of a source image. The entries of a path and format share a prefix,
+		//the last write time and the encoder version select the entry within them
+		static std::filesystem::path GetCachePath(const std::filesystem::path& sourcePath, ImageFormat format);
+		//removes the older entries of the same path and format, once cachePath has been written
+		static void RemoveStaleCacheEntries(const std::filesystem::path& cachePath);
+	private:
+		static void CompressLevel(const uint8_t* rgba, uint32_t width, uint32_t height, ImageFormat format, uint8_t* destination);
+		static std::vector<uint8_t> Downsample(const uint8_t* rgba, uint32_t width, uint32_t height, bool isSRGB);
+
+		//block is 16 RGBA texels
+		static void CompressBlockBC1(const uint8_t* block, uint8_t* destination, bool allowTransparency);
+		//block is 16 values with the given stride
+		static void CompressBlockBC4(const uint8_t* block, uint32_t stride, uint8_t* destination);
+		static void CompressBlockBC7(const uint8_t* block, uint8_t* destination);
+
+		static inline std::filesystem::path s_CacheFolder = "Assets/Textures/Cached/";
+		//bump on any change to the encoders, the mip filter or the KTX2 layout, the cache entries are written again
+		static constexpr uint32_t s_EncoderVersion = 1;
+	};
+}
@@ -0,0 +1,196 @@
+#include "lypch.h"
+#include "TextureStreamer.h"
+
+namespace Lucy {
+
+	TextureStreamer::TextureStreamer(size_t budget)
+		: m_Budget(budget) {
+	}
+
+	void TextureStreamer::Register(RenderResourceHandle handle, uint32_t width, uint32_t height, const std::vector<size_t>& levelSizes, uint32_t residentMip) {
+		LUCY_ASSERT(residentMip < levelSizes.size(), "Resident mip {0} is out of range, the image has {1} levels.", residentMip, levelSizes.size());
+
+		std::scoped_lock lock(m_Mutex);
+		//pending until the image has uploaded its low mips
+		auto [it, inserted] = m_Textures.try_emplace(handle, StreamedTexture{
+			.Size = glm::max(width, height),
+			.LevelSizes = levelSizes,
+			.BaseMip = residentMip,
+			.ResidentMip = residentMip,
+			.DesiredMip = residentMip,
+			.LastUsedUpdate = 0,
+			.IsPending = true
+		});
+		LUCY_ASSERT(inserted, "Image has already been registered for streaming.");
+		m_ResidentSize += GetResidentSize(it->second, residentMip);
+	}
+
+	void TextureStreamer::Unregister(RenderResourceHandle handle) {
+		std::scoped_lock lock(m_Mutex);
+		auto it = m_Textures.find(handle);
+		if (it == m_Textures.end())
+			return;
+
+		m_ResidentSize -= GetResidentSize(it->second, it->second.ResidentMip);
+		m_Textures.erase(it);
+	}
+
+	void TextureStreamer::UnregisterAll() {
+		std::scoped_lock lock(m_Mutex);
+		m_Textures.clear();
+		m_ResidentSize = 0;
+	}
+
+	void TextureStreamer::RequestMip(RenderResourceHandle handle, uint32_t mip) {
+		std::scoped_lock lock(m_Mutex);
+		if (auto it = m_Textures.find(handle); it != m_Textures.end())
+			it->second.RequestedMip = glm::min(it->second.RequestedMip, mip);
+	}
+
+	void TextureStreamer::RequestScreenSize(RenderResourceHandle handle, float screenPixels) {
+		std::scoped_lock lock(m_Mutex);
+		if (auto it = m_Textures.find(handle); it != m_Textures.end()) {
+			StreamedTexture& texture = it->second;
+			texture.RequestedMip = glm::min(texture.RequestedMip, ComputeDesiredMip(texture.Size, screenPixels, (uint32_t)texture.LevelSizes.size()));
+		}
+	}
+
+	std::vector<TextureResidencyChange> TextureStreamer::Update() {
+		LUCY_PROFILE_NEW_EVENT("TextureStreamer::Update");
+
+		std::scoped_lock lock(m_Mutex);
+		std::vector<TextureResidencyChange> changes;
+
+		//the requests of the last frame
+		for (StreamedTexture& texture : m_Textures | std::views::values) {
+			if (texture.RequestedMip == UINT32_MAX)
+				continue;
+			texture.DesiredMip = glm::min(texture.RequestedMip, texture.BaseMip);
+			texture.LastUsedUpdate = m_CurrentUpdate;
+			texture.RequestedMip = UINT32_MAX;
+		}
+
+		//the budget might have been lowered
+		EvictFor(nullptr, 0, changes);
+
+		std::vector<std::pair<RenderResourceHandle, StreamedTexture*>> candidates;
+		for (auto& [handle, texture] : m_Textures) {
+			if (!texture.IsPending && texture.DesiredMip < texture.ResidentMip)
+				candidates.emplace_back(handle, &texture);
+		}
+
+		std::sort(candidates.begin(), candidates.end(), [](const auto& a, const auto& b) {
+			if (a.second->LastUsedUpdate != b.second->LastUsedUpdate)
+				return a.second->LastUsedUpdate > b.second->LastUsedUpdate;
+			return a.second->ResidentMip - a.second->DesiredMip > b.second->ResidentMip - b.second->DesiredMip;
+		});
+
+		uint32_t streamInCount = 0;
+		for (auto& [handle, texture] : candidates) {
+			if (streamInCount >= m_MaxChangesPerUpdate)
+				break;
+			//might have been evicted for a more recently used texture
+			if (texture->IsPending)
+				continue;
+
+			const uint32_t targetMip = texture->ResidentMip - 1;
+			const size_t levelSize = texture->LevelSizes[targetMip];
+			if (!EvictFor(texture, levelSize, changes))
+				continue;
+
+			texture->ResidentMip = targetMip;
+			texture->IsPending = true;
+			m_ResidentSize += levelSize;
+
+			changes.push_back(TextureResidencyChange{ .Handle = handle, .ResidentMip = targetMip });
+			streamInCount++;
+		}
+
+		m_CurrentUpdate++;
+		return changes;
+	}
+
+	bool TextureStreamer::EvictFor(const StreamedTexture* requester, size_t requiredSize, std::vector<TextureResidencyChange>& changes) {
+		//textures, that have been used as recently as the requester, only give up the levels they don't need
+		const auto GetEvictionLimit = [requester](const StreamedTexture& texture) {
+			if (requester && texture.LastUsedUpdate >= requester->LastUsedUpdate)
+				return texture.DesiredMip;
+			return texture.BaseMip;
+		};
+
+		while (m_ResidentSize + requiredSize > m_Budget) {
+			RenderResourceHandle victimHandle = InvalidRenderResourceHandle;
+			StreamedTexture* victim = nullptr;
+
+			for (auto& [handle, texture] : m_Textures) {
+				if (&texture == requester || texture.IsPending || texture.ResidentMip >= GetEvictionLimit(texture))
+					continue;
+
+				const bool isLessRecentlyUsed = !victim || texture.LastUsedUpdate < victim->LastUsedUpdate ||
+					(texture.LastUsedUpdate == victim->LastUsedUpdate && GetResidentSize(texture, texture.ResidentMip) > GetResidentSize(*victim, victim->ResidentMip));
+				if (isLessRecentlyUsed) {
+					victimHandle = handle;
+					victim = &texture;
+				}
+			}
+
+			if (!victim)
+				return false;
+
+			const uint32_t evictionLimit = GetEvictionLimit(*victim);
+			while (victim->ResidentMip < evictionLimit && m_ResidentSize + requiredSize > m_Budget) {
+				m_ResidentSize -= victim->LevelSizes[victim->ResidentMip];
+				victim->ResidentMip++;
+			}
+			victim->IsPending = true;
+			changes.push_back(TextureResidencyChange{ .Handle = victimHandle, .ResidentMip = victim->ResidentMip });
+		}
+		return true;
+	}
+
+	void TextureStreamer::OnResidencyChanged(RenderResourceHandle handle, uint32_t residentMip) {
+		std::scoped_lock lock(m_Mutex);
+		auto it = m_Textures.find(handle);
+		if (it == m_Textures.end())
+			return;
+
+		StreamedTexture& texture = it->second;
+		if (texture.ResidentMip != residentMip) {
+			m_ResidentSize -= GetResidentSize(texture, texture.ResidentMip);
+			m_ResidentSize += GetResidentSize(texture, residentMip);
+			texture.ResidentMip = residentMip;
+		}
+		texture.IsPending = false;
+	}
+
+	std::vector<RenderResourceHandle> TextureStreamer::GetPendingHandles() {
+		std::scoped_lock lock(m_Mutex);
+		std::vector<RenderResourceHandle> handles;
+		for (const auto& [handle, texture] : m_Textures) {
+			if (texture.IsPending)
+				handles.push_back(handle);
+		}
+		return handles;
+	}
+
+	void TextureStreamer::SetBudget(size_t budget) {
+		std::scoped_lock lock(m_Mutex);
+		m_Budget = budget;
+	}
+
+	size_t TextureStreamer::GetResidentSize(const StreamedTexture& texture, uint32_t residentMip) const {
+		return std::accumulate(texture.LevelSizes.begin() + residentMip, texture.LevelSizes.end(), (size_t)0);
+	}
+
+	uint32_t TextureStreamer::ComputeDesiredMip(uint32_t textureSize, float screenPixels, uint32_t levelCount) {
+		if (levelCount == 0)
+			return 0;
+		if (screenPixels < 1.0f)
+			return levelCount - 1;
+
+		const float texelsPerPixel = (float)textureSize / screenPixels;
+		if (texelsPerPixel <= 1.0f)
+			return 0;
+		return glm::min((uint32_t)glm::floor(glm::log2(texelsPerPixel)), levelCount - 1);
+	}
+}
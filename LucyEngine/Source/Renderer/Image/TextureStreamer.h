@@ -0,0 +1,75 @@
+#pragma once
+
+#include <mutex>
+
+#include "Image.h"
+
+namespace Lucy {
+
+	struct TextureResidencyChange {
+		RenderResourceHandle Handle = InvalidRenderResourceHandle;
+		uint32_t ResidentMip = 0;
+	};
+
+	/*
+	* Residency policy of the streamed images (see ImageCreateInfo::StreamMips), it only does the bookkeeping, the images load and drop their levels.
+	* Every frame, the renderer requests the mip it wants to sample of a texture (a screen size estimate or GPU feedback).
+	* Update then streams the missing levels in (one level per texture and update, the most recently used textures first),
+	* as long as the resident size stays within the budget. If it doesn't, the least recently used textures lose their finest levels (LRU eviction),
+	* a texture only evicts ones, that have been used less recently than itself or that hold more levels than they need.
+	* The low mips, that have been loaded with the image, are never evicted.
+	*/
+	class TextureStreamer final {
+	public:
+		TextureStreamer(size_t budget = s_DefaultBudget);
+		~TextureStreamer() = default;
+
+		//levelSizes are the sizes of the full mip chain, the resident mip is also the coarsest, that the streamer evicts down to
+		void Register(RenderResourceHandle handle, uint32_t width, uint32_t height, const std::vector<size_t>& levelSizes, uint32_t residentMip);
+		void Unregister(RenderResourceHandle handle);
+		void UnregisterAll();
+
+		//the finest mip requested within a frame wins. Handles, that have not been registered, are ignored
+		void RequestMip(RenderResourceHandle handle, uint32_t mip);
+		//screenPixels: the projected size of the surface, that the texture is mapped onto
+		void RequestScreenSize(RenderResourceHandle handle, float screenPixels);
+
+		std::vector<TextureResidencyChange> Update();
+		//a change has been applied (or has failed, then residentMip is the old one)
+		void OnResidencyChanged(RenderResourceHandle handle, uint32_t residentMip);
+		std::vector<RenderResourceHandle> GetPendingHandles();
+
+		void SetBudget(size_t budget);
+		inline size_t GetBudget() const { return m_Budget; }
+		inline size_t GetResidentSize() const { return m_ResidentSize; }
+		inline void SetMaxChangesPerUpdate(uint32_t maxChangesPerUpdate) { m_MaxChangesPerUpdate = maxChangesPerUpdate; }
+
+		//the mip, whose texel density matches the screen (one texel per pixel), assuming the texture is mapped once onto the surface
+		static uint32_t ComputeDesiredMip(uint32_t textureSize, float screenPixels, uint32_t levelCount);
+
+		static constexpr size_t s_DefaultBudget = 512ull * 1024ull * 1024ull;
+	private:
+		struct StreamedTexture {
+			uint32_t Size = 0; //max(width, height) of level 0
+			std::vector<size_t> LevelSizes;
+			uint32_t BaseMip = 0;
+			uint32_t ResidentMip = 0; //the target, while a change is pending
+			uint32_t DesiredMip = 0;
+			uint32_t RequestedMip = UINT32_MAX;
+			uint64_t LastUsedUpdate = 0;
+			bool IsPending = false;
+		};
+
+		size_t GetResidentSize(const StreamedTexture& texture, uint32_t residentMip) const;
+		//drops the finest levels of the least recently used texture, until the size fits into the budget
+		bool EvictFor(const StreamedTexture* requester, size_t requiredSize, std::vector<TextureResidencyChange>& changes);
+
+		std::unordered_map<RenderResourceHandle, StreamedTexture> m_Textures;
+		size_t m_Budget = s_DefaultBudget;
+		size_t m_ResidentSize = 0;
+		uint64_t m_CurrentUpdate = 1;
+		uint32_t m_MaxChangesPerUpdate = 8;
+
+		std::mutex m_Mutex;
+	};
+}
@@ -29,6 +29,10 @@ namespace Lucy {
 		vkCmdCopyImage(commandBuffer, m_Image, m_CurrentLayout, destImage->GetVulkanHandle(), destImage->GetCurrentLayout(), (uint32_t)imageCopyRegions.size(), imageCopyRegions.data());
 	}
 
+	void VulkanImage::CopyImageToBuffer(VkCommandBuffer commandBuffer, const VkBuffer& bufferToCopy, const std::vector<VkBufferImageCopy>& imageCopyRegions) {
+		vkCmdCopyImageToBuffer(commandBuffer, m_Image, m_CurrentLayout, bufferToCopy, (uint32_t)imageCopyRegions.size(), imageCopyRegions.data());
+	}
+
 	void VulkanImage::CopyImageToImageImmediate(VkImage image, VkImageLayout layout, const std::vector<VkImageCopy>& regions) {
 		Renderer::SubmitImmediateCommand([=](VkCommandBuffer commandBuffer) {
 			vkCmdCopyImage(commandBuffer, m_Image, m_CurrentLayout, image, layout, (uint32_t)regions.size(), regions.data());
@@ -78,43 +82,64 @@ namespace Lucy {
 	}
 
 	void VulkanImage::GenerateMipmapsImmediate() {
+		Renderer::SubmitImmediateCommand([&](VkCommandBuffer commandBuffer) {
+			GenerateMipmaps(commandBuffer);
+		});
+	}
+
+	void VulkanImage::GenerateMipmaps(VkCommandBuffer commandBuffer) {
+#if USE_COMPUTE_FOR_MIPMAP_GEN
+		const Unique<VulkanMipGenerator>& mipGenerator = Renderer::GetMipGenerator();
+		if (UsesComputeMipGeneration() && mipGenerator->IsReady()) {
+			mipGenerator->RTRecordGenerateMips(commandBuffer, MipGenerationInfo{
+				.Image = m_Image,
+				.Format = m_CreateInfo.Format,
+				.Width = (uint32_t)m_CreateInfo.Width,
+				.Height = (uint32_t)m_CreateInfo.Height,
+				.MipCount = m_MaxMipLevel,
+				.LayerCount = m_CreateInfo.Layers,
+				.CurrentLayout = m_CurrentLayout
+			});
+			m_CurrentLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+			return;
+		}
+#endif
+
 		//Transfering first mip of all the layers (if it has any) to "src optimal" for read during vkCmdBlit
-		TransitionImageLayoutImmediate(m_Image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, 0, 0, 1, m_CreateInfo.Layers);
+		TransitionImageLayout(commandBuffer, m_Image, m_CurrentLayout, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, 0, 0, 1, m_CreateInfo.Layers);
 
 		//Generate the mip chain
 		//Copying down the whole mip chain doing a blit from mip-1 to mip
-		Renderer::SubmitImmediateCommand([&](VkCommandBuffer commandBuffer) {
-			for (uint32_t mip = 1; mip < m_MaxMipLevel; mip++) {
-				for (uint32_t face = 0; face < m_CreateInfo.Layers; face++) {
-					VkImageSubresourceLayers srcSubresource = VulkanAPI::ImageSubresourceLayers(m_CreateInfo.ImageUsage == ImageUsage::AsDepthAttachment
-						? VK_IMAGE_ASPECT_DEPTH_BIT : VK_IMAGE_ASPECT_COLOR_BIT, mip - 1, face, 1);
-					VkImageSubresourceLayers dstSubresource = VulkanAPI::ImageSubresourceLayers(srcSubresource.aspectMask, mip, face, 1);
+		for (uint32_t mip = 1; mip < m_MaxMipLevel; mip++) {
+			for (uint32_t face = 0; face < m_CreateInfo.Layers; face++) {
+				VkImageSubresourceLayers srcSubresource = VulkanAPI::ImageSubresourceLayers(m_CreateInfo.ImageUsage == ImageUsage::AsDepthAttachment
+					? VK_IMAGE_ASPECT_DEPTH_BIT : VK_IMAGE_ASPECT_COLOR_BIT, mip - 1, face, 1);
+				VkImageSubresourceLayers dstSubresource = VulkanAPI::ImageSubresourceLayers(srcSubresource.aspectMask, mip, face, 1);
 
-					VkOffset3D srcOffsets[2] = { {}, {} };
-					srcOffsets[1].x = (m_CreateInfo.Width >> (mip - 1));
-					srcOffsets[1].y = (m_CreateInfo.Height >> (mip - 1));
-					srcOffsets[1].z = 1;
+				VkOffset3D srcOffsets[2] = { {}, {} };
+				srcOffsets[1].x = (m_CreateInfo.Width >> (mip - 1));
+				srcOffsets[1].y = (m_CreateInfo.Height >> (mip - 1));
+				srcOffsets[1].z = 1;
 
-					VkOffset3D dstOffsets[2] = { {}, {} };
-					dstOffsets[1].x = (m_CreateInfo.Width >> mip);
-					dstOffsets[1].y = (m_CreateInfo.Height >> mip);
-					dstOffsets[1].z = 1;
+				VkOffset3D dstOffsets[2] = { {}, {} };
+				dstOffsets[1].x = (m_CreateInfo.Width >> mip);
+				dstOffsets[1].y = (m_CreateInfo.Height >> mip);
+				dstOffsets[1].z = 1;
 
-					VkImageBlit blit = VulkanAPI::ImageBlit(srcSubresource, srcOffsets, dstSubresource, dstOffsets);
+				VkImageBlit blit = VulkanAPI::ImageBlit(srcSubresource, srcOffsets, dstSubresource, dstOffsets);
 
-					// Prepare current mip level as image blit destination
-					TransitionImageLayout(commandBuffer, m_Image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, mip, face, 1, 1);
+				// Prepare current mip level as image blit destination
+				TransitionImageLayout(commandBuffer, m_Image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, mip, face, 1, 1);
 
-					// Blit from previous level
-					vkCmdBlitImage(commandBuffer, m_Image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, m_Image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &blit, VK_FILTER_LINEAR);
+				// Blit from previous level
+				vkCmdBlitImage(commandBuffer, m_Image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, m_Image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &blit, VK_FILTER_LINEAR);
 
-					// Prepare current mip level as image blit source for next level
-					TransitionImageLayout(commandBuffer, m_Image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, mip, face, 1, 1);
-				}
+				// Prepare current mip level as image blit source for next level
+				TransitionImageLayout(commandBuffer, m_Image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, mip, face, 1, 1);
 			}
-			// After the loop, all mip layers are in TRANSFER_SRC layout, so transition all to SHADER_READ
-			TransitionImageLayout(commandBuffer, m_Image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, 0, 0, m_MaxMipLevel, m_CreateInfo.Layers);
-		});
+		}
+		// After the loop, all mip layers are in TRANSFER_SRC layout, so transition all to SHADER_READ
+		TransitionImageLayout(commandBuffer, m_Image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, 0, 0, m_MaxMipLevel, m_CreateInfo.Layers);
 	}
 
 	void VulkanImage::SetLayout(VkCommandBuffer commandBuffer, VkImageLayout newLayout, uint32_t baseMipLevel, uint32_t baseArrayLayer, uint32_t levelCount, uint32_t layerCount) {
@@ -259,6 +284,7 @@ namespace Lucy {
 		VkImageViewCreateInfo createInfo = VulkanAPI::ImageViewCreateInfo(m_CreateInfo.Image, GetImageType(m_CreateInfo.ImageType), m_CreateInfo.Format, subresourceRange, components);
 
 		LUCY_VK_ASSERT(vkCreateImageView(m_VulkanDevice->GetLogicalDevice(), &createInfo, nullptr, &m_ImageView));
+		m_ID = s_NextID++;
 	}
 
 	void VulkanImageView::RTCreateSampler() {
@@ -310,6 +336,9 @@ namespace Lucy {
 			case ImageUsage::AsTransientColorAttachment:
 				flags |= VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
 				break;
+			case ImageUsage::AsSampledTexture:
+				flags |= VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+				break;
 		}
 
 		if (m_CreateInfo.GenerateSampler)
@@ -318,9 +347,33 @@ namespace Lucy {
 		if (m_CreateInfo.GenerateMipmap)
 			flags |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
 
+		if (UsesComputeMipGeneration())
+			flags |= VK_IMAGE_USAGE_STORAGE_BIT;
+
 		return flags;
 	}
 
+	VkImageCreateFlags VulkanImage::GetImageCreateFlagsBasedOnUsage() {
+		VkImageCreateFlags flags = 0;
+
+		//sRGB formats have no storage support, the levels are written through a UNORM view
+		if (UsesComputeMipGeneration() && VulkanMipGenerator::GetStorageFormat(m_CreateInfo.Format) != (VkFormat)GetAPIImageFormat(m_CreateInfo.Format))
+			flags |= VK_IMAGE_CREATE_MUTABLE_FORMAT_BIT | VK_IMAGE_CREATE_EXTENDED_USAGE_BIT;
+
+		return flags;
+	}
+
+	bool VulkanImage::UsesComputeMipGeneration() {
+#if USE_COMPUTE_FOR_MIPMAP_GEN
+		const Unique<VulkanMipGenerator>& mipGenerator = Renderer::GetMipGenerator();
+		return m_CreateInfo.GenerateMipmap && m_MaxMipLevel > 1 && m_MaxMipLevel <= VulkanMipGenerator::s_MaxMipCount &&
+			m_CreateInfo.Layers <= VulkanMipGenerator::s_MaxLayerCount && m_CreateInfo.ImageUsage != ImageUsage::AsDepthAttachment &&
+			mipGenerator && mipGenerator->IsFormatSupported(m_CreateInfo.Format);
+#else
+		return false;
+#endif
+	}
+
 	uint32_t GetAPIImageFormat(ImageFormat format) {
 		if (Renderer::GetRenderArchitecture() != RenderArchitecture::Vulkan) {
 			LUCY_ASSERT(false);
@@ -361,6 +414,22 @@ namespace Lucy {
 				return VK_FORMAT_R32_SFLOAT;
 			case ImageFormat::R32_UINT:
 				return VK_FORMAT_R32_UINT;
+			case ImageFormat::BC1_RGBA_UNORM:
+				return VK_FORMAT_BC1_RGBA_UNORM_BLOCK;
+			case ImageFormat::BC1_RGBA_SRGB:
+				return VK_FORMAT_BC1_RGBA_SRGB_BLOCK;
+			case ImageFormat::BC3_UNORM:
+				return VK_FORMAT_BC3_UNORM_BLOCK;
+			case ImageFormat::BC3_SRGB:
+				return VK_FORMAT_BC3_SRGB_BLOCK;
+			case ImageFormat::BC4_UNORM:
+				return VK_FORMAT_BC4_UNORM_BLOCK;
+			case ImageFormat::BC5_UNORM:
+				return VK_FORMAT_BC5_UNORM_BLOCK;
+			case ImageFormat::BC7_UNORM:
+				return VK_FORMAT_BC7_UNORM_BLOCK;
+			case ImageFormat::BC7_SRGB:
+				return VK_FORMAT_BC7_SRGB_BLOCK;
 			default:
 				return VK_FORMAT_MAX_ENUM;
 		}
@@ -406,6 +475,22 @@ namespace Lucy {
 				return ImageFormat::R32_SFLOAT;
 			case VK_FORMAT_R32_UINT:
 				return ImageFormat::R32_UINT;
+			case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+				return ImageFormat::BC1_RGBA_UNORM;
+			case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+				return ImageFormat::BC1_RGBA_SRGB;
+			case VK_FORMAT_BC3_UNORM_BLOCK:
+				return ImageFormat::BC3_UNORM;
+			case VK_FORMAT_BC3_SRGB_BLOCK:
+				return ImageFormat::BC3_SRGB;
+			case VK_FORMAT_BC4_UNORM_BLOCK:
+				return ImageFormat::BC4_UNORM;
+			case VK_FORMAT_BC5_UNORM_BLOCK:
+				return ImageFormat::BC5_UNORM;
+			case VK_FORMAT_BC7_UNORM_BLOCK:
+				return ImageFormat::BC7_UNORM;
+			case VK_FORMAT_BC7_SRGB_BLOCK:
+				return ImageFormat::BC7_SRGB;
 			default:
 				return ImageFormat::Unknown;
 		}
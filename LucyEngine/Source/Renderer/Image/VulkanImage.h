@@ -29,6 +29,8 @@ namespace Lucy {
 
 		inline VkImageView GetVulkanHandle() const { return m_ImageView; }
 		inline VkSampler GetSampler() const { return m_Sampler; }
+		//unique for every created view, unlike the handle, which can be reused after the destruction of a view
+		inline uint64_t GetID() const { return m_ID; }
 
 		void RTRecreate(const ImageViewCreateInfo& createInfo);
 		void RTDestroyResource();	
@@ -40,8 +42,11 @@ namespace Lucy {
 
 		VkImageView m_ImageView = VK_NULL_HANDLE;
 		VkSampler m_Sampler = VK_NULL_HANDLE;
+		uint64_t m_ID = 0;
 		ImageViewCreateInfo m_CreateInfo;
 
+		static inline std::atomic<uint64_t> s_NextID = 1;
+
 		Ref<VulkanRenderDevice> m_VulkanDevice = nullptr;
 
 		friend class VulkanImage;
@@ -65,6 +70,7 @@ namespace Lucy {
 
 		void SetLayout(VkCommandBuffer commandBuffer, VkImageLayout newLayout, uint32_t baseMipLevel, uint32_t baseArrayLayer, uint32_t levelCount, uint32_t layerCount);
 		void CopyImageToImage(VkCommandBuffer commandBuffer, const Ref<VulkanImage>& destImage, const std::vector<VkImageCopy>& imageCopyRegions);
+		void CopyImageToBuffer(VkCommandBuffer commandBuffer, const VkBuffer& bufferToCopy, const std::vector<VkBufferImageCopy>& imageCopyRegions);
 
 		void SetLayoutImmediate(VkImageLayout newLayout);
 		void CopyImageToBufferImmediate(const VkBuffer& bufferToCopy, uint32_t layerCount = 1);
@@ -85,6 +91,7 @@ namespace Lucy {
 		void CopyBufferToImageImmediate(VkImage image, const VkBuffer& bufferToCopy, const std::vector<VkBufferImageCopy>& bufferCopyRegions);
 
 		void GenerateMipmapsImmediate();
+		void GenerateMipmaps(VkCommandBuffer commandBuffer);
 
 		void TransitionImageLayoutImmediate(VkImage image, VkImageLayout newLayout, uint32_t baseMipLevel = 0, uint32_t baseArrayLayer = 0, uint32_t levelCount = 1, uint32_t layerCount = 1);
 		void TransitionImageLayoutImmediate(VkImage image, VkImageLayout oldLayout, VkImageLayout newLayout, uint32_t baseMipLevel = 0, uint32_t baseArrayLayer = 0, uint32_t levelCount = 1, uint32_t layerCount = 1);
@@ -94,6 +101,9 @@ namespace Lucy {
 		void RTCreateVulkanImageViewHandle(const Ref<VulkanRenderDevice>& device, VulkanImageView& imageView, VkImage image);
 
 		VkImageUsageFlags GetImageFlagsBasedOnUsage();
+		VkImageCreateFlags GetImageCreateFlagsBasedOnUsage();
+		//whether the mip chain is generated by VulkanMipGenerator instead of the blit chain
+		bool UsesComputeMipGeneration();
 
 		VkImage m_Image = VK_NULL_HANDLE;
 		VmaAllocation m_ImageVma = VK_NULL_HANDLE;
@@ -1,9 +1,13 @@
 #include "lypch.h"
 #include "VulkanImage2D.h"
 
+#include "Core/Application.h"
+
 #include "Renderer/Renderer.h"
 #include "Renderer/Device/VulkanRenderDevice.h"
 
+#include "KTX2.h"
+
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb/stb_image.h"
 
@@ -52,57 +56,362 @@ namespace Lucy {
 	}
 
 	void VulkanImage2D::RTCreateFromPath() {
+		LUCY_PROFILE_NEW_EVENT("VulkanImage2D::RTCreateFromPath");
+		m_UploadLevels.clear();
+		m_StreamedLevelSizes.clear();
+		m_StreamSourcePath.clear();
+		m_ResidentMip = 0;
+		m_PendingResidentMip = 0;
+
+		//precompressed textures are uploaded as they are, including their mips
+		if (m_Path.extension() == ".ktx2") {
+			KTX2Info info;
+			bool hasInfo = KTX2::ReadInfo(m_Path, info);
+			LUCY_ASSERT(hasInfo, "Failed to load a KTX2 texture. Texture path: {0}", m_Path.string());
+			RTCreateFromKTX2(m_Path, info);
+			return;
+		}
+
+		//only the header is read here, the decoding happens on a worker thread
 		std::string pathInString = m_Path.string();
-		uint8_t* data = nullptr;
 		bool isHDR = stbi_is_hdr(pathInString.c_str());
+		bool hasInfo = stbi_info(pathInString.c_str(), (int32_t*)&m_CreateInfo.Width, (int32_t*)&m_CreateInfo.Height, &m_Channels);
 
-		if (isHDR)
-			data = (uint8_t*)stbi_loadf(pathInString.c_str(), (int32_t*)&m_CreateInfo.Width, (int32_t*)&m_CreateInfo.Height, &m_Channels, STBI_rgb_alpha);
-		else
-			data = stbi_load(pathInString.c_str(), (int32_t*)&m_CreateInfo.Width, (int32_t*)&m_CreateInfo.Height, &m_Channels, STBI_rgb_alpha);
+		LUCY_ASSERT(hasInfo, "Failed to load a texture. Texture path: {0}", pathInString);
+		LUCY_ASSERT(m_CreateInfo.Width > 0 && m_CreateInfo.Height > 0, "Width or height of the image is less than zero.");
+
+		if (TextureCompressor::IsBlockCompressed(m_CreateInfo.Format)) {
+			LUCY_ASSERT(!isHDR, "HDR images can't be block compressed (BC6H is not supported). Texture path: {0}", pathInString);
+			RTCreateCompressedFromPath();
+			return;
+		}
 
 		if (m_CreateInfo.GenerateMipmap)
 			m_MaxMipLevel = (uint32_t)glm::floor(glm::log2(glm::max(m_CreateInfo.Width, m_CreateInfo.Height))) + 1u;
 
-		LUCY_ASSERT(data != nullptr, "Failed to load a texture. Texture path: {0}", pathInString);
-		LUCY_ASSERT(m_CreateInfo.Width > 0 && m_CreateInfo.Height > 0, "Width or height of the image is less than zero.");
-
 		VkDeviceSize imageSize = (VkDeviceSize)m_CreateInfo.Width * m_CreateInfo.Height * 4 * GetFormatSize(m_CreateInfo.Format);
+		void* pixelData = RTCreateStagedImage(imageSize);
 
-		VkBuffer imageStagingBuffer = VK_NULL_HANDLE;
-		VmaAllocation imageStagingBufferVma = VK_NULL_HANDLE;
+		ScheduleDecode([pathInString, isHDR, imageSize, pixelData]() {
+			int32_t width = 0, height = 0, channels = 0;
+			void* data = nullptr;
+			if (isHDR)
+				data = stbi_loadf(pathInString.c_str(), &width, &height, &channels, STBI_rgb_alpha);
+			else
+				data = stbi_load(pathInString.c_str(), &width, &height, &channels, STBI_rgb_alpha);
 
-		VulkanAllocator& allocator = m_VulkanDevice->GetAllocator();
-		allocator.CreateVulkanBufferVma(VulkanBufferUsage::CPUOnly, imageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, imageStagingBuffer, imageStagingBufferVma);
+			if (!data) {
+				LUCY_CRITICAL("Failed to decode a texture. Texture path: {0}", pathInString);
+				return false;
+			}
 
-		void* pixelData = nullptr;
-		allocator.MapMemory(imageStagingBufferVma, pixelData);
-		if (isHDR)
-			memcpy(pixelData, (float*)data, imageSize);
-		else
 			memcpy(pixelData, data, imageSize);
-		allocator.UnmapMemory(imageStagingBufferVma);
+			stbi_image_free(data);
+			return true;
+		});
+	}
+
+	void VulkanImage2D::RTCreateCompressedFromPath() {
+		const ImageFormat format = m_CreateInfo.Format;
+		const uint32_t levelCount = TextureCompressor::GetLevelCount(m_CreateInfo.Width, m_CreateInfo.Height, m_CreateInfo.GenerateMipmap);
+
+		//compressed on a previous run
+		std::filesystem::path cachePath = TextureCompressor::GetCachePath(m_Path, format);
+		if (KTX2Info info; KTX2::ReadInfo(cachePath, info) && info.Format == format && info.Width == m_CreateInfo.Width &&
+			info.Height == m_CreateInfo.Height && info.Levels.size() == levelCount) {
+			RTCreateFromKTX2(cachePath, info);
+			return;
+		}
+
+		m_MaxMipLevel = levelCount;
+		std::vector<CompressedLevel> levels;
+		for (uint32_t level = 0; level < levelCount; level++) {
+			const uint32_t levelWidth = glm::max(m_CreateInfo.Width >> level, 1u);
+			const uint32_t levelHeight = glm::max(m_CreateInfo.Height >> level, 1u);
+			levels.push_back(CompressedLevel{ .Width = levelWidth, .Height = levelHeight, .Size = TextureCompressor::GetLevelSize(format, levelWidth, levelHeight) });
+		}
+		SetUploadLevels(levels);
+
+		void* pixelData = RTCreateStagedImage(TextureCompressor::GetTextureSize(format, m_CreateInfo.Width, m_CreateInfo.Height, levelCount));
+
+		//first load: decode, compress and write the cache entry, the staging buffer receives the same levels.
+		//the image is fully resident, it is streamed from the cache entry from the next run on
+		ScheduleDecode([pathInString = m_Path.string(), cachePath, format, levelCount, pixelData]() {
+			int32_t width = 0, height = 0, channels = 0;
+			uint8_t* data = stbi_load(pathInString.c_str(), &width, &height, &channels, STBI_rgb_alpha);
+			if (!data) {
+				LUCY_CRITICAL("Failed to decode a texture. Texture path: {0}", pathInString);
+				return false;
+			}
+
+			CompressedTexture texture = TextureCompressor::Compress(data, (uint32_t)width, (uint32_t)height, format, levelCount);
+			stbi_image_free(data);
+
+			memcpy(pixelData, texture.Data.data(), texture.Data.size());
+			if (KTX2::Write(cachePath, texture))
+				TextureCompressor::RemoveStaleCacheEntries(cachePath);
+			else
+				LUCY_WARN("Failed to write the compressed texture {0} into the texture cache ({1}).", pathInString, cachePath.generic_string());
+			return true;
+		});
+	}
 
-		stbi_image_free(data);
+	void VulkanImage2D::RTCreateFromKTX2(const std::filesystem::path& path, const KTX2Info& info) {
+		const uint32_t levelCount = (uint32_t)info.Levels.size();
+
+		m_CreateInfo.Format = info.Format;
+		m_CreateInfo.Width = info.Width;
+		m_CreateInfo.Height = info.Height;
+		m_CreateInfo.GenerateMipmap = levelCount > 1; //for the LOD range of the sampler, the mips are not generated again
+		m_Channels = 4;
+
+		//only the low mips are loaded, the TextureStreamer requests the finer ones
+		if (m_CreateInfo.StreamMips && levelCount > 1) {
+			m_StreamSourcePath = path;
+			m_StreamInfo = info;
+			for (const CompressedLevel& level : info.Levels)
+				m_StreamedLevelSizes.push_back(level.Size);
+
+			while (m_ResidentMip + 1 < levelCount && glm::max(info.Levels[m_ResidentMip].Width, info.Levels[m_ResidentMip].Height) > s_StreamingBaseSize)
+				m_ResidentMip++;
+			m_PendingResidentMip = m_ResidentMip;
+		}
+		m_MaxMipLevel = levelCount - m_ResidentMip;
+
+		KTX2Info stagedInfo = info;
+		stagedInfo.Levels.erase(stagedInfo.Levels.begin(), stagedInfo.Levels.begin() + m_ResidentMip);
+		SetUploadLevels(stagedInfo.Levels);
+
+		void* pixelData = RTCreateStagedImage(stagedInfo.GetDataSize());
+
+		ScheduleDecode([path, stagedInfo, pixelData]() {
+			if (!KTX2::ReadLevels(path, stagedInfo, (uint8_t*)pixelData)) {
+				LUCY_CRITICAL("Failed to read a KTX2 texture. Texture path: {0}", path.string());
+				return false;
+			}
+			return true;
+		});
+	}
+
+	void VulkanImage2D::SetUploadLevels(const std::vector<CompressedLevel>& levels) {
+		m_UploadLevels.clear();
+		size_t offset = 0;
+		for (const CompressedLevel& level : levels) {
+			m_UploadLevels.push_back(CompressedLevel{ .Width = level.Width, .Height = level.Height, .Offset = offset, .Size = level.Size });
+			offset += level.Size;
+		}
+	}
+
+	void* VulkanImage2D::RTCreateStagingBuffer(VkDeviceSize stagingSize) {
+		//the buffer offset of a copy into an image has to be a multiple of the texel (or block) size and of 4
+		const ImageFormat format = m_CreateInfo.Format;
+		const VkDeviceSize texelSize = TextureCompressor::IsBlockCompressed(format) ? TextureCompressor::GetBlockSize(format) : 4 * GetFormatSize(format);
+
+		m_Staging = m_VulkanDevice->GetStagingRing().Allocate(stagingSize, std::lcm(VulkanStagingRing::s_DefaultAlignment, texelSize));
+		return m_Staging.MappedData;
+	}
+
+	void* VulkanImage2D::RTCreateStagedImage(VkDeviceSize stagingSize) {
+		void* pixelData = RTCreateStagingBuffer(stagingSize);
 
 		VkImageUsageFlags flags = GetImageFlagsBasedOnUsage();
 
-		allocator.CreateVulkanImageVma(m_CreateInfo.Width, m_CreateInfo.Height, m_MaxMipLevel, (VkFormat)GetAPIImageFormat(m_CreateInfo.Format), m_CurrentLayout,
-									   flags, VK_IMAGE_TYPE_2D, m_Image, m_ImageVma);
+		//level 0 of the image is the resident mip
+		VulkanAllocator& allocator = m_VulkanDevice->GetAllocator();
+		allocator.CreateVulkanImageVma(glm::max(m_CreateInfo.Width >> m_ResidentMip, 1u), glm::max(m_CreateInfo.Height >> m_ResidentMip, 1u), m_MaxMipLevel,
+									   (VkFormat)GetAPIImageFormat(m_CreateInfo.Format), m_CurrentLayout, flags, VK_IMAGE_TYPE_2D, m_Image, m_ImageVma, GetImageCreateFlagsBasedOnUsage());
 
-		TransitionImageLayoutImmediate(m_Image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-		CopyBufferToImageImmediate(imageStagingBuffer);
+		m_IsReady = false;
+		AddPendingUpload(DecodeState::Decoding);
+		return pixelData;
+	}
 
-		if (m_CreateInfo.GenerateMipmap)
-			GenerateMipmapsImmediate();
-		else //transitioning only then, when we dont care about mipmapping. Mipmapping already transitions to the right layout
-			SetLayoutImmediate(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+	void VulkanImage2D::AddPendingUpload(DecodeState state) {
+		m_DecodeState = state;
+		std::scoped_lock lock(s_PendingUploadsMutex);
+		s_PendingUploads.push_back(this);
+	}
+
+	bool VulkanImage2D::IsResidencyChangePending() const {
+		return !m_IsReady || m_PendingResidentMip != m_ResidentMip;
+	}
+
+	void VulkanImage2D::RTRequestResidentMip(uint32_t mip) {
+		LUCY_PROFILE_NEW_EVENT("VulkanImage2D::RTRequestResidentMip");
+		LUCY_ASSERT(IsStreamed() && !IsResidencyChangePending(), "Image is not streamed or is still changing its resident levels.");
 
-		allocator.DestroyBuffer(imageStagingBuffer, imageStagingBufferVma);
+		mip = glm::min(mip, (uint32_t)m_StreamInfo.Levels.size() - 1);
+		if (mip == m_ResidentMip)
+			return;
+		m_PendingResidentMip = mip;
+
+		//dropping levels doesn't load anything, the kept levels are copied into a smaller image
+		if (mip > m_ResidentMip) {
+			m_UploadLevels.clear();
+			AddPendingUpload(DecodeState::Decoded);
+			return;
+		}
+
+		KTX2Info stagedInfo = m_StreamInfo;
+		stagedInfo.Levels.assign(m_StreamInfo.Levels.begin() + mip, m_StreamInfo.Levels.begin() + m_ResidentMip);
+		SetUploadLevels(stagedInfo.Levels);
+
+		void* pixelData = RTCreateStagingBuffer(stagedInfo.GetDataSize());
+		AddPendingUpload(DecodeState::Decoding);
+
+		ScheduleDecode([path = m_StreamSourcePath, stagedInfo, pixelData]() {
+			if (!KTX2::ReadLevels(path, stagedInfo, (uint8_t*)pixelData)) {
+				LUCY_CRITICAL("Failed to stream the levels of a KTX2 texture. Texture path: {0}", path.string());
+				return false;
+			}
+			return true;
+		});
+	}
+
+	void VulkanImage2D::ScheduleDecode(std::function<bool()>&& decodeFunc) {
+		Application::GetTaskScheduler()->Schedule(TaskScheduler::Launch::Async, TaskPriority::Medium, [this, decodeFunc = std::move(decodeFunc)]([[maybe_unused]] const TaskArgs& args) {
+			LUCY_PROFILE_NEW_EVENT("VulkanImage2D::Decode");
+			m_DecodeState.store(decodeFunc() ? DecodeState::Decoded : DecodeState::Failed, std::memory_order_release);
+		});
+	}
+
+	bool VulkanImage2D::HasPendingUploads() {
+		std::scoped_lock lock(s_PendingUploadsMutex);
+		return !s_PendingUploads.empty();
+	}
+
+	void VulkanImage2D::RTRecordPendingUploads(VkCommandBuffer commandBuffer) {
+		LUCY_PROFILE_NEW_EVENT("VulkanImage2D::RTRecordPendingUploads");
+
+		std::scoped_lock lock(s_PendingUploadsMutex);
+		std::erase_if(s_PendingUploads, [commandBuffer](VulkanImage2D* image) {
+			switch (image->m_DecodeState.load(std::memory_order_acquire)) {
+				case DecodeState::Decoding:
+					return false;
+				case DecodeState::Decoded:
+					image->RTRecordUpload(commandBuffer);
+					return true;
+				case DecodeState::Failed:
+				default:
+					image->RTAbortUpload();
+					return true;
+			}
+		});
+	}
+
+	void VulkanImage2D::RTRecordUpload(VkCommandBuffer commandBuffer) {
+		//a streamed image, that already has its low mips
+		if (m_IsReady) {
+			RTRecordResidencyChange(commandBuffer);
+			return;
+		}
+
+		TransitionImageLayout(commandBuffer, m_Image, m_CurrentLayout, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 0, 0, m_MaxMipLevel, 1);
+
+		if (!m_UploadLevels.empty()) {
+			//block compressed, every level has been precomputed
+			std::vector<VkBufferImageCopy> regions;
+			regions.reserve(m_UploadLevels.size());
+			for (uint32_t level = 0; level < (uint32_t)m_UploadLevels.size(); level++) {
+				VkImageSubresourceLayers imageSubresource = VulkanAPI::ImageSubresourceLayers(VK_IMAGE_ASPECT_COLOR_BIT, level, 0, 1);
+				regions.push_back(VulkanAPI::BufferImageCopy(m_Staging.Offset + m_UploadLevels[level].Offset, 0, 0, imageSubresource, { 0, 0, 0 }, { m_UploadLevels[level].Width, m_UploadLevels[level].Height, 1 }));
+			}
+			vkCmdCopyBufferToImage(commandBuffer, m_Staging.Buffer, m_Image, m_CurrentLayout, (uint32_t)regions.size(), regions.data());
+			TransitionImageLayout(commandBuffer, m_Image, m_CurrentLayout, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, 0, 0, m_MaxMipLevel, 1);
+		} else {
+			VkImageSubresourceLayers imageSubresource = VulkanAPI::ImageSubresourceLayers(VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1);
+			VkBufferImageCopy region = VulkanAPI::BufferImageCopy(m_Staging.Offset, 0, 0, imageSubresource, { 0, 0, 0 }, { (uint32_t)m_CreateInfo.Width, (uint32_t)m_CreateInfo.Height, 1 });
+			vkCmdCopyBufferToImage(commandBuffer, m_Staging.Buffer, m_Image, m_CurrentLayout, 1, &region);
+
+			if (m_CreateInfo.GenerateMipmap)
+				GenerateMipmaps(commandBuffer);
+			else //transitioning only then, when we dont care about mipmapping. Mipmapping already transitions to the right layout
+				TransitionImageLayout(commandBuffer, m_Image, m_CurrentLayout, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+		}
+
+		RTReleaseStagingBuffer();
+
+		RTCreateVulkanImageViewHandle(m_VulkanDevice);
+		m_IsReady = true;
+	}
+
+	void VulkanImage2D::RTRecordResidencyChange(VkCommandBuffer commandBuffer) {
+		LUCY_PROFILE_NEW_EVENT("VulkanImage2D::RTRecordResidencyChange");
+
+		const uint32_t targetMip = m_PendingResidentMip;
+		const uint32_t chainLevelCount = (uint32_t)m_StreamInfo.Levels.size();
+		const uint32_t levelCount = chainLevelCount - targetMip;
+
+		VulkanAllocator& allocator = m_VulkanDevice->GetAllocator();
+		VkImage image = VK_NULL_HANDLE;
+		VmaAllocation imageVma = VK_NULL_HANDLE;
+		allocator.CreateVulkanImageVma(m_StreamInfo.Levels[targetMip].Width, m_StreamInfo.Levels[targetMip].Height, levelCount, (VkFormat)GetAPIImageFormat(m_CreateInfo.Format),
+									   VK_IMAGE_LAYOUT_UNDEFINED, GetImageFlagsBasedOnUsage(), VK_IMAGE_TYPE_2D, image, imageVma);
+
+		TransitionImageLayout(commandBuffer, image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 0, 0, levelCount, 1);
+		TransitionImageLayout(commandBuffer, m_Image, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, 0, 0, m_MaxMipLevel, 1);
+
+		//the levels, that stay resident, are copied from the old image
+		std::vector<VkImageCopy> imageCopies;
+		for (uint32_t mip = glm::max(targetMip, m_ResidentMip); mip < chainLevelCount; mip++) {
+			imageCopies.push_back(VkImageCopy{
+				.srcSubresource = VulkanAPI::ImageSubresourceLayers(VK_IMAGE_ASPECT_COLOR_BIT, mip - m_ResidentMip, 0, 1),
+				.srcOffset = { 0, 0, 0 },
+				.dstSubresource = VulkanAPI::ImageSubresourceLayers(VK_IMAGE_ASPECT_COLOR_BIT, mip - targetMip, 0, 1),
+				.dstOffset = { 0, 0, 0 },
+				.extent = { m_StreamInfo.Levels[mip].Width, m_StreamInfo.Levels[mip].Height, 1 }
+			});
+		}
+		vkCmdCopyImage(commandBuffer, m_Image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, (uint32_t)imageCopies.size(), imageCopies.data());
+
+		//the streamed in levels are the first ones of the new image
+		if (targetMip < m_ResidentMip) {
+			std::vector<VkBufferImageCopy> regions;
+			for (uint32_t level = 0; level < (uint32_t)m_UploadLevels.size(); level++) {
+				VkImageSubresourceLayers imageSubresource = VulkanAPI::ImageSubresourceLayers(VK_IMAGE_ASPECT_COLOR_BIT, level, 0, 1);
+				regions.push_back(VulkanAPI::BufferImageCopy(m_Staging.Offset + m_UploadLevels[level].Offset, 0, 0, imageSubresource, { 0, 0, 0 }, { m_UploadLevels[level].Width, m_UploadLevels[level].Height, 1 }));
+			}
+			vkCmdCopyBufferToImage(commandBuffer, m_Staging.Buffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, (uint32_t)regions.size(), regions.data());
+			RTReleaseStagingBuffer();
+		}
+
+		//the descriptors of this frame still point to the old image
+		TransitionImageLayout(commandBuffer, m_Image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, 0, 0, m_MaxMipLevel, 1);
+		TransitionImageLayout(commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, 0, 0, levelCount, 1);
+
+		Renderer::EnqueueDeletion([&allocator, oldImage = m_Image, oldImageVma = m_ImageVma, oldImageView = m_ImageView]() mutable {
+			oldImageView.RTDestroyResource();
+			allocator.DestroyImage(oldImage, oldImageVma);
+		});
+
+		m_Image = image;
+		m_ImageVma = imageVma;
+		m_MaxMipLevel = levelCount;
+		m_ResidentMip = targetMip;
+		m_UploadLevels.clear();
 
 		RTCreateVulkanImageViewHandle(m_VulkanDevice);
 	}
 
+	void VulkanImage2D::RTReleaseStagingBuffer() {
+		//the staging memory is in use, until the frame has been completed
+		m_VulkanDevice->GetStagingRing().RTRetire(m_Staging);
+		m_Staging = {};
+	}
+
+	void VulkanImage2D::RTAbortUpload() {
+		//nothing has been recorded, the staging memory is not in use
+		m_VulkanDevice->GetStagingRing().Free(m_Staging);
+		m_Staging = {};
+		m_PendingResidentMip = m_ResidentMip;
+		m_UploadLevels.clear();
+	}
+
+	void VulkanImage2D::WaitForDecode() const {
+		while (m_DecodeState.load(std::memory_order_acquire) == DecodeState::Decoding)
+			std::this_thread::yield();
+	}
+
 	void VulkanImage2D::RTCreateEmptyImage() {
 		LUCY_ASSERT(m_CreateInfo.Width > 0 && m_CreateInfo.Height > 0, "Width or height of the image is less than zero.");
 
@@ -113,7 +422,7 @@ namespace Lucy {
 
 		VulkanAllocator& allocator = m_VulkanDevice->GetAllocator();
 		allocator.CreateVulkanImageVma(m_CreateInfo.Width, m_CreateInfo.Height, m_MaxMipLevel, (VkFormat)GetAPIImageFormat(m_CreateInfo.Format), m_CurrentLayout,
-									   flags, VK_IMAGE_TYPE_2D, m_Image, m_ImageVma, 0, m_CreateInfo.Layers);
+									   flags, VK_IMAGE_TYPE_2D, m_Image, m_ImageVma, GetImageCreateFlagsBasedOnUsage(), m_CreateInfo.Layers);
 
 		if (m_CreateInfo.GenerateMipmap)
 			GenerateMipmapsImmediate();
@@ -147,12 +456,23 @@ namespace Lucy {
 		if (!m_Image)
 			return;
 
+		//the decoder task might still write into the staging buffer
+		WaitForDecode();
+		{
+			std::scoped_lock lock(s_PendingUploadsMutex);
+			std::erase(s_PendingUploads, this);
+		}
+
+		m_VulkanDevice->GetStagingRing().Free(m_Staging);
+		m_Staging = {};
+
+		VulkanAllocator& allocator = m_VulkanDevice->GetAllocator();
+
 		//if (m_CreateInfo.ImGuiUsage)
 			//ImGui_ImplVulkan_RemoveTexture((VkDescriptorSet)m_ImGuiID);
 
 		m_ImageView.RTDestroyResource();
 
-		VulkanAllocator& allocator = m_VulkanDevice->GetAllocator();
 		allocator.DestroyImage(m_Image, m_ImageVma);
 		m_Image = VK_NULL_HANDLE;
 	}
@@ -1,6 +1,9 @@
 #pragma once
 
 #include "VulkanImage.h"
+#include "KTX2.h"
+
+#include "Renderer/Memory/VulkanStagingRing.h"
 
 namespace Lucy {
 
@@ -14,14 +17,61 @@ namespace Lucy {
 		virtual ~VulkanImage2D() = default;
 
 		void RTRecreate(uint32_t width, uint32_t height) final override;
+
+		bool IsResidencyChangePending() const final override;
+		//the levels are loaded on a worker thread and copied into a reallocated image, together with the levels that stay resident
+		void RTRequestResidentMip(uint32_t mip) final override;
+
+		static bool HasPendingUploads();
+		//records the copies and barriers of the images, whose decoding has been finished. Images that are still being decoded are left for a later frame
+		static void RTRecordPendingUploads(VkCommandBuffer commandBuffer);
 	private:
+		enum class DecodeState : uint8_t {
+			Decoding,
+			Decoded,
+			Failed
+		};
+
 		void RTCreateFromPath();
+		//block compressed formats, compressed once and then loaded from the texture cache folder
+		void RTCreateCompressedFromPath();
+		void RTCreateFromKTX2(const std::filesystem::path& path, const KTX2Info& info);
+		//creates the image and the mapped staging buffer, the image is pending until its upload has been recorded
+		void* RTCreateStagedImage(VkDeviceSize stagingSize);
+		void* RTCreateStagingBuffer(VkDeviceSize stagingSize);
+		//the levels are packed into the staging buffer in the given order
+		void SetUploadLevels(const std::vector<CompressedLevel>& levels);
+		void AddPendingUpload(DecodeState state);
+		void ScheduleDecode(std::function<bool()>&& decodeFunc);
 		void RTCreateEmptyImage();
 		void RTCreateDepthImage();
 
+		void RTRecordUpload(VkCommandBuffer commandBuffer);
+		void RTRecordResidencyChange(VkCommandBuffer commandBuffer);
+		void RTReleaseStagingBuffer();
+		//the decoding has failed, the image keeps its resident levels
+		void RTAbortUpload();
+		void WaitForDecode() const;
+
 		void RTDestroyResource() final override;
 
 		Ref<VulkanRenderDevice> m_VulkanDevice = nullptr;
+
+		//the decoder task writes the pixels straight into the mapped staging memory (a range of the staging ring, if it fits)
+		StagingAllocation m_Staging;
+		std::atomic<DecodeState> m_DecodeState = DecodeState::Decoded;
+		//the precomputed levels in the staging buffer (block compressed only), otherwise the mips are generated after the upload
+		std::vector<CompressedLevel> m_UploadLevels;
+
+		//the file, that the streamed levels are read from (KTX2 only), and its full mip chain
+		std::filesystem::path m_StreamSourcePath;
+		KTX2Info m_StreamInfo;
+		uint32_t m_PendingResidentMip = 0;
+		//levels up to this size are loaded with the image and never evicted
+		static constexpr uint32_t s_StreamingBaseSize = 256;
+
+		static inline std::vector<VulkanImage2D*> s_PendingUploads;
+		static inline std::mutex s_PendingUploadsMutex;
 	};
 }
 
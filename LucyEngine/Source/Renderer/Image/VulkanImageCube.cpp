@@ -31,7 +31,7 @@ namespace Lucy {
 
 		VulkanAllocator& allocator = m_VulkanDevice->GetAllocator();
 		allocator.CreateVulkanImageVma(m_CreateInfo.Width, m_CreateInfo.Height, m_MaxMipLevel, (VkFormat)GetAPIImageFormat(m_CreateInfo.Format), m_CurrentLayout,
-									   flags, VK_IMAGE_TYPE_2D, m_Image, m_ImageVma, VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT, m_CreateInfo.Layers);
+									   flags, VK_IMAGE_TYPE_2D, m_Image, m_ImageVma, VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT | GetImageCreateFlagsBasedOnUsage(), m_CreateInfo.Layers);
 		if (m_CreateInfo.GenerateMipmap)
 			GenerateMipmapsImmediate();
 		else //transitioning only then, when we dont care about mipmapping. Mipmapping already transitions to the right layout
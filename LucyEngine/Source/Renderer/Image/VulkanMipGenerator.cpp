@@ -0,0 +1,215 @@
+#include "lypch.h"
+#include "VulkanMipGenerator.h"
+
+#include "Renderer/Renderer.h"
+#include "Renderer/Device/VulkanRenderDevice.h"
+#include "Renderer/Descriptors/VulkanDescriptorSet.h"
+#include "Renderer/Pipeline/VulkanComputePipeline.h"
+#include "TextureCompressor.h"
+
+namespace Lucy {
+
+	static constexpr const char* s_MipGenPipelineName = "MipGenComputePipeline";
+
+	struct MipGenPushConstants {
+		glm::uvec2 Size = glm::uvec2(0);
+		uint32_t MipCount = 0;
+		uint32_t WorkGroupCount = 0;
+		uint32_t LayerStride = 0;
+		uint32_t IsSRGB = 0;
+	};
+
+	VulkanMipGenerator::VulkanMipGenerator(const Ref<RenderDevice>& device)
+		: m_VulkanDevice(device->As<VulkanRenderDevice>()) {
+	}
+
+	VkFormat VulkanMipGenerator::GetStorageFormat(ImageFormat format) {
+		switch (format) {
+			case ImageFormat::R8G8B8A8_SRGB:
+				return VK_FORMAT_R8G8B8A8_UNORM;
+			case ImageFormat::B8G8R8A8_SRGB:
+				return VK_FORMAT_B8G8R8A8_UNORM;
+			default:
+				return (VkFormat)GetAPIImageFormat(format);
+		}
+	}
+
+	uint32_t VulkanMipGenerator::GetIntermediateLayerStride(uint32_t width, uint32_t height, uint32_t mipCount) {
+		uint32_t stride = 0;
+		for (uint32_t level = s_TileMipCount; level < mipCount; level++)
+			stride += glm::max(width >> level, 1u) * glm::max(height >> level, 1u);
+		return stride;
+	}
+
+	bool VulkanMipGenerator::IsFormatSupported(ImageFormat format) const {
+		switch (format) {
+			//integer formats can't be filtered, depth can't be written as a storage image
+			case ImageFormat::Unknown:
+			case ImageFormat::R8G8B8A8_UINT:
+			case ImageFormat::B8G8R8A8_UINT:
+			case ImageFormat::R16G16B16A16_UINT:
+			case ImageFormat::R32G32B32A32_UINT:
+			case ImageFormat::R32_UINT:
+			case ImageFormat::D32_SFLOAT:
+				return false;
+			default:
+				if (TextureCompressor::IsBlockCompressed(format))
+					return false;
+				break;
+		}
+
+		VkFormatProperties storageProperties;
+		vkGetPhysicalDeviceFormatProperties(m_VulkanDevice->GetPhysicalDevice(), GetStorageFormat(format), &storageProperties);
+		VkFormatProperties sampledProperties;
+		vkGetPhysicalDeviceFormatProperties(m_VulkanDevice->GetPhysicalDevice(), (VkFormat)GetAPIImageFormat(format), &sampledProperties);
+
+		return (storageProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT) &&
+			(sampledProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT);
+	}
+
+	bool VulkanMipGenerator::IsReady() const {
+		const Unique<PipelineManager>& pipelineManager = Renderer::GetPipelineManager();
+		if (!pipelineManager || !pipelineManager->HasPipeline(s_MipGenPipelineName))
+			return false;
+		return pipelineManager->GetAs<ComputePipeline>(s_MipGenPipelineName)->As<VulkanComputePipeline>()->GetVulkanHandle() != VK_NULL_HANDLE;
+	}
+
+	void VulkanMipGenerator::RTRecordGenerateMips(VkCommandBuffer commandBuffer, const MipGenerationInfo& info) {
+		LUCY_PROFILE_NEW_EVENT("VulkanMipGenerator::RTRecordGenerateMips");
+		LUCY_ASSERT(info.MipCount > 1 && info.MipCount <= s_MaxMipCount, "Mip count {0} is not supported by the compute mip generation.", info.MipCount);
+		LUCY_ASSERT(info.LayerCount <= s_MaxLayerCount, "Layer count {0} is not supported by the compute mip generation.", info.LayerCount);
+
+		VkDevice device = m_VulkanDevice->GetLogicalDevice();
+		VulkanAllocator& allocator = m_VulkanDevice->GetAllocator();
+
+		if (!m_Sampler) {
+			VkSamplerCreateInfo samplerCreateInfo = VulkanAPI::SamplerCreateInfo(VK_FILTER_NEAREST, VK_FILTER_NEAREST, VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE, VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+																				 VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE, VK_FALSE, 1.0f, VK_BORDER_COLOR_INT_OPAQUE_BLACK, VK_FALSE, VK_FALSE,
+																				 VK_COMPARE_OP_ALWAYS, VK_SAMPLER_MIPMAP_MODE_NEAREST, 0.0f, 0.0f, 0.0f);
+			LUCY_VK_ASSERT(vkCreateSampler(device, &samplerCreateInfo, nullptr, &m_Sampler));
+			allocator.CreateVulkanBufferVma(VulkanBufferUsage::GPUOnly, s_MaxLayerCount * sizeof(uint32_t), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+											m_CounterBuffer, m_CounterBufferVma);
+		}
+
+		const uint32_t layerStride = GetIntermediateLayerStride(info.Width, info.Height, info.MipCount);
+		RTEnsureIntermediateSize(glm::max((VkDeviceSize)layerStride * info.LayerCount, (VkDeviceSize)1) * sizeof(glm::vec4));
+
+		const auto& pipeline = Renderer::GetPipelineManager()->GetAs<ComputePipeline>(s_MipGenPipelineName)->As<VulkanComputePipeline>();
+		const auto& descriptorSetHandles = pipeline->GetShader()->GetDescriptorSetHandles();
+		VkDescriptorSetLayout descriptorSetLayout = m_VulkanDevice->AccessResource<VulkanDescriptorSet>(descriptorSetHandles[0])->GetDescriptorSetLayout();
+
+		//level 0 is sampled in its own format (sRGB is decoded), the other levels are written through the storage format
+		std::vector<VkImageView> imageViews;
+		const auto CreateView = [&](VkFormat format, uint32_t level) {
+			VkImageSubresourceRange subresourceRange = VulkanAPI::ImageSubresourceRange(VK_IMAGE_ASPECT_COLOR_BIT, level, 0, 1, info.LayerCount);
+			VkComponentMapping components = { VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY };
+			VkImageViewCreateInfo createInfo = VulkanAPI::ImageViewCreateInfo(info.Image, VK_IMAGE_VIEW_TYPE_2D_ARRAY, format, subresourceRange, components);
+
+			VkImageView imageView = VK_NULL_HANDLE;
+			LUCY_VK_ASSERT(vkCreateImageView(device, &createInfo, nullptr, &imageView));
+			imageViews.push_back(imageView);
+			return imageView;
+		};
+
+		VkDescriptorImageInfo sourceInfo = VulkanAPI::DescriptorImageInfo(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, CreateView((VkFormat)GetAPIImageFormat(info.Format), 0), m_Sampler);
+
+		//every element of the array is statically used, the ones past the mip chain repeat the last level
+		std::array<VkDescriptorImageInfo, s_MaxMipCount - 1> mipInfos;
+		const VkFormat storageFormat = GetStorageFormat(info.Format);
+		for (uint32_t level = 1; level < s_MaxMipCount; level++) {
+			if (level < info.MipCount)
+				mipInfos[level - 1] = VulkanAPI::DescriptorImageInfo(VK_IMAGE_LAYOUT_GENERAL, CreateView(storageFormat, level), VK_NULL_HANDLE);
+			else
+				mipInfos[level - 1] = mipInfos[info.MipCount - 2];
+		}
+
+		VkDescriptorBufferInfo intermediateInfo = VulkanAPI::DescriptorBufferInfo(m_IntermediateBuffer, 0, VK_WHOLE_SIZE);
+		VkDescriptorBufferInfo counterInfo = VulkanAPI::DescriptorBufferInfo(m_CounterBuffer, 0, VK_WHOLE_SIZE);
+
+		std::array<VkWriteDescriptorSet, 4> writes = {
+			VulkanAPI::WriteDescriptorSet(VK_NULL_HANDLE, 0, 0, 1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, nullptr, &sourceInfo),
+			VulkanAPI::WriteDescriptorSet(VK_NULL_HANDLE, 0, 1, (uint32_t)mipInfos.size(), VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, nullptr, mipInfos.data()),
+			VulkanAPI::WriteDescriptorSet(VK_NULL_HANDLE, 0, 2, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, &intermediateInfo),
+			VulkanAPI::WriteDescriptorSet(VK_NULL_HANDLE, 0, 3, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, &counterInfo),
+		};
+		//the set is reclaimed with the frame pools, once the frame has been completed
+		VkDescriptorSet descriptorSet = m_VulkanDevice->GetDescriptorAllocator().RTAllocateFrameSet(Renderer::GetCurrentFrameIndex(), descriptorSetLayout, writes);
+
+		vkCmdFillBuffer(commandBuffer, m_CounterBuffer, 0, VK_WHOLE_SIZE, 0);
+
+		//level 0 has been written by a transfer (or rendered into), the other levels are overwritten
+		std::array<VkImageMemoryBarrier, 2> imageBarriers = {
+			VulkanAPI::ImageMemoryBarrier(info.Image, info.CurrentLayout, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+										  VulkanAPI::ImageSubresourceRange(VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1, info.LayerCount),
+										  info.CurrentLayout == VK_IMAGE_LAYOUT_UNDEFINED ? VK_ACCESS_NONE_KHR : VK_ACCESS_MEMORY_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT),
+			VulkanAPI::ImageMemoryBarrier(info.Image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL,
+										  VulkanAPI::ImageSubresourceRange(VK_IMAGE_ASPECT_COLOR_BIT, 1, 0, info.MipCount - 1, info.LayerCount),
+										  VK_ACCESS_NONE_KHR, VK_ACCESS_SHADER_WRITE_BIT),
+		};
+		VkMemoryBarrier counterBarrier{ .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER, .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT, .dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT };
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &counterBarrier, 0, nullptr,
+							 (uint32_t)imageBarriers.size(), imageBarriers.data());
+
+		const uint32_t workGroupCountX = (info.Width + s_TileSize - 1) / s_TileSize;
+		const uint32_t workGroupCountY = (info.Height + s_TileSize - 1) / s_TileSize;
+
+		MipGenPushConstants pushConstants{
+			.Size = glm::uvec2(info.Width, info.Height),
+			.MipCount = info.MipCount,
+			.WorkGroupCount = workGroupCountX * workGroupCountY,
+			.LayerStride = layerStride,
+			.IsSRGB = TextureCompressor::IsSRGB(info.Format) ? 1u : 0u
+		};
+
+		pipeline->RTBind(commandBuffer);
+		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline->GetPipelineLayout(), 0, 1, &descriptorSet, 0, nullptr);
+		vkCmdPushConstants(commandBuffer, pipeline->GetPipelineLayout(), VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(MipGenPushConstants), &pushConstants);
+		pipeline->RTDispatch(commandBuffer, workGroupCountX, workGroupCountY, info.LayerCount);
+
+		//the intermediate and the counter buffer are reused by the next dispatch
+		VkImageMemoryBarrier mipBarrier = VulkanAPI::ImageMemoryBarrier(info.Image, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+																		VulkanAPI::ImageSubresourceRange(VK_IMAGE_ASPECT_COLOR_BIT, 1, 0, info.MipCount - 1, info.LayerCount),
+																		VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_TRANSFER_READ_BIT);
+		VkMemoryBarrier bufferBarrier{ .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER, .srcAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+									   .dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT };
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+							 VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &bufferBarrier, 0, nullptr, 1, &mipBarrier);
+
+		Renderer::EnqueueDeletion([device, imageViews]() {
+			for (VkImageView imageView : imageViews)
+				vkDestroyImageView(device, imageView, nullptr);
+		});
+	}
+
+	void VulkanMipGenerator::RTEnsureIntermediateSize(VkDeviceSize size) {
+		if (size <= m_IntermediateSize)
+			return;
+
+		VulkanAllocator& allocator = m_VulkanDevice->GetAllocator();
+		if (m_IntermediateBuffer) {
+			Renderer::EnqueueDeletion([&allocator, buffer = m_IntermediateBuffer, bufferVma = m_IntermediateBufferVma]() {
+				allocator.DestroyBuffer(buffer, bufferVma);
+			});
+		}
+
+		allocator.CreateVulkanBufferVma(VulkanBufferUsage::GPUOnly, size, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, m_IntermediateBuffer, m_IntermediateBufferVma);
+		m_IntermediateSize = size;
+	}
+
+	void VulkanMipGenerator::RTDestroyResource() {
+		VkDevice device = m_VulkanDevice->GetLogicalDevice();
+		VulkanAllocator& allocator = m_VulkanDevice->GetAllocator();
+
+		if (m_Sampler) {
+			vkDestroySampler(device, m_Sampler, nullptr);
+			allocator.DestroyBuffer(m_CounterBuffer, m_CounterBufferVma);
+			m_Sampler = VK_NULL_HANDLE;
+		}
+
+		if (m_IntermediateBuffer) {
+			allocator.DestroyBuffer(m_IntermediateBuffer, m_IntermediateBufferVma);
+			m_IntermediateBuffer = VK_NULL_HANDLE;
+			m_IntermediateSize = 0;
+		}
+	}
+}
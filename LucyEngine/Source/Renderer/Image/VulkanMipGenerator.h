@@ -0,0 +1,60 @@
+#pragma once
+
+#include "VulkanImage.h"
+
+namespace Lucy {
+
+	class RenderDevice;
+	class VulkanRenderDevice;
+
+	struct MipGenerationInfo {
+		VkImage Image = VK_NULL_HANDLE;
+		ImageFormat Format = ImageFormat::Unknown;
+		uint32_t Width = 0, Height = 0;
+		uint32_t MipCount = 1;
+		uint32_t LayerCount = 1;
+		VkImageLayout CurrentLayout = VK_IMAGE_LAYOUT_UNDEFINED; //of level 0, the other levels are discarded
+	};
+
+	/*
+	* Generates the mip chain of a color image (2D or cube) with a single compute dispatch (LucyMipGen.comp),
+	* instead of a blit and two barriers per level and layer.
+	* The levels are written as storage images, sRGB images through a UNORM view (they are created with a mutable format), the filtering happens in linear space.
+	* Formats without storage support and depth images keep using the blit path (see VulkanImage::GenerateMipmaps).
+	*/
+	class VulkanMipGenerator final {
+	public:
+		VulkanMipGenerator(const Ref<RenderDevice>& device);
+		~VulkanMipGenerator() = default;
+
+		bool IsFormatSupported(ImageFormat format) const;
+		//the pipeline is created with the other pipelines, images that are created before use the blit path
+		bool IsReady() const;
+
+		//every level ends up in VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+		void RTRecordGenerateMips(VkCommandBuffer commandBuffer, const MipGenerationInfo& info);
+		void RTDestroyResource();
+
+		//the format of the views, that the levels are written through
+		static VkFormat GetStorageFormat(ImageFormat format);
+		static uint32_t GetIntermediateLayerStride(uint32_t width, uint32_t height, uint32_t mipCount);
+
+		static constexpr uint32_t s_MaxMipCount = 14; //including level 0, keep in sync with LucyMipGen.comp
+		static constexpr uint32_t s_MaxLayerCount = 6;
+		static constexpr uint32_t s_TileSize = 64; //of level 0, per workgroup
+		static constexpr uint32_t s_TileMipCount = 6;
+	private:
+		void RTEnsureIntermediateSize(VkDeviceSize size);
+
+		VkSampler m_Sampler = VK_NULL_HANDLE;
+
+		//the levels from s_TileMipCount on, that the last workgroup reduces. Shared by every dispatch, they are serialized by a barrier
+		VkBuffer m_IntermediateBuffer = VK_NULL_HANDLE;
+		VmaAllocation m_IntermediateBufferVma = VK_NULL_HANDLE;
+		VkDeviceSize m_IntermediateSize = 0;
+		VkBuffer m_CounterBuffer = VK_NULL_HANDLE;
+		VmaAllocation m_CounterBufferVma = VK_NULL_HANDLE;
+
+		Ref<VulkanRenderDevice> m_VulkanDevice = nullptr;
+	};
+}
@@ -8,7 +8,8 @@ namespace Lucy {
 
 	class RenderDevice;
 
-	using MaterialID = float;
+	//the index of the material in the material buffer (LucyMaterialAttributes)
+	using MaterialID = uint32_t;
 
 	class Material : public MemoryTrackable {
 	public:
@@ -16,11 +17,21 @@ namespace Lucy {
 			: m_MaterialID(materialID) {
 		}
 		virtual ~Material() = default;
-		virtual void Update() = 0;
+		//writes the shader data of the material into its entry of the material buffer, returns false if it has to be written again (e.g. a texture is still loading)
+		virtual bool Update(uint8_t* shaderData) = 0;
+		//screenPixels: the projected size of a surface, that the material is rendered onto (see TextureStreamer)
+		virtual void RequestTextureMips(float screenPixels) = 0;
 		virtual void RTDestroyResource() = 0;
 
 		inline MaterialID GetMaterialID() const { return m_MaterialID; }
+		inline bool IsDirty() const { return m_IsDirty; }
+	protected:
+		//every mutator of the shader data has to call this
+		inline void MarkDirty() { m_IsDirty = true; }
 	private:
 		MaterialID m_MaterialID = InvalidID<MaterialID>;
+		bool m_IsDirty = true;
+
+		friend class MaterialManager;
 	};
 }
\ No newline at end of file
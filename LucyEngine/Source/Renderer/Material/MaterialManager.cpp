@@ -7,6 +7,8 @@
 #include "assimp/material.h"
 
 namespace Lucy {
+
+	const size_t MaterialManager::s_MaterialShaderDataSize = sizeof(PBRMaterialShaderData);
 	
 	MaterialManager::MaterialManager(const std::unordered_map<std::string, Ref<Shader>>& shaders)
 		: m_Shaders(shaders) {
@@ -26,6 +28,8 @@ namespace Lucy {
 	void MaterialManager::RTDestroyMaterial(MaterialID materialID) {
 		s_MaterialIDProvider.ReturnID(materialID);
 		m_Materials.at(materialID)->RTDestroyResource();
+		//the entry of the material buffer is overwritten by the next material with this id
+		m_Materials.erase(materialID);
 	}
 
 	void MaterialManager::RTDestroyMaterials(const std::vector<MaterialID>& materialIDs) {
@@ -38,11 +42,37 @@ namespace Lucy {
 			material->RTDestroyResource();
 	}
 
-	//TODO: Material update system (currently, its updating every frame -> bad for performance)
 	void MaterialManager::UpdateMaterialsIfNecessary() {
 		LUCY_PROFILE_NEW_EVENT("MaterialManager::UpdateMaterialsIfNecessary");
-		for (Ref<Material> material : m_Materials | std::views::values)
-			material->Update();
+
+		//the storage buffer keeps the shader data of every material, indexed by its MaterialID
+		auto ssboMaterialAttributes = m_Shaders.at("LucyPBR")->GetSharedStorageBufferIfExists("LucyMaterialAttributes");
+		ssboMaterialAttributes->SetKeepContent(true);
+
+		//a new buffer (the shader has been reloaded) has to be written entirely
+		const bool writeAll = ssboMaterialAttributes->IsEmpty();
+
+		const uint32_t updatedMaterialCount = WriteMaterials(m_Materials, *ssboMaterialAttributes, writeAll);
+		LUCY_PROFILE_PLOT("Material Updates", (int64_t)updatedMaterialCount);
+	}
+
+	uint32_t MaterialManager::WriteMaterials(const std::map<MaterialID, Ref<Material>>& materials, ByteBuffer& materialBuffer, bool writeAll) {
+		uint32_t writtenMaterialCount = 0;
+		std::vector<uint8_t> shaderData(s_MaterialShaderDataSize);
+		for (const auto& [materialID, material] : materials) {
+			if (!material->IsDirty() && !writeAll)
+				continue;
+
+			material->m_IsDirty = !material->Update(shaderData.data());
+			materialBuffer.SetData((size_t)materialID * s_MaterialShaderDataSize, shaderData.data(), s_MaterialShaderDataSize);
+			writtenMaterialCount++;
+		}
+		return writtenMaterialCount;
+	}
+
+	void MaterialManager::RequestTextureMips(MaterialID materialID, float screenPixels) {
+		if (auto it = m_Materials.find(materialID); it != m_Materials.end())
+			it->second->RequestTextureMips(screenPixels);
 	}
 
 	MaterialID MaterialManager::CreatePBRMaterial(aiMaterial* aiMaterial, const std::string& importedFilePath) {
@@ -64,16 +94,21 @@ namespace Lucy {
 		PBRMaterialData materialData(glm::vec3(diffuse.r, diffuse.g, diffuse.b), metallic, roughness, aoContribution);
 		MaterialID materialID = s_MaterialIDProvider.RequestID();
 
-		auto LoadPBRTexture = [](auto aiMaterial, aiTextureType textureType, const std::string& importedFilePath, const Ref<PBRMaterial>& outMaterial) {
+		auto LoadPBRTexture = [](auto aiMaterial, aiTextureType textureType, const PBRMaterialImageType& type, const std::string& importedFilePath, const Ref<PBRMaterial>& outMaterial) {
 			aiString path;
 			if (aiMaterial->GetTexture(textureType, 0, &path) == aiReturn_SUCCESS) {
 				auto properTexturePath = FileSystem::GetParentPath(importedFilePath) / std::string(path.data);
 
-				Renderer::EnqueueToRenderCommandQueue([outMaterial, path, properTexturePath](const Ref<RenderDevice>& device) {
+				Renderer::EnqueueToRenderCommandQueue([outMaterial, type, path, properTexturePath]([[maybe_unused]] const Ref<RenderDevice>& device) {
 					ImageCreateInfo createInfo;
+#if USE_BLOCK_COMPRESSED_TEXTURES
+					createInfo.Format = ImageFormat::BC7_UNORM;
+					createInfo.ImageUsage = ImageUsage::AsSampledTexture;
+#else
 					createInfo.Format = ImageFormat::R8G8B8A8_UNORM;
-					createInfo.ImageType = ImageType::Type2D;
 					createInfo.ImageUsage = ImageUsage::AsColorAttachment;
+#endif
+					createInfo.ImageType = ImageType::Type2D;
 					createInfo.Parameter.Mag = ImageFilterMode::LINEAR;
 					createInfo.Parameter.Min = ImageFilterMode::LINEAR;
 					createInfo.Parameter.U = ImageAddressMode::REPEAT;
@@ -82,9 +117,13 @@ namespace Lucy {
 					createInfo.GenerateMipmap = true;
 					createInfo.ImGuiUsage = true;
 					createInfo.GenerateSampler = true;
+#if USE_TEXTURE_STREAMING
+					createInfo.StreamMips = true;
+#endif
 
-					RenderResourceHandle texture2DHandle = device->CreateImage(properTexturePath, createInfo);
-					outMaterial->AddTexture(texture2DHandle);
+					//materials that share a texture (e.g. Sponza) share the image as well
+					RenderResourceHandle texture2DHandle = Renderer::GetTextureCache()->RTAcquire(properTexturePath, createInfo);
+					outMaterial->AddTexture(type, texture2DHandle);
 				});
 			} else {
 				if (path.data)
@@ -92,14 +131,14 @@ namespace Lucy {
 			}
 		};
 
-		m_Materials.try_emplace(materialID, Memory::CreateRef<PBRMaterial>(materialID, m_Shaders.at("LucyPBR"), materialData));
+		m_Materials.try_emplace(materialID, Memory::CreateRef<PBRMaterial>(materialID, materialData));
 		const Ref<PBRMaterial>& pbrMaterial = m_Materials[materialID]->As<PBRMaterial>();
 
-		LoadPBRTexture(aiMaterial, aiTextureType_DIFFUSE, importedFilePath, pbrMaterial);
-		LoadPBRTexture(aiMaterial, aiTextureType_HEIGHT, importedFilePath, pbrMaterial);
-		LoadPBRTexture(aiMaterial, aiTextureType_SHININESS, importedFilePath, pbrMaterial);
-		LoadPBRTexture(aiMaterial, aiTextureType_SPECULAR, importedFilePath, pbrMaterial);
-		LoadPBRTexture(aiMaterial, aiTextureType_AMBIENT_OCCLUSION, importedFilePath, pbrMaterial);
+		LoadPBRTexture(aiMaterial, aiTextureType_DIFFUSE, PBRMaterial::ALBEDO_TYPE, importedFilePath, pbrMaterial);
+		LoadPBRTexture(aiMaterial, aiTextureType_HEIGHT, PBRMaterial::NORMALS_TYPE, importedFilePath, pbrMaterial);
+		LoadPBRTexture(aiMaterial, aiTextureType_SPECULAR, PBRMaterial::METALLIC_TYPE, importedFilePath, pbrMaterial);
+		LoadPBRTexture(aiMaterial, aiTextureType_SHININESS, PBRMaterial::ROUGHNESS_TYPE, importedFilePath, pbrMaterial);
+		LoadPBRTexture(aiMaterial, aiTextureType_AMBIENT_OCCLUSION, PBRMaterial::AO_TYPE, importedFilePath, pbrMaterial);
 
 		return materialID;
 	}
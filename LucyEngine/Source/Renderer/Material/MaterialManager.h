@@ -3,11 +3,14 @@
 
 #include "Material.h"
 #include "Utilities/UUID.h"
+#include "Renderer/Memory/Buffer/Buffer.h"
 
 struct aiMaterial;
 
 namespace Lucy {
 
+	class Shader;
+
 	enum class MaterialType {
 		PBR,
 		Subsurface, //TODO:
@@ -15,7 +18,7 @@ namespace Lucy {
 		Hair //TODO:
 	};
 
-	using MaterialIDProvider = IDProvider<float>;
+	using MaterialIDProvider = IDProvider<MaterialID>;
 
 	class MaterialManager final {
 	public:
@@ -27,8 +30,16 @@ namespace Lucy {
 		void RTDestroyMaterials(const std::vector<MaterialID>& materialIDs);
 		void DestroyAll();
 
+		//only the dirty materials are written into the material buffer (and uploaded), nothing is written if no material has changed
 		void UpdateMaterialsIfNecessary();
+		void RequestTextureMips(MaterialID materialID, float screenPixels);
 		inline const Ref<Material>& GetMaterialByID(MaterialID materialID) const { return m_Materials.at(materialID); }
+
+		//writes the shader data of the dirty materials (of every material with writeAll) at their MaterialID, returns the number of written materials
+		static uint32_t WriteMaterials(const std::map<MaterialID, Ref<Material>>& materials, ByteBuffer& materialBuffer, bool writeAll);
+
+		//the stride of the material buffer (LucyMaterialAttributes)
+		static const size_t s_MaterialShaderDataSize;
 	private:
 		MaterialID CreatePBRMaterial(aiMaterial* aiMaterial, const std::string& importedFilePath);
 
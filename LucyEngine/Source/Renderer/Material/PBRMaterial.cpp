@@ -5,46 +5,61 @@
 
 namespace Lucy {
 
-	PBRMaterial::PBRMaterial(MaterialID materialID, const Ref<Shader>& shader, const PBRMaterialData& data) 
-		: Material(materialID), m_PBRShader(shader), m_MaterialData(data) {
+	PBRMaterial::PBRMaterial(MaterialID materialID, const PBRMaterialData& data) 
+		: Material(materialID), m_MaterialData(data) {
 	}
 
-	void PBRMaterial::Update() {
+	bool PBRMaterial::Update(uint8_t* shaderData) {
 		LUCY_PROFILE_NEW_EVENT("Material::Update");
 
-		if (HasImage(PBRMaterial::ALBEDO_TYPE)) {
-			uint32_t pos = m_PBRShader->BindImageHandleTo("u_Textures", GetImage(PBRMaterial::ALBEDO_TYPE));
-			m_MaterialShaderData.AlbedoSlot = pos;
-		} else if (HasImage(PBRMaterial::NORMALS_TYPE)) {
-			uint32_t pos = m_PBRShader->BindImageHandleTo("u_Textures", GetImage(PBRMaterial::NORMALS_TYPE));
-			m_MaterialShaderData.NormalSlot = pos;
-		} else if (HasImage(PBRMaterial::METALLIC_TYPE)) {
-			uint32_t pos = m_PBRShader->BindImageHandleTo("u_Textures", GetImage(PBRMaterial::METALLIC_TYPE));
-			m_MaterialShaderData.MetallicSlot = pos;
-		} else if (HasImage(PBRMaterial::ROUGHNESS_TYPE)) {
-			uint32_t pos = m_PBRShader->BindImageHandleTo("u_Textures", GetImage(PBRMaterial::ROUGHNESS_TYPE));
-			m_MaterialShaderData.RoughnessSlot = pos;
-		} else if (HasImage(PBRMaterial::AO_TYPE)) {
-			uint32_t pos = m_PBRShader->BindImageHandleTo("u_Textures", GetImage(PBRMaterial::AO_TYPE));
-			m_MaterialShaderData.AOSlot = pos;
-		}
+		PBRMaterialShaderData materialShaderData;
+
+		//the textures are bound once per frame by the texture cache, images that are still loading use the base values
+		const auto GetTextureSlot = [this](const PBRMaterialImageType& type) {
+			if (!HasImage(type))
+				return -1.0f;
+			const uint32_t bindlessIndex = Renderer::GetTextureCache()->GetBindlessIndex(m_MaterialData.TextureHandles[type.Index]);
+			return bindlessIndex == TextureCache::InvalidBindlessIndex ? -1.0f : (float)bindlessIndex;
+		};
+
+		materialShaderData.AlbedoSlot = GetTextureSlot(PBRMaterial::ALBEDO_TYPE);
+		materialShaderData.NormalSlot = GetTextureSlot(PBRMaterial::NORMALS_TYPE);
+		materialShaderData.MetallicSlot = GetTextureSlot(PBRMaterial::METALLIC_TYPE);
+		materialShaderData.RoughnessSlot = GetTextureSlot(PBRMaterial::ROUGHNESS_TYPE);
+		materialShaderData.AOSlot = GetTextureSlot(PBRMaterial::AO_TYPE);
 
 		//TODO: Change diffuse color to vec4
-		m_MaterialShaderData.BaseDiffuseColor = glm::vec4(m_MaterialData.Diffuse, 1.0f);
-		m_MaterialShaderData.BaseMetallicValue = m_MaterialData.Metallic;
-		m_MaterialShaderData.BaseRoughnessValue = m_MaterialData.Roughness;
-		m_MaterialShaderData.BaseAOValue = m_MaterialData.AOContribution;
+		materialShaderData.BaseDiffuseColor = glm::vec4(m_MaterialData.Diffuse, 1.0f);
+		materialShaderData.BaseMetallicValue = m_MaterialData.Metallic;
+		materialShaderData.BaseRoughnessValue = m_MaterialData.Roughness;
+		materialShaderData.BaseAOValue = m_MaterialData.AOContribution;
+
+		memcpy(shaderData, &materialShaderData, sizeof(PBRMaterialShaderData));
 
-		auto ssboMaterialAttributes = m_PBRShader->GetSharedStorageBufferIfExists("LucyMaterialAttributes");
-		ssboMaterialAttributes->Append((uint8_t*)&m_MaterialShaderData, sizeof(m_MaterialShaderData));
+		//the slots of the textures, that are still loading, have to be written again once they are ready
+		return std::ranges::none_of(m_MaterialData.TextureHandles, [](RenderResourceHandle textureHandle) {
+			return textureHandle != InvalidRenderResourceHandle && !Renderer::AccessResource<Image>(textureHandle)->IsReady();
+		});
 	}
 
-	void PBRMaterial::AddTexture(RenderResourceHandle textureHandle) {
-		m_MaterialData.TextureHandles.push_back(textureHandle);
+	void PBRMaterial::AddTexture(const PBRMaterialImageType& type, RenderResourceHandle textureHandle) {
+		//the textures are loaded in any order and some types might be missing
+		if (m_MaterialData.TextureHandles.size() <= type.Index)
+			m_MaterialData.TextureHandles.resize(type.Index + 1, InvalidRenderResourceHandle);
+		m_MaterialData.TextureHandles[type.Index] = textureHandle;
+		MarkDirty();
+	}
+
+	void PBRMaterial::RequestTextureMips(float screenPixels) {
+		for (RenderResourceHandle textureHandle : m_MaterialData.TextureHandles) {
+			if (textureHandle != InvalidRenderResourceHandle)
+				Renderer::GetTextureStreamer()->RequestScreenSize(textureHandle, screenPixels);
+		}
 	}
 
 	void PBRMaterial::RTDestroyResource() {
+		//the textures might be shared with other materials
 		for (RenderResourceHandle imageHandle : m_MaterialData.TextureHandles)
-			Renderer::EnqueueResourceDestroy(imageHandle);
+			Renderer::GetTextureCache()->RTRelease(imageHandle);
 	}
 }
\ No newline at end of file
@@ -17,6 +17,7 @@ namespace Lucy {
 		PBRMaterialData() = default;
 	};
 
+	//the slots are indices into the bindless texture array (see TextureCache), -1 for the base values
 	struct PBRMaterialShaderData {
 		float AlbedoSlot = -1.0f;
 		float NormalSlot = -1.0f;
@@ -29,6 +30,7 @@ namespace Lucy {
 		float BaseAOValue = 1.0f;
 		float AOSlot = -1.0f;
 	};
+	static_assert(sizeof(PBRMaterialShaderData) == 48, "PBRMaterialShaderData does not match the std430 layout!");
 
 	struct PBRMaterialImageType {
 		std::string Name;
@@ -37,12 +39,16 @@ namespace Lucy {
 
 	class PBRMaterial final : public Material {
 	public:
-		PBRMaterial(MaterialID materialID, const Ref<Shader>& shader, const PBRMaterialData& data);
+		PBRMaterial(MaterialID materialID, const PBRMaterialData& data);
 		virtual ~PBRMaterial() = default;
 
-		inline float& GetRoughnessValue() { return m_MaterialData.Roughness; }
-		inline float& GetMetallicValue() { return m_MaterialData.Metallic; }
-		inline float& GetAOContribution() { return m_MaterialData.AOContribution; }
+		inline float GetRoughnessValue() const { return m_MaterialData.Roughness; }
+		inline float GetMetallicValue() const { return m_MaterialData.Metallic; }
+		inline float GetAOContribution() const { return m_MaterialData.AOContribution; }
+
+		inline void SetRoughnessValue(float roughness) { m_MaterialData.Roughness = roughness; MarkDirty(); }
+		inline void SetMetallicValue(float metallic) { m_MaterialData.Metallic = metallic; MarkDirty(); }
+		inline void SetAOContribution(float aoContribution) { m_MaterialData.AOContribution = aoContribution; MarkDirty(); }
 
 		inline Ref<Image> GetImage(const PBRMaterialImageType& type) const { 
 			return Renderer::AccessResource<Image>(m_MaterialData.TextureHandles[type.Index]); 
@@ -51,12 +57,14 @@ namespace Lucy {
 		inline bool HasImage(const PBRMaterialImageType& type) const {
 			return !m_MaterialData.TextureHandles.empty() && 
 				m_MaterialData.TextureHandles.size() > type.Index && 
-				m_MaterialData.TextureHandles[type.Index] != InvalidRenderResourceHandle;
+				m_MaterialData.TextureHandles[type.Index] != InvalidRenderResourceHandle &&
+				GetImage(type)->IsReady();
 		}
 
-		void Update() final override;
+		bool Update(uint8_t* shaderData) final override;
+		void RequestTextureMips(float screenPixels) final override;
 		void RTDestroyResource() final override;
-		void AddTexture(RenderResourceHandle textureHandle);
+		void AddTexture(const PBRMaterialImageType& type, RenderResourceHandle textureHandle);
 
 		static inline const PBRMaterialImageType ALBEDO_TYPE = { "Albedo", 0 };
 		static inline const PBRMaterialImageType NORMALS_TYPE = { "Normals", 1 };
@@ -64,9 +72,6 @@ namespace Lucy {
 		static inline const PBRMaterialImageType ROUGHNESS_TYPE = { "Roughness", 3 };
 		static inline const PBRMaterialImageType AO_TYPE = { "Ambient Occlusion", 4 };
 	private:
-		Ref<Shader> m_PBRShader = nullptr;
-
-		PBRMaterialShaderData m_MaterialShaderData;
 		PBRMaterialData m_MaterialData;
 	};
 }
\ No newline at end of file
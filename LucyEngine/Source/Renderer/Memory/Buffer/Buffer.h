@@ -2,6 +2,29 @@
 
 namespace Lucy {
 
+	//half open [Begin, End), in elements of the buffer
+	struct BufferRange {
+		size_t Begin = 0;
+		size_t End = 0;
+
+		bool operator==(const BufferRange& other) const = default;
+	};
+
+	//keeps the ranges sorted and merges the overlapping (and touching) ones
+	inline void AddBufferRange(std::vector<BufferRange>& ranges, size_t begin, size_t end) {
+		if (begin >= end)
+			return;
+
+		auto first = std::lower_bound(ranges.begin(), ranges.end(), begin, [](const BufferRange& range, size_t value) { return range.End < value; });
+		auto last = first;
+		for (; last != ranges.end() && last->Begin <= end; last++) {
+			begin = std::min(begin, last->Begin);
+			end = std::max(end, last->End);
+		}
+		first = ranges.erase(first, last);
+		ranges.insert(first, BufferRange{ begin, end });
+	}
+
 	template <typename T>
 	class Buffer {
 		using VecIterator = typename std::vector<T>::iterator;
@@ -14,12 +37,14 @@ namespace Lucy {
 
 		Buffer(const Buffer& other) {
 			std::copy(other.m_Data.begin(), other.m_Data.end(), std::back_inserter(m_Data));
+			MarkDirty(0, m_Data.size());
 		}
 
 		Buffer& operator=(const Buffer& other) { 
 			if (this != &other) {
 				Clear();
 				std::copy(other.m_Data.begin(), other.m_Data.end(), std::back_inserter(m_Data));
+				MarkDirty(0, m_Data.size());
 			}
 			return *this;
 		}
@@ -35,7 +60,9 @@ namespace Lucy {
 		}
 
 		void Resize(size_t size) {
+			const size_t oldSize = m_Data.size();
 			m_Data.resize(size);
+			MarkDirty(oldSize, size);
 		}
 
 		void SetData(const std::vector<T>& data, size_t from = 0, size_t to = 0) {
@@ -51,11 +78,25 @@ namespace Lucy {
 			for (size_t i = from; i < to + from; i++) {
 				m_Data[i] = data[indexData++];
 			}
+			MarkDirty(from, from + to);
 		}
 
 		void SetData(T* data, size_t size) {
-			Resize(size);
-			memcpy(m_Data.data(), data, size);
+			//the new elements are overwritten right away, they are only marked as part of the write
+			m_Data.resize(size);
+			memcpy(m_Data.data(), data, size * sizeof(T));
+			MarkDirty(0, size);
+		}
+
+		//writes the elements at the offset, the buffer grows if they don't fit
+		void SetData(size_t offset, const T* data, size_t size) {
+			//only the gap up to the offset stays zeroed, the rest is overwritten right away
+			if (m_Data.size() < offset)
+				Resize(offset);
+			if (m_Data.size() < offset + size)
+				m_Data.resize(offset + size);
+			memcpy(m_Data.data() + offset, data, size * sizeof(T));
+			MarkDirty(offset, offset + size);
 		}
 
 		void SetData(const Buffer<T>& other) {
@@ -65,25 +106,42 @@ namespace Lucy {
 		inline T* operator&() const { return m_Data.data(); }
 
 		inline void Append(const std::vector<T>& data) {
+			const size_t offset = m_Data.size();
 			m_Data.insert(m_Data.end(), data.begin(), data.end());
+			MarkDirty(offset, m_Data.size());
 		}
 
 		inline void Append(const Buffer& buffer) {
-			Append(buffer.m_Data, buffer.m_Data.size());
+			Append(buffer.m_Data);
 		}
 
 		inline void Append(T* data, size_t size) {
 			InsertPadding(alignof(T));
+			const size_t offset = m_Data.size();
 			m_Data.insert(m_Data.end(), data, data + size);
+			MarkDirty(offset, m_Data.size());
 		}
 
 		inline void AppendMove(T* data, size_t size) {
 			InsertPadding(alignof(T));
+			const size_t offset = m_Data.size();
 			m_Data.insert(m_Data.end(), std::make_move_iterator(data), std::make_move_iterator(data + size));
+			MarkDirty(offset, m_Data.size());
 		}
 
+		//nothing of the old content is left to be uploaded
 		inline void Clear() {
 			m_Data.clear();
+			m_PreviousData.clear();
+			m_DirtyRanges.clear();
+		}
+
+		//for buffers, that are written from scratch after every upload. The uploaded content is kept for the comparison with the new writes,
+		//the unchanged elements at both ends of a write are not dirty, since the device buffers still hold them
+		inline void BeginRewrite() {
+			std::swap(m_Data, m_PreviousData);
+			m_Data.clear();
+			m_DirtyRanges.clear();
 		}
 
 		inline auto Begin() -> VecIterator { return m_Data.begin(); }
@@ -93,6 +151,9 @@ namespace Lucy {
 		inline size_t GetSize() { return m_Data.size(); }
 		inline size_t GetCapacity() const { return m_Data.capacity(); }
 	protected:
+		//the ranges, that have been written since the last call. Writes through operator[] or operator& are not tracked
+		inline std::vector<BufferRange> ConsumeDirtyRanges() { return std::exchange(m_DirtyRanges, {}); }
+
 		std::vector<T> m_Data;
 
 	private:
@@ -100,7 +161,25 @@ namespace Lucy {
 			size_t offset = m_Data.size();
 			size_t padding = (alignment - (offset % alignment)) % alignment;
 			m_Data.insert(m_Data.end(), padding, 0);
+			MarkDirty(offset, m_Data.size());
 		}
+
+		inline void MarkDirty(size_t begin, size_t end) {
+			const size_t compareEnd = std::min(end, m_PreviousData.size());
+			if (begin < compareEnd) {
+				const auto previousBegin = m_PreviousData.begin() + begin;
+				const auto previousEnd = m_PreviousData.begin() + compareEnd;
+				begin += std::mismatch(previousBegin, previousEnd, m_Data.begin() + begin).first - previousBegin;
+				//the elements after the old content are always dirty
+				if (end == compareEnd)
+					end -= std::mismatch(std::make_reverse_iterator(previousEnd), std::make_reverse_iterator(m_PreviousData.begin() + begin),
+										 std::make_reverse_iterator(m_Data.begin() + end)).first - std::make_reverse_iterator(previousEnd);
+			}
+			AddBufferRange(m_DirtyRanges, begin, end);
+		}
+
+		std::vector<T> m_PreviousData; //the content before BeginRewrite, empty otherwise
+		std::vector<BufferRange> m_DirtyRanges;
 	};
 
 	using ByteBuffer = Buffer<uint8_t>;
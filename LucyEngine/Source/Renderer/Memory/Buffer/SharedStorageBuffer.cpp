@@ -0,0 +1,27 @@
+#include "lypch.h"
+#include "SharedStorageBuffer.h"
+
+#include "Renderer/Shader/ShaderReflect.h" //for ShaderMemberVariable
+
+namespace Lucy {
+
+	size_t SharedStorageBuffer::GetNewCapacity(size_t capacity, size_t requiredSize, uint32_t& underusedUploadCount) {
+		//geometric, so that a buffer that grows a bit every frame is only recreated a couple of times
+		if (requiredSize > capacity) {
+			underusedUploadCount = 0;
+			return AlignCapacity(glm::max(requiredSize, capacity * s_GrowthFactor));
+		}
+
+		if (capacity <= s_MinCapacity || requiredSize * s_ShrinkFactor > capacity) {
+			underusedUploadCount = 0;
+			return capacity;
+		}
+
+		//mostly unused for a while, shrinks to twice of what is used (a single spike is not worth the recreation)
+		if (++underusedUploadCount < s_ShrinkAfterUploadCount)
+			return capacity;
+
+		underusedUploadCount = 0;
+		return AlignCapacity(requiredSize * s_GrowthFactor);
+	}
+}
@@ -12,9 +12,10 @@ namespace Lucy {
 	struct SharedStorageBufferCreateInfo {
 		std::string Name = "Unnamed Shared Storage Buffer";
 		uint32_t Binding = 0;
-		uint32_t BufferSize = 0;
+		uint32_t BufferSize = 0; //the initial capacity, the buffer grows (and shrinks) with its content
 		uint32_t ArraySize = 0; //default is 0, which means no array
 		DescriptorType Type = DescriptorType::Undefined;
+		bool IsWrittenByShader = false; //not declared as readonly in every stage, the uploads can't skip the unchanged bytes
 		std::vector<ShaderMemberVariable> ShaderMemberVariables;
 	};
 
@@ -33,7 +34,25 @@ namespace Lucy {
 		inline uint32_t GetSize() const { return m_CreateInfo.BufferSize; }
 		inline uint32_t GetArraySize() const { return m_CreateInfo.ArraySize; }
 		inline DescriptorType GetDescriptorType() const { return m_CreateInfo.Type; }
+
+		//the device buffer grows to at least this size, without uploading anything (for buffers that are entirely written by the GPU)
+		inline void SetDeviceSize(size_t size) { m_DeviceSize = size; }
+		//the content is kept after the upload instead of being cleared, so that parts of it can be written with SetData(offset, ...)
+		inline void SetKeepContent(bool keepContent) { m_KeepContent = keepContent; }
+		inline bool KeepsContent() const { return m_KeepContent; }
+
+		//the capacity of a device buffer (one per frame in flight) for the next upload. underusedUploadCount belongs to the same buffer
+		//and is kept between the calls, a mostly unused buffer only shrinks after s_ShrinkAfterUploadCount uploads in a row
+		static size_t GetNewCapacity(size_t capacity, size_t requiredSize, uint32_t& underusedUploadCount);
+		static inline size_t AlignCapacity(size_t size) { return (glm::max(size, s_MinCapacity) + s_MinCapacity - 1) / s_MinCapacity * s_MinCapacity; }
+
+		static constexpr size_t s_MinCapacity = 256;
+		static constexpr size_t s_GrowthFactor = 2;
+		static constexpr size_t s_ShrinkFactor = 4; //if at most a quarter is used
+		static constexpr uint32_t s_ShrinkAfterUploadCount = 300; //per frame in flight
 	protected:
 		SharedStorageBufferCreateInfo m_CreateInfo;
+		size_t m_DeviceSize = 0;
+		bool m_KeepContent = false;
 	};
 }
\ No newline at end of file
@@ -9,13 +9,22 @@ namespace Lucy {
 
 	class VertexBuffer : public FloatBuffer, public RenderResource {
 	public:
+		using StagingWriteFunc = std::function<void(float* mappedData, size_t size)>;
+
 		virtual ~VertexBuffer() = default;
 
+		/*
+		* Maps the staging buffer and hands it to the caller, so that the vertices can be generated in place.
+		* The internal CPU-side copy (m_Data) is not touched and therefore never allocated.
+		*/
+		virtual void RTWriteToStaging(const StagingWriteFunc& func) = 0;
 		virtual void RTLoadToDevice() = 0;
 	protected:
 		VertexBuffer(size_t size) 
-			: RenderResource("Vertex Buffer") {
-			Resize(size); //internal std::vector allocation
+			: RenderResource("Vertex Buffer"), m_Size(size) {
+			//no internal std::vector allocation, use RTWriteToStaging or Resize/SetData
 		}
+
+		size_t m_Size = 0; //in floats
 	};
-}
\ No newline at end of file
+}
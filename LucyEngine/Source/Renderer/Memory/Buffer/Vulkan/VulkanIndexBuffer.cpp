@@ -8,13 +8,6 @@ namespace Lucy {
 
 	VulkanIndexBuffer::VulkanIndexBuffer(size_t size, const Ref<VulkanRenderDevice>& device)
 		: IndexBuffer(size), m_VulkanDevice(device) {
-		RTCreate(size); //staging buffer allocation
-	}
-
-	void VulkanIndexBuffer::RTCreate(size_t size) {
-		VulkanAllocator& allocator = m_VulkanDevice->GetAllocator();
-		allocator.CreateVulkanBufferVma(VulkanBufferUsage::CPUOnly, size * sizeof(float), VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-										m_StagingBufferHandle, m_StagingBufferVma);
 	}
 
 	void VulkanIndexBuffer::RTBind(const VulkanIndexBindInfo& info) {
@@ -24,17 +17,15 @@ namespace Lucy {
 
 	void VulkanIndexBuffer::RTLoadToDevice() {
 		VulkanAllocator& allocator = m_VulkanDevice->GetAllocator();
+		VulkanStagingRing& stagingRing = m_VulkanDevice->GetStagingRing();
 
-		void* data;
-		allocator.MapMemory(m_StagingBufferVma, data);
-		memcpy(data, m_Data.data(), m_Data.size() * sizeof(float));
-		allocator.UnmapMemory(m_StagingBufferVma);
-
-		allocator.CreateVulkanBufferVma(VulkanBufferUsage::GPUOnly, m_Data.size() * sizeof(float),
-										VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, m_BufferHandle, m_BufferVma);
-		Renderer::RTDirectCopyBuffer(m_StagingBufferHandle, m_BufferHandle, m_Data.size() * sizeof(float));
+		const VkDeviceSize size = m_Data.size() * sizeof(uint32_t);
+		StagingAllocation staging = stagingRing.Allocate(size);
+		memcpy(staging.MappedData, m_Data.data(), size);
 
-		allocator.DestroyBuffer(m_StagingBufferHandle, m_StagingBufferVma);
+		allocator.CreateVulkanBufferVma(VulkanBufferUsage::GPUOnly, size, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, m_BufferHandle, m_BufferVma);
+		//recorded with the uploads of the next frame
+		stagingRing.EnqueueBufferCopy(staging, m_BufferHandle);
 	}
 
 	void VulkanIndexBuffer::RTDestroyResource() {
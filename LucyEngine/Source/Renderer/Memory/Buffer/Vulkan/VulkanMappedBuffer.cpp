@@ -0,0 +1,62 @@
+#include "lypch.h"
+#include "VulkanMappedBuffer.h"
+
+#include "Renderer/Memory/VulkanAllocator.h"
+
+namespace Lucy {
+
+	void VulkanMappedBuffer::Create(VulkanAllocator& allocator, VkDeviceSize size, VkBufferUsageFlags usage) {
+		allocator.CreateVulkanBufferVma(VulkanBufferUsage::CPUOnlyMapped, size, usage, m_Buffer, m_BufferVma);
+		m_MappedData = (uint8_t*)allocator.GetMappedData(m_BufferVma);
+		m_Size = size;
+		m_ID = s_NextID++;
+		m_DirtyRanges = { BufferRange{ 0, size } };
+	}
+
+	void VulkanMappedBuffer::Destroy(VulkanAllocator& allocator) {
+		if (!m_Buffer)
+			return;
+
+		//the allocation is unmapped by vma
+		allocator.DestroyBuffer(m_Buffer, m_BufferVma);
+		m_Buffer = VK_NULL_HANDLE;
+		m_BufferVma = VK_NULL_HANDLE;
+		m_MappedData = nullptr;
+		m_Size = 0;
+		m_ID = 0;
+		m_DirtyRanges.clear();
+	}
+
+	void VulkanMappedBuffer::MarkDirty(VkDeviceSize offset, VkDeviceSize size) {
+		AddBufferRange(m_DirtyRanges, offset, glm::min(offset + size, m_Size));
+	}
+
+	void VulkanMappedBuffer::RTUpload(VulkanAllocator& allocator, const uint8_t* data, VkDeviceSize size, bool onlyDirtyRanges) {
+		LUCY_PROFILE_NEW_EVENT("VulkanMappedBuffer::RTUpload");
+		LUCY_ASSERT(size <= m_Size, "Upload of {0} bytes into a buffer of {1} bytes!", size, m_Size);
+
+		if (size == 0)
+			return;
+
+		if (!onlyDirtyRanges) {
+			m_DirtyRanges.clear();
+			WriteRange(allocator, data, 0, size);
+			return;
+		}
+
+		//the bytes after the uploaded ones are not part of the content, they are marked again once they are written
+		for (const BufferRange& range : m_DirtyRanges) {
+			if (range.Begin >= size)
+				break;
+			const VkDeviceSize end = glm::min((VkDeviceSize)range.End, size);
+			WriteRange(allocator, data + range.Begin, range.Begin, end - range.Begin);
+		}
+		m_DirtyRanges.clear();
+	}
+
+	void VulkanMappedBuffer::WriteRange(VulkanAllocator& allocator, const uint8_t* data, VkDeviceSize offset, VkDeviceSize size) {
+		memcpy(m_MappedData + offset, data, size);
+		allocator.FlushMemory(m_BufferVma, offset, size);
+		s_UploadedBytes += size;
+	}
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <atomic>
+
+#include "vulkan/vulkan.h"
+#include "vma/vk_mem_alloc.h"
+
+#include "../Buffer.h"
+
+namespace Lucy {
+
+	class VulkanAllocator;
+
+	/*
+	* A host visible buffer, that stays mapped for its whole lifetime (one per frame in flight for uniform and storage buffers).
+	* It collects the ranges, that have been written on the CPU since its last upload, so that an upload only writes
+	* (and flushes, if the memory is not coherent) these. A new buffer is entirely dirty.
+	*/
+	class VulkanMappedBuffer final {
+	public:
+		VulkanMappedBuffer() = default;
+		~VulkanMappedBuffer() = default;
+
+		void Create(VulkanAllocator& allocator, VkDeviceSize size, VkBufferUsageFlags usage);
+		void Destroy(VulkanAllocator& allocator);
+
+		void MarkDirty(VkDeviceSize offset, VkDeviceSize size);
+		//only the dirty ranges are written, unless the GPU writes to the buffer as well (the bytes outside of them might have been changed)
+		void RTUpload(VulkanAllocator& allocator, const uint8_t* data, VkDeviceSize size, bool onlyDirtyRanges);
+
+		inline VkBuffer GetBuffer() const { return m_Buffer; }
+		inline VkDeviceSize GetSize() const { return m_Size; }
+		//unique for every created buffer, unlike the handle, which can be reused after the destruction of a buffer
+		inline uint64_t GetID() const { return m_ID; }
+
+		//the bytes, that have been written by every mapped buffer since the last call (for the profiler)
+		static inline uint64_t ConsumeUploadedBytes() { return s_UploadedBytes.exchange(0); }
+	private:
+		void WriteRange(VulkanAllocator& allocator, const uint8_t* data, VkDeviceSize offset, VkDeviceSize size);
+
+		VkBuffer m_Buffer = VK_NULL_HANDLE;
+		VmaAllocation m_BufferVma = VK_NULL_HANDLE;
+		uint8_t* m_MappedData = nullptr;
+		VkDeviceSize m_Size = 0;
+		uint64_t m_ID = 0;
+
+		std::vector<BufferRange> m_DirtyRanges; //in bytes
+
+		static inline std::atomic<uint64_t> s_UploadedBytes = 0;
+		static inline std::atomic<uint64_t> s_NextID = 1;
+	};
+}
@@ -10,29 +10,61 @@ namespace Lucy {
 
 	VulkanSharedStorageBuffer::VulkanSharedStorageBuffer(const SharedStorageBufferCreateInfo& createInfo, const Ref<VulkanRenderDevice>& device)
 		: SharedStorageBuffer(createInfo), m_VulkanDevice(device) {
-		LUCY_ASSERT(m_CreateInfo.BufferSize != 0, "The size of SSBO is 0.");
-
 		const uint32_t maxFramesInFlight = Renderer::GetMaxFramesInFlight();
-		m_Buffers.resize(maxFramesInFlight, VK_NULL_HANDLE);
-		m_BufferVma.resize(maxFramesInFlight, VK_NULL_HANDLE);
+		m_Buffers.resize(maxFramesInFlight);
+		m_UnderusedUploadCounts.resize(maxFramesInFlight, 0);
 
-		VulkanAllocator& allocator = m_VulkanDevice->GetAllocator();
+		//the declared size (without the runtime arrays), the buffers grow with their content
 		for (uint32_t i = 0; i < maxFramesInFlight; i++)
-			allocator.CreateVulkanBufferVma(VulkanBufferUsage::CPUOnly, m_CreateInfo.BufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, m_Buffers[i], m_BufferVma[i]);
+			RTCreateBuffer(i, AlignCapacity(m_CreateInfo.BufferSize));
+	}
+
+	void VulkanSharedStorageBuffer::RTCreateBuffer(uint32_t index, VkDeviceSize size) {
+		//indirect usage, so that the compute written SSBO's can be directly consumed by vkCmdDraw*Indirect*
+		static constexpr VkBufferUsageFlags usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT;
+
+		m_Buffers[index].Create(m_VulkanDevice->GetAllocator(), size, usage);
+		s_AllocatedSize += size;
+	}
+
+	void VulkanSharedStorageBuffer::RTRecreateBuffer(uint32_t index, VkDeviceSize size) {
+		LUCY_PROFILE_NEW_EVENT("VulkanSharedStorageBuffer::RTRecreateBuffer");
+
+		//the buffer of the current frame is not in use by the GPU anymore (we waited for its fence), so it can be safely recreated.
+		//descriptor sets, that have been updated this frame before this call (bound to another shader), still point to the old buffer,
+		//so it is destroyed once the frame has been completed. Descriptors are written after this call, so they will point to the new buffer.
+		Renderer::EnqueueDeletion([oldBuffer = m_Buffers[index], device = m_VulkanDevice]() mutable {
+			s_AllocatedSize -= oldBuffer.GetSize();
+			oldBuffer.Destroy(device->GetAllocator());
+		});
+
+		m_Buffers[index] = VulkanMappedBuffer();
+		RTCreateBuffer(index, size);
 	}
 
 	void VulkanSharedStorageBuffer::RTLoadToDevice() {
 		VulkanAllocator& allocator = m_VulkanDevice->GetAllocator();
+		const uint32_t frameIndex = Renderer::GetCurrentFrameIndex();
+
+		const VkDeviceSize requiredSize = glm::max(m_Data.size(), m_DeviceSize);
+		if (VkDeviceSize capacity = GetNewCapacity(m_Buffers[frameIndex].GetSize(), requiredSize, m_UnderusedUploadCounts[frameIndex]); capacity != m_Buffers[frameIndex].GetSize())
+			RTRecreateBuffer(frameIndex, capacity);
+
+		//the buffers of the other frames in flight are behind by the same writes
+		for (const BufferRange& range : ConsumeDirtyRanges()) {
+			for (VulkanMappedBuffer& buffer : m_Buffers)
+				buffer.MarkDirty(range.Begin, range.End - range.Begin);
+		}
 
-		void* dataLocal;
-		allocator.MapMemory(m_BufferVma[Renderer::GetCurrentFrameIndex()], dataLocal);
-		memcpy(dataLocal, m_Data.data(), m_Data.size());
-		allocator.UnmapMemory(m_BufferVma[Renderer::GetCurrentFrameIndex()]);
+		//the GPU might have changed the bytes, that have been written last time (e.g. counters that are reset every frame)
+		m_Buffers[frameIndex].RTUpload(allocator, m_Data.data(), m_Data.size(), !m_CreateInfo.IsWrittenByShader);
 	}
 
 	void VulkanSharedStorageBuffer::RTDestroyResource() {
 		VulkanAllocator& allocator = m_VulkanDevice->GetAllocator();
-		for (uint32_t i = 0; i < Renderer::GetMaxFramesInFlight(); i++)
-			allocator.DestroyBuffer(m_Buffers[i], m_BufferVma[i]);
+		for (VulkanMappedBuffer& buffer : m_Buffers) {
+			s_AllocatedSize -= buffer.GetSize();
+			buffer.Destroy(allocator);
+		}
 	}
 }
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include "vma/vk_mem_alloc.h"
 
 #include "../SharedStorageBuffer.h"
+#include "VulkanMappedBuffer.h"
 
 namespace Lucy {
 
@@ -14,12 +15,21 @@ namespace Lucy {
 
 		void RTLoadToDevice() final override;
 
-		inline VkBuffer GetVulkanBufferHandle(const uint32_t index) { return m_Buffers[index]; }
+		inline VkBuffer GetVulkanBufferHandle(const uint32_t index) { return m_Buffers[index].GetBuffer(); }
+		inline VkDeviceSize GetVulkanBufferSize(const uint32_t index) const { return m_Buffers[index].GetSize(); }
+		inline uint64_t GetVulkanBufferID(const uint32_t index) const { return m_Buffers[index].GetID(); }
+
+		//of every storage buffer (and every frame in flight), including the ones that wait for their deletion
+		static inline uint64_t GetAllocatedSize() { return s_AllocatedSize; }
 	private:
+		void RTCreateBuffer(uint32_t index, VkDeviceSize size);
+		void RTRecreateBuffer(uint32_t index, VkDeviceSize size);
 		void RTDestroyResource() final override;
 
-		std::vector<VkBuffer> m_Buffers;
-		std::vector<VmaAllocation> m_BufferVma;
+		std::vector<VulkanMappedBuffer> m_Buffers;
+		std::vector<uint32_t> m_UnderusedUploadCounts; //consecutive uploads, that have used less than 1 / s_ShrinkFactor of the buffer
+
+		static inline std::atomic<uint64_t> s_AllocatedSize = 0;
 
 		Ref<VulkanRenderDevice> m_VulkanDevice = nullptr;
 	};
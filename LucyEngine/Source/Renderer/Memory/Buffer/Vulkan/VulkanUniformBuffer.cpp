@@ -13,26 +13,27 @@ namespace Lucy {
 		LUCY_ASSERT(m_CreateInfo.BufferSize != 0, "The size of UBO is 0.");
 
 		const uint32_t maxFramesInFlight = Renderer::GetMaxFramesInFlight();
-		m_Buffers.resize(maxFramesInFlight, VK_NULL_HANDLE);
-		m_BufferVma.resize(maxFramesInFlight, VK_NULL_HANDLE);
+		m_Buffers.resize(maxFramesInFlight);
 
 		VulkanAllocator& allocator = m_VulkanDevice->GetAllocator();
-		for (uint32_t i = 0; i < maxFramesInFlight; i++)
-			allocator.CreateVulkanBufferVma(VulkanBufferUsage::CPUOnly, m_CreateInfo.BufferSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, m_Buffers[i], m_BufferVma[i]);
+		for (VulkanMappedBuffer& buffer : m_Buffers)
+			buffer.Create(allocator, m_CreateInfo.BufferSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT);
 	}
 
 	void VulkanUniformBuffer::RTLoadToDevice() {
-		VulkanAllocator& allocator = m_VulkanDevice->GetAllocator();
-
-		void* dataLocal;
-		allocator.MapMemory(m_BufferVma[Renderer::GetCurrentFrameIndex()], dataLocal);
-		memcpy(dataLocal, m_Data.data(), m_Data.size());
-		allocator.UnmapMemory(m_BufferVma[Renderer::GetCurrentFrameIndex()]);
+		//the buffers of the other frames in flight are behind by the same writes
+		for (const BufferRange& range : ConsumeDirtyRanges()) {
+			for (VulkanMappedBuffer& buffer : m_Buffers)
+				buffer.MarkDirty(range.Begin, range.End - range.Begin);
+		}
+
+		//uniform buffers are never written by the GPU
+		m_Buffers[Renderer::GetCurrentFrameIndex()].RTUpload(m_VulkanDevice->GetAllocator(), m_Data.data(), m_Data.size(), true);
 	}
 
 	void VulkanUniformBuffer::RTDestroyResource() {
 		VulkanAllocator& allocator = m_VulkanDevice->GetAllocator();
-		for (uint32_t i = 0; i < Renderer::GetMaxFramesInFlight(); i++)
-			allocator.DestroyBuffer(m_Buffers[i], m_BufferVma[i]);
+		for (VulkanMappedBuffer& buffer : m_Buffers)
+			buffer.Destroy(allocator);
 	}
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../UniformBuffer.h"
+#include "VulkanMappedBuffer.h"
 #include "Renderer/Image/VulkanImage2D.h"
 
 namespace Lucy {
@@ -12,12 +13,12 @@ namespace Lucy {
 
 		void RTLoadToDevice() final override;
 
-		inline VkBuffer GetVulkanBufferHandle(const uint32_t index) { return m_Buffers[index]; }
+		inline VkBuffer GetVulkanBufferHandle(const uint32_t index) { return m_Buffers[index].GetBuffer(); }
+		inline uint64_t GetVulkanBufferID(const uint32_t index) const { return m_Buffers[index].GetID(); }
 	private:
 		void RTDestroyResource() final override;
 
-		std::vector<VkBuffer> m_Buffers;
-		std::vector<VmaAllocation> m_BufferVma;
+		std::vector<VulkanMappedBuffer> m_Buffers;
 
 		Ref<VulkanRenderDevice> m_VulkanDevice = nullptr;
 	};
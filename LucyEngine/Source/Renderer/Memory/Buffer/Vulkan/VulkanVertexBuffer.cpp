@@ -8,13 +8,11 @@ namespace Lucy {
 
 	VulkanVertexBuffer::VulkanVertexBuffer(size_t size, const Ref<VulkanRenderDevice>& device)
 		: VertexBuffer(size), m_VulkanDevice(device) {
-		RTCreate(size); //staging buffer allocation
 	}
 
-	void VulkanVertexBuffer::RTCreate(size_t size) {
-		VulkanAllocator& allocator = m_VulkanDevice->GetAllocator();
-		allocator.CreateVulkanBufferVma(VulkanBufferUsage::CPUOnly, size * sizeof(float), VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-										m_StagingBufferHandle, m_StagingBufferVma);
+	void VulkanVertexBuffer::RTAllocateStaging() {
+		if (!m_Staging.IsValid())
+			m_Staging = m_VulkanDevice->GetStagingRing().Allocate(m_Size * sizeof(float));
 	}
 
 	void VulkanVertexBuffer::RTBind(const VulkanVertexBindInfo& info) {
@@ -23,22 +21,34 @@ namespace Lucy {
 		vkCmdBindVertexBuffers(info.CommandBuffer, 0, 1, &m_BufferHandle, offset);
 	}
 
+	void VulkanVertexBuffer::RTWriteToStaging(const StagingWriteFunc& func) {
+		LUCY_ASSERT(!m_BufferHandle, "Vertex buffer has already been uploaded!");
+		RTAllocateStaging();
+		func((float*)m_Staging.MappedData, m_Size);
+	}
+
 	void VulkanVertexBuffer::RTLoadToDevice() {
 		VulkanAllocator& allocator = m_VulkanDevice->GetAllocator();
+		RTAllocateStaging();
 
-		void* data;
-		allocator.MapMemory(m_StagingBufferVma, data);
-		memcpy(data, m_Data.data(), m_Data.size() * sizeof(float));
-		allocator.UnmapMemory(m_StagingBufferVma);
+		//only needed, if the data has been set through the CPU-side buffer (Resize/SetData)
+		if (!m_Data.empty()) {
+			LUCY_ASSERT(m_Data.size() <= m_Size, "Vertex data exceeds the size of the vertex buffer!");
+			memcpy(m_Staging.MappedData, m_Data.data(), m_Data.size() * sizeof(float));
+		}
 
-		allocator.CreateVulkanBufferVma(VulkanBufferUsage::GPUOnly, m_Data.size() * sizeof(float),
+		allocator.CreateVulkanBufferVma(VulkanBufferUsage::GPUOnly, m_Size * sizeof(float),
 										VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, m_BufferHandle, m_BufferVma);
-		Renderer::RTDirectCopyBuffer(m_StagingBufferHandle, m_BufferHandle, m_Data.size() * sizeof(float));
-
-		allocator.DestroyBuffer(m_StagingBufferHandle, m_StagingBufferVma);
+		//recorded with the uploads of the next frame, the staging range is reclaimed once that frame has been completed
+		m_VulkanDevice->GetStagingRing().EnqueueBufferCopy(m_Staging, m_BufferHandle);
+		m_Staging = {};
 	}
 
 	void VulkanVertexBuffer::RTDestroyResource() {
+		//never uploaded
+		m_VulkanDevice->GetStagingRing().Free(m_Staging);
+		m_Staging = {};
+
 		VulkanAllocator& allocator = m_VulkanDevice->GetAllocator();
 		allocator.DestroyBuffer(m_BufferHandle, m_BufferVma);
 	}
@@ -5,6 +5,8 @@
 #include "vulkan/vulkan.h"
 #include "vma/vk_mem_alloc.h"
 
+#include "Renderer/Memory/VulkanStagingRing.h"
+
 namespace Lucy {
 
 	struct VulkanVertexBindInfo {
@@ -17,17 +19,18 @@ namespace Lucy {
 		virtual ~VulkanVertexBuffer() = default;
 
 		void RTBind(const VulkanVertexBindInfo& info);
+		void RTWriteToStaging(const StagingWriteFunc& func) final override;
 		void RTLoadToDevice() final override;
 	private:
 		void RTDestroyResource() final override;
-		void RTCreate(size_t size);
+		void RTAllocateStaging();
 
-		VkBuffer m_StagingBufferHandle = VK_NULL_HANDLE;
 		VkBuffer m_BufferHandle = VK_NULL_HANDLE;
-
-		VmaAllocation m_StagingBufferVma = VK_NULL_HANDLE;
 		VmaAllocation m_BufferVma = VK_NULL_HANDLE;
 
+		//from the staging ring, until the copy has been enqueued
+		StagingAllocation m_Staging;
+
 		Ref<VulkanRenderDevice> m_VulkanDevice = nullptr;
 	};
 }
\ No newline at end of file
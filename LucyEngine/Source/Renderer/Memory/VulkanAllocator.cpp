@@ -35,6 +35,20 @@ namespace Lucy {
 		vmaUnmapMemory(m_Allocator, allocation);
 	}
 
+	void VulkanAllocator::InvalidateMemory(VmaAllocation allocation, VkDeviceSize offset, VkDeviceSize size) {
+		vmaInvalidateAllocation(m_Allocator, allocation, offset, size);
+	}
+
+	void VulkanAllocator::FlushMemory(VmaAllocation allocation, VkDeviceSize offset, VkDeviceSize size) {
+		vmaFlushAllocation(m_Allocator, allocation, offset, size);
+	}
+
+	void* VulkanAllocator::GetMappedData(VmaAllocation allocation) {
+		VmaAllocationInfo allocationInfo;
+		vmaGetAllocationInfo(m_Allocator, allocation, &allocationInfo);
+		return allocationInfo.pMappedData;
+	}
+
 	void VulkanAllocator::DestroyBuffer(VkBuffer buffer, VmaAllocation allocation) {
 		vmaDestroyBuffer(m_Allocator, buffer, allocation);
 	}
@@ -97,6 +111,10 @@ namespace Lucy {
 				vmaCreateInfo.usage = VMA_MEMORY_USAGE_CPU_ONLY;
 				vmaCreateInfo.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT;
 				break;
+			case VulkanBufferUsage::CPUOnlyMapped:
+				vmaCreateInfo.usage = VMA_MEMORY_USAGE_CPU_ONLY;
+				vmaCreateInfo.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT;
+				break;
 			case VulkanBufferUsage::GPUOnly:
 				vmaCreateInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
 				//vmaCreateInfo.flags = VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT;
@@ -15,6 +15,12 @@ namespace Lucy {
 		* Resides on the CPU Ram
 		*/
 		CPUOnly,
+
+		/*
+		* Same as CPUOnly, but the buffer stays mapped for its whole lifetime (see GetMappedData).
+		* For buffers that are written every frame
+		*/
+		CPUOnlyMapped,
 		
 		/*
 		* Any resources that you frequently write and read on GPU, e.g. images used as color attachments (aka "render targets"), 
@@ -39,6 +45,12 @@ namespace Lucy {
 
 		void MapMemory(VmaAllocation allocation, void*& mappedData);
 		void UnmapMemory(VmaAllocation allocation);
+		//makes GPU writes visible to the CPU, no-op for host coherent memory
+		void InvalidateMemory(VmaAllocation allocation, VkDeviceSize offset, VkDeviceSize size);
+		//makes CPU writes visible to the GPU, no-op for host coherent memory
+		void FlushMemory(VmaAllocation allocation, VkDeviceSize offset, VkDeviceSize size);
+		//for allocations that have been created with VulkanBufferUsage::CPUOnlyMapped
+		void* GetMappedData(VmaAllocation allocation);
 
 		void DestroyBuffer(VkBuffer buffer, VmaAllocation allocation);
 		void DestroyImage(VkImage buffer, VmaAllocation allocation);
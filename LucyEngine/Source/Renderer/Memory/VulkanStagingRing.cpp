@@ -0,0 +1,275 @@
+#include "lypch.h"
+#include "VulkanStagingRing.h"
+
+#include "VulkanAllocator.h"
+#include "Renderer/Renderer.h"
+
+namespace Lucy {
+
+	void VulkanStagingRing::Init(VulkanAllocator& allocator, VkDevice logicalDevice, VkQueue transferQueue, uint32_t graphicsFamily, uint32_t transferFamily) {
+		m_Allocator = &allocator;
+		InitRing();
+
+		m_LogicalDevice = logicalDevice;
+		m_GraphicsFamily = graphicsFamily;
+		m_TransferFamily = transferFamily;
+
+		//the device falls back to the graphics family, the copies are recorded into the frame's command buffer
+		if (graphicsFamily == transferFamily)
+			return;
+
+		m_TransferQueue = transferQueue;
+
+		VkCommandPoolCreateInfo commandPoolCreateInfo = VulkanAPI::CommandPoolCreateInfo(VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT, transferFamily);
+		LUCY_VK_ASSERT(vkCreateCommandPool(m_LogicalDevice, &commandPoolCreateInfo, nullptr, &m_TransferCommandPool));
+
+		VkSemaphoreTypeCreateInfo semaphoreTypeCreateInfo{};
+		semaphoreTypeCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+		semaphoreTypeCreateInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+		semaphoreTypeCreateInfo.initialValue = m_TransferSemaphoreValue;
+
+		VkSemaphoreCreateInfo semaphoreCreateInfo = VulkanAPI::SemaphoreCreateInfo();
+		semaphoreCreateInfo.pNext = &semaphoreTypeCreateInfo;
+		LUCY_VK_ASSERT(vkCreateSemaphore(m_LogicalDevice, &semaphoreCreateInfo, nullptr, &m_TransferSemaphore));
+	}
+
+	void VulkanStagingRing::InitRing() {
+		CreateStagingBuffer(m_RingSize, m_Buffer, m_BufferVma, m_MappedData);
+	}
+
+	void VulkanStagingRing::CreateStagingBuffer(VkDeviceSize size, VkBuffer& buffer, VmaAllocation& bufferVma, uint8_t*& mappedData) {
+		m_Allocator->CreateVulkanBufferVma(VulkanBufferUsage::CPUOnly, size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, buffer, bufferVma);
+
+		void* data = nullptr;
+		m_Allocator->MapMemory(bufferVma, data);
+		mappedData = (uint8_t*)data;
+	}
+
+	void VulkanStagingRing::DestroyStagingBuffer(VkBuffer buffer, VmaAllocation bufferVma) {
+		m_Allocator->UnmapMemory(bufferVma);
+		m_Allocator->DestroyBuffer(buffer, bufferVma);
+	}
+
+	StagingAllocation VulkanStagingRing::Allocate(VkDeviceSize size, VkDeviceSize alignment) {
+		LUCY_PROFILE_NEW_EVENT("VulkanStagingRing::Allocate");
+
+		std::scoped_lock lock(m_Mutex);
+		Reclaim();
+
+		//rather than holding the ring for a long time (or stalling until it drains)
+		if (size == 0 || size > m_RingSize / 2)
+			return AllocateDedicated(size);
+
+		VkDeviceSize offset = (m_Head + alignment - 1) / alignment * alignment;
+		if (m_Ranges.empty()) {
+			m_Head = m_Tail = 0;
+			offset = 0;
+		} else if (m_Head == m_Tail) {
+			return AllocateDedicated(size);
+		} else if (m_Head > m_Tail) {
+			//free are [head, end) and [0, tail)
+			if (offset + size > m_RingSize) {
+				if (size > m_Tail)
+					return AllocateDedicated(size);
+				offset = 0;
+			}
+		} else if (offset + size > m_Tail) {
+			//free is [head, tail)
+			return AllocateDedicated(size);
+		}
+
+		m_Head = offset + size;
+		m_Ranges.push_back(Range{ .End = m_Head, .ID = ++m_LastID });
+
+		return StagingAllocation{
+			.Buffer = m_Buffer,
+			.Offset = offset,
+			.Size = size,
+			.MappedData = m_MappedData + offset,
+			.ID = m_LastID
+		};
+	}
+
+	StagingAllocation VulkanStagingRing::AllocateDedicated(VkDeviceSize size) {
+		StagingAllocation allocation{ .Size = size };
+		CreateStagingBuffer(glm::max(size, (VkDeviceSize)1), allocation.Buffer, allocation.DedicatedBufferVma, allocation.MappedData);
+		return allocation;
+	}
+
+	void VulkanStagingRing::EnqueueBufferCopy(const StagingAllocation& allocation, VkBuffer dstBuffer, VkDeviceSize dstOffset) {
+		LUCY_ASSERT(allocation.IsValid(), "Staging allocation is invalid!");
+
+		std::scoped_lock lock(m_Mutex);
+		m_PendingCopies.push_back(PendingCopy{ .Allocation = allocation, .DstBuffer = dstBuffer, .DstOffset = dstOffset });
+	}
+
+	void VulkanStagingRing::RTRetire(const StagingAllocation& allocation) {
+		if (!allocation.IsValid())
+			return;
+
+		//the allocation is in use, until the frame has been completed
+		Renderer::EnqueueDeletion([this, allocation]() {
+			Free(allocation);
+		});
+	}
+
+	void VulkanStagingRing::Free(const StagingAllocation& allocation) {
+		if (!allocation.IsValid())
+			return;
+
+		if (allocation.DedicatedBufferVma) {
+			DestroyStagingBuffer(allocation.Buffer, allocation.DedicatedBufferVma);
+			return;
+		}
+
+		std::scoped_lock lock(m_Mutex);
+		//the ring has been destroyed already (shutdown)
+		if (!m_Buffer)
+			return;
+		MarkCompleted(allocation.ID);
+	}
+
+	bool VulkanStagingRing::HasPendingCopies() {
+		std::scoped_lock lock(m_Mutex);
+		return !m_PendingCopies.empty();
+	}
+
+	void VulkanStagingRing::RTRecordPendingCopies(VkCommandBuffer commandBuffer) {
+		LUCY_PROFILE_NEW_EVENT("VulkanStagingRing::RTRecordPendingCopies");
+
+		std::vector<PendingCopy> pendingCopies;
+		{
+			std::scoped_lock lock(m_Mutex);
+			pendingCopies.swap(m_PendingCopies);
+		}
+
+		if (pendingCopies.empty())
+			return;
+
+		if (UsesTransferQueue()) {
+			RTSubmitTransferCopies(commandBuffer, pendingCopies);
+		} else {
+			for (const PendingCopy& copy : pendingCopies) {
+				VkBufferCopy copyRegion = VulkanAPI::BufferCopy(copy.Allocation.Offset, copy.DstOffset, copy.Allocation.Size);
+				vkCmdCopyBuffer(commandBuffer, copy.Allocation.Buffer, copy.DstBuffer, 1, &copyRegion);
+			}
+
+			VkMemoryBarrier barrier{};
+			barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+			barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			barrier.dstAccessMask = s_DstAccessMask;
+			vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, s_DstStageMask, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+		}
+
+		//the graphics submission of the frame waits on the transfer submission, the frame's fence covers both
+		for (const PendingCopy& copy : pendingCopies)
+			RTRetire(copy.Allocation);
+	}
+
+	void VulkanStagingRing::RTSubmitTransferCopies(VkCommandBuffer commandBuffer, const std::vector<PendingCopy>& pendingCopies) {
+		LUCY_PROFILE_NEW_EVENT("VulkanStagingRing::RTSubmitTransferCopies");
+
+		if (m_TransferCommandBuffers.empty()) {
+			m_TransferCommandBuffers.resize(Renderer::GetMaxFramesInFlight(), VK_NULL_HANDLE);
+
+			VkCommandBufferAllocateInfo allocInfo = VulkanAPI::CommandBufferAllocateInfo(m_TransferCommandPool, VK_COMMAND_BUFFER_LEVEL_PRIMARY, (uint32_t)m_TransferCommandBuffers.size());
+			LUCY_VK_ASSERT(vkAllocateCommandBuffers(m_LogicalDevice, &allocInfo, m_TransferCommandBuffers.data()));
+		}
+
+		//the frame's fence has been waited on, so has the previous transfer submission of this frame index (the graphics submission waited on it)
+		VkCommandBuffer transferCommandBuffer = m_TransferCommandBuffers[Renderer::GetCurrentFrameIndex()];
+		LUCY_VK_ASSERT(vkResetCommandBuffer(transferCommandBuffer, 0));
+
+		VkCommandBufferBeginInfo beginInfo = VulkanAPI::CommandBufferBeginInfo(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+		LUCY_VK_ASSERT(vkBeginCommandBuffer(transferCommandBuffer, &beginInfo));
+
+		//the destination ranges are overwritten, there is no need to release them from the graphics family first
+		std::vector<VkBufferMemoryBarrier> ownershipBarriers;
+		ownershipBarriers.reserve(pendingCopies.size());
+
+		for (const PendingCopy& copy : pendingCopies) {
+			VkBufferCopy copyRegion = VulkanAPI::BufferCopy(copy.Allocation.Offset, copy.DstOffset, copy.Allocation.Size);
+			vkCmdCopyBuffer(transferCommandBuffer, copy.Allocation.Buffer, copy.DstBuffer, 1, &copyRegion);
+
+			ownershipBarriers.push_back(VulkanAPI::BufferMemoryBarrier(copy.DstBuffer, copy.DstOffset, copy.Allocation.Size,
+				VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_NONE_KHR, m_TransferFamily, m_GraphicsFamily));
+		}
+
+		//release
+		vkCmdPipelineBarrier(transferCommandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0,
+							 0, nullptr, (uint32_t)ownershipBarriers.size(), ownershipBarriers.data(), 0, nullptr);
+		LUCY_VK_ASSERT(vkEndCommandBuffer(transferCommandBuffer));
+
+		uint64_t signalValue = ++m_TransferSemaphoreValue;
+
+		VkTimelineSemaphoreSubmitInfo timelineSubmitInfo{};
+		timelineSubmitInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+		timelineSubmitInfo.signalSemaphoreValueCount = 1;
+		timelineSubmitInfo.pSignalSemaphoreValues = &signalValue;
+
+		VkSubmitInfo submitInfo = VulkanAPI::QueueSubmitInfo(1, &transferCommandBuffer, 0, nullptr, nullptr, 1, &m_TransferSemaphore);
+		submitInfo.pNext = &timelineSubmitInfo;
+		LUCY_VK_ASSERT(vkQueueSubmit(m_TransferQueue, 1, &submitInfo, VK_NULL_HANDLE));
+
+		//acquire, the graphics submission waits on the timeline value at the same stages
+		for (VkBufferMemoryBarrier& barrier : ownershipBarriers) {
+			barrier.srcAccessMask = VK_ACCESS_NONE_KHR;
+			barrier.dstAccessMask = s_DstAccessMask;
+		}
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, s_DstStageMask, 0,
+							 0, nullptr, (uint32_t)ownershipBarriers.size(), ownershipBarriers.data(), 0, nullptr);
+
+		m_PendingTransferWaitValue = signalValue;
+	}
+
+	bool VulkanStagingRing::RTConsumeTransferWait(VkSemaphore& semaphore, uint64_t& value) {
+		if (m_PendingTransferWaitValue == 0)
+			return false;
+
+		semaphore = m_TransferSemaphore;
+		value = m_PendingTransferWaitValue;
+		m_PendingTransferWaitValue = 0;
+		return true;
+	}
+
+	void VulkanStagingRing::MarkCompleted(uint64_t id) {
+		//the ranges are ordered by their ID
+		auto it = std::ranges::lower_bound(m_Ranges, id, {}, &Range::ID);
+		LUCY_ASSERT(it != m_Ranges.end() && it->ID == id, "Staging range {0} has already been reclaimed!", id);
+		it->IsCompleted = true;
+	}
+
+	void VulkanStagingRing::Reclaim() {
+		//in order, a range that is still in use keeps the ones after it
+		while (!m_Ranges.empty() && m_Ranges.front().IsCompleted) {
+			m_Tail = m_Ranges.front().End;
+			m_Ranges.pop_front();
+		}
+
+		if (m_Ranges.empty())
+			m_Head = m_Tail = 0;
+	}
+
+	void VulkanStagingRing::Destroy() {
+		//the pending copies are never recorded, their dedicated buffers are destroyed with them
+		for (const PendingCopy& copy : m_PendingCopies) {
+			if (copy.Allocation.DedicatedBufferVma)
+				Free(copy.Allocation);
+		}
+		m_PendingCopies.clear();
+		m_Ranges.clear();
+
+		DestroyStagingBuffer(m_Buffer, m_BufferVma);
+		m_Buffer = VK_NULL_HANDLE;
+		m_MappedData = nullptr;
+
+		if (!UsesTransferQueue())
+			return;
+
+		//the command buffers are freed with their pool
+		vkDestroyCommandPool(m_LogicalDevice, m_TransferCommandPool, nullptr);
+		vkDestroySemaphore(m_LogicalDevice, m_TransferSemaphore, nullptr);
+		m_TransferCommandBuffers.clear();
+		m_TransferQueue = VK_NULL_HANDLE;
+	}
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <deque>
+#include <mutex>
+
+#include "vulkan/vulkan.h"
+#include "vma/vk_mem_alloc.h"
+
+namespace Lucy {
+
+	class VulkanAllocator;
+
+	struct StagingAllocation {
+		VkBuffer Buffer = VK_NULL_HANDLE;
+		VkDeviceSize Offset = 0;
+		VkDeviceSize Size = 0;
+		uint8_t* MappedData = nullptr;
+
+		uint64_t ID = 0; //of the ring range, 0 for a dedicated buffer
+		VmaAllocation DedicatedBufferVma = VK_NULL_HANDLE; //if the allocation didn't fit into the ring
+
+		inline bool IsValid() const { return MappedData != nullptr; }
+	};
+
+	/*
+	* A persistently mapped staging buffer, that is allocated from front to back and wraps around.
+	* The ranges are reclaimed in allocation order, once the frame that has copied them has been completed (see Renderer::EnqueueDeletion).
+	* Allocations, that don't fit into the ring, get a dedicated staging buffer, that is destroyed the same way.
+	* Buffer copies are collected and recorded at the beginning of the frame's command buffer, instead of an immediate submit per buffer.
+	* With a dedicated transfer queue family, the copies are submitted to the transfer queue instead. The buffers are released to the graphics family there,
+	* acquired at the beginning of the frame's command buffer and the graphics submission waits on the timeline semaphore value of the copies.
+	*/
+	class VulkanStagingRing {
+	public:
+		VulkanStagingRing(VkDeviceSize ringSize = s_RingSize)
+			: m_RingSize(ringSize) {
+		}
+		virtual ~VulkanStagingRing() = default;
+
+		StagingAllocation Allocate(VkDeviceSize size, VkDeviceSize alignment = s_DefaultAlignment);
+
+		//the copy is recorded with the next frame, the allocation is retired with it
+		void EnqueueBufferCopy(const StagingAllocation& allocation, VkBuffer dstBuffer, VkDeviceSize dstOffset = 0);
+		//for allocations, that have been copied by the caller (e.g. into an image) in the current frame
+		void RTRetire(const StagingAllocation& allocation);
+		//for allocations, that have never been copied
+		void Free(const StagingAllocation& allocation);
+
+		bool HasPendingCopies();
+		//records every pending copy and a single barrier for the vertex input, index and shader reads of the frame
+		//or submits them to the transfer queue and records the ownership acquires into the frame's command buffer
+		void RTRecordPendingCopies(VkCommandBuffer commandBuffer);
+		//the timeline semaphore value, that the next graphics submission has to wait on (once), false if there is nothing to wait on
+		bool RTConsumeTransferWait(VkSemaphore& semaphore, uint64_t& value);
+
+		inline bool UsesTransferQueue() const { return m_TransferQueue != VK_NULL_HANDLE; }
+		inline VkDeviceSize GetRingSize() const { return m_RingSize; }
+
+		static constexpr VkDeviceSize s_DefaultAlignment = 16;
+		static constexpr VkDeviceSize s_RingSize = 64 * 1024 * 1024;
+
+		//vertex, index, indirect and storage buffers are read by every pass of the frame
+		static constexpr VkAccessFlags s_DstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_INDIRECT_COMMAND_READ_BIT |
+			VK_ACCESS_UNIFORM_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+		static constexpr VkPipelineStageFlags s_DstStageMask = VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT |
+			VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+	protected:
+		//creates and maps the ring buffer
+		void InitRing();
+	private:
+		//the transfer queue is only used, if its family differs from the graphics family (a single family, e.g. lavapipe, records into the frame)
+		void Init(VulkanAllocator& allocator, VkDevice logicalDevice, VkQueue transferQueue, uint32_t graphicsFamily, uint32_t transferFamily);
+		void Destroy();
+
+		//creates and maps a CPU only transfer source buffer (replaced by the tests, so that the ring works without a device)
+		virtual void CreateStagingBuffer(VkDeviceSize size, VkBuffer& buffer, VmaAllocation& bufferVma, uint8_t*& mappedData);
+		virtual void DestroyStagingBuffer(VkBuffer buffer, VmaAllocation bufferVma);
+
+		StagingAllocation AllocateDedicated(VkDeviceSize size);
+		//expects the mutex to be locked
+		void MarkCompleted(uint64_t id);
+		void Reclaim();
+
+		struct Range {
+			VkDeviceSize End = 0; //the range begins at the end of the previous one (including the alignment and wrap around padding)
+			uint64_t ID = 0;
+			bool IsCompleted = false;
+		};
+
+		struct PendingCopy {
+			StagingAllocation Allocation;
+			VkBuffer DstBuffer = VK_NULL_HANDLE;
+			VkDeviceSize DstOffset = 0;
+		};
+
+		void RTSubmitTransferCopies(VkCommandBuffer commandBuffer, const std::vector<PendingCopy>& pendingCopies);
+
+		VkBuffer m_Buffer = VK_NULL_HANDLE;
+		VmaAllocation m_BufferVma = VK_NULL_HANDLE;
+		uint8_t* m_MappedData = nullptr;
+		VkDeviceSize m_RingSize = s_RingSize;
+
+		VkDeviceSize m_Head = 0;
+		VkDeviceSize m_Tail = 0;
+		std::deque<Range> m_Ranges;
+		uint64_t m_LastID = 0;
+
+		std::vector<PendingCopy> m_PendingCopies;
+
+		VkDevice m_LogicalDevice = VK_NULL_HANDLE;
+		VkQueue m_TransferQueue = VK_NULL_HANDLE;
+		uint32_t m_GraphicsFamily = UINT32_MAX;
+		uint32_t m_TransferFamily = UINT32_MAX;
+
+		VkCommandPool m_TransferCommandPool = VK_NULL_HANDLE;
+		std::vector<VkCommandBuffer> m_TransferCommandBuffers; //per frame in flight, allocated with the first copies
+		VkSemaphore m_TransferSemaphore = VK_NULL_HANDLE; //timeline
+		uint64_t m_TransferSemaphoreValue = 0;
+		uint64_t m_PendingTransferWaitValue = 0;
+
+		VulkanAllocator* m_Allocator = nullptr;
+		std::mutex m_Mutex;
+
+		friend class VulkanRenderDevice;
+	};
+}
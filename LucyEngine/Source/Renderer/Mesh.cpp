@@ -8,9 +8,12 @@
 #include "Memory/Buffer/IndexBuffer.h"
 
 #include "Renderer.h"
+#include "MeshOptimizer.h"
 
 #include "Core/Timer.h"
 
+#include <xmmintrin.h>
+
 namespace Lucy {
 
 	constexpr static uint32_t ASSIMP_FLAGS = aiProcess_CalcTangentSpace |
@@ -18,7 +21,7 @@ namespace Lucy {
 		aiProcess_FixInfacingNormals |
 		aiProcess_FlipUVs |
 		aiProcess_JoinIdenticalVertices |
-		aiProcess_ImproveCacheLocality |
+		//aiProcess_ImproveCacheLocality | (done by the MeshOptimizer after the import)
 		aiProcess_LimitBoneWeights |
 		aiProcess_RemoveRedundantMaterials |
 		aiProcess_ValidateDataStructure |
@@ -27,6 +30,78 @@ namespace Lucy {
 		aiProcess_SplitLargeMeshes |
 		aiProcess_OptimizeMeshes;
 
+	/*
+	* Matches the vertex input layout of the shaders:
+	* position(3), mesh id(3), uv(2), normal(3), tangent(3), bitangent(3)
+	*/
+	struct InterleavedVertex {
+		glm::vec3 Position;
+		glm::vec3 MeshID;
+		glm::vec2 TextureCoords;
+		glm::vec3 Normal;
+		glm::vec3 Tangent;
+		glm::vec3 BiTangent;
+	};
+
+	static constexpr uint32_t INTERLEAVED_VERTEX_FLOAT_COUNT = Mesh::s_InterleavedVertexFloatCount;
+	static_assert(sizeof(InterleavedVertex) == INTERLEAVED_VERTEX_FLOAT_COUNT * sizeof(float), "InterleavedVertex must be tightly packed!");
+
+	//the vertex is assembled on the stack and then streamed out with four unaligned 128-bit stores (+ one scalar),
+	//so that the (write-combined) staging memory is only ever written sequentially and never read from.
+	static inline void StreamVertex(InterleavedVertex* dst, const InterleavedVertex& vertex) {
+		const float* src = (const float*)&vertex;
+		float* out = (float*)dst;
+
+		_mm_storeu_ps(out + 0, _mm_loadu_ps(src + 0));
+		_mm_storeu_ps(out + 4, _mm_loadu_ps(src + 4));
+		_mm_storeu_ps(out + 8, _mm_loadu_ps(src + 8));
+		_mm_storeu_ps(out + 12, _mm_loadu_ps(src + 12));
+		out[16] = src[16];
+	}
+
+	static InterleavedVertex* InterleaveSubmesh(const Submesh& submesh, const glm::vec3& meshID, InterleavedVertex* dst) {
+		//missing attributes are resolved once per submesh instead of once per vertex
+		const glm::vec3* positions = submesh.Vertices.data();
+		const glm::vec2* textureCoords = submesh.TextureCoords.empty() ? nullptr : submesh.TextureCoords.data();
+		const glm::vec3* normals = submesh.Normals.empty() ? nullptr : submesh.Normals.data();
+		const glm::vec3* tangents = submesh.Tangents.empty() ? nullptr : submesh.Tangents.data();
+		const glm::vec3* biTangents = submesh.BiTangents.empty() ? nullptr : submesh.BiTangents.data();
+
+		InterleavedVertex vertex;
+		vertex.MeshID = meshID;
+		vertex.TextureCoords = glm::vec2(0.0f);
+		vertex.Normal = glm::vec3(0.0f);
+		vertex.Tangent = glm::vec3(0.0f);
+		vertex.BiTangent = glm::vec3(0.0f);
+
+		for (uint32_t i = 0; i < submesh.VertexCount; i++) {
+			vertex.Position = positions[i];
+			if (textureCoords)
+				vertex.TextureCoords = textureCoords[i];
+			if (normals)
+				vertex.Normal = normals[i];
+			if (tangents)
+				vertex.Tangent = tangents[i];
+			if (biTangents)
+				vertex.BiTangent = biTangents[i];
+
+			StreamVertex(dst++, vertex);
+		}
+		return dst;
+	}
+
+	static void ComputeBounds(Submesh& submesh) {
+		if (submesh.Vertices.empty())
+			return;
+
+		Maths::AABB& boundingBox = submesh.BoundingBox;
+		for (const glm::vec3& position : submesh.Vertices)
+			boundingBox.Expand(position);
+
+		submesh.BoundsCenter = boundingBox.GetCenter();
+		submesh.BoundsRadius = glm::length(boundingBox.GetExtents());
+	}
+
 	static void IncreaseMeshCount(Mesh* m) {
 		if (MESH_ID_COUNT_X <= 255) {
 			MESH_ID_COUNT_X++;
@@ -70,7 +145,9 @@ namespace Lucy {
 		const auto& vertexBuffer = Renderer::AccessResource<VertexBuffer>(m_VertexBufferHandle);
 		const auto& indexBuffer = Renderer::AccessResource<IndexBuffer>(m_IndexBufferHandle);
 
-		vertexBuffer->SetData(vertices);
+		vertexBuffer->RTWriteToStaging([&](float* mappedData, size_t size) {
+			memcpy(mappedData, vertices.data(), size * sizeof(float));
+		});
 		indexBuffer->SetData(indices);
 
 		vertexBuffer->RTLoadToDevice();
@@ -96,14 +173,75 @@ namespace Lucy {
 
 		IncreaseMeshCount(this);
 
+		{
+			ScopedTimer optimizeTimer(std::format("{0} vertex cache optimization", m_Name));
+			//of the whole mesh, the ACMR is weighted by the triangles and the ATVR by the vertices of the submeshes
+			VertexCacheStatistics before, after;
+			size_t triangleCount = 0, vertexCount = 0;
+			for (Submesh& submesh : m_Submeshes) {
+				const size_t submeshTriangleCount = submesh.Faces.size() / 3;
+				const VertexCacheStatistics submeshBefore = MeshOptimizer::AnalyzeVertexCache(submesh.Faces, submesh.VertexCount, MESH_VERTEX_CACHE_SIZE);
+				MeshOptimizer::Optimize(submesh);
+				const VertexCacheStatistics submeshAfter = MeshOptimizer::AnalyzeVertexCache(submesh.Faces, submesh.VertexCount, MESH_VERTEX_CACHE_SIZE);
+
+				before.ACMR += submeshBefore.ACMR * submeshTriangleCount;
+				after.ACMR += submeshAfter.ACMR * submeshTriangleCount;
+				before.ATVR += submeshBefore.ATVR * submesh.VertexCount;
+				after.ATVR += submeshAfter.ATVR * submesh.VertexCount;
+				triangleCount += submeshTriangleCount;
+				vertexCount += submesh.VertexCount;
+			}
+
+			if (triangleCount > 0 && vertexCount > 0) {
+				LUCY_INFO("{0}: ACMR {1:.3f} -> {2:.3f}, ATVR {3:.3f} -> {4:.3f} ({5} submeshes, {6}-entry FIFO)", m_Name,
+						  before.ACMR / triangleCount, after.ACMR / triangleCount, before.ATVR / vertexCount, after.ATVR / vertexCount,
+						  m_Submeshes.size(), MESH_VERTEX_CACHE_SIZE);
+			}
+		}
+
+		for (Submesh& submesh : m_Submeshes) {
+			ComputeBounds(submesh);
+			if (submesh.BoundingBox.IsValid())
+				m_BoundingBox.Expand(Maths::TransformAABB(submesh.BoundingBox, submesh.Transform));
+		}
+
+		{
+			ScopedTimer lodTimer(std::format("{0} LOD generation", m_Name));
+			for (Submesh& submesh : m_Submeshes)
+				MeshSimplifier::GenerateLODs(submesh);
+		}
+
+		{
+			ScopedTimer meshletTimer(std::format("{0} meshlet generation", m_Name));
+			for (Submesh& submesh : m_Submeshes)
+				MeshletBuilder::Build(submesh);
+		}
+
 		//Getting the size of the buffer
 		for (const Submesh& submesh : m_Submeshes) {
 			m_MetadataInfo.TotalIndicesSize += submesh.IndexCount;
 			m_MetadataInfo.TotalVerticesSize += submesh.VertexCount;
+			m_MetadataInfo.TotalMeshletCount += (uint32_t)submesh.Meshlets.size();
 		}
 
+		//LOD indices are placed after all of the LOD 0 indices, so that the LOD 0 layout stays the same
+		const uint32_t baseIndexCount = m_MetadataInfo.TotalIndicesSize;
+		uint32_t lodCount = 0;
+		float maxLODError = 0.0f;
+		for (Submesh& submesh : m_Submeshes) {
+			for (SubmeshLOD& lod : submesh.LODs) {
+				lod.BaseIndexCount = m_MetadataInfo.TotalIndicesSize;
+				m_MetadataInfo.TotalIndicesSize += lod.IndexCount;
+				maxLODError = glm::max(maxLODError, lod.Error);
+				lodCount++;
+			}
+		}
+		//a single line per mesh, scenes like sponza have hundreds of submeshes
+		LUCY_INFO("{0}: {1} LODs of {2} submeshes, {3} triangles (max error {4})", m_Name, lodCount, m_Submeshes.size(),
+				  (m_MetadataInfo.TotalIndicesSize - baseIndexCount) / 3, maxLODError);
+
 		Renderer::EnqueueToRenderCommandQueue([=](const Ref<RenderDevice>& device) {
-			m_VertexBufferHandle = device->CreateVertexBuffer(m_MetadataInfo.TotalVerticesSize * 17LL);
+			m_VertexBufferHandle = device->CreateVertexBuffer(m_MetadataInfo.TotalVerticesSize * (size_t)INTERLEAVED_VERTEX_FLOAT_COUNT);
 			m_IndexBufferHandle = device->CreateIndexBuffer(m_MetadataInfo.TotalIndicesSize);
 
 			const auto& vertexBuffer = Renderer::AccessResource<VertexBuffer>(m_VertexBufferHandle);
@@ -117,67 +255,30 @@ namespace Lucy {
 				from += faces.size();
 			}
 
-			from = 0;
-
-			for (Submesh& submesh : m_Submeshes) {
-				auto& submeshVertices = submesh.Vertices;
-				auto& submeshTextureCoords = submesh.TextureCoords;
-				auto& submeshNormals = submesh.Normals;
-				auto& submeshTangents = submesh.Tangents;
-				auto& submeshBiTangents = submesh.BiTangents;
-
-				for (uint32_t i = 0; i < submesh.VertexCount; i++) {
-
-					glm::vec2 textureCoords = { 0.0f, 0.0f };
-					if (!submeshTextureCoords.empty())
-						textureCoords = { submeshTextureCoords[i].x, submeshTextureCoords[i].y };
-
-					glm::vec3 normals = { 0.0f, 0.0f, 0.0f };
-					if (!submeshNormals.empty())
-						normals = { submeshNormals[i].x, submeshNormals[i].y, submeshNormals[i].z };
-
-					glm::vec3 tangents = { 0.0f, 0.0f, 0.0f };
-					if (!submeshTangents.empty())
-						tangents = { submeshTangents[i].x, submeshTangents[i].y, submeshTangents[i].z };
-
-					glm::vec3 biTangents = { 0.0f, 0.0f, 0.0f };
-					if (!submeshBiTangents.empty())
-						biTangents = { submeshBiTangents[i].x, submeshBiTangents[i].y, submeshBiTangents[i].z };
-
-					std::vector<float> vertex = {
-						submeshVertices[i].x,
-						submeshVertices[i].y,
-						submeshVertices[i].z,
-
-						(float)MESH_ID_COUNT_X,
-						(float)MESH_ID_COUNT_Y,
-						(float)MESH_ID_COUNT_Z,
-
-						textureCoords.x,
-						textureCoords.y,
-
-						normals.x,
-						normals.y,
-						normals.z,
-
-						tangents.x,
-						tangents.y,
-						tangents.z,
-
-						biTangents.x,
-						biTangents.y,
-						biTangents.z
-					};
-					vertexBuffer->SetData(vertex, from);
-					from += vertex.size();
+			for (const Submesh& submesh : m_Submeshes) {
+				for (const SubmeshLOD& lod : submesh.LODs) {
+					indexBuffer->SetData(lod.Faces, lod.BaseIndexCount);
 				}
 			}
-				
+
+			vertexBuffer->RTWriteToStaging([&](float* mappedData, size_t size) {
+				ScopedTimer interleaveTimer("Mesh vertex interleave", TimeUnit::Microseconds);
+				LUCY_ASSERT(size == m_MetadataInfo.TotalVerticesSize * (size_t)INTERLEAVED_VERTEX_FLOAT_COUNT);
+
+				InterleaveVertices(m_Submeshes, m_MeshID, mappedData);
+			});
+
 			vertexBuffer->RTLoadToDevice();
 			indexBuffer->RTLoadToDevice();
 		});
 	}
 
+	void Mesh::InterleaveVertices(const std::vector<Submesh>& submeshes, const glm::vec3& meshID, float* dst) {
+		InterleavedVertex* vertices = (InterleavedVertex*)dst;
+		for (const Submesh& submesh : submeshes)
+			vertices = InterleaveSubmesh(submesh, meshID, vertices);
+	}
+
 	void Mesh::LoadData(const aiScene* scene) {
 		ScopedTimer scopedTimer(std::format("{0} data parsing", m_Name));
 
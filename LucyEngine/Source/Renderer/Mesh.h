@@ -3,6 +3,7 @@
 #include "assimp/scene.h"
 
 #include "Material/Material.h"
+#include "MeshLOD.h"
 
 #include "Device/RenderResource.h"
 
@@ -18,19 +19,29 @@ namespace Lucy {
 		std::vector<glm::vec2> TextureCoords;
 
 		std::vector<uint32_t> Faces;
+		std::vector<Meshlet> Meshlets;
+		std::vector<SubmeshLOD> LODs; //LOD 1..n, LOD 0 is Faces/Meshlets
 		MaterialID MaterialID;
 
+		//bounding volumes in submesh space (without Transform)
+		Maths::AABB BoundingBox;
+		glm::vec3 BoundsCenter = glm::vec3(0.0f);
+		float BoundsRadius = 0.0f;
+
 		glm::mat4 Transform = glm::mat4(1.0f);
 
 		uint32_t VertexCount = 0;
 		uint32_t IndexCount = 0;
 		uint32_t BaseVertexCount = 0;
 		uint32_t BaseIndexCount = 0;
+
+		inline uint32_t GetLODCount() const { return 1u + (uint32_t)LODs.size(); }
 	};
 
 	struct MetadataInfo {
 		uint32_t TotalIndicesSize = 0;
 		uint32_t TotalVerticesSize = 0;
+		uint32_t TotalMeshletCount = 0;
 	};
 
 	static int32_t MESH_ID_COUNT_X = 0;
@@ -57,8 +68,15 @@ namespace Lucy {
 		inline RenderResourceHandle GetIndexBufferHandle() { return m_IndexBufferHandle; }
 
 		inline MetadataInfo GetMetadataInfo() const { return m_MetadataInfo; }
+		//in mesh space, contains every submesh with its transform
+		inline const Maths::AABB& GetBoundingBox() const { return m_BoundingBox; }
 
 		void Destroy();
+
+		//position(3), mesh id(3), uv(2), normal(3), tangent(3), bitangent(3)
+		static constexpr uint32_t s_InterleavedVertexFloatCount = 17u;
+		//writes the vertices of every submesh in order, dst needs room for s_InterleavedVertexFloatCount floats per vertex
+		static void InterleaveVertices(const std::vector<Submesh>& submeshes, const glm::vec3& meshID, float* dst);
 	private:
 		void Load(Ref<RenderDevice>& device, const std::vector<float>& vertices, const std::vector<uint32_t>& indices);
 		void Load();
@@ -75,6 +93,7 @@ namespace Lucy {
 
 		glm::vec3 m_MeshID = glm::vec3(-1.0f);
 		MetadataInfo m_MetadataInfo;
+		Maths::AABB m_BoundingBox;
 	private:
 		friend void IncreaseMeshCount(Mesh* m);
 	};
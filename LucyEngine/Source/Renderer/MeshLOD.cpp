@@ -0,0 +1,308 @@
+#include "lypch.h"
+#include "MeshLOD.h"
+
+#include "Mesh.h"
+
+namespace Lucy {
+
+	//LOD k is only generated when the simplifier stays below this error (relative to the submesh bounding radius)
+	static constexpr float s_LODTargetErrors[MESH_MAX_LOD_COUNT] = { 0.0f, 0.01f, 0.02f, 0.05f, 0.1f };
+	//LOD k is used when the screen size of the submesh drops below this threshold
+	static constexpr float s_LODScreenSizes[MESH_MAX_LOD_COUNT] = { FLT_MAX, 0.5f, 0.25f, 0.125f, 0.0625f };
+	static constexpr float s_LODHysteresis = 0.1f;
+
+	static constexpr size_t s_LODMinTriangleCount = 32;
+	//a LOD has to remove at least this many triangles of the previous one, otherwise the chain stops
+	static constexpr float s_LODMinReduction = 0.1f;
+
+	//symmetric 4x4 matrix (10 unique values) of the plane equations, evaluated as v^T * Q * v
+	struct Quadric {
+		double A00 = 0.0, A01 = 0.0, A02 = 0.0, A11 = 0.0, A12 = 0.0, A22 = 0.0;
+		double B0 = 0.0, B1 = 0.0, B2 = 0.0;
+		double C = 0.0;
+
+		void AddPlane(const glm::dvec3& n, double d) {
+			A00 += n.x * n.x; A01 += n.x * n.y; A02 += n.x * n.z;
+			A11 += n.y * n.y; A12 += n.y * n.z; A22 += n.z * n.z;
+			B0 += n.x * d; B1 += n.y * d; B2 += n.z * d;
+			C += d * d;
+		}
+
+		Quadric& operator+=(const Quadric& other) {
+			A00 += other.A00; A01 += other.A01; A02 += other.A02;
+			A11 += other.A11; A12 += other.A12; A22 += other.A22;
+			B0 += other.B0; B1 += other.B1; B2 += other.B2;
+			C += other.C;
+			return *this;
+		}
+
+		//sum of the squared distances to all accumulated planes
+		double Evaluate(const glm::vec3& point) const {
+			const double x = point.x, y = point.y, z = point.z;
+			const double result = x * x * A00 + y * y * A11 + z * z * A22 +
+				2.0 * (x * y * A01 + x * z * A02 + y * z * A12) +
+				2.0 * (x * B0 + y * B1 + z * B2) + C;
+			return glm::max(result, 0.0); //rounding
+		}
+	};
+
+	struct CollapseCandidate {
+		uint32_t From;
+		uint32_t To;
+		double Cost;
+	};
+
+	static uint64_t EdgeKey(uint32_t a, uint32_t b) {
+		if (a > b)
+			std::swap(a, b);
+		return ((uint64_t)a << 32) | b;
+	}
+
+	//vertices that were split by the importer (different normals/uvs at the same position) end up in the same group
+	static std::vector<uint32_t> BuildPositionRemap(const std::vector<glm::vec3>& positions) {
+		std::vector<uint32_t> sorted(positions.size());
+		std::iota(sorted.begin(), sorted.end(), 0u);
+		std::sort(sorted.begin(), sorted.end(), [&](uint32_t a, uint32_t b) {
+			const glm::vec3& pa = positions[a];
+			const glm::vec3& pb = positions[b];
+			if (pa.x != pb.x) return pa.x < pb.x;
+			if (pa.y != pb.y) return pa.y < pb.y;
+			if (pa.z != pb.z) return pa.z < pb.z;
+			return a < b;
+		});
+
+		std::vector<uint32_t> remap(positions.size());
+		for (size_t i = 0; i < sorted.size(); i++) {
+			const bool sameAsPrevious = i > 0 && positions[sorted[i]] == positions[sorted[i - 1]];
+			remap[sorted[i]] = sameAsPrevious ? remap[sorted[i - 1]] : sorted[i];
+		}
+		return remap;
+	}
+
+	float MeshSimplifier::Simplify(const std::vector<glm::vec3>& positions, const std::vector<uint32_t>& indices,
+								   size_t targetIndexCount, float targetError, std::vector<uint32_t>& outIndices) {
+		outIndices = indices;
+
+		const size_t vertexCount = positions.size();
+		if (vertexCount == 0 || indices.size() <= targetIndexCount)
+			return 0.0f;
+
+		std::vector<bool> locked(vertexCount, false);
+
+		const std::vector<uint32_t> positionRemap = BuildPositionRemap(positions);
+		for (uint32_t i = 0; i < vertexCount; i++) {
+			if (positionRemap[i] != i) {
+				locked[i] = true;
+				locked[positionRemap[i]] = true;
+			}
+		}
+
+		//edges that are used by only one triangle are on the border, edges with more than two are non-manifold
+		std::unordered_map<uint64_t, uint32_t> edgeUseCount;
+		edgeUseCount.reserve(indices.size());
+		for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+			for (uint32_t k = 0; k < 3; k++)
+				edgeUseCount[EdgeKey(positionRemap[indices[i + k]], positionRemap[indices[i + (k + 1) % 3]])]++;
+		}
+		for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+			for (uint32_t k = 0; k < 3; k++) {
+				const uint32_t a = indices[i + k];
+				const uint32_t b = indices[i + (k + 1) % 3];
+				if (edgeUseCount[EdgeKey(positionRemap[a], positionRemap[b])] != 2)
+					locked[a] = locked[b] = true;
+			}
+		}
+
+		std::vector<Quadric> quadrics(vertexCount);
+		for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+			const glm::dvec3 p0 = positions[indices[i + 0]];
+			const glm::dvec3 p1 = positions[indices[i + 1]];
+			const glm::dvec3 p2 = positions[indices[i + 2]];
+
+			glm::dvec3 normal = glm::cross(p1 - p0, p2 - p0);
+			const double length = glm::length(normal);
+			if (length <= DBL_EPSILON)
+				continue;
+			normal /= length;
+
+			Quadric plane;
+			plane.AddPlane(normal, -glm::dot(normal, p0));
+			for (uint32_t k = 0; k < 3; k++)
+				quadrics[indices[i + k]] += plane;
+		}
+
+		const double maxCost = (double)targetError * targetError;
+		double resultCost = 0.0;
+
+		std::vector<uint32_t> triangleOffsets(vertexCount + 1);
+		std::vector<uint32_t> vertexTriangles;
+		std::vector<CollapseCandidate> candidates;
+		std::vector<uint32_t> remap(vertexCount);
+		std::vector<bool> dirty(vertexCount);
+
+		//moving "from" onto "to" must not turn any of the remaining triangles around
+		const auto FlipsTriangle = [&](uint32_t from, uint32_t to) {
+			for (uint32_t t = triangleOffsets[from]; t < triangleOffsets[from + 1]; t++) {
+				const uint32_t* triangle = &outIndices[vertexTriangles[t] * 3];
+				if (triangle[0] == to || triangle[1] == to || triangle[2] == to)
+					continue; //collapses into a degenerate triangle and gets removed
+
+				glm::vec3 p[3], moved[3];
+				for (uint32_t k = 0; k < 3; k++) {
+					p[k] = positions[triangle[k]];
+					moved[k] = triangle[k] == from ? positions[to] : p[k];
+				}
+
+				const glm::vec3 before = glm::cross(p[1] - p[0], p[2] - p[0]);
+				const glm::vec3 after = glm::cross(moved[1] - moved[0], moved[2] - moved[0]);
+				if (glm::dot(before, after) <= 0.0f)
+					return true;
+			}
+			return false;
+		};
+
+		while (outIndices.size() > targetIndexCount) {
+			const uint32_t triangleCount = (uint32_t)(outIndices.size() / 3);
+
+			//vertex -> triangles adjacency of the current index list
+			std::fill(triangleOffsets.begin(), triangleOffsets.end(), 0u);
+			for (uint32_t index : outIndices)
+				triangleOffsets[index + 1]++;
+			for (size_t i = 0; i < vertexCount; i++)
+				triangleOffsets[i + 1] += triangleOffsets[i];
+			vertexTriangles.resize(outIndices.size());
+			{
+				std::vector<uint32_t> cursor(triangleOffsets.begin(), triangleOffsets.end() - 1);
+				for (uint32_t t = 0; t < triangleCount; t++) {
+					for (uint32_t k = 0; k < 3; k++)
+						vertexTriangles[cursor[outIndices[t * 3 + k]]++] = t;
+				}
+			}
+
+			candidates.clear();
+			for (uint32_t t = 0; t < triangleCount; t++) {
+				for (uint32_t k = 0; k < 3; k++) {
+					const uint32_t a = outIndices[t * 3 + k];
+					const uint32_t b = outIndices[t * 3 + (k + 1) % 3];
+					if (locked[a] && locked[b])
+						continue;
+
+					Quadric combined = quadrics[a];
+					combined += quadrics[b];
+
+					const double costAB = locked[a] ? DBL_MAX : combined.Evaluate(positions[b]);
+					const double costBA = locked[b] ? DBL_MAX : combined.Evaluate(positions[a]);
+					if (costAB <= costBA)
+						candidates.push_back({ a, b, costAB });
+					else
+						candidates.push_back({ b, a, costBA });
+				}
+			}
+			std::sort(candidates.begin(), candidates.end(), [](const CollapseCandidate& a, const CollapseCandidate& b) { return a.Cost < b.Cost; });
+
+			std::iota(remap.begin(), remap.end(), 0u);
+			std::fill(dirty.begin(), dirty.end(), false);
+
+			size_t removedIndexCount = 0;
+			uint32_t collapseCount = 0;
+
+			//one pass collapses every vertex at most once, the adjacency is rebuilt afterwards
+			for (const CollapseCandidate& candidate : candidates) {
+				if (candidate.Cost > maxCost || outIndices.size() - removedIndexCount <= targetIndexCount)
+					break;
+				if (dirty[candidate.From] || dirty[candidate.To])
+					continue;
+				if (FlipsTriangle(candidate.From, candidate.To))
+					continue;
+
+				for (uint32_t t = triangleOffsets[candidate.From]; t < triangleOffsets[candidate.From + 1]; t++) {
+					const uint32_t* triangle = &outIndices[vertexTriangles[t] * 3];
+					if (triangle[0] == candidate.To || triangle[1] == candidate.To || triangle[2] == candidate.To)
+						removedIndexCount += 3;
+					//the flip test above is only valid, as long as the neighbours stay where they are
+					for (uint32_t k = 0; k < 3; k++)
+						dirty[triangle[k]] = true;
+				}
+
+				remap[candidate.From] = candidate.To;
+				quadrics[candidate.To] += quadrics[candidate.From];
+				resultCost = glm::max(resultCost, candidate.Cost);
+				collapseCount++;
+			}
+
+			if (collapseCount == 0)
+				break;
+
+			size_t writeIndex = 0;
+			for (size_t i = 0; i < outIndices.size(); i += 3) {
+				const uint32_t a = remap[outIndices[i + 0]];
+				const uint32_t b = remap[outIndices[i + 1]];
+				const uint32_t c = remap[outIndices[i + 2]];
+				if (a == b || b == c || a == c)
+					continue;
+				outIndices[writeIndex++] = a;
+				outIndices[writeIndex++] = b;
+				outIndices[writeIndex++] = c;
+			}
+			outIndices.resize(writeIndex);
+		}
+
+		return (float)glm::sqrt(resultCost);
+	}
+
+	void MeshSimplifier::GenerateLODs(Submesh& submesh) {
+		submesh.LODs.clear();
+
+		if (submesh.Faces.size() / 3 < s_LODMinTriangleCount * 2 || submesh.BoundsRadius <= 0.0f)
+			return;
+
+		const std::vector<uint32_t>* previousFaces = &submesh.Faces;
+		for (uint32_t lod = 1; lod < MESH_MAX_LOD_COUNT; lod++) {
+			const size_t targetTriangleCount = (submesh.Faces.size() / 3) >> lod;
+			if (targetTriangleCount < s_LODMinTriangleCount)
+				break;
+
+			//every LOD is simplified from LOD 0, that way the error is measured against the original surface and doesn't accumulate
+			const float targetError = s_LODTargetErrors[lod] * submesh.BoundsRadius;
+
+			SubmeshLOD level;
+			const float error = Simplify(submesh.Vertices, submesh.Faces, targetTriangleCount * 3, targetError, level.Faces);
+			LUCY_ASSERT(error <= targetError, "Simplification error {0} exceeds the bound {1}", error, targetError);
+
+			//the error bound (or locked vertices) stopped the simplifier, the following LODs wouldn't get any further
+			if ((float)level.Faces.size() > (float)previousFaces->size() * (1.0f - s_LODMinReduction))
+				break;
+
+			level.IndexCount = (uint32_t)level.Faces.size();
+			level.Error = error / submesh.BoundsRadius;
+			MeshletBuilder::Build(submesh.Vertices, level.Faces, level.Meshlets);
+
+			submesh.LODs.push_back(std::move(level));
+			previousFaces = &submesh.LODs.back().Faces;
+		}
+	}
+
+	float LODSelector::ComputeScreenSize(const glm::vec3& center, float radius, const glm::vec3& cameraPosition, float projectionScaleY) {
+		const float distance = glm::length(center - cameraPosition);
+		if (distance <= radius)
+			return FLT_MAX;
+		return radius * glm::abs(projectionScaleY) / distance;
+	}
+
+	uint32_t LODSelector::Select(float screenSize, uint32_t currentLOD, uint32_t lodCount) {
+		if (lodCount <= 1)
+			return 0;
+
+		const uint32_t maxLOD = glm::min(lodCount, MESH_MAX_LOD_COUNT) - 1;
+		uint32_t lod = glm::min(currentLOD, maxLOD);
+
+		while (lod < maxLOD && screenSize < s_LODScreenSizes[lod + 1] * (1.0f - s_LODHysteresis))
+			lod++;
+		if (lod != currentLOD)
+			return lod;
+
+		while (lod > 0 && screenSize > s_LODScreenSizes[lod] * (1.0f + s_LODHysteresis))
+			lod--;
+		return lod;
+	}
+}
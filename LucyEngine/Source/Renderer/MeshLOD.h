@@ -0,0 +1,48 @@
+#pragma once
+
+#include "Meshlet.h"
+
+namespace Lucy {
+
+	struct Submesh;
+
+	//including LOD 0 (the imported geometry)
+	static inline constexpr const uint32_t MESH_MAX_LOD_COUNT = 5u;
+
+	/*
+	* A simplified version of a submesh.
+	* LODs share the vertices of the submesh, only the index data differs.
+	* The indices are placed after all LOD 0 indices in the shared index buffer of the mesh.
+	*/
+	struct SubmeshLOD {
+		std::vector<uint32_t> Faces;
+		std::vector<Meshlet> Meshlets;
+
+		uint32_t IndexCount = 0;
+		uint32_t BaseIndexCount = 0; //offset into the shared index buffer of the mesh
+
+		float Error = 0.0f; //upper bound of the geometric deviation, relative to the submesh bounding radius
+	};
+
+	class MeshSimplifier final {
+	public:
+		/*
+		* Quadric error metric edge collapse (Garland & Heckbert).
+		* Vertices are collapsed onto existing vertices, so the vertex data stays untouched and only the indices change.
+		* Border and attribute seam vertices are locked, which keeps the silhouette and the UV layout intact.
+		* Returns the error (in mesh units) of the result, which never exceeds targetError.
+		*/
+		static float Simplify(const std::vector<glm::vec3>& positions, const std::vector<uint32_t>& indices,
+							  size_t targetIndexCount, float targetError, std::vector<uint32_t>& outIndices);
+
+		static void GenerateLODs(Submesh& submesh);
+	};
+
+	class LODSelector final {
+	public:
+		//projected diameter of the sphere relative to the screen height (projectionScaleY = projection[1][1])
+		static float ComputeScreenSize(const glm::vec3& center, float radius, const glm::vec3& cameraPosition, float projectionScaleY);
+		//switches only when the screen size leaves the hysteresis band around a threshold, so the LOD doesn't flicker at the boundary
+		static uint32_t Select(float screenSize, uint32_t currentLOD, uint32_t lodCount);
+	};
+}
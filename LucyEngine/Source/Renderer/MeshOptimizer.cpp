@@ -0,0 +1,378 @@
+#include "lypch.h"
+#include "MeshOptimizer.h"
+
+#include "Mesh.h"
+
+namespace Lucy {
+
+	static constexpr uint32_t s_InvalidIndex = UINT32_MAX;
+
+	//Tom Forsyth, "Linear-Speed Vertex Cache Optimisation"
+	//the scores are tuned for a 32 entry LRU cache. This is deliberately not MESH_VERTEX_CACHE_SIZE, that the results are measured with:
+	//scoring with a 16 entry LRU gave a worse 16 entry FIFO ACMR on shuffled grids and spheres (0.718 instead of 0.670, 0.748 instead of 0.706)
+	static constexpr uint32_t s_ForsythCacheSize = 32;
+	static constexpr float s_ForsythCacheDecayPower = 1.5f;
+	static constexpr float s_ForsythLastTriangleScore = 0.75f;
+	static constexpr float s_ForsythValenceBoostScale = 2.0f;
+	static constexpr float s_ForsythValenceBoostPower = 0.5f;
+
+	static constexpr float s_OverdrawThreshold = 1.05f;
+
+	static float ForsythVertexScore(int32_t cachePosition, uint32_t remainingTriangles) {
+		if (remainingTriangles == 0)
+			return -1.0f;
+
+		float score = 0.0f;
+		if (cachePosition >= 0) {
+			//the vertices of the last triangle get a fixed score, so that it doesn't matter in which order they were added
+			if (cachePosition < 3) {
+				score = s_ForsythLastTriangleScore;
+			} else {
+				const float scaler = 1.0f / (float)(s_ForsythCacheSize - 3);
+				score = glm::pow(1.0f - (float)(cachePosition - 3) * scaler, s_ForsythCacheDecayPower);
+			}
+		}
+
+		//vertices with only a few triangles left are preferred, so that they don't get stranded
+		score += s_ForsythValenceBoostScale * glm::pow((float)remainingTriangles, -s_ForsythValenceBoostPower);
+		return score;
+	}
+
+#ifdef LUCY_DEBUG
+	//the triangle set must stay the same, only the order of the triangles (and the starting vertex within a triangle) may change
+	static bool IsSameTopology(const std::vector<uint32_t>& a, const std::vector<uint32_t>& b) {
+		if (a.size() != b.size())
+			return false;
+
+		const auto Canonicalize = [](const std::vector<uint32_t>& indices) {
+			std::vector<std::array<uint32_t, 3>> triangles;
+			triangles.reserve(indices.size() / 3);
+			for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+				std::array<uint32_t, 3> triangle = { indices[i + 0], indices[i + 1], indices[i + 2] };
+				//rotating keeps the winding
+				while (triangle[0] > triangle[1] || triangle[0] > triangle[2])
+					std::rotate(triangle.begin(), triangle.begin() + 1, triangle.end());
+				triangles.push_back(triangle);
+			}
+			std::sort(triangles.begin(), triangles.end());
+			return triangles;
+		};
+
+		return Canonicalize(a) == Canonicalize(b);
+	}
+#endif
+
+	void MeshOptimizer::Optimize(Submesh& submesh) {
+		if (submesh.Faces.empty() || submesh.Vertices.empty())
+			return;
+
+#ifdef LUCY_DEBUG
+		const std::vector<uint32_t> originalFaces = submesh.Faces;
+#endif
+
+		OptimizeVertexCache(submesh.Faces, submesh.VertexCount);
+		OptimizeOverdraw(submesh.Faces, submesh.Vertices, s_OverdrawThreshold);
+
+#ifdef LUCY_DEBUG
+		LUCY_ASSERT(IsSameTopology(originalFaces, submesh.Faces), "Mesh optimization changed the topology of the submesh!");
+#endif
+
+		//only remaps the vertices, the triangles themselves stay the same
+		OptimizeVertexFetch(submesh);
+	}
+
+	void MeshOptimizer::OptimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount) {
+		const uint32_t triangleCount = (uint32_t)(indices.size() / 3);
+		if (triangleCount == 0)
+			return;
+
+		//vertex -> triangles adjacency, the first remainingTriangles[v] entries are the triangles that are not emitted yet
+		std::vector<uint32_t> remainingTriangles(vertexCount, 0);
+		for (uint32_t index : indices)
+			remainingTriangles[index]++;
+
+		std::vector<uint32_t> triangleOffsets(vertexCount + 1, 0);
+		for (size_t i = 0; i < vertexCount; i++)
+			triangleOffsets[i + 1] = triangleOffsets[i] + remainingTriangles[i];
+
+		std::vector<uint32_t> vertexTriangles(indices.size());
+		{
+			std::vector<uint32_t> cursor(triangleOffsets.begin(), triangleOffsets.end() - 1);
+			for (uint32_t t = 0; t < triangleCount; t++) {
+				for (uint32_t k = 0; k < 3; k++)
+					vertexTriangles[cursor[indices[t * 3 + k]]++] = t;
+			}
+		}
+
+		std::vector<int32_t> cachePositions(vertexCount, -1);
+		std::vector<float> vertexScores(vertexCount);
+		for (size_t v = 0; v < vertexCount; v++)
+			vertexScores[v] = ForsythVertexScore(-1, remainingTriangles[v]);
+
+		std::vector<float> triangleScores(triangleCount);
+		std::vector<bool> emitted(triangleCount, false);
+
+		uint32_t bestTriangle = s_InvalidIndex;
+		float bestScore = -1.0f;
+		for (uint32_t t = 0; t < triangleCount; t++) {
+			triangleScores[t] = vertexScores[indices[t * 3 + 0]] + vertexScores[indices[t * 3 + 1]] + vertexScores[indices[t * 3 + 2]];
+			if (triangleScores[t] > bestScore) {
+				bestScore = triangleScores[t];
+				bestTriangle = t;
+			}
+		}
+
+		std::vector<uint32_t> result;
+		result.reserve(indices.size());
+
+		std::vector<uint32_t> cache, newCache;
+		cache.reserve(s_ForsythCacheSize + 3);
+		newCache.reserve(s_ForsythCacheSize + 3);
+
+		const auto UpdateVertexScore = [&](uint32_t vertex) {
+			const float score = ForsythVertexScore(cachePositions[vertex], remainingTriangles[vertex]);
+			const float delta = score - vertexScores[vertex];
+			vertexScores[vertex] = score;
+
+			const uint32_t begin = triangleOffsets[vertex];
+			for (uint32_t i = begin; i < begin + remainingTriangles[vertex]; i++)
+				triangleScores[vertexTriangles[i]] += delta;
+		};
+
+		uint32_t scanCursor = 0;
+		for (uint32_t emittedCount = 0; emittedCount < triangleCount; emittedCount++) {
+			//none of the cached vertices has triangles left, continue with the next one in the input order
+			if (bestTriangle == s_InvalidIndex) {
+				while (emitted[scanCursor])
+					scanCursor++;
+				bestTriangle = scanCursor;
+			}
+
+			const uint32_t* triangle = &indices[bestTriangle * 3];
+			result.insert(result.end(), triangle, triangle + 3);
+			emitted[bestTriangle] = true;
+
+			for (uint32_t k = 0; k < 3; k++) {
+				const uint32_t vertex = triangle[k];
+				const uint32_t begin = triangleOffsets[vertex];
+				const uint32_t end = begin + remainingTriangles[vertex];
+				for (uint32_t i = begin; i < end; i++) {
+					if (vertexTriangles[i] != bestTriangle)
+						continue;
+					std::swap(vertexTriangles[i], vertexTriangles[end - 1]);
+					remainingTriangles[vertex]--;
+					break;
+				}
+			}
+
+			//LRU: the vertices of the emitted triangle move to the front
+			newCache.clear();
+			newCache.insert(newCache.end(), triangle, triangle + 3);
+			for (uint32_t vertex : cache) {
+				if (vertex != triangle[0] && vertex != triangle[1] && vertex != triangle[2])
+					newCache.push_back(vertex);
+			}
+
+			for (size_t i = s_ForsythCacheSize; i < newCache.size(); i++) {
+				cachePositions[newCache[i]] = -1;
+				UpdateVertexScore(newCache[i]);
+			}
+			if (newCache.size() > s_ForsythCacheSize)
+				newCache.resize(s_ForsythCacheSize);
+			cache.swap(newCache);
+
+			for (size_t i = 0; i < cache.size(); i++) {
+				cachePositions[cache[i]] = (int32_t)i;
+				UpdateVertexScore(cache[i]);
+			}
+
+			//only triangles that touch the cache could have changed their score
+			bestTriangle = s_InvalidIndex;
+			bestScore = -1.0f;
+			for (uint32_t vertex : cache) {
+				const uint32_t begin = triangleOffsets[vertex];
+				for (uint32_t i = begin; i < begin + remainingTriangles[vertex]; i++) {
+					const uint32_t t = vertexTriangles[i];
+					if (triangleScores[t] > bestScore) {
+						bestScore = triangleScores[t];
+						bestTriangle = t;
+					}
+				}
+			}
+		}
+
+		indices.swap(result);
+	}
+
+	void MeshOptimizer::OptimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<glm::vec3>& positions, float threshold) {
+		const uint32_t triangleCount = (uint32_t)(indices.size() / 3);
+		if (triangleCount < 2)
+			return;
+
+		//FIFO cache simulation, a vertex is cached if it was transformed within the last MESH_VERTEX_CACHE_SIZE transforms
+		std::vector<uint32_t> cacheTimestamps(positions.size(), 0);
+		uint32_t timestamp = MESH_VERTEX_CACHE_SIZE + 1;
+
+		const auto ResetCache = [&]() { timestamp += MESH_VERTEX_CACHE_SIZE + 1; };
+		const auto TransformTriangle = [&](uint32_t t) {
+			uint32_t misses = 0;
+			for (uint32_t k = 0; k < 3; k++) {
+				const uint32_t vertex = indices[t * 3 + k];
+				if (timestamp - cacheTimestamps[vertex] > MESH_VERTEX_CACHE_SIZE) {
+					cacheTimestamps[vertex] = timestamp++;
+					misses++;
+				}
+			}
+			return misses;
+		};
+
+		//hard boundaries: triangles that miss the cache with all of their vertices, the cache is effectively restarted there
+		std::vector<uint32_t> hardBoundaries;
+		for (uint32_t t = 0; t < triangleCount; t++) {
+			if (TransformTriangle(t) == 3 || t == 0)
+				hardBoundaries.push_back(t);
+		}
+		hardBoundaries.push_back(triangleCount);
+
+		//soft boundaries: hard clusters are split further, as long as each part stays below the threshold of the cluster ACMR
+		std::vector<uint32_t> clusterStarts;
+		for (size_t c = 0; c + 1 < hardBoundaries.size(); c++) {
+			const uint32_t start = hardBoundaries[c];
+			const uint32_t end = hardBoundaries[c + 1];
+
+			ResetCache();
+			uint32_t clusterMisses = 0;
+			for (uint32_t t = start; t < end; t++)
+				clusterMisses += TransformTriangle(t);
+			const float clusterThreshold = threshold * (float)clusterMisses / (float)(end - start);
+
+			ResetCache();
+			clusterStarts.push_back(start);
+			uint32_t softStart = start;
+			uint32_t softMisses = 0;
+			for (uint32_t t = start; t < end; t++) {
+				softMisses += TransformTriangle(t);
+				if (t + 1 < end && (float)softMisses / (float)(t - softStart + 1) <= clusterThreshold) {
+					clusterStarts.push_back(t + 1);
+					softStart = t + 1;
+					softMisses = 0;
+					ResetCache();
+				}
+			}
+		}
+		clusterStarts.push_back(triangleCount);
+
+		const size_t clusterCount = clusterStarts.size() - 1;
+
+		glm::vec3 meshCentroid = glm::vec3(0.0f);
+		float meshArea = 0.0f;
+
+		std::vector<glm::vec3> clusterCentroids(clusterCount, glm::vec3(0.0f));
+		std::vector<glm::vec3> clusterNormals(clusterCount, glm::vec3(0.0f));
+		for (size_t c = 0; c < clusterCount; c++) {
+			float clusterArea = 0.0f;
+			for (uint32_t t = clusterStarts[c]; t < clusterStarts[c + 1]; t++) {
+				const glm::vec3& p0 = positions[indices[t * 3 + 0]];
+				const glm::vec3& p1 = positions[indices[t * 3 + 1]];
+				const glm::vec3& p2 = positions[indices[t * 3 + 2]];
+
+				//the length of the cross product is twice the area, so the sum of them is an area weighted normal
+				const glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+				const float area = glm::length(normal);
+
+				clusterCentroids[c] += (p0 + p1 + p2) * (area / 3.0f);
+				clusterNormals[c] += normal;
+				clusterArea += area;
+			}
+
+			meshCentroid += clusterCentroids[c];
+			meshArea += clusterArea;
+			if (clusterArea > 0.0f)
+				clusterCentroids[c] /= clusterArea;
+		}
+		if (meshArea > 0.0f)
+			meshCentroid /= meshArea;
+
+		//clusters that face away from the center are more likely to be in front of the others (and to occlude them), so they are drawn first
+		std::vector<float> sortKeys(clusterCount, 0.0f);
+		for (size_t c = 0; c < clusterCount; c++) {
+			const float normalLength = glm::length(clusterNormals[c]);
+			if (normalLength > 0.0f)
+				sortKeys[c] = glm::dot(clusterCentroids[c] - meshCentroid, clusterNormals[c] / normalLength);
+		}
+
+		std::vector<uint32_t> clusterOrder(clusterCount);
+		std::iota(clusterOrder.begin(), clusterOrder.end(), 0u);
+		std::stable_sort(clusterOrder.begin(), clusterOrder.end(), [&](uint32_t a, uint32_t b) { return sortKeys[a] > sortKeys[b]; });
+
+		std::vector<uint32_t> result;
+		result.reserve(indices.size());
+		for (uint32_t c : clusterOrder)
+			result.insert(result.end(), indices.begin() + clusterStarts[c] * 3, indices.begin() + clusterStarts[c + 1] * 3);
+
+		indices.swap(result);
+	}
+
+	void MeshOptimizer::OptimizeVertexFetch(Submesh& submesh) {
+		const size_t vertexCount = submesh.Vertices.size();
+
+		//vertices are numbered in the order of their first use, unused vertices are kept at the end (the base vertex offsets stay valid)
+		std::vector<uint32_t> remap(vertexCount, s_InvalidIndex);
+		uint32_t nextVertex = 0;
+		for (uint32_t index : submesh.Faces) {
+			if (remap[index] == s_InvalidIndex)
+				remap[index] = nextVertex++;
+		}
+		for (uint32_t& newIndex : remap) {
+			if (newIndex == s_InvalidIndex)
+				newIndex = nextVertex++;
+		}
+
+		const auto Reorder = [&](auto& attributes) {
+			if (attributes.empty())
+				return;
+			LUCY_ASSERT(attributes.size() == vertexCount);
+
+			std::remove_reference_t<decltype(attributes)> reordered(vertexCount);
+			for (size_t v = 0; v < vertexCount; v++)
+				reordered[remap[v]] = attributes[v];
+			attributes.swap(reordered);
+		};
+
+		Reorder(submesh.Vertices);
+		Reorder(submesh.Normals);
+		Reorder(submesh.Tangents);
+		Reorder(submesh.BiTangents);
+		Reorder(submesh.TextureCoords);
+
+		for (uint32_t& index : submesh.Faces)
+			index = remap[index];
+	}
+
+	VertexCacheStatistics MeshOptimizer::AnalyzeVertexCache(const std::vector<uint32_t>& indices, size_t vertexCount, uint32_t cacheSize) {
+		VertexCacheStatistics statistics;
+		if (indices.empty() || vertexCount == 0)
+			return statistics;
+
+		std::vector<uint32_t> cacheTimestamps(vertexCount, 0);
+		std::vector<bool> referenced(vertexCount, false);
+		uint32_t timestamp = cacheSize + 1;
+
+		uint32_t transformedVertices = 0;
+		uint32_t referencedVertices = 0;
+		for (uint32_t index : indices) {
+			if (timestamp - cacheTimestamps[index] > cacheSize) {
+				cacheTimestamps[index] = timestamp++;
+				transformedVertices++;
+			}
+			if (!referenced[index]) {
+				referenced[index] = true;
+				referencedVertices++;
+			}
+		}
+
+		statistics.ACMR = (float)transformedVertices / (float)(indices.size() / 3);
+		statistics.ATVR = (float)transformedVertices / (float)referencedVertices;
+		return statistics;
+	}
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+namespace Lucy {
+
+	struct Submesh;
+
+	//FIFO post-transform cache size used for the statistics and the overdraw optimization.
+	//the Forsyth ordering keeps its own 32 entry LRU model, see s_ForsythCacheSize
+	static inline constexpr const uint32_t MESH_VERTEX_CACHE_SIZE = 16u;
+
+	struct VertexCacheStatistics {
+		float ACMR = 0.0f; //average cache miss ratio: transformed vertices per triangle (0.5 - 3.0)
+		float ATVR = 0.0f; //average transformed vertex ratio: transformed vertices per referenced vertex (1.0 - n)
+	};
+
+	/*
+	* Post-import reordering of the submesh data:
+	* 1. triangles are reordered for the post-transform vertex cache (Forsyth)
+	* 2. clusters of triangles are reordered to reduce overdraw, while keeping most of the cache efficiency (Sander et al.)
+	* 3. vertices are reordered in the order of their first use, for better vertex fetch locality
+	* The topology is not changed, every triangle keeps its vertices and winding.
+	*/
+	class MeshOptimizer final {
+	public:
+		static void Optimize(Submesh& submesh);
+
+		static void OptimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount);
+		//threshold: the maximum allowed ACMR degradation (1.05 = 5% worse) in exchange for less overdraw
+		static void OptimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<glm::vec3>& positions, float threshold);
+		static void OptimizeVertexFetch(Submesh& submesh);
+
+		//FIFO cache simulation
+		static VertexCacheStatistics AnalyzeVertexCache(const std::vector<uint32_t>& indices, size_t vertexCount, uint32_t cacheSize);
+	};
+}
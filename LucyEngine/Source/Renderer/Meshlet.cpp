@@ -0,0 +1,154 @@
+#include "lypch.h"
+#include "Meshlet.h"
+
+#include "Mesh.h"
+
+namespace Lucy {
+
+	void MeshletBuilder::Build(Submesh& submesh) {
+		Build(submesh.Vertices, submesh.Faces, submesh.Meshlets);
+	}
+
+	void MeshletBuilder::Build(const std::vector<glm::vec3>& positions, const std::vector<uint32_t>& indices, std::vector<Meshlet>& outMeshlets) {
+		static constexpr uint32_t invalidMeshlet = UINT32_MAX;
+
+		outMeshlets.clear();
+		if (indices.empty() || positions.empty())
+			return;
+
+		//stores the meshlet index, that the vertex was last added to (avoids clearing a set for every meshlet)
+		std::vector<uint32_t> vertexMeshletStamp(positions.size(), invalidMeshlet);
+
+		Meshlet current;
+		const auto FlushMeshlet = [&]() {
+			if (current.IndexCount == 0)
+				return;
+			ComputeBounds(positions, indices, current);
+			outMeshlets.push_back(current);
+
+			current = Meshlet();
+			current.FirstIndex = outMeshlets.back().FirstIndex + outMeshlets.back().IndexCount;
+		};
+
+		for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+			const uint32_t meshletIndex = (uint32_t)outMeshlets.size();
+
+			uint32_t newVertices = 0;
+			for (uint32_t k = 0; k < 3; k++)
+				newVertices += vertexMeshletStamp[indices[i + k]] != meshletIndex;
+
+			if (current.VertexCount + newVertices > MESHLET_MAX_VERTICES || current.IndexCount / 3 + 1 > MESHLET_MAX_TRIANGLES)
+				FlushMeshlet();
+
+			const uint32_t stamp = (uint32_t)outMeshlets.size();
+			for (uint32_t k = 0; k < 3; k++) {
+				uint32_t& vertexStamp = vertexMeshletStamp[indices[i + k]];
+				if (vertexStamp == stamp)
+					continue;
+				vertexStamp = stamp;
+				current.VertexCount++;
+			}
+			current.IndexCount += 3;
+		}
+		FlushMeshlet();
+	}
+
+	void MeshletBuilder::ComputeBounds(const std::vector<glm::vec3>& vertexPositions, const std::vector<uint32_t>& faces, Meshlet& meshlet) {
+		const glm::vec3* positions = vertexPositions.data();
+		const uint32_t* indices = faces.data() + meshlet.FirstIndex;
+
+		//Ritter's bounding sphere: start with the two points that are (approximately) the furthest apart and grow it afterwards
+		const glm::vec3& first = positions[indices[0]];
+		glm::vec3 a = first;
+		float maxDistance = 0.0f;
+		for (uint32_t i = 0; i < meshlet.IndexCount; i++) {
+			const glm::vec3& p = positions[indices[i]];
+			float distance = glm::dot(p - first, p - first);
+			if (distance > maxDistance) {
+				maxDistance = distance;
+				a = p;
+			}
+		}
+
+		glm::vec3 b = a;
+		maxDistance = 0.0f;
+		for (uint32_t i = 0; i < meshlet.IndexCount; i++) {
+			const glm::vec3& p = positions[indices[i]];
+			float distance = glm::dot(p - a, p - a);
+			if (distance > maxDistance) {
+				maxDistance = distance;
+				b = p;
+			}
+		}
+
+		glm::vec3 center = (a + b) * 0.5f;
+		float radius = glm::length(b - a) * 0.5f;
+
+		for (uint32_t i = 0; i < meshlet.IndexCount; i++) {
+			const glm::vec3& p = positions[indices[i]];
+			float distance = glm::length(p - center);
+			if (distance <= radius)
+				continue;
+			float newRadius = (radius + distance) * 0.5f;
+			center += (p - center) * ((newRadius - radius) / distance);
+			radius = newRadius;
+		}
+
+		meshlet.Center = center;
+		meshlet.Radius = radius;
+
+		//normal cone, the same way as meshoptimizer does it (meshopt_computeClusterBounds)
+		std::vector<glm::vec3> triangleNormals;
+		triangleNormals.reserve(meshlet.IndexCount / 3);
+
+		glm::vec3 normalSum = glm::vec3(0.0f);
+		for (uint32_t i = 0; i < meshlet.IndexCount; i += 3) {
+			const glm::vec3& p0 = positions[indices[i + 0]];
+			const glm::vec3& p1 = positions[indices[i + 1]];
+			const glm::vec3& p2 = positions[indices[i + 2]];
+
+			glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+			float length = glm::length(normal);
+			if (length <= FLT_EPSILON) //degenerate triangle
+				continue;
+
+			normal /= length;
+			triangleNormals.push_back(normal);
+			normalSum += normal;
+		}
+
+		float axisLength = glm::length(normalSum);
+		if (triangleNormals.empty() || axisLength <= FLT_EPSILON)
+			return;
+
+		glm::vec3 axis = normalSum / axisLength;
+
+		float minDot = 1.0f;
+		for (const glm::vec3& normal : triangleNormals)
+			minDot = glm::min(minDot, glm::dot(normal, axis));
+
+		meshlet.ConeAxis = axis;
+		//the cone is too wide (or degenerate), culling would be too conservative to be useful anyway
+		meshlet.ConeCutoff = minDot <= 0.1f ? 1.0f : glm::sqrt(1.0f - minDot * minDot);
+	}
+
+	bool MeshletCuller::IsVisible(const Meshlet& meshlet, const glm::mat4& modelMatrix, const Maths::Frustum& frustum, const glm::vec3& cameraPosition, bool coneCulling) {
+		const glm::vec3 center = glm::vec3(modelMatrix * glm::vec4(meshlet.Center, 1.0f));
+		const float maxScale = glm::max(glm::length(glm::vec3(modelMatrix[0])), glm::max(glm::length(glm::vec3(modelMatrix[1])), glm::length(glm::vec3(modelMatrix[2]))));
+		const float radius = meshlet.Radius * maxScale;
+
+		if (!Maths::SphereInFrustum(frustum, center, radius))
+			return false;
+
+		if (!coneCulling || meshlet.ConeCutoff >= 1.0f)
+			return true;
+
+		const glm::vec3 coneAxis = glm::normalize(glm::mat3(modelMatrix) * meshlet.ConeAxis);
+		return !IsBackfacing(center, radius, coneAxis, meshlet.ConeCutoff, cameraPosition);
+	}
+
+	bool MeshletCuller::IsBackfacing(const glm::vec3& center, float radius, const glm::vec3& coneAxis, float coneCutoff, const glm::vec3& cameraPosition) {
+		const glm::vec3 toCenter = center - cameraPosition;
+		return glm::dot(toCenter, coneAxis) >= coneCutoff * glm::length(toCenter) + radius;
+	}
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "Utilities/Utilities.h"
+
+namespace Lucy {
+
+	struct Submesh;
+
+	static inline constexpr const uint32_t MESHLET_MAX_VERTICES = 64u;
+	static inline constexpr const uint32_t MESHLET_MAX_TRIANGLES = 124u;
+
+	/*
+	* A meshlet is a small, contiguous range of the submesh index buffer.
+	* Triangles are not reordered, so a meshlet can be drawn with a plain indexed draw.
+	*/
+	struct Meshlet {
+		uint32_t FirstIndex = 0; //relative to the first index of the submesh
+		uint32_t IndexCount = 0;
+		uint32_t VertexCount = 0; //unique vertices
+
+		//bounding sphere in mesh space
+		glm::vec3 Center = glm::vec3(0.0f);
+		float Radius = 0.0f;
+
+		//normal cone in mesh space (cutoff = 1 means the cone is too wide to be culled)
+		glm::vec3 ConeAxis = glm::vec3(0.0f, 0.0f, 1.0f);
+		float ConeCutoff = 1.0f;
+	};
+
+	class MeshletBuilder final {
+	public:
+		static void Build(Submesh& submesh);
+		static void Build(const std::vector<glm::vec3>& positions, const std::vector<uint32_t>& indices, std::vector<Meshlet>& outMeshlets);
+	private:
+		static void ComputeBounds(const std::vector<glm::vec3>& positions, const std::vector<uint32_t>& indices, Meshlet& meshlet);
+	};
+
+	//CPU reference of the cluster culling compute shader (LucyClusterCull.comp), both must be kept in sync
+	class MeshletCuller final {
+	public:
+		static bool IsVisible(const Meshlet& meshlet, const glm::mat4& modelMatrix, const Maths::Frustum& frustum, const glm::vec3& cameraPosition, bool coneCulling = true);
+		static bool IsBackfacing(const glm::vec3& center, float radius, const glm::vec3& coneAxis, float coneCutoff, const glm::vec3& cameraPosition);
+	};
+}
@@ -20,6 +20,8 @@ namespace Lucy {
 			return m_RenderDevice->AccessResource<TPipeline>(m_ComputePipelines.at(name));
 		}
 
+		inline bool HasPipeline(const std::string& name) const { return m_GraphicsPipelines.contains(name) || m_ComputePipelines.contains(name); }
+
 		inline size_t GetGraphicsPipelineCount() const { return m_GraphicsPipelines.size(); }
 		inline size_t GetComputePipelineCount() const { return m_ComputePipelines.size(); }
 		inline size_t GetAllPipelineCount() const { return GetGraphicsPipelineCount() + GetComputePipelineCount(); }
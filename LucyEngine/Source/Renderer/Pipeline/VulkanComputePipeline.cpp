@@ -19,20 +19,7 @@ namespace Lucy {
 	}
 
 	void VulkanComputePipeline::Create(const Ref<VulkanRenderDevice>& vulkanDevice) {
-		const std::vector<VkDescriptorPoolSize> poolSizes = {
-			{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 10 },
-			{ VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 10 },
-			{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 10 }
-		};
-
-		VulkanDescriptorPoolCreateInfo poolCreateInfo;
-		poolCreateInfo.PoolSizesVector = poolSizes;
-		poolCreateInfo.MaxSet = 100;
-		poolCreateInfo.PoolFlags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
-		poolCreateInfo.LogicalDevice = vulkanDevice->GetLogicalDevice();
-		m_DescriptorPool = Memory::CreateRef<VulkanDescriptorPool>(poolCreateInfo);
-
-		m_CreateInfo.Shader->RTLoadDescriptors(vulkanDevice, m_DescriptorPool);
+		m_CreateInfo.Shader->RTLoadDescriptors(vulkanDevice);
 		const auto& descriptorSetsHandles = m_CreateInfo.Shader->GetDescriptorSetHandles();
 		const auto& pushConstants = m_CreateInfo.Shader->GetPushConstants();
 
@@ -78,8 +65,6 @@ namespace Lucy {
 		Renderer::EnqueueToRenderCommandQueue([=](const auto& device) {
 			const auto& vulkanDevice = device->As<VulkanRenderDevice>();
 
-			m_DescriptorPool->RTDestroyResource();
-			m_DescriptorPool = nullptr;
 			vkDestroyPipelineLayout(vulkanDevice->GetLogicalDevice(), m_PipelineLayoutHandle, nullptr);
 			vkDestroyPipeline(vulkanDevice->GetLogicalDevice(), m_PipelineHandle, nullptr);
 		});
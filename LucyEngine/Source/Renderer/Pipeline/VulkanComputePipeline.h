@@ -23,7 +23,5 @@ namespace Lucy {
 
 		VkPipeline m_PipelineHandle = VK_NULL_HANDLE;
 		VkPipelineLayout m_PipelineLayoutHandle = VK_NULL_HANDLE;
-
-		Ref<VulkanDescriptorPool> m_DescriptorPool = nullptr;
 	};
 }
\ No newline at end of file
@@ -23,32 +23,6 @@ namespace Lucy {
 	void VulkanGraphicsPipeline::Create(const Ref<VulkanRenderDevice>& vulkanDevice) {
 		const auto& renderPass = vulkanDevice->AccessResource<RenderPass>(m_CreateInfo.RenderPassHandle)->As<VulkanRenderPass>();
 
-		if (!m_DescriptorPool) {
-#if USE_INTEGRATED_GRAPHICS
-			const std::vector<VkDescriptorPoolSize> poolSizes = {
-				{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 100 },
-				{ VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 100 },
-				{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 100 }
-			};
-#else
-			const std::vector<VkDescriptorPoolSize> poolSizes = {
-				{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 100 },
-				{ VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 100 },
-				{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 100 }
-			};
-#endif
-			VulkanDescriptorPoolCreateInfo poolCreateInfo;
-			poolCreateInfo.PoolSizesVector = poolSizes;
-#if USE_INTEGRATED_GRAPHICS
-			poolCreateInfo.MaxSet = 100;
-#else
-			poolCreateInfo.MaxSet = 100;
-#endif
-			poolCreateInfo.PoolFlags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
-			poolCreateInfo.LogicalDevice = vulkanDevice->GetLogicalDevice();
-			m_DescriptorPool = Memory::CreateRef<VulkanDescriptorPool>(poolCreateInfo);
-		}
-
 		const auto& bindingDescriptor = CreateBindingDescription();
 		const auto& attributeDescriptor = CreateAttributeDescription(bindingDescriptor.binding);
 
@@ -80,7 +54,7 @@ namespace Lucy {
 
 		VkPipelineDynamicStateCreateInfo dynamicState = VulkanAPI::PipelineDynamicStateCreateInfo(3, dynamicStates);
 
-		m_CreateInfo.Shader->RTLoadDescriptors(vulkanDevice, m_DescriptorPool);
+		m_CreateInfo.Shader->RTLoadDescriptors(vulkanDevice);
 		const auto& descriptorSetsHandles = m_CreateInfo.Shader->GetDescriptorSetHandles();
 		const auto& pushConstants = m_CreateInfo.Shader->GetPushConstants();
 		
@@ -173,8 +147,6 @@ namespace Lucy {
 			const auto& vulkanDevice = device->As<VulkanRenderDevice>();
 			VkDevice logicalDevice = vulkanDevice->GetLogicalDevice();
 
-			m_DescriptorPool->RTDestroyResource();
-			m_DescriptorPool = nullptr;
 			vkDestroyPipelineLayout(logicalDevice, m_PipelineLayoutHandle, nullptr);
 			vkDestroyPipeline(logicalDevice, m_PipelineHandle, nullptr);
 
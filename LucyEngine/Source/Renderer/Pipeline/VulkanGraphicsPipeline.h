@@ -26,7 +26,5 @@ namespace Lucy {
 
 		VkPipeline m_PipelineHandle = VK_NULL_HANDLE;
 		VkPipelineLayout m_PipelineLayoutHandle = VK_NULL_HANDLE;
-
-		Ref<VulkanDescriptorPool> m_DescriptorPool;
 	};
 }
\ No newline at end of file
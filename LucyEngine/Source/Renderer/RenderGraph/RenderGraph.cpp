@@ -17,7 +17,8 @@ namespace Lucy {
 	void RenderGraph::Execute() {
 		LUCY_PROFILE_NEW_EVENT("RenderGraph::Execute");
 		Traverse([](RenderGraphPass* pass) {
-			Renderer::SubmitToRender(*pass);
+			if (pass->ShouldExecute())
+				Renderer::SubmitToRender(*pass);
 		});
 	}
 
@@ -25,7 +26,8 @@ namespace Lucy {
 		LUCY_PROFILE_NEW_EVENT("RenderGraph::Flush");
 		Update();
 		for (auto& [rgResource, transientRenderResource] : m_ExternalTransientResources) {
-			if (!Renderer::IsValidRenderResource(transientRenderResource))
+			//an image that is still being decoded has not been used by any pass yet
+			if (!IsExternalImageReady(transientRenderResource))
 				continue;
 			Renderer::EnqueueResourceDestroy(transientRenderResource);
 		}
@@ -143,6 +145,10 @@ namespace Lucy {
 		m_AcyclicGraph.AddWriteDependency(currentPass, rgResourceToWrite);
 	}
 
+	bool RenderGraph::IsExternalImageReady(RenderResourceHandle handle) {
+		return Renderer::IsValidRenderResource(handle) && Renderer::AccessResource<Image>(handle)->IsReady();
+	}
+
 	bool RenderGraph::CheckIfPassNeedsCulling(RenderGraphPass* pass, const std::unordered_set<RenderGraphResource>& inputResources, 
 		const std::unordered_set<RenderGraphResource>& outputResources) {
 
@@ -158,9 +164,9 @@ namespace Lucy {
 		const auto CheckIfExternalResourcesAreValid = [this](const std::unordered_set<RenderGraphResource>& rgResources) {
 			LUCY_PROFILE_NEW_EVENT("RenderGraph::CheckIfPassHasExternalDependency");
 			for (const RenderGraphResource& rgResource : rgResources) {
-				if (m_ExternalResources.contains(rgResource) && !Renderer::IsValidRenderResource(m_ExternalResources.at(rgResource)))
+				if (m_ExternalResources.contains(rgResource) && !IsExternalImageReady(m_ExternalResources.at(rgResource)))
 					return false;
-				if (m_ExternalTransientResources.contains(rgResource) && !Renderer::IsValidRenderResource(m_ExternalTransientResources.at(rgResource)))
+				if (m_ExternalTransientResources.contains(rgResource) && !IsExternalImageReady(m_ExternalTransientResources.at(rgResource)))
 					return false;
 			}
 			return true;
@@ -71,6 +71,8 @@ namespace Lucy {
 		inline const RGImageData& GetImageData(const RenderGraphResource& rgResource) { return m_Registry.GetImageData(rgResource); }
 		inline const RGBufferData& GetBufferData(const RenderGraphResource& rgResource) { return m_Registry.GetBufferData(rgResource); }
 
+		//images that are loaded from a file are only ready, once they have been uploaded
+		static bool IsExternalImageReady(RenderResourceHandle handle);
 		bool CheckIfPassNeedsCulling(RenderGraphPass* pass, const std::unordered_set<RenderGraphResource>& inputResources, 
 			const std::unordered_set<RenderGraphResource>& outputResources);
 		void Update();
@@ -25,6 +25,10 @@ namespace Lucy {
 		m_RenderGraphPass->SetClearColor(clearColor);
 	}
 
+	void RenderGraphBuilder::SetExecuteCondition(std::function<bool()>&& condition) {
+		m_RenderGraphPass->SetExecuteCondition(std::move(condition));
+	}
+
 	void RenderGraphBuilder::DeclareImage(const RenderGraphResource& rgResource, const ImageCreateInfo& createInfo, RenderPassLoadStoreAttachments loadStoreAccessOp) {
 		m_RenderGraph->DeclareImage(rgResource, createInfo, loadStoreAccessOp);
 	}
@@ -16,6 +16,8 @@ namespace Lucy {
 		void SetViewportArea(uint32_t width, uint32_t height);
 		void SetInFlightMode(bool mode);
 		void SetClearColor(ClearColor clearColor);
+		//for passes that are only needed on demand (e.g. picking)
+		void SetExecuteCondition(std::function<bool()>&& condition);
 
 		void DeclareImage(const RenderGraphResource& rgResource, const ImageCreateInfo& createInfo, RenderPassLoadStoreAttachments loadStoreAccessOp);
 		void DeclareImage(const RenderGraphResource& rgResource, const ImageCreateInfo& createInfo, RenderPassLoadStoreAttachments loadStoreAccessOp,
@@ -42,4 +42,8 @@ namespace Lucy {
 	void RenderGraphPass::SetClearColor(ClearColor clearColor) {
 		m_ClearColor = clearColor;
 	}
+
+	void RenderGraphPass::SetExecuteCondition(RenderGraphExecuteCondition&& condition) {
+		m_ExecuteCondition = std::move(condition);
+	}
 }
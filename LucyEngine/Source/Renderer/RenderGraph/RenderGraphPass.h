@@ -10,6 +10,8 @@ namespace Lucy {
 
 	using RenderGraphExecuteFunc = std::function<void(RenderGraphRegistry&, RenderCommandList&)>;
 	using RenderGraphSetupFunc = std::function<RenderGraphExecuteFunc(RenderGraphBuilder&)>;
+	//evaluated every frame before the pass is submitted, the pass (including its render pass) is skipped if it returns false
+	using RenderGraphExecuteCondition = std::function<bool()>;
 
 	enum class RenderGraphPassState : uint8_t {
 		New,
@@ -42,6 +44,7 @@ namespace Lucy {
 		void SetInFlightMode(bool mode);
 		void SetState(RenderGraphPassState state);
 		void SetClearColor(ClearColor clearColor);
+		void SetExecuteCondition(RenderGraphExecuteCondition&& condition);
 
 		inline bool operator==(const RenderGraphPass& other) const { return m_CreateInfo.Name.compare(other.m_CreateInfo.Name) == 0; }
 
@@ -63,9 +66,11 @@ namespace Lucy {
 		inline TargetQueueFamily GetTargetQueueFamily() const { return m_CreateInfo.TargetQueueFamily; }
 
 		inline RenderGraphPassState GetCurrentState() const { return m_State; }
+		inline bool ShouldExecute() const { return !m_ExecuteCondition || m_ExecuteCondition(); }
 		inline const std::string& GetName() const { return m_CreateInfo.Name; }
 	private:
 		RenderGraphExecuteFunc m_ExecuteFunc;
+		RenderGraphExecuteCondition m_ExecuteCondition;
 		RenderGraphPassCreateInfo m_CreateInfo;
 
 		RGRenderTargetElements m_RenderTargets;
@@ -6,6 +6,7 @@
 
 #include "Renderer.h"
 #include "Renderer/VulkanRenderer.h"
+#include "Renderer/Device/VulkanRenderDevice.h"
 #include "RenderPass.h"
 
 #include "Scene/Entity.h"
@@ -15,6 +16,7 @@
 #include "Events/EventHandler.h"
 
 #include "Image/Image.h"
+#include "Image/VulkanImage2D.h"
 
 #include "Memory/Buffer/Vulkan/VulkanFrameBuffer.h"
 
@@ -54,6 +56,7 @@ namespace Lucy {
 
 		constexpr size_t graphicsShaderCount = 5;
 		constexpr size_t computeShaderCount = 2;
+		constexpr size_t cullingShaderCount = 3;
 
 		constexpr const std::array<const char*, graphicsShaderCount> graphicsShaders = {
 			"LucyPBR",
@@ -68,6 +71,13 @@ namespace Lucy {
 			"LucyPrefilterGen",
 		};
 
+		//always compute, independent of the cubemap generation path
+		constexpr const std::array<const char*, cullingShaderCount> cullingShaders = {
+			"LucyClusterCull",
+			"LucyHiZ",
+			"LucyMipGen",
+		};
+
 		const auto& device = GetRenderDevice();
 		const auto& shaderFolder = Shader::GetShaderFolder();
 		
@@ -91,12 +101,16 @@ namespace Lucy {
 #else
 			ScheduleShaderCompilationBatch(computeShaders, ".glsl", computeShaderCount);
 #endif
+			ScheduleShaderCompilationBatch(cullingShaders, ".comp", cullingShaderCount);
 
 		}
 
 		s_RenderGraph = Memory::CreateRef<RenderGraph>();
 		s_PipelineManager = Memory::CreateUnique<PipelineManager>(GetRenderDevice());
 		s_MaterialManager = Memory::CreateUnique<MaterialManager>(s_Shaders);
+		s_TextureCache = Memory::CreateUnique<TextureCache>(GetRenderDevice());
+		s_TextureStreamer = Memory::CreateUnique<TextureStreamer>();
+		s_MipGenerator = Memory::CreateUnique<VulkanMipGenerator>(GetRenderDevice());
 
 		EnqueueToRenderCommandQueue([](const Ref<RenderDevice>& device) {
 			static ImageCreateInfo blankCubeCreateInfo;
@@ -113,6 +127,19 @@ namespace Lucy {
 			blankCubeCreateInfo.GenerateSampler = true;
 
 			s_BlankCubeHandle = device->CreateImage(blankCubeCreateInfo);
+
+			//bound to the unused indices of the bindless texture array
+			static ImageCreateInfo blankImageCreateInfo;
+			blankImageCreateInfo.Width = 1;
+			blankImageCreateInfo.Height = 1;
+			blankImageCreateInfo.Format = ImageFormat::R8G8B8A8_UNORM;
+			blankImageCreateInfo.ImageType = ImageType::Type2D;
+			blankImageCreateInfo.ImageUsage = ImageUsage::AsColorTransferAttachment;
+			blankImageCreateInfo.Parameter.Mag = ImageFilterMode::LINEAR;
+			blankImageCreateInfo.Parameter.Min = ImageFilterMode::LINEAR;
+			blankImageCreateInfo.GenerateSampler = true;
+
+			s_BlankImageHandle = device->CreateImage(blankImageCreateInfo);
 		});
 
 		static std::vector<float> vertices = {
@@ -348,9 +375,9 @@ namespace Lucy {
 			};
 
 #if !USE_COMPUTE_FOR_CUBEMAP_GEN
-			constexpr size_t graphicsPipelineCount = 7;
+			constexpr size_t graphicsPipelineCount = 8;
 #else
-			constexpr size_t graphicsPipelineCount = 5;
+			constexpr size_t graphicsPipelineCount = 6;
 #endif
 			constexpr const std::array<RenderGraphPipelineCreateInfo, graphicsPipelineCount> graphicsPipelineCreateInfos = {
 				// PBR Geometry Pipeline
@@ -360,6 +387,13 @@ namespace Lucy {
 					.PipelineName = "PBRGeometryPipeline",
 					.RasterizationConfig = {.DisableBackCulling = true, .CullingMode = CullingMode::None}
 				},
+				// PBR Geometry Pipeline of the late occlusion cull phase (a pipeline per pass)
+				{
+					.ShaderName = "LucyPBR",
+					.PassName = "PBRGeometryLatePass",
+					.PipelineName = "PBRGeometryLatePipeline",
+					.RasterizationConfig = {.DisableBackCulling = true, .CullingMode = CullingMode::None}
+				},
 				// ID Pipeline
 				{
 					.ShaderName = "LucyID",
@@ -403,7 +437,7 @@ namespace Lucy {
 #endif
 			};
 
-			constexpr size_t computePipelineCount = 2;
+			constexpr size_t computePipelineCount = 5;
 			constexpr const std::array<RenderGraphPipelineCreateInfo, computePipelineCount> computePipelineCreateInfos = {
 				RenderGraphPipelineCreateInfo {
 					.ShaderName = "LucyIrradianceGen",
@@ -413,6 +447,18 @@ namespace Lucy {
 					.ShaderName = "LucyPrefilterGen",
 					.PipelineName = "PrefilterComputePipeline"
 				},
+				{
+					.ShaderName = "LucyClusterCull",
+					.PipelineName = "ClusterCullComputePipeline"
+				},
+				{
+					.ShaderName = "LucyHiZ",
+					.PipelineName = "HiZComputePipeline"
+				},
+				{
+					.ShaderName = "LucyMipGen",
+					.PipelineName = "MipGenComputePipeline"
+				},
 			};
 
 			static std::mutex pipelineMutex;
@@ -448,12 +494,78 @@ namespace Lucy {
 
 	void Renderer::ExecuteRenderGraph() {
 		LUCY_PROFILE_NEW_EVENT("Renderer::ExecuteRenderGraph");
+		const bool pickPending = IsPickPending();
+
+		//buffers, that have been loaded in the meantime, and images that have been decoded (or whose streamed levels have been read) are uploaded first, 
+		//so that every pass of this frame sees them
+		if (GetRenderArchitecture() == RenderArchitecture::Vulkan) {
+			s_Backend->EnqueueToRenderCommandQueue([](RenderCommandList& cmdList) {
+				VkCommandBuffer commandBuffer = (VkCommandBuffer)cmdList.GetPrimaryCommandPool()->GetCurrentFrameCommandBuffer();
+
+				VulkanStagingRing& stagingRing = GetRenderDevice()->As<VulkanRenderDevice>()->GetStagingRing();
+				if (stagingRing.HasPendingCopies())
+					stagingRing.RTRecordPendingCopies(commandBuffer);
+#if USE_TEXTURE_STREAMING
+				RTUpdateTextureStreaming();
+#endif
+				if (VulkanImage2D::HasPendingUploads())
+					VulkanImage2D::RTRecordPendingUploads(commandBuffer);
+			});
+		}
 		s_RenderGraph->Execute();
+
+		//the ID pass has been submitted with this frame, the pick is resolved once the frame has been rendered
+		if (pickPending) {
+			std::scoped_lock lock(s_PendingPickMutex);
+			s_PendingPick->FrameIndex = GetCurrentFrameIndex();
+			s_PendingPick->IsSubmitted = true;
+		}
+	}
+
+	void Renderer::RTUpdateTextureStreaming() {
+		LUCY_PROFILE_NEW_EVENT("Renderer::RTUpdateTextureStreaming");
+
+		//the changes, that have been recorded (or have failed) since the last update
+		for (RenderResourceHandle handle : s_TextureStreamer->GetPendingHandles()) {
+			const Ref<Image>& image = AccessResource<Image>(handle);
+			if (!image->IsResidencyChangePending())
+				s_TextureStreamer->OnResidencyChanged(handle, image->GetResidentMip());
+		}
+
+		for (const TextureResidencyChange& change : s_TextureStreamer->Update())
+			AccessResource<Image>(change.Handle)->RTRequestResidentMip(change.ResidentMip);
 	}
 
 	void Renderer::Flush() {
 		LUCY_PROFILE_NEW_EVENT("Renderer::Flush");
 		s_RenderGraph->Flush();
+
+		//the readback is resolved, as soon as the GPU has finished the frame. It must not be read any earlier, the copy might not have landed yet
+		std::optional<PickRequest> completedPick;
+		{
+			std::scoped_lock lock(s_PendingPickMutex);
+			if (s_PendingPick && s_PendingPick->IsSubmitted) {
+				//nothing has been copied, the ID pass is rendered again with the next frame
+				if (!s_Backend->IsFrameSubmitted(s_PendingPick->FrameIndex))
+					s_PendingPick->IsSubmitted = false;
+				else if (s_Backend->IsFrameCompleted(s_PendingPick->FrameIndex))
+					completedPick = std::exchange(s_PendingPick, std::nullopt);
+			}
+		}
+
+		//outside of the lock, the callback might request the next pick
+		if (completedPick)
+			ResolvePick(*completedPick);
+	}
+
+	bool Renderer::IsPickPending() {
+		std::scoped_lock lock(s_PendingPickMutex);
+		return s_PendingPick.has_value() && !s_PendingPick->IsSubmitted;
+	}
+
+	glm::uvec2 Renderer::GetPendingPickPixel() {
+		std::scoped_lock lock(s_PendingPickMutex);
+		return s_PendingPick ? s_PendingPick->Pixel : glm::uvec2(0);
 	}
 
 	RenderContextResultCodes Renderer::WaitAndPresent() {
@@ -466,6 +578,7 @@ namespace Lucy {
 		WaitForDevice();
 
 		EnqueueResourceDestroy(s_BlankCubeHandle);
+		EnqueueResourceDestroy(s_BlankImageHandle);
 
 		/*
 		* Have to do this, since some passes can be utilizing the framebuffer of other passes, so before i delete them, i have to
@@ -493,6 +606,10 @@ namespace Lucy {
 
 		s_PipelineManager->DestroyAll();
 		s_MaterialManager->DestroyAll();
+		s_TextureCache->DestroyAll();
+		EnqueueToRenderCommandQueue([](const Ref<RenderDevice>& device) {
+			s_MipGenerator->RTDestroyResource();
+		});
 
 		s_CubeMesh->Destroy();
 		DestroyAllShaders();
@@ -549,6 +666,10 @@ namespace Lucy {
 		s_Backend->EnqueueResourceDestroy(handle);
 	}
 
+	void Renderer::EnqueueDeletion(RenderDeletionFunc&& func) {
+		s_Backend->EnqueueDeletion(std::move(func));
+	}
+
 	void Renderer::InitializeImGui() {
 		s_Backend->InitializeImGui();
 	}
@@ -585,6 +706,10 @@ namespace Lucy {
 				break;
 			}
 			case TargetQueueFamily::Graphics: {
+				if (pass.GetRenderTargets().empty()) {
+					s_Backend->SubmitToRender(pass);
+					break;
+				}
 				const auto& [renderPassHandle, frameBufferHandle] = s_RenderFrameHandleMap.at(pass.GetName());
 				s_Backend->SubmitToRender(pass, renderPassHandle, frameBufferHandle);
 				break;
@@ -623,11 +748,7 @@ namespace Lucy {
 		});
 
 		EventHandler::AddListener<EntityPickedEvent>(evt, [](const EntityPickedEvent& e) {
-			auto scene = e.GetScene();
-			auto id = OnMousePicking(e);
-			if (id == glm::vec3(-1.0))
-				return;
-			e.GetEntity() = scene->GetEntityByMeshID(id);
+			OnMousePicking(e);
 		});
 	}
 
@@ -641,15 +762,45 @@ namespace Lucy {
 		s_Backend->OnViewportResize();
 	}
 
-	glm::vec3 Renderer::OnMousePicking(const EntityPickedEvent& e) {
+	void Renderer::OnMousePicking(const EntityPickedEvent& e) {
 		LUCY_PROFILE_NEW_EVENT("Renderer::OnMousePicking");
 
-		const auto& device = GetRenderDevice();
-		auto frameBufferHandle = s_RenderFrameHandleMap.at("IDPass").FrameBufferHandle;
-		const auto& frameBuffer = device->AccessResource<FrameBuffer>(frameBufferHandle);
-		if (GetRenderArchitecture() == RenderArchitecture::Vulkan)
-			return s_Backend->OnMousePicking(e, device->AccessResource<Image>(frameBuffer->As<VulkanFrameBuffer>()->GetImageHandles()[GetCurrentFrameIndex()]));
-		return glm::vec3(-1.0f);
+		const float mouseX = e.GetViewportMouseX();
+		const float mouseY = e.GetViewportMouseY();
+		const float width = e.GetViewportWidth();
+		const float height = e.GetViewportHeight();
+
+		if (mouseX < 0.0f || mouseY < 0.0f || mouseX >= width || mouseY >= height) {
+			e.GetOnPickedFunc()(Entity{});
+			return;
+		}
+
+#if USE_GPU_PICKING
+		//the ID image is upside down (the viewport panel flips it), a newer pick replaces an unresolved one
+		std::scoped_lock lock(s_PendingPickMutex);
+		s_PendingPick = PickRequest{
+			.TargetScene = e.GetScene(),
+			.Pixel = glm::uvec2((uint32_t)mouseX, (uint32_t)(height - 1.0f - mouseY)),
+			.OnPicked = e.GetOnPickedFunc(),
+		};
+#else
+		Scene* scene = e.GetScene();
+		const glm::vec2 ndc = glm::vec2((mouseX + 0.5f) / width * 2.0f - 1.0f, 1.0f - (mouseY + 0.5f) / height * 2.0f);
+		const auto& vp = scene->GetEditorCamera().GetCameraViewProjection();
+		e.GetOnPickedFunc()(scene->PickEntity(Maths::NDCToRay(ndc, vp.Proj * vp.View)));
+#endif
+	}
+
+	void Renderer::ResolvePick(const PickRequest& pick) {
+		LUCY_PROFILE_NEW_EVENT("Renderer::ResolvePick");
+
+		const glm::vec3 meshID = s_Backend->ReadIDReadback(pick.FrameIndex);
+		pick.OnPicked(meshID == glm::vec3(-1.0f) ? Entity{} : pick.TargetScene->GetEntityByMeshID(meshID));
+	}
+
+	void Renderer::RTRecordIDReadback(RenderCommandList& cmdList, const Ref<Image>& idImage, const glm::uvec2& pixel) {
+		LUCY_ASSERT(IsOnRenderThread(), "RTRecordIDReadback is being called from the main thread!");
+		s_Backend->RTRecordIDReadback(cmdList.GetPrimaryCommandPool(), idImage, pixel);
 	}
 
 	void Renderer::PushShader(Ref<Shader> shader) {
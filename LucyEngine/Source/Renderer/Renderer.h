@@ -1,5 +1,7 @@
 #pragma once
 
+#include <mutex>
+
 #include "Renderer/RendererBackend.h"
 
 #include "Pipeline/PipelineManager.h"
@@ -9,9 +11,14 @@
 #include "Device/RenderDevice.h"
 
 #include "Image/Image.h"
+#include "Image/TextureCache.h"
+#include "Image/TextureStreamer.h"
+#include "Image/VulkanMipGenerator.h"
 #include "Memory/Buffer/IndexBuffer.h"
 #include "Renderer/Mesh.h"
 
+#include "Events/InputEvent.h"
+
 namespace Lucy {
 
 	class RenderPipeline;
@@ -67,6 +74,7 @@ namespace Lucy {
 
 		static void EnqueueToRenderCommandQueue(RenderCommandFunc&& func);
 		static void EnqueueResourceDestroy(RenderResourceHandle& handle);
+		static void EnqueueDeletion(RenderDeletionFunc&& func);
 #pragma endregion RenderDevice
 		static void InitializeImGui();
 		static void RenderImGui();
@@ -85,9 +93,13 @@ namespace Lucy {
 
 		static inline Unique<PipelineManager>& GetPipelineManager() { return s_PipelineManager; }
 		static inline Unique<MaterialManager>& GetMaterialManager() { return s_MaterialManager; }
+		static inline Unique<TextureCache>& GetTextureCache() { return s_TextureCache; }
+		static inline Unique<TextureStreamer>& GetTextureStreamer() { return s_TextureStreamer; }
+		static inline Unique<VulkanMipGenerator>& GetMipGenerator() { return s_MipGenerator; }
 
 		static inline RenderArchitecture GetRenderArchitecture() { return s_Config.RenderArchitecture; }
 
+		static inline Ref<Image> GetBlankImage() { return GetRenderDevice()->AccessResource<Image>(s_BlankImageHandle); }
 		static inline RenderResourceHandle GetBlankCubeImageHandle() { return s_BlankCubeHandle; }
 		static inline Ref<Image> GetBlankCubeImage() { return GetRenderDevice()->AccessResource<Image>(s_BlankCubeHandle); }
 		static inline const Ref<Mesh>& GetEnvCubeMesh() { return s_CubeMesh; }
@@ -101,7 +113,22 @@ namespace Lucy {
 		static void RTSetBackend(Ref<RendererBackend> backend);
 
 		static void OnEvent(Event& evt);
+
+		//the ID pass only runs, while a pick is pending (see USE_GPU_PICKING)
+		static bool IsPickPending();
+		//in the ID image, read by the passes on the render thread
+		static glm::uvec2 GetPendingPickPixel();
+		//records the readback of the picked texel, it is resolved asynchronously once the frame has been completed
+		static void RTRecordIDReadback(RenderCommandList& cmdList, const Ref<Image>& idImage, const glm::uvec2& pixel);
 	private:
+		struct PickRequest {
+			Scene* TargetScene = nullptr;
+			glm::uvec2 Pixel = glm::uvec2(0);
+			EntityPickedFunc OnPicked;
+			uint32_t FrameIndex = 0; //the frame, in which the ID pass has been rendered
+			bool IsSubmitted = false;
+		};
+
 		static inline const Ref<RenderContext>& GetRenderContext() { return s_Backend->GetRenderContext(); }
 		static inline const Ref<RenderDevice>& GetRenderDevice() { return s_Backend->GetRenderDevice(); }
 
@@ -112,7 +139,10 @@ namespace Lucy {
 
 		static void OnWindowResize();
 		static void OnViewportResize();
-		static glm::vec3 OnMousePicking(const EntityPickedEvent& e);
+		static void OnMousePicking(const EntityPickedEvent& e);
+		static void ResolvePick(const PickRequest& pick);
+		//applies the residency changes of the texture streamer to the images
+		static void RTUpdateTextureStreaming();
 
 		static void PushShader(Ref<Shader> shader);
 		static void DestroyAllShaders();
@@ -126,12 +156,19 @@ namespace Lucy {
 
 		static inline Unique<PipelineManager> s_PipelineManager;
 		static inline Unique<MaterialManager> s_MaterialManager;
+		static inline Unique<TextureCache> s_TextureCache;
+		static inline Unique<TextureStreamer> s_TextureStreamer;
+		static inline Unique<VulkanMipGenerator> s_MipGenerator;
 
 		static inline std::unordered_map<std::string, Ref<Shader>> s_Shaders;
 
 		static inline RenderResourceHandle s_BlankCubeHandle = InvalidRenderResourceHandle;
+		static inline RenderResourceHandle s_BlankImageHandle = InvalidRenderResourceHandle;
 		static inline Ref<Mesh> s_CubeMesh = nullptr;
 
+		static inline std::optional<PickRequest> s_PendingPick;
+		static inline std::mutex s_PendingPickMutex; //the main thread replaces and resolves the pick, while the passes read it on the render thread
+
 		friend class Application; //for Init etc.
 		friend class RenderGraph; //for CreateImage etc.
 
@@ -53,6 +53,10 @@ namespace Lucy {
 		});
 	}
 
+	void RendererBackend::EnqueueDeletion(RenderDeletionFunc&& func) {
+		m_ResourceDeletionQueues[GetCurrentFrameIndex()].emplace_back(std::move(func));
+	}
+
 	void RendererBackend::SubmitToRender(RenderGraphPass& pass, RenderResourceHandle renderPassHandle, RenderResourceHandle frameBufferHandle) {
 		//LUCY_ASSERT(!Renderer::IsOnRenderThread(), "SubmitToRender should only be called on the main thread!");
 		EnqueueToRenderCommandQueue([&, renderPassHandle, frameBufferHandle](RenderCommandList& cmdList) {
@@ -66,6 +70,13 @@ namespace Lucy {
 		});
 	}
 
+	void RendererBackend::SubmitToRender(RenderGraphPass& pass) {
+		EnqueueToRenderCommandQueue([&](RenderCommandList& cmdList) {
+			LUCY_PROFILE_NEW_EVENT("RendererBackend::SubmitToRender");
+			pass.Execute(cmdList);
+		});
+	}
+
 	void RendererBackend::SubmitToCompute(RenderGraphPass& pass) {
 		(*m_RenderComputeCommandQueue) += ([&](RenderCommandList& cmdList) {
 			LUCY_PROFILE_NEW_EVENT("RendererBackend::SubmitToCompute");
@@ -11,13 +11,12 @@ namespace Lucy {
 	class Image;
 	class VulkanPushConstant;
 	class DescriptorSet;
+	class CommandPool;
 
 	class RenderDevice;
 	class SwapChain;
 	class RenderGraphPass;
 
-	struct EntityPickedEvent;
-
 	using RenderDeletionFunc = std::function<void()>;
 
 	class RendererBackend : public MemoryTrackable {
@@ -32,8 +31,12 @@ namespace Lucy {
 		
 		void EnqueueToRenderCommandQueue(RenderCommandFunc&& func);
 		void EnqueueResourceDestroy(RenderResourceHandle handle);
+		//for API objects, that are not a render resource (e.g. staging buffers)
+		void EnqueueDeletion(RenderDeletionFunc&& func);
 
 		void SubmitToRender(RenderGraphPass& pass, RenderResourceHandle renderPassHandle, RenderResourceHandle frameBufferHandle);
+		//for graphics queue passes that do not render into any target (e.g. compute work that has to be ordered before a draw)
+		void SubmitToRender(RenderGraphPass& pass);
 		void SubmitToCompute(RenderGraphPass& pass);
 		virtual RenderContextResultCodes WaitAndPresent() = 0;
 
@@ -52,7 +55,15 @@ namespace Lucy {
 
 		virtual void OnWindowResize() = 0;
 		virtual void OnViewportResize() = 0;
-		virtual glm::vec3 OnMousePicking(const EntityPickedEvent& e, const Ref<Image>& currentFrameBufferImage) = 0;
+		//copies a single texel of the ID image into the readback slot of the current frame
+		virtual void RTRecordIDReadback(const Ref<CommandPool>& cmdPool, const Ref<Image>& idImage, const glm::uvec2& pixel) = 0;
+		//returns the mesh ID, that has been read back in the given frame or -1, if nothing has been rendered there.
+		//only valid once the frame has been completed by the GPU
+		virtual glm::vec3 ReadIDReadback(uint32_t frameIndex) = 0;
+		//non blocking, true if the GPU has finished the last submission of the given frame
+		virtual bool IsFrameCompleted(uint32_t frameIndex) = 0;
+		//false, if the last frame of the given index has not been submitted (e.g. the swap chain image could not be acquired)
+		virtual bool IsFrameSubmitted(uint32_t frameIndex) = 0;
 
 		virtual void InitializeImGui() = 0;
 		virtual void RTRenderImGui() = 0;
@@ -11,6 +11,10 @@
 #include "Pipeline/ComputePipeline.h"
 
 #include "Scene/Components.h"
+#include "Scene/Entity.h"
+
+#include "Mesh.h"
+#include "HiZPyramid.h"
 
 #include "glm/gtx/euler_angles.hpp"
 
@@ -25,14 +29,361 @@ namespace Lucy {
 		we have to separate mesh and materials. materials should set each thing
 	*/
 
+	void CulledMeshList::Cull(Scene& scene, const Maths::Frustum* frustums, uint32_t frustumCount) {
+		LUCY_PROFILE_NEW_EVENT("CulledMeshList::Cull");
+		Entries.clear();
+		Candidates.clear();
+
+		//whole subtrees outside of a view are skipped, only the meshes with a valid bounds have a proxy
+		for (uint32_t i = 0; i < frustumCount; i++) {
+			scene.GetBVH().QueryFrustum(frustums[i], [&](uint32_t userData) {
+				Candidates.push_back(userData);
+				return true;
+			});
+		}
+
+		//a mesh, that is seen by several views, is only drawn once
+		if (frustumCount > 1) {
+			std::sort(Candidates.begin(), Candidates.end());
+			Candidates.erase(std::unique(Candidates.begin(), Candidates.end()), Candidates.end());
+		}
+
+		//the tree only knows the fat bounds, the candidates are tested with their tight bounds (4 at a time)
+		Culler.Clear();
+		Culler.Reserve(Candidates.size());
+		CandidateEntries.clear();
+		for (uint32_t userData : Candidates) {
+			Entity entity{ &scene, (entt::entity)userData };
+			MeshComponent& meshComponent = entity.GetComponent<MeshComponent>();
+			if (!meshComponent.IsValid())
+				continue;
+
+			Culler.Add(entity.GetComponent<BoundsComponent>().GetAABB());
+			CandidateEntries.push_back({ &meshComponent, &entity.GetComponent<TransformComponent>() });
+		}
+
+		IsVisible.assign(CandidateEntries.size(), 0);
+		for (uint32_t i = 0; i < frustumCount; i++) {
+			Culler.Cull(frustums[i], VisibleIndices);
+			for (uint32_t index : VisibleIndices)
+				IsVisible[index] = 1;
+		}
+
+		for (size_t i = 0; i < CandidateEntries.size(); i++) {
+			if (IsVisible[i])
+				Entries.push_back(CandidateEntries[i]);
+		}
+	}
+
 #pragma region ForwardPBRPass
 
+	struct ClusterCullPushConstants {
+		glm::vec4 FrustumPlanes[Maths::Frustum::PlaneCount];
+		glm::vec4 CamPos;
+		uint32_t MeshletCount = 0;
+		uint32_t ConeCullingEnabled = 0;
+		uint32_t Phase = 0; //0 = early, 1 = late
+	};
+
+	struct OcclusionCullParams {
+		glm::mat4 ViewProjections[2]; //per phase
+		glm::uvec2 DepthSize;
+		uint32_t PyramidMipCount = 0;
+		uint32_t BatchCount = 0;
+		glm::uvec2 OcclusionCullingEnabled; //per phase
+	};
+	static_assert(sizeof(OcclusionCullParams) == 152, "OcclusionCullParams does not match the std140 layout!");
+
+	struct HiZPushConstants {
+		glm::uvec2 DepthSize;
+		uint32_t MipCount = 0;
+		uint32_t WorkGroupCount = 0;
+	};
+
+	//a meshlet whose normal cone faces away is only invisible, if its back faces are culled by the rasterizer as well (open or double sided geometry)
+	static bool IsConeCullingEnabled(const Ref<GraphicsPipeline>& geometryPipeline) {
+		if (!USE_CLUSTER_CONE_CULLING)
+			return false;
+		const Rasterization rasterization = geometryPipeline->GetRasterization();
+		return !rasterization.DisableBackCulling && (rasterization.CullingMode == CullingMode::Back || rasterization.CullingMode == CullingMode::FrontAndBack);
+	}
+
+	//records the reduction of the current content of the depth image into the pyramid (see LucyHiZ.comp).
+	//the descriptors are only updated once per frame, otherwise the already recorded commands would be invalidated
+	static void RecordHiZPyramid(const ForwardPBRPass::ShaderBindings& bindings, const Ref<Image>& depthImage, RenderCommandList& cmdList, bool updateDescriptorSets, bool dispatch) {
+		static constexpr const uint32_t tileSize = 64; //depth texels per workgroup and axis
+
+		const auto& pipeline = Renderer::GetPipelineManager()->GetAs<ComputePipeline>("HiZComputePipeline");
+		const auto& shader = pipeline->GetShader();
+
+		const glm::uvec2 depthSize = glm::uvec2(depthImage->GetWidth(), depthImage->GetHeight());
+		const glm::uvec2 workGroupCount = (depthSize + tileSize - 1u) / tileSize;
+
+		const auto& pyramidBuffer = shader->GetSharedStorageBuffer(bindings.HiZPyramid);
+
+		if (updateDescriptorSets) {
+			shader->BindImageHandleTo(bindings.HiZDepthImage, depthImage);
+			//entirely written by the GPU
+			pyramidBuffer->SetDeviceSize(HiZPyramid::GetTexelCount(depthSize.x, depthSize.y) * sizeof(float));
+			//the last workgroup resets the counter, it only has to be 0 initially
+			const uint32_t finishedWorkGroups = 0;
+			shader->GetSharedStorageBuffer(bindings.HiZAtomicCounter)->SetData((uint8_t*)&finishedWorkGroups, sizeof(uint32_t));
+		}
+
+		HiZPushConstants pushConstantData;
+		pushConstantData.DepthSize = depthSize;
+		pushConstantData.MipCount = HiZPyramid::GetMipCount(depthSize.x, depthSize.y);
+		pushConstantData.WorkGroupCount = workGroupCount.x * workGroupCount.y;
+
+		VulkanPushConstant& pushConstant = shader->GetPushConstants("LucyHiZPushConstants");
+		pushConstant.SetData((uint8_t*)&pushConstantData, sizeof(HiZPushConstants));
+
+		RenderCommand& hiz = cmdList.BeginRenderCommand("HiZPyramid");
+		hiz.BindPipeline(pipeline);
+		if (updateDescriptorSets)
+			hiz.UpdateDescriptorSets();
+
+		if (dispatch) {
+			hiz.BindAllDescriptorSets();
+			hiz.BindPushConstant(pushConstant);
+
+			//the depth has been written by a render pass and the pyramid might still be read by the cull of the last phase
+			hiz.SetMemoryBarrier(VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+								 VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+			hiz.DispatchCompute(workGroupCount.x, workGroupCount.y, 1);
+
+			//the pyramid is read by the cull, the depth is written again by the next render pass (write after read)
+			hiz.SetBufferBarrier(pyramidBuffer, VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT,
+								 VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+			hiz.SetMemoryBarrier(0, VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+								 VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT);
+		}
+
+		cmdList.EndRenderCommand();
+	}
+
 	ForwardPBRPass::ForwardPBRPass(Ref<Scene> scene, uint32_t width, uint32_t height)
-		: m_Scene(scene), m_Width(width), m_Height(height) {
+		: m_Scene(scene), m_Width(width), m_Height(height), m_ClusterDrawList(Memory::CreateRef<ClusterDrawList>()), m_CulledMeshList(Memory::CreateRef<CulledMeshList>()),
+		m_OcclusionCullHistory(Memory::CreateRef<OcclusionCullHistory>()), m_ShaderBindings(Memory::CreateRef<ShaderBindings>()) {
+	}
+
+	void ForwardPBRPass::ResolveShaderBindings() const {
+		ShaderBindings& bindings = *m_ShaderBindings;
+		if (bindings.IsResolved)
+			return;
+
+		const auto& pipelineManager = Renderer::GetPipelineManager();
+
+		const auto& hizShader = pipelineManager->GetAs<ComputePipeline>("HiZComputePipeline")->GetShader();
+		bindings.HiZPyramid = hizShader->GetBindingHandle("LucyHiZPyramid");
+		bindings.HiZAtomicCounter = hizShader->GetBindingHandle("LucyHiZAtomicCounter");
+		bindings.HiZDepthImage = hizShader->GetBindingHandle("u_DepthImage");
+
+		const auto& cullShader = pipelineManager->GetAs<ComputePipeline>("ClusterCullComputePipeline")->GetShader();
+		bindings.MeshletCullData = cullShader->GetBindingHandle("LucyMeshletCullData");
+		bindings.ClusterDrawData = cullShader->GetBindingHandle("LucyClusterDrawData");
+		bindings.IndirectDraws = cullShader->GetBindingHandle("LucyIndirectDraws");
+		bindings.IndirectDrawCounts = cullShader->GetBindingHandle("LucyIndirectDrawCounts");
+		bindings.InstanceBounds = cullShader->GetBindingHandle("LucyInstanceBounds");
+		bindings.MeshletVisibility = cullShader->GetBindingHandle("LucyMeshletVisibility");
+		bindings.CullHiZPyramid = cullShader->GetBindingHandle("LucyHiZPyramid");
+		bindings.OcclusionCullParams = cullShader->GetBindingHandle("LucyOcclusionCullParams");
+
+		const auto& pbrShader = pipelineManager->GetAs<GraphicsPipeline>("PBRGeometryPipeline")->GetShader();
+		bindings.LightningValues = pbrShader->GetBindingHandle("LucyLightningValues");
+		bindings.ShadowMap = pbrShader->GetBindingHandle("u_ShadowMap");
+		bindings.Textures = pbrShader->GetBindingHandle("u_Textures");
+		bindings.IrradianceMap = pbrShader->GetBindingHandle("u_IrradianceMap");
+		bindings.PBRCamera = pbrShader->GetBindingHandle("LucyCamera");
+		bindings.PBRClusterDrawData = pbrShader->GetBindingHandle("LucyClusterDrawData");
+
+		const auto& idShader = pipelineManager->GetAs<GraphicsPipeline>("IDPipeline")->GetShader();
+		bindings.IDCamera = idShader->GetBindingHandle("LucyCamera");
+
+		bindings.IsResolved = true;
 	}
 
 	void ForwardPBRPass::AddPass(const Ref<RenderGraph>& renderGraph) {
 
+		//the geometry depth image still contains the depth of the last frame at this point.
+		//it can't be declared as a read, since the geometry passes of this frame write it (cycle)
+		renderGraph->AddPass(TargetQueueFamily::Graphics, "HiZEarlyPass", [=, *this](RenderGraphBuilder& build) {
+			build.WriteBuffer(RGResource(HiZPyramidEarly));
+
+			return [=](RenderGraphRegistry& registry, RenderCommandList& cmdList) {
+				ResolveShaderBindings();
+
+				const auto& depthImage = registry.GetImage(RGResource(GeometryDepthImage));
+				const OcclusionCullHistory& history = *m_OcclusionCullHistory;
+				const bool historyValid = USE_HIZ_OCCLUSION_CULLING && history.IsValid &&
+					history.DepthSize == glm::uvec2(depthImage->GetWidth(), depthImage->GetHeight());
+
+				RecordHiZPyramid(*m_ShaderBindings, depthImage, cmdList, true, historyValid);
+			};
+		});
+
+		//recorded on the graphics queue without a render pass, so that the indirect draws are ready before the geometry pass
+		renderGraph->AddPass(TargetQueueFamily::Graphics, "ClusterCullPass", [=, *this](RenderGraphBuilder& build) {
+			build.ReadBuffer(RGResource(HiZPyramidEarly));
+			build.WriteBuffer(RGResource(ClusterDrawCommands));
+
+			return [=](RenderGraphRegistry& registry, RenderCommandList& cmdList) {
+				static constexpr const uint32_t workGroupSize = 64;
+
+				ResolveShaderBindings();
+				const ShaderBindings& bindings = *m_ShaderBindings;
+
+				const auto& pipeline = Renderer::GetPipelineManager()->GetAs<ComputePipeline>("ClusterCullComputePipeline");
+				const auto& shader = pipeline->GetShader();
+
+				ClusterDrawList& drawList = *m_ClusterDrawList;
+				drawList.Clear();
+
+				const auto& vp = m_Scene->GetEditorCamera().GetCameraViewProjection();
+				const glm::vec3 cameraPosition = glm::vec3(vp.CamPos);
+				const glm::mat4 viewProjection = vp.Proj * vp.View;
+				const Maths::Frustum frustum = Maths::ExtractFrustum(viewProjection);
+
+				drawList.ViewProjection = viewProjection;
+				drawList.Frustum = frustum;
+				drawList.CameraPosition = vp.CamPos;
+
+				//whole meshes are culled on the CPU first, the meshlets of the visible ones are culled on the GPU
+				CulledMeshList& culledMeshes = *m_CulledMeshList;
+				culledMeshes.Cull(*m_Scene, &frustum, 1);
+
+				culledMeshes.ForEachVisible([&](MeshComponent& meshComponent, TransformComponent& transformComponent) {
+					const Ref<Mesh>& mesh = meshComponent.GetMesh();
+					const glm::mat4& meshTransform = transformComponent.GetMatrix();
+
+					const uint32_t batchIndex = (uint32_t)drawList.Batches.size();
+					const uint32_t batchFirstCommand = (uint32_t)drawList.Meshlets.size();
+
+					const auto& submeshes = mesh->GetSubmeshes();
+					std::vector<uint32_t>& submeshLODs = meshComponent.GetSubmeshLODs();
+					submeshLODs.resize(submeshes.size(), 0u);
+
+					for (uint32_t i = 0; i < submeshes.size(); i++) {
+						const Submesh& submesh = submeshes[i];
+						const glm::mat4 modelMatrix = meshTransform * submesh.Transform;
+
+						const uint32_t drawDataIndex = (uint32_t)drawList.DrawData.size();
+						drawList.DrawData.push_back(ClusterDrawData{
+							.ModelMatrix = modelMatrix,
+							.MaterialID = submesh.MaterialID,
+						});
+
+						InstanceBoundsData& bounds = drawList.InstanceBounds.emplace_back();
+						if (submesh.BoundingBox.IsValid()) {
+							const Maths::AABB worldAABB = Maths::TransformAABB(submesh.BoundingBox, modelMatrix);
+							bounds.Min = glm::vec4(worldAABB.Min, 1.0f);
+							bounds.Max = glm::vec4(worldAABB.Max, 1.0f);
+						}
+
+						const float maxScale = glm::max(glm::length(glm::vec3(modelMatrix[0])), glm::max(glm::length(glm::vec3(modelMatrix[1])), glm::length(glm::vec3(modelMatrix[2]))));
+						const float screenSize = LODSelector::ComputeScreenSize(glm::vec3(modelMatrix * glm::vec4(submesh.BoundsCenter, 1.0f)),
+																				submesh.BoundsRadius * maxScale, cameraPosition, vp.Proj[1][1]);
+						const uint32_t lod = LODSelector::Select(screenSize, submeshLODs[i], submesh.GetLODCount());
+						submeshLODs[i] = lod;
+
+#if USE_TEXTURE_STREAMING
+						//the projected diameter of the submesh in pixels
+						Renderer::GetMaterialManager()->RequestTextureMips(submesh.MaterialID, screenSize * (float)m_Height);
+#endif
+
+						const std::vector<Meshlet>& meshlets = lod == 0 ? submesh.Meshlets : submesh.LODs[lod - 1].Meshlets;
+						const uint32_t baseIndexCount = lod == 0 ? submesh.BaseIndexCount : submesh.LODs[lod - 1].BaseIndexCount;
+
+						for (const Meshlet& meshlet : meshlets) {
+							drawList.Meshlets.push_back(MeshletCullData{
+								.Sphere = glm::vec4(meshlet.Center, meshlet.Radius),
+								.Cone = glm::vec4(meshlet.ConeAxis, meshlet.ConeCutoff),
+								.FirstIndex = baseIndexCount + meshlet.FirstIndex,
+								.IndexCount = meshlet.IndexCount,
+								.VertexOffset = (int32_t)submesh.BaseVertexCount,
+								.DrawDataIndex = drawDataIndex,
+								.BatchIndex = batchIndex,
+								.BatchFirstCommand = batchFirstCommand,
+							});
+						}
+					}
+
+					const uint32_t meshletCount = (uint32_t)drawList.Meshlets.size() - batchFirstCommand;
+					if (meshletCount == 0)
+						return;
+					drawList.Batches.push_back({ mesh, batchFirstCommand, meshletCount });
+				});
+
+				if (drawList.Meshlets.empty())
+					return;
+
+				const auto& meshletBuffer = shader->GetSharedStorageBuffer(bindings.MeshletCullData);
+				const auto& drawDataBuffer = shader->GetSharedStorageBuffer(bindings.ClusterDrawData);
+				const auto& indirectDrawBuffer = shader->GetSharedStorageBuffer(bindings.IndirectDraws);
+				const auto& drawCountBuffer = shader->GetSharedStorageBuffer(bindings.IndirectDrawCounts);
+				const auto& instanceBoundsBuffer = shader->GetSharedStorageBuffer(bindings.InstanceBounds);
+				const auto& visibilityBuffer = shader->GetSharedStorageBuffer(bindings.MeshletVisibility);
+
+				meshletBuffer->SetData((uint8_t*)drawList.Meshlets.data(), drawList.Meshlets.size() * sizeof(MeshletCullData));
+				drawDataBuffer->SetData((uint8_t*)drawList.DrawData.data(), drawList.DrawData.size() * sizeof(ClusterDrawData));
+				instanceBoundsBuffer->SetData((uint8_t*)drawList.InstanceBounds.data(), drawList.InstanceBounds.size() * sizeof(InstanceBoundsData));
+
+				//the commands and the visibility are entirely written by the GPU, only the size has to fit.
+				//the visibility is written for every meshlet by the early cull and only read by the late cull of the same frame,
+				//so the reordered list of the next frame never sees bits of other meshlets.
+				//the counts are reset to 0 every frame, since the shader appends to them.
+				//both phases have their own commands and counts, the ones of the late phase come after the early ones
+				indirectDrawBuffer->SetDeviceSize(2 * drawList.Meshlets.size() * sizeof(VkDrawIndexedIndirectCommand));
+				visibilityBuffer->SetDeviceSize(drawList.Meshlets.size() * sizeof(uint32_t));
+				drawCountBuffer->Clear();
+				drawCountBuffer->Resize(2 * drawList.Batches.size() * sizeof(uint32_t));
+
+				//both phases read the pyramid of the HiZ shader, it holds the last frame for the early and the early phase for the late cull
+				const auto& hizShader = Renderer::GetPipelineManager()->GetAs<ComputePipeline>("HiZComputePipeline")->GetShader();
+				shader->BindSharedStorageBufferTo(bindings.CullHiZPyramid, hizShader->GetSharedStorageBuffer(bindings.HiZPyramid));
+
+				const auto& depthImage = registry.GetImage(RGResource(GeometryDepthImage));
+				const glm::uvec2 depthSize = glm::uvec2(depthImage->GetWidth(), depthImage->GetHeight());
+				const OcclusionCullHistory& history = *m_OcclusionCullHistory;
+
+				OcclusionCullParams occlusionCullParams;
+				occlusionCullParams.ViewProjections[0] = history.ViewProjection;
+				occlusionCullParams.ViewProjections[1] = viewProjection;
+				occlusionCullParams.DepthSize = depthSize;
+				occlusionCullParams.PyramidMipCount = HiZPyramid::GetMipCount(depthSize.x, depthSize.y);
+				occlusionCullParams.BatchCount = (uint32_t)drawList.Batches.size();
+				occlusionCullParams.OcclusionCullingEnabled = glm::uvec2(USE_HIZ_OCCLUSION_CULLING && history.IsValid && history.DepthSize == depthSize,
+																		 USE_HIZ_OCCLUSION_CULLING);
+				shader->GetUniformBuffer(bindings.OcclusionCullParams)->SetData((uint8_t*)&occlusionCullParams, sizeof(OcclusionCullParams));
+
+				ClusterCullPushConstants pushConstantData;
+				memcpy(pushConstantData.FrustumPlanes, frustum.Planes, sizeof(frustum.Planes));
+				pushConstantData.CamPos = vp.CamPos;
+				pushConstantData.MeshletCount = (uint32_t)drawList.Meshlets.size();
+				pushConstantData.ConeCullingEnabled = IsConeCullingEnabled(Renderer::GetPipelineManager()->GetAs<GraphicsPipeline>("PBRGeometryPipeline"));
+				pushConstantData.Phase = 0;
+
+				VulkanPushConstant& pushConstant = shader->GetPushConstants("LucyClusterCullPushConstants");
+				pushConstant.SetData((uint8_t*)&pushConstantData, sizeof(ClusterCullPushConstants));
+
+				RenderCommand& cull = cmdList.BeginRenderCommand("ClusterCull");
+				cull.BindPipeline(pipeline);
+				cull.UpdateDescriptorSets();
+				cull.BindAllDescriptorSets();
+				cull.BindPushConstant(pushConstant);
+				cull.DispatchCompute((pushConstantData.MeshletCount + workGroupSize - 1) / workGroupSize, 1, 1);
+
+				cull.SetBufferBarrier(visibilityBuffer, VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT,
+									  VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+				cull.SetBufferBarrier(indirectDrawBuffer, VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT,
+									  VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT);
+				cull.SetBufferBarrier(drawCountBuffer, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT,
+									  VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT);
+
+				cmdList.EndRenderCommand();
+			};
+		});
+
 		renderGraph->AddPass(TargetQueueFamily::Graphics, "PBRGeometryPass", [=, *this](RenderGraphBuilder& build) {
 			build.SetViewportArea(m_Width, m_Height);
 			build.SetInFlightMode(true);
@@ -56,15 +407,21 @@ namespace Lucy {
 			}, RenderPassLoadStoreAttachments::ClearStore);
 
 			build.ReadImage(RGResource(ShadowImages));
+			build.ReadBuffer(RGResource(ClusterDrawCommands));
+			//stands for the depth of the early phase, GeometryDepthImage itself is written by the late geometry pass as well
+			build.WriteBuffer(RGResource(GeometryEarlyDepth));
 
 			build.BindRenderTarget(RGResource(GeometryImage), RGResource(GeometryDepthImage));
 
 			return [=](RenderGraphRegistry& registry, RenderCommandList& cmdList) {
+				ResolveShaderBindings();
+				const ShaderBindings& bindings = *m_ShaderBindings;
+
 				const auto& pipeline = Renderer::GetPipelineManager()->GetAs<GraphicsPipeline>("PBRGeometryPipeline");
 				const auto& shader = pipeline->GetShader();
 
 				m_Scene->ViewForEach<DirectionalLightComponent>([&, pbrShader = shader](DirectionalLightComponent& lightComponent) {
-					const auto& lightningAttributes = pbrShader->GetUniformBufferIfExists("LucyLightningValues");
+					const auto& lightningAttributes = pbrShader->GetUniformBuffer(bindings.LightningValues);
 					lightningAttributes->SetData((uint8_t*)&lightComponent, sizeof(DirectionalLightComponent));
 
 					glm::vec4 shadowCameraFarPlanes;
@@ -85,37 +442,150 @@ namespace Lucy {
 					lightningAttributes->Append((uint8_t*)&shadowCameraFarPlanes, sizeof(glm::vec4));
 				});
 
-				shader->BindImageHandleTo("u_ShadowMap", registry.GetImage(RGResource(ShadowImages)));
+				shader->BindImageHandleTo(bindings.ShadowMap, registry.GetImage(RGResource(ShadowImages)));
+				//the materials only store the indices of their textures
+				Renderer::GetTextureCache()->BindBindlessTextures(shader, bindings.Textures);
 
 				bool imageBound = false;
 
-				m_Scene->ViewForEach<HDRCubemapComponent>([pbrShader = shader, &registry, &imageBound](const HDRCubemapComponent& hdrComponent) {
+				m_Scene->ViewForEach<HDRCubemapComponent>([pbrShader = shader, &bindings, &registry, &imageBound](const HDRCubemapComponent& hdrComponent) {
 					if (!hdrComponent.IsPrimary || imageBound)
 						return;
 #if USE_COMPUTE_FOR_CUBEMAP_GEN
-					pbrShader->BindImageHandleTo("u_IrradianceMap", hdrComponent.GetIrradianceImage());
+					pbrShader->BindImageHandleTo(bindings.IrradianceMap, hdrComponent.GetIrradianceImage());
 #else
-					pbrShader->BindImageHandleTo("u_IrradianceMap", registry.GetImage(RGResource(IrradianceImage)));
+					pbrShader->BindImageHandleTo(bindings.IrradianceMap, registry.GetImage(RGResource(IrradianceImage)));
 #endif
 					imageBound = true;
 				});
 
-				if (!shader->HasImageHandleBoundTo("u_IrradianceMap"))
-					shader->BindImageHandleTo("u_IrradianceMap", Renderer::GetBlankCubeImage());
+				if (!shader->HasImageHandleBoundTo(bindings.IrradianceMap))
+					shader->BindImageHandleTo(bindings.IrradianceMap, Renderer::GetBlankCubeImage());
 
-				if (auto cameraBuffer = shader->GetUniformBufferIfExists("LucyCamera")) {
+				if (auto cameraBuffer = shader->GetUniformBuffer(bindings.PBRCamera)) {
 					auto vp = m_Scene->GetEditorCamera().GetCameraViewProjection();
 					cameraBuffer->SetData((uint8_t*)&vp, sizeof(vp));
 				}
 
+				const ClusterDrawList& drawList = *m_ClusterDrawList;
+				if (auto drawDataBuffer = shader->GetSharedStorageBuffer(bindings.PBRClusterDrawData))
+					drawDataBuffer->SetData((uint8_t*)drawList.DrawData.data(), drawList.DrawData.size() * sizeof(ClusterDrawData));
+
+				//written by the cluster cull pass
+				const auto& cullShader = Renderer::GetPipelineManager()->GetAs<ComputePipeline>("ClusterCullComputePipeline")->GetShader();
+				const auto& indirectDrawBuffer = cullShader->GetSharedStorageBuffer(m_ShaderBindings->IndirectDraws);
+				const auto& drawCountBuffer = cullShader->GetSharedStorageBuffer(m_ShaderBindings->IndirectDrawCounts);
+
 				RenderCommand& draw = cmdList.BeginRenderCommand("PBRForwardPass");
 				draw.BindPipeline(pipeline);
 				draw.UpdateDescriptorSets();
 				draw.BindAllDescriptorSets();
 
-				m_Scene->ViewRForEach<MeshComponent, TransformComponent>([&](MeshComponent& meshComponent, TransformComponent& transformComponent) {
-					draw.DrawIndexedMeshWithMaterial(meshComponent.GetMesh(), transformComponent.GetMatrix());
-				});
+				for (uint32_t i = 0; i < drawList.Batches.size(); i++) {
+					const ClusterDrawList::Batch& batch = drawList.Batches[i];
+					draw.DrawIndexedIndirectCount(batch.Mesh, indirectDrawBuffer, batch.FirstCommand * sizeof(VkDrawIndexedIndirectCommand),
+												  drawCountBuffer, i * sizeof(uint32_t), batch.MaxCommandCount);
+				}
+
+				cmdList.EndRenderCommand();
+			};
+		});
+
+		renderGraph->AddPass(TargetQueueFamily::Graphics, "HiZLatePass", [=, *this](RenderGraphBuilder& build) {
+			build.ReadBuffer(RGResource(GeometryEarlyDepth));
+			build.WriteBuffer(RGResource(HiZPyramidLate));
+
+			return [=](RenderGraphRegistry& registry, RenderCommandList& cmdList) {
+				if (!USE_HIZ_OCCLUSION_CULLING || m_ClusterDrawList->Meshlets.empty())
+					return;
+				RecordHiZPyramid(*m_ShaderBindings, registry.GetImage(RGResource(GeometryDepthImage)), cmdList, false, true);
+			};
+		});
+
+		renderGraph->AddPass(TargetQueueFamily::Graphics, "ClusterCullLatePass", [=, *this](RenderGraphBuilder& build) {
+			build.ReadBuffer(RGResource(HiZPyramidLate));
+			build.WriteBuffer(RGResource(ClusterLateDrawCommands));
+
+			return [=](RenderGraphRegistry& registry, RenderCommandList& cmdList) {
+				static constexpr const uint32_t workGroupSize = 64;
+
+				const ClusterDrawList& drawList = *m_ClusterDrawList;
+				if (!USE_HIZ_OCCLUSION_CULLING || drawList.Meshlets.empty())
+					return;
+
+				const auto& pipeline = Renderer::GetPipelineManager()->GetAs<ComputePipeline>("ClusterCullComputePipeline");
+				const auto& shader = pipeline->GetShader();
+
+				const auto& indirectDrawBuffer = shader->GetSharedStorageBuffer(m_ShaderBindings->IndirectDraws);
+				const auto& drawCountBuffer = shader->GetSharedStorageBuffer(m_ShaderBindings->IndirectDrawCounts);
+
+				ClusterCullPushConstants pushConstantData;
+				memcpy(pushConstantData.FrustumPlanes, drawList.Frustum.Planes, sizeof(drawList.Frustum.Planes));
+				pushConstantData.CamPos = drawList.CameraPosition;
+				pushConstantData.MeshletCount = (uint32_t)drawList.Meshlets.size();
+				pushConstantData.ConeCullingEnabled = IsConeCullingEnabled(Renderer::GetPipelineManager()->GetAs<GraphicsPipeline>("PBRGeometryLatePipeline"));
+				pushConstantData.Phase = 1;
+
+				VulkanPushConstant& pushConstant = shader->GetPushConstants("LucyClusterCullPushConstants");
+				pushConstant.SetData((uint8_t*)&pushConstantData, sizeof(ClusterCullPushConstants));
+
+				//the descriptors have been updated by the early cull
+				RenderCommand& cull = cmdList.BeginRenderCommand("ClusterCullLate");
+				cull.BindPipeline(pipeline);
+				cull.BindAllDescriptorSets();
+				cull.BindPushConstant(pushConstant);
+				cull.DispatchCompute((pushConstantData.MeshletCount + workGroupSize - 1) / workGroupSize, 1, 1);
+
+				cull.SetBufferBarrier(indirectDrawBuffer, VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT,
+									  VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT);
+				cull.SetBufferBarrier(drawCountBuffer, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT,
+									  VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT);
+
+				cmdList.EndRenderCommand();
+
+				//at the end of the frame the depth image contains everything that is visible with this view
+				const auto& depthImage = registry.GetImage(RGResource(GeometryDepthImage));
+				OcclusionCullHistory& history = *m_OcclusionCullHistory;
+				history.ViewProjection = drawList.ViewProjection;
+				history.DepthSize = glm::uvec2(depthImage->GetWidth(), depthImage->GetHeight());
+				history.IsValid = true;
+			};
+		});
+
+		//draws the meshlets that became visible in the late cull phase, on top of the early geometry pass (load/store, same framebuffer)
+		renderGraph->AddPass(TargetQueueFamily::Graphics, "PBRGeometryLatePass", [=, *this](RenderGraphBuilder& build) {
+			build.SetViewportArea(m_Width, m_Height);
+			build.SetInFlightMode(true);
+
+			build.ReadImage(RGResource(ShadowImages));
+			build.ReadBuffer(RGResource(ClusterLateDrawCommands));
+
+			build.BindRenderTarget(RGResource(GeometryImage), RGResource(GeometryDepthImage));
+
+			return [=](RenderGraphRegistry& registry, RenderCommandList& cmdList) {
+				const ClusterDrawList& drawList = *m_ClusterDrawList;
+				if (!USE_HIZ_OCCLUSION_CULLING || drawList.Meshlets.empty())
+					return;
+
+				const auto& pipeline = Renderer::GetPipelineManager()->GetAs<GraphicsPipeline>("PBRGeometryLatePipeline");
+
+				const auto& cullShader = Renderer::GetPipelineManager()->GetAs<ComputePipeline>("ClusterCullComputePipeline")->GetShader();
+				const auto& indirectDrawBuffer = cullShader->GetSharedStorageBuffer(m_ShaderBindings->IndirectDraws);
+				const auto& drawCountBuffer = cullShader->GetSharedStorageBuffer(m_ShaderBindings->IndirectDrawCounts);
+
+				const size_t meshletCount = drawList.Meshlets.size();
+				const size_t batchCount = drawList.Batches.size();
+
+				//same shader as the early geometry pass, its descriptors are already up to date
+				RenderCommand& draw = cmdList.BeginRenderCommand("PBRForwardLatePass");
+				draw.BindPipeline(pipeline);
+				draw.BindAllDescriptorSets();
+
+				for (uint32_t i = 0; i < batchCount; i++) {
+					const ClusterDrawList::Batch& batch = drawList.Batches[i];
+					draw.DrawIndexedIndirectCount(batch.Mesh, indirectDrawBuffer, (meshletCount + batch.FirstCommand) * sizeof(VkDrawIndexedIndirectCommand),
+												  drawCountBuffer, (batchCount + i) * sizeof(uint32_t), batch.MaxCommandCount);
+				}
 
 				cmdList.EndRenderCommand();
 			};
@@ -144,24 +614,57 @@ namespace Lucy {
 
 			build.BindRenderTarget(RGResource(IDPassImage), RGResource(IDPassDepthImage));
 
+			//only needed for mouse picking, so it is rendered on demand and only into the picked pixel
+			build.SetExecuteCondition([]() { return Renderer::IsPickPending(); });
+
 			return [=](RenderGraphRegistry& registry, RenderCommandList& cmdList) {
+				ResolveShaderBindings();
+
 				const auto& pipeline = Renderer::GetPipelineManager()->GetAs<GraphicsPipeline>("IDPipeline");
 				const auto& shader = pipeline->GetShader();
 
-				if (auto cameraBuffer = shader->GetUniformBufferIfExists("LucyCamera")) {
-					auto vp = m_Scene->GetEditorCamera().GetCameraViewProjection();
+				const auto& vp = m_Scene->GetEditorCamera().GetCameraViewProjection();
+				if (auto cameraBuffer = shader->GetUniformBuffer(m_ShaderBindings->IDCamera))
 					cameraBuffer->SetData((uint8_t*)&vp, sizeof(vp));
-				}
+
+				const auto& idImage = registry.GetImage(RGResource(IDPassImage));
+				const glm::uvec2 imageSize = glm::uvec2(idImage->GetWidth(), idImage->GetHeight());
+				const glm::uvec2 pickPixel = glm::min(Renderer::GetPendingPickPixel(), imageSize - 1u);
+
+				//only the meshes whose bounds are hit by the ray through the picked pixel can end up in it
+				const glm::vec2 ndc = (glm::vec2(pickPixel) + 0.5f) / glm::vec2(imageSize) * 2.0f - 1.0f;
+				std::vector<Entity> pickCandidates;
+				m_Scene->RayCast(Maths::NDCToRay(ndc, vp.Proj * vp.View), FLT_MAX, pickCandidates);
 
 				RenderCommand& draw = cmdList.BeginRenderCommand("IDPass");
 				draw.BindPipeline(pipeline);
 				draw.UpdateDescriptorSets();
 				draw.BindAllDescriptorSets();
+				draw.SetScissor((int32_t)pickPixel.x, (int32_t)pickPixel.y, 1, 1);
 
-				m_Scene->ViewRForEach<MeshComponent, TransformComponent>([&](MeshComponent& meshComponent, TransformComponent& transformComponent) {
-					draw.DrawIndexedMeshWithMaterial(meshComponent.GetMesh(), transformComponent.GetMatrix());
-				});
+				for (Entity& entity : pickCandidates) {
+					MeshComponent& meshComponent = entity.GetComponent<MeshComponent>();
+					if (!meshComponent.IsValid())
+						continue;
+					draw.DrawIndexedMeshWithMaterial(meshComponent.GetMesh(), entity.GetComponent<TransformComponent>().GetMatrix());
+				}
+
+				cmdList.EndRenderCommand();
+			};
+		});
 
+		//outside of the render pass of the ID pass, only the picked texel is copied back to the CPU
+		renderGraph->AddPass(TargetQueueFamily::Graphics, "IDReadbackPass", [=, *this](RenderGraphBuilder& build) {
+			build.ReadImage(RGResource(IDPassImage));
+			build.SetExecuteCondition([]() { return Renderer::IsPickPending(); });
+
+			return [=](RenderGraphRegistry& registry, RenderCommandList& cmdList) {
+				const auto& idImage = Renderer::GetOutputOfPass("IDPass");
+				const glm::uvec2 imageSize = glm::uvec2(idImage->GetWidth(), idImage->GetHeight());
+				const glm::uvec2 pickPixel = glm::min(Renderer::GetPendingPickPixel(), imageSize - 1u);
+
+				cmdList.BeginRenderCommand("IDReadback");
+				Renderer::RTRecordIDReadback(cmdList, idImage, pickPixel);
 				cmdList.EndRenderCommand();
 			};
 		});
@@ -172,7 +675,7 @@ namespace Lucy {
 #pragma region ShadowPass
 
 	ShadowPass::ShadowPass(Ref<Scene> scene, uint32_t size)
-		: m_Scene(scene), m_ShadowMapSize(size) {
+		: m_Scene(scene), m_ShadowMapSize(size), m_CulledMeshList(Memory::CreateRef<CulledMeshList>()), m_CameraBinding(Memory::CreateRef<ShaderBindingHandle>()) {
 	}
 
 	void ShadowPass::AddPass(const Ref<RenderGraph>& renderGraph) {
@@ -208,23 +711,32 @@ namespace Lucy {
 			return [=](RenderGraphRegistry& registry, RenderCommandList& cmdList) {
 				const auto& pipeline = Renderer::GetPipelineManager()->GetAs<GraphicsPipeline>("VSMPipeline");
 				const auto& depthShader = pipeline->GetShader();
+				if (!m_CameraBinding->IsValid())
+					*m_CameraBinding = depthShader->GetBindingHandle("LucyCamera");
 				
-				if (auto cameraBuffer = depthShader->GetUniformBufferIfExists("LucyCamera")) {
+				Maths::Frustum cascadeFrustums[NUM_CASCADES] = {};
+
+				if (auto cameraBuffer = depthShader->GetUniformBuffer(*m_CameraBinding)) {
 					ShadowCamera::ResetSplit();
-					for (ShadowCamera& shadowCamera : s_ShadowCameras) {
+					for (uint32_t i = 0; ShadowCamera& shadowCamera : s_ShadowCameras) {
 						shadowCamera.Update();
 						
 						const auto& vp = shadowCamera.GetCameraViewProjection();
 						cameraBuffer->Append((uint8_t*)&vp, sizeof(vp));
+						cascadeFrustums[i++] = Maths::ExtractShadowCasterFrustum(vp.Proj * vp.View);
 					}
 				}
 
+				//every draw is rendered into all cascades (multiview), so a mesh is drawn if any cascade sees it
+				CulledMeshList& culledMeshes = *m_CulledMeshList;
+				culledMeshes.Cull(*m_Scene, cascadeFrustums, NUM_CASCADES);
+
 				RenderCommand& draw = cmdList.BeginRenderCommand("VSM Draw");
 				draw.BindPipeline(pipeline);
 				draw.UpdateDescriptorSets();
 				draw.BindAllDescriptorSets();
 
-				m_Scene->ViewRForEach<MeshComponent, TransformComponent>([&](MeshComponent& meshComponent, TransformComponent& transformComponent) {
+				culledMeshes.ForEachVisible([&](MeshComponent& meshComponent, TransformComponent& transformComponent) {
 					draw.DrawIndexedMesh(meshComponent.GetMesh(), transformComponent.GetMatrix());
 				});
 
@@ -403,7 +915,32 @@ namespace Lucy {
 #pragma region CubemapPass
 
 	CubemapPass::CubemapPass(Ref<Scene> scene, uint32_t width, uint32_t height)
-		: m_Scene(scene), m_Width(width), m_Height(height) {
+		: m_Scene(scene), m_Width(width), m_Height(height), m_ShaderBindings(Memory::CreateRef<ShaderBindings>()) {
+	}
+
+	void CubemapPass::ResolveShaderBindings() const {
+		ShaderBindings& bindings = *m_ShaderBindings;
+		if (bindings.IsResolved)
+			return;
+
+		const auto& pipelineManager = Renderer::GetPipelineManager();
+
+		const auto& skyboxShader = pipelineManager->GetAs<GraphicsPipeline>("SkyboxPipeline")->GetShader();
+		bindings.SkyboxEnvironmentMap = skyboxShader->GetBindingHandle("u_EnvironmentMap");
+		bindings.SkyboxCamera = skyboxShader->GetBindingHandle("LucyCamera");
+
+		const auto& convertShader = pipelineManager->GetAs<GraphicsPipeline>("HDRImageToLayeredImageConvertPipeline")->GetShader();
+		bindings.EquirectangularMap = convertShader->GetBindingHandle("u_EquirectangularMap");
+
+#if USE_COMPUTE_FOR_CUBEMAP_GEN
+		const auto& irradianceShader = pipelineManager->GetAs<ComputePipeline>("IrradianceComputePipeline")->GetShader();
+		bindings.EnvironmentIrradianceMap = irradianceShader->GetBindingHandle("u_EnvironmentIrradianceMap");
+#else
+		const auto& irradianceShader = pipelineManager->GetAs<GraphicsPipeline>("IrradiancePipeline")->GetShader();
+#endif
+		bindings.IrradianceEnvironmentMap = irradianceShader->GetBindingHandle("u_EnvironmentMap");
+
+		bindings.IsResolved = true;
 	}
 
 	void CubemapPass::AddPass(const Ref<RenderGraph>& renderGraph) {
@@ -417,22 +954,25 @@ namespace Lucy {
 			build.BindRenderTarget(RGResource(GeometryImage), RGResource(GeometryDepthImage));
 
 			return [=](RenderGraphRegistry& registry, RenderCommandList& cmdList) {
+				ResolveShaderBindings();
+				const ShaderBindings& bindings = *m_ShaderBindings;
+
 				const auto& pipeline = Renderer::GetPipelineManager()->GetAs<GraphicsPipeline>("SkyboxPipeline");
 				const auto& hdrSkyboxShader = pipeline->GetShader();
 
 				bool imageBound = false;
 
-				m_Scene->ViewForEach<HDRCubemapComponent>([shader = hdrSkyboxShader, &imageBound](const HDRCubemapComponent& hdrComponent) {
+				m_Scene->ViewForEach<HDRCubemapComponent>([shader = hdrSkyboxShader, &bindings, &imageBound](const HDRCubemapComponent& hdrComponent) {
 					if (!hdrComponent.IsPrimary || imageBound)
 						return;
-					shader->BindImageHandleTo("u_EnvironmentMap", hdrComponent.GetCubemapImage());
+					shader->BindImageHandleTo(bindings.SkyboxEnvironmentMap, hdrComponent.GetCubemapImage());
 					imageBound = true;
 				});
 
-				if (!hdrSkyboxShader->HasImageHandleBoundTo("u_EnvironmentMap"))
+				if (!hdrSkyboxShader->HasImageHandleBoundTo(bindings.SkyboxEnvironmentMap))
 					return;
 
-				if (auto cameraBuffer = hdrSkyboxShader->GetUniformBufferIfExists("LucyCamera")) {
+				if (auto cameraBuffer = hdrSkyboxShader->GetUniformBuffer(bindings.SkyboxCamera)) {
 					const auto& vp = m_Scene->GetEditorCamera().GetCameraViewProjection();
 					cameraBuffer->SetData((uint8_t*)&vp, sizeof(vp));
 				}
@@ -470,7 +1010,8 @@ namespace Lucy {
 				const auto& pipeline = Renderer::GetPipelineManager()->GetAs<GraphicsPipeline>("HDRImageToLayeredImageConvertPipeline");
 				const auto& shader = pipeline->GetShader();
 
-				shader->BindImageHandleTo("u_EquirectangularMap", registry.GetExternalImage(RGResource(OriginalHDRImage)));
+				ResolveShaderBindings();
+				shader->BindImageHandleTo(m_ShaderBindings->EquirectangularMap, registry.GetExternalImage(RGResource(OriginalHDRImage)));
 
 				const auto& cubeMesh = Renderer::GetEnvCubeMesh();
 				const uint32_t cubeMeshIndexCount = Renderer::GetEnvCubeMeshIndexCount();
@@ -570,8 +1111,9 @@ namespace Lucy {
 				draw.SetImageLayout(cubeImage, VK_IMAGE_LAYOUT_GENERAL, 0, 0, 1, layerCount);
 				draw.SetImageLayout(irradianceImage, VK_IMAGE_LAYOUT_GENERAL, 0, 0, 1, layerCount);
 
-				shader->BindImageHandleTo("u_EnvironmentMap", cubeImage);
-				shader->BindImageHandleTo("u_EnvironmentIrradianceMap", irradianceImage);
+				ResolveShaderBindings();
+				shader->BindImageHandleTo(m_ShaderBindings->IrradianceEnvironmentMap, cubeImage);
+				shader->BindImageHandleTo(m_ShaderBindings->EnvironmentIrradianceMap, irradianceImage);
 
 				draw.BindPipeline(pipeline);
 				draw.UpdateDescriptorSets();
@@ -612,7 +1154,8 @@ namespace Lucy {
 
 				draw.SetImageLayout(environmentMap, VK_IMAGE_LAYOUT_GENERAL, 0, 0, 1, 6);
 
-				shader->BindImageHandleTo("u_EnvironmentMap", environmentMap);
+				ResolveShaderBindings();
+				shader->BindImageHandleTo(m_ShaderBindings->IrradianceEnvironmentMap, environmentMap);
 
 				draw.BindPipeline(pipeline);
 				draw.UpdateDescriptorSets();
@@ -1,22 +1,161 @@
 #pragma once
 
 #include "Scene/Scene.h"
+#include "FrustumCuller.h"
 
 #include "RenderGraph/RenderGraph.h"
 
+#include "Material/Material.h"
+#include "Shader/Shader.h"
+
 namespace Lucy {
 
+	class Mesh;
+	struct MeshComponent;
+	struct TransformComponent;
+
+	//the meshes of the scene, that are visible in the views of a pass
+	struct CulledMeshList {
+		struct Entry {
+			MeshComponent* MeshComponent = nullptr;
+			TransformComponent* TransformComponent = nullptr;
+		};
+
+		std::vector<Entry> Entries;
+		//the entities, whose fat bounds in the BVH of the scene intersect a view
+		std::vector<uint32_t> Candidates;
+		//the tight bounds of the valid candidates, in the order of CandidateEntries
+		FrustumCuller Culler;
+		std::vector<Entry> CandidateEntries;
+		std::vector<uint32_t> VisibleIndices;
+		std::vector<uint8_t> IsVisible;
+
+		//a mesh is visible, if it is visible in at least one of the views (e.g. the shadow cascades, that are drawn with multiview)
+		void Cull(Scene& scene, const Maths::Frustum* frustums, uint32_t frustumCount);
+
+		template <typename TFunc>
+		inline void ForEachVisible(TFunc func) {
+			for (const Entry& entry : Entries)
+				func(*entry.MeshComponent, *entry.TransformComponent);
+		}
+	};
+
 #pragma region GeometryPass
 
+	//GPU layouts, must match LucyClusterCull.comp and LucyPBR.glsl (std430)
+	struct MeshletCullData {
+		glm::vec4 Sphere; //xyz = center (mesh space), w = radius
+		glm::vec4 Cone; //xyz = axis (mesh space), w = cutoff
+		uint32_t FirstIndex = 0;
+		uint32_t IndexCount = 0;
+		int32_t VertexOffset = 0;
+		uint32_t DrawDataIndex = 0;
+		uint32_t BatchIndex = 0;
+		uint32_t BatchFirstCommand = 0;
+		uint32_t _Padding0 = 0;
+		uint32_t _Padding1 = 0;
+	};
+	static_assert(sizeof(MeshletCullData) == 64, "MeshletCullData does not match the std430 layout!");
+
+	struct ClusterDrawData {
+		glm::mat4 ModelMatrix;
+		MaterialID MaterialID;
+		float _Padding0 = 0.0f;
+		float _Padding1 = 0.0f;
+		float _Padding2 = 0.0f;
+	};
+	static_assert(sizeof(ClusterDrawData) == 80, "ClusterDrawData does not match the std430 layout!");
+
+	struct InstanceBoundsData {
+		glm::vec4 Min; //xyz = world space, w = 0, if the bounds are unknown (never occluded)
+		glm::vec4 Max;
+	};
+	static_assert(sizeof(InstanceBoundsData) == 32, "InstanceBoundsData does not match the std430 layout!");
+
+	//gathered by the cluster cull pass every frame and consumed by the geometry pass.
+	//every batch is a mesh (own vertex/index buffer) that is drawn with a single indirect count draw.
+	struct ClusterDrawList {
+		struct Batch {
+			Ref<Mesh> Mesh = nullptr;
+			uint32_t FirstCommand = 0;
+			uint32_t MaxCommandCount = 0;
+		};
+
+		std::vector<MeshletCullData> Meshlets;
+		std::vector<ClusterDrawData> DrawData;
+		//per draw data, for the occlusion culling
+		std::vector<InstanceBoundsData> InstanceBounds;
+		std::vector<Batch> Batches;
+
+		//the view the list has been culled for, the late cull phase uses the same one
+		glm::mat4 ViewProjection = glm::mat4(1.0f);
+		Maths::Frustum Frustum;
+		glm::vec4 CameraPosition = glm::vec4(0.0f);
+
+		inline void Clear() {
+			Meshlets.clear();
+			DrawData.clear();
+			InstanceBounds.clear();
+			Batches.clear();
+		}
+	};
+
+	//the depth buffer persists between frames, so the early phase of the occlusion culling can test against the depth of the last frame.
+	//the pyramid of that depth is only valid with the view projection it has been rendered with
+	struct OcclusionCullHistory {
+		glm::mat4 ViewProjection = glm::mat4(1.0f);
+		glm::uvec2 DepthSize = glm::uvec2(0);
+		bool IsValid = false;
+	};
+
 	struct ForwardPBRPass final {
 		ForwardPBRPass(Ref<Scene> scene, uint32_t width, uint32_t height);
 		~ForwardPBRPass() = default;
 
 		void AddPass(const Ref<RenderGraph>& renderGraph);
+
+		//the bindings, that are written every frame. Resolved on the first execution (the shaders are loaded after the passes have been added),
+		//the handles stay valid when a shader is reloaded
+		struct ShaderBindings {
+			bool IsResolved = false;
+
+			//HiZComputePipeline
+			ShaderBindingHandle HiZPyramid;
+			ShaderBindingHandle HiZAtomicCounter;
+			ShaderBindingHandle HiZDepthImage;
+
+			//ClusterCullComputePipeline
+			ShaderBindingHandle MeshletCullData;
+			ShaderBindingHandle ClusterDrawData;
+			ShaderBindingHandle IndirectDraws;
+			ShaderBindingHandle IndirectDrawCounts;
+			ShaderBindingHandle InstanceBounds;
+			ShaderBindingHandle MeshletVisibility;
+			ShaderBindingHandle CullHiZPyramid;
+			ShaderBindingHandle OcclusionCullParams;
+
+			//PBRGeometryPipeline
+			ShaderBindingHandle LightningValues;
+			ShaderBindingHandle ShadowMap;
+			ShaderBindingHandle Textures;
+			ShaderBindingHandle IrradianceMap;
+			ShaderBindingHandle PBRCamera;
+			ShaderBindingHandle PBRClusterDrawData;
+
+			//IDPipeline
+			ShaderBindingHandle IDCamera;
+		};
 	private:
+		void ResolveShaderBindings() const;
+
 		Ref<Scene> m_Scene;
 		uint32_t m_Width;
 		uint32_t m_Height;
+
+		Ref<ClusterDrawList> m_ClusterDrawList = nullptr;
+		Ref<CulledMeshList> m_CulledMeshList = nullptr;
+		Ref<OcclusionCullHistory> m_OcclusionCullHistory = nullptr;
+		Ref<ShaderBindings> m_ShaderBindings = nullptr;
 	};
 #pragma endregion GeometryPass
 
@@ -64,6 +203,10 @@ namespace Lucy {
 
 		Ref<Scene> m_Scene;
 		uint32_t m_ShadowMapSize;
+
+		Ref<CulledMeshList> m_CulledMeshList = nullptr;
+		//LucyCamera of the VSMPipeline, resolved on the first execution (see ForwardPBRPass::ShaderBindings)
+		Ref<ShaderBindingHandle> m_CameraBinding = nullptr;
 	};
 #pragma endregion ShadowPass
 
@@ -86,10 +229,32 @@ namespace Lucy {
 		static inline constexpr const uint32_t HDRImageWidth = 1024;
 		static inline constexpr const uint32_t HDRImageHeight = 1024;
 #endif
+
+		//resolved on the first execution (see ForwardPBRPass::ShaderBindings)
+		struct ShaderBindings {
+			bool IsResolved = false;
+
+			//SkyboxPipeline
+			ShaderBindingHandle SkyboxEnvironmentMap;
+			ShaderBindingHandle SkyboxCamera;
+
+			//HDRImageToLayeredImageConvertPipeline
+			ShaderBindingHandle EquirectangularMap;
+
+			//IrradianceComputePipeline or IrradiancePipeline
+			ShaderBindingHandle IrradianceEnvironmentMap;
+#if USE_COMPUTE_FOR_CUBEMAP_GEN
+			ShaderBindingHandle EnvironmentIrradianceMap;
+#endif
+		};
 	private:
+		void ResolveShaderBindings() const;
+
 		Ref<Scene> m_Scene;
 		uint32_t m_Width = 0;
 		uint32_t m_Height = 0;
+
+		Ref<ShaderBindings> m_ShaderBindings = nullptr;
 	};
 #pragma endregion CubemapPass
 
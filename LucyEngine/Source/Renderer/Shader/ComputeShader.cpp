@@ -15,13 +15,7 @@ namespace Lucy {
 		shaderc::Compiler compiler;
 		shaderc::CompileOptions options;
 
-		options.SetIncluder(std::make_unique<CustomShaderIncluder>(device));
-
-		options.SetOptimizationLevel(shaderc_optimization_level::shaderc_optimization_level_performance);
-		options.SetGenerateDebugInfo();
-
-		if (Renderer::GetRenderArchitecture() == RenderArchitecture::Vulkan)
-			options.SetTargetEnvironment(shaderc_target_env_vulkan, shaderc_env_version_vulkan_1_3);
+		const uint64_t optionsHash = SetCompileOptions(device, options, shaderc_optimization_level::shaderc_optimization_level_performance);
 
 		const char* computeFileExtension = ".cached_vulkan.comp";
 
@@ -34,18 +28,12 @@ namespace Lucy {
 
 		std::filesystem::path cacheComputeFilePath = cachedFolderWithName.replace_extension(computeFileExtension);
 
-		std::vector<uint32_t> dataCompute;
-
-		if (!FileSystem::FileExists(cacheComputeFilePath) || forceReloadFromDisk) {
-			auto path = GetPath();
-			dataCompute = LoadSPIRVData(path, compiler, options, shaderc_shader_kind::shaderc_compute_shader);
-			if (!forceReloadFromDisk)
-				FileSystem::WriteToFile<uint32_t>(cacheComputeFilePath, dataCompute, OpenMode::Binary);
-		} else {
-			dataCompute = LoadSPIRVDataFromCache(cacheComputeFilePath);
-		}
+		std::vector<uint32_t> dataCompute = LoadSPIRVData(GetPath(), cacheComputeFilePath, compiler, options, shaderc_shader_kind::shaderc_compute_shader,
+														  optionsHash, forceReloadFromDisk);
 
 		RunReflect(dataCompute, VK_SHADER_STAGE_COMPUTE_BIT);
+		//before the shader is published (or, for a reload, on the render thread), the descriptors only resolve the names
+		AddReflectedBindings();
 		LoadInternal(device, dataCompute);
 	}
 }
\ No newline at end of file
@@ -17,13 +17,7 @@ namespace Lucy {
 		shaderc::Compiler compiler;
 		shaderc::CompileOptions options;
 
-		options.SetIncluder(std::make_unique<CustomShaderIncluder>(device));
-
-		options.SetOptimizationLevel(shaderc_optimization_level::shaderc_optimization_level_zero);
-		options.SetGenerateDebugInfo();
-
-		if (Renderer::GetRenderArchitecture() == RenderArchitecture::Vulkan)
-			options.SetTargetEnvironment(shaderc_target_env_vulkan, shaderc_env_version_vulkan_1_3);
+		const uint64_t optionsHash = SetCompileOptions(device, options, shaderc_optimization_level::shaderc_optimization_level_zero);
 
 		const auto& [vertexFileExtension, fragmentFileExtension] = GetCachedFileExtension();
 
@@ -37,27 +31,15 @@ namespace Lucy {
 		std::filesystem::path cacheFileVert = cachedFolderWithName.replace_extension(vertexFileExtension);
 		std::filesystem::path cacheFileFrag = cachedFolderWithName.replace_extension(fragmentFileExtension);
 
-		if (!FileSystem::FileExists(cacheFileVert) || !FileSystem::FileExists(cacheFileFrag) || forceReloadFromDisk) {
-			auto path = GetPath();
-			std::vector<uint32_t> dataVert = LoadSPIRVData(path, compiler, options, shaderc_shader_kind::shaderc_vertex_shader);
-			std::vector<uint32_t> dataFrag = LoadSPIRVData(path, compiler, options, shaderc_shader_kind::shaderc_fragment_shader);
-			
-			if (!forceReloadFromDisk) {
-				FileSystem::WriteToFile<uint32_t>(cacheFileVert, dataVert, OpenMode::Binary);
-				FileSystem::WriteToFile<uint32_t>(cacheFileFrag, dataFrag, OpenMode::Binary);
-			}
+		auto path = GetPath();
+		std::vector<uint32_t> dataVert = LoadSPIRVData(path, cacheFileVert, compiler, options, shaderc_shader_kind::shaderc_vertex_shader, optionsHash, forceReloadFromDisk);
+		std::vector<uint32_t> dataFrag = LoadSPIRVData(path, cacheFileFrag, compiler, options, shaderc_shader_kind::shaderc_fragment_shader, optionsHash, forceReloadFromDisk);
 
-			RunReflect(dataVert, VK_SHADER_STAGE_VERTEX_BIT);
-			RunReflect(dataFrag, VK_SHADER_STAGE_FRAGMENT_BIT);
-			LoadInternal(device, dataVert, dataFrag);
-		} else {
-			std::vector<uint32_t> dataVert = LoadSPIRVDataFromCache(cacheFileVert);
-			std::vector<uint32_t> dataFrag = LoadSPIRVDataFromCache(cacheFileFrag);
-
-			RunReflect(dataVert, VK_SHADER_STAGE_VERTEX_BIT);
-			RunReflect(dataFrag, VK_SHADER_STAGE_FRAGMENT_BIT);
-			LoadInternal(device, dataVert, dataFrag);
-		}
+		RunReflect(dataVert, VK_SHADER_STAGE_VERTEX_BIT);
+		RunReflect(dataFrag, VK_SHADER_STAGE_FRAGMENT_BIT);
+		//before the shader is published (or, for a reload, on the render thread), the descriptors only resolve the names
+		AddReflectedBindings();
+		LoadInternal(device, dataVert, dataFrag);
 	}
 
 	GraphicsShader::Extensions GraphicsShader::GetCachedFileExtension() const {
@@ -4,6 +4,7 @@
 #include "VulkanGraphicsShader.h"
 #include "VulkanComputeShader.h"
 #include "VulkanUniformImageSampler.h"
+#include "ShaderCache.h"
 
 #include "Core/FileSystem.h"
 
@@ -13,6 +14,7 @@
 
 #include "Renderer/Renderer.h"
 #include "Renderer/Descriptors/VulkanDescriptorSet.h"
+#include "Renderer/Memory/Buffer/Vulkan/VulkanSharedStorageBuffer.h"
 #include "Renderer/Image/VulkanImage.h"
 #include "Renderer/Memory/Buffer/PushConstant.h"
 
@@ -55,38 +57,91 @@ namespace Lucy {
 		LUCY_ASSERT(false, "Could not find a suitable Push Constant for the given name: {0}", name);
 	}
 
-	uint32_t Shader::BindImageHandleTo(const std::string& imageBufferName, const Ref<Image>& image) {
-		LUCY_ASSERT(image != nullptr, "Binding image failed, because image '{0}' is nullptr!", imageBufferName);
+	ShaderBindingHandle Shader::GetBindingHandle(const std::string& name) const {
+		return m_BindingTable.Find(name);
+	}
+
+	const Shader::ShaderBinding* Shader::GetBinding(ShaderBindingHandle bindingHandle) const {
+		if (!bindingHandle.IsValid() || bindingHandle.Index >= m_Bindings.size())
+			return nullptr;
+		const ShaderBinding& binding = m_Bindings[bindingHandle.Index];
+		return binding.DescriptorSetHandle != InvalidRenderResourceHandle ? &binding : nullptr;
+	}
+
+	RenderResourceHandle Shader::GetBufferHandle(ShaderBindingHandle bindingHandle, bool isSharedStorageBuffer) const {
+		const ShaderBinding* binding = GetBinding(bindingHandle);
+		if (!binding)
+			return InvalidRenderResourceHandle;
+
+		const bool isSSBO = binding->Type == DescriptorType::SSBO || binding->Type == DescriptorType::SSBODynamic;
+		const bool isUBO = binding->Type == DescriptorType::Buffer || binding->Type == DescriptorType::DynamicBuffer;
+		if ((isSharedStorageBuffer && !isSSBO) || (!isSharedStorageBuffer && !isUBO))
+			return InvalidRenderResourceHandle;
+		return binding->BufferHandle;
+	}
+
+	void Shader::BindImageHandleTo(const std::string& imageBufferName, const Ref<Image>& image, uint32_t arrayElement) {
+		ShaderBindingHandle bindingHandle = GetBindingHandle(imageBufferName);
+		LUCY_ASSERT(bindingHandle.IsValid(), "Could not find a image sampler with the name {0}", imageBufferName);
+		BindImageHandleTo(bindingHandle, image, arrayElement);
+	}
+
+	void Shader::BindImageHandleTo(ShaderBindingHandle bindingHandle, const Ref<Image>& image, uint32_t arrayElement) {
+		const ShaderBinding* binding = GetBinding(bindingHandle);
+		LUCY_ASSERT(binding && binding->ImageSampler, "Binding {0} of shader {1} is not an image sampler!", bindingHandle.Index, m_Name);
+		if (!binding || !binding->ImageSampler)
+			return;
+		LUCY_ASSERT(image != nullptr, "Binding image failed, because image '{0}' is nullptr!", binding->Name);
 
 		if (Renderer::GetRenderArchitecture() == RenderArchitecture::Vulkan) {
 			const Ref<VulkanImage> vulkanImage = image->As<VulkanImage>();
 
-			for (const auto& handle : m_DescriptorSetHandles) {
-				auto descriptorSet = GetDescriptorSetFromHandle(handle)->As<VulkanDescriptorSet>();
-
-				if (auto imageSampler = descriptorSet->GetVulkanImageSampler(imageBufferName)) {
-					imageSampler->ImageInfos.push_back(VulkanAPI::DescriptorImageInfo(
-						vulkanImage->GetCurrentLayout(), vulkanImage->GetImageView().GetVulkanHandle(), vulkanImage->GetImageView().GetSampler()));
-					return (uint32_t)imageSampler->ImageInfos.size() - 1;
-				}
+			auto& imageInfos = binding->ImageSampler->ImageInfos;
+			LUCY_ASSERT(arrayElement <= imageInfos.size(), "Array element {0} of {1} is bound before the elements in front of it!", arrayElement, binding->Name);
+			auto& imageViewIDs = binding->ImageSampler->ImageViewIDs;
+			if (arrayElement == imageInfos.size()) {
+				imageInfos.emplace_back();
+				imageViewIDs.emplace_back();
 			}
-			LUCY_ASSERT(false, "Could not find a image sampler with the name {0}", imageBufferName);
+			imageInfos[arrayElement] = VulkanAPI::DescriptorImageInfo(vulkanImage->GetCurrentLayout(), vulkanImage->GetImageView().GetVulkanHandle(),
+																	   vulkanImage->GetImageView().GetSampler());
+			imageViewIDs[arrayElement] = vulkanImage->GetImageView().GetID();
 		}
-		return 0;
 	}
 
 	bool Shader::HasImageHandleBoundTo(const std::string& imageBufferName) const {
-		for (const auto& handle : m_DescriptorSetHandles) {
-			auto descriptorSet = GetDescriptorSetFromHandle(handle)->As<VulkanDescriptorSet>();
+		ShaderBindingHandle bindingHandle = GetBindingHandle(imageBufferName);
+		LUCY_ASSERT(bindingHandle.IsValid(), "Could not find a image sampler with the name {0}", imageBufferName);
+		return HasImageHandleBoundTo(bindingHandle);
+	}
+
+	bool Shader::HasImageHandleBoundTo(ShaderBindingHandle bindingHandle) const {
+		const ShaderBinding* binding = GetBinding(bindingHandle);
+		LUCY_ASSERT(binding && binding->ImageSampler, "Binding {0} of shader {1} is not an image sampler!", bindingHandle.Index, m_Name);
+		return binding && binding->ImageSampler && !binding->ImageSampler->ImageInfos.empty();
+	}
+
+	void Shader::BindSharedStorageBufferTo(const std::string& ssboName, const Ref<SharedStorageBuffer>& ssbo) {
+		ShaderBindingHandle bindingHandle = GetBindingHandle(ssboName);
+		LUCY_ASSERT(bindingHandle.IsValid(), "Could not find a SSBO with the name {0}", ssboName);
+		BindSharedStorageBufferTo(bindingHandle, ssbo);
+	}
+
+	void Shader::BindSharedStorageBufferTo(ShaderBindingHandle bindingHandle, const Ref<SharedStorageBuffer>& ssbo) {
+		const bool isSSBO = GetBufferHandle(bindingHandle, true) != InvalidRenderResourceHandle;
+		LUCY_ASSERT(isSSBO, "Binding {0} of shader {1} is not a SSBO!", bindingHandle.Index, m_Name);
+		if (!isSSBO)
+			return;
+		const ShaderBinding* binding = GetBinding(bindingHandle);
+		LUCY_ASSERT(ssbo != nullptr, "Binding SSBO failed, because SSBO '{0}' is nullptr!", binding->Name);
 
-			if (auto imageSampler = descriptorSet->GetVulkanImageSampler(imageBufferName))
-				return !imageSampler->ImageInfos.empty();
+		if (Renderer::GetRenderArchitecture() == RenderArchitecture::Vulkan) {
+			auto descriptorSet = GetDescriptorSetFromHandle(binding->DescriptorSetHandle)->As<VulkanDescriptorSet>();
+			descriptorSet->BindSharedStorageBuffer(binding->Name, ssbo->As<VulkanSharedStorageBuffer>());
 		}
-		LUCY_ASSERT(false, "Could not find a image sampler with the name {0}", imageBufferName);
-		return false;
 	}
 
-	void Shader::RTLoadDescriptors(const Ref<RenderDevice>& device, const Ref<VulkanDescriptorPool>& descriptorPool) {
+	void Shader::RTLoadDescriptors(const Ref<RenderDevice>& device) {
 		const auto& reflectPushConstants = m_Reflect.GetShaderPushConstants();
 		const auto& reflectUniformBlockMaps = m_Reflect.GetShaderUniformBlockMap();
 
@@ -97,18 +152,64 @@ namespace Lucy {
 			};
 			RenderResourceHandle descriptorSetHandle = device->CreateDescriptorSet(createInfo);
 			const auto& descriptorSet = device->AccessResource<VulkanDescriptorSet>(descriptorSetHandle);
-			descriptorSet->RTBake(descriptorPool);
+			descriptorSet->RTBake();
 			m_DescriptorSetHandles.push_back(descriptorSetHandle); //maybe just store the handle?
+
+			ResolveBindings(set, info, descriptorSetHandle);
 		}
 
 		for (auto& pc : reflectPushConstants)
 			m_PushConstants.emplace_back(pc.Name, pc.BufferSize, 0, pc.StageFlag);
 	}
 
+	void Shader::ResolveBindings(uint32_t set, const std::vector<ShaderUniformBlock>& uniformBlocks, RenderResourceHandle descriptorSetHandle) {
+		const auto& descriptorSet = GetDescriptorSetFromHandle(descriptorSetHandle)->As<VulkanDescriptorSet>();
+
+		for (const ShaderUniformBlock& block : uniformBlocks) {
+			//the names have been added in RTLoad, nothing is added here
+			const ShaderBindingHandle bindingHandle = m_BindingTable.Find(block.Name);
+			LUCY_ASSERT(bindingHandle.IsValid() && bindingHandle.Index < m_Bindings.size(), "Binding {0} of shader {1} has not been reflected!", block.Name, m_Name);
+
+			ShaderBinding& binding = m_Bindings[bindingHandle.Index];
+			//the first set with that name wins
+			if (binding.DescriptorSetHandle != InvalidRenderResourceHandle)
+				continue;
+
+			binding.Set = set;
+			binding.Binding = block.Binding;
+			binding.Type = block.Type;
+			binding.DescriptorSetHandle = descriptorSetHandle;
+
+			switch (block.Type) {
+				case DescriptorType::Buffer:
+				case DescriptorType::DynamicBuffer:
+					binding.BufferHandle = descriptorSet->GetAllUniformBufferHandles().at(block.Name);
+					break;
+				case DescriptorType::SSBO:
+				case DescriptorType::SSBODynamic:
+					binding.BufferHandle = descriptorSet->GetAllSharedStorageBufferHandles().at(block.Name);
+					break;
+				default:
+					binding.ImageSampler = descriptorSet->GetVulkanImageSampler(block.Name);
+					break;
+			}
+		}
+	}
+
 	void Shader::RunReflect(const std::vector<uint32_t>& data, int32_t flags) {
 		m_Reflect.Info(m_Path, data, flags);
 	}
 
+	void Shader::AddReflectedBindings() {
+		for (const auto& [set, uniformBlocks] : m_Reflect.GetShaderUniformBlockMap()) {
+			for (const ShaderUniformBlock& block : uniformBlocks) {
+				const ShaderBindingHandle bindingHandle = m_BindingTable.Add(block.Name);
+				if (bindingHandle.Index == m_Bindings.size())
+					m_Bindings.emplace_back().Name = block.Name;
+			}
+		}
+	}
+
 	void Shader::RTDestroyResource(const Ref<RenderDevice>& device) {
 		m_PushConstants.clear();
 		m_Reflect.DestroyCachedData();
@@ -116,38 +217,94 @@ namespace Lucy {
 		for (auto handles : m_DescriptorSetHandles)
 			device->RTDestroyResource(handles);
 		m_DescriptorSetHandles.clear();
+
+		//the handles given out stay valid, they are resolved again in RTLoadDescriptors
+		for (ShaderBinding& binding : m_Bindings) {
+			binding.DescriptorSetHandle = InvalidRenderResourceHandle;
+			binding.BufferHandle = InvalidRenderResourceHandle;
+			binding.ImageSampler = nullptr;
+		}
 	}
 
-	std::vector<uint32_t> Shader::LoadSPIRVData(const std::filesystem::path& path, shaderc::Compiler& compiler, shaderc::CompileOptions& options,
-							   shaderc_shader_kind kind) {
+	uint64_t Shader::SetCompileOptions(const Ref<RenderDevice>& device, shaderc::CompileOptions& options, shaderc_optimization_level optimizationLevel) {
+		options.SetIncluder(std::make_unique<CustomShaderIncluder>(device));
+
+		options.SetOptimizationLevel(optimizationLevel);
+		options.SetGenerateDebugInfo();
+
+		if (Renderer::GetRenderArchitecture() == RenderArchitecture::Vulkan)
+			options.SetTargetEnvironment(shaderc_target_env_vulkan, shaderc_env_version_vulkan_1_3);
+
+		//a newer compiler produces different SPIR-V for the same source. shaderc has no version query of its own,
+		//it ships with the Vulkan SDK, so the header version of the SDK stands for it (see ShaderCache::s_FormatVersion)
+		const std::string settings = std::format("{};{};{};{};{}", ShaderCache::s_FormatVersion, (uint32_t)Renderer::GetRenderArchitecture(),
+												 (uint32_t)optimizationLevel, true, (uint32_t)VK_HEADER_VERSION_COMPLETE);
+		return ShaderCache::ComputeOptionsHash(settings);
+	}
+
+	std::vector<uint32_t> Shader::LoadSPIRVData(const std::filesystem::path& path, const std::filesystem::path& cachedFilePath, shaderc::Compiler& compiler,
+												shaderc::CompileOptions& options, shaderc_shader_kind kind, uint64_t optionsHash, bool forceReloadFromDisk) {
+		LUCY_PROFILE_NEW_EVENT("Shader::LoadSPIRVData");
+
+		const std::string source = LoadStageSource(path, kind);
+
+		//the preprocessed source contains every include and the expanded macros, so an edited include invalidates every shader using it
+		shaderc::PreprocessedSourceCompilationResult preprocessed = compiler.PreprocessGlsl(source, kind, FileSystem::GetFileName(path).c_str(), options);
+		LUCY_ASSERT(preprocessed.GetCompilationStatus() == shaderc_compilation_status_success, "Preprocessing {0} failed, Message: {1}",
+					path.string(), preprocessed.GetErrorMessage());
+
+		const uint64_t cacheKey = ShaderCache::ComputeKey(std::string_view(preprocessed.cbegin(), preprocessed.cend()), optionsHash, (uint32_t)kind);
+		if (!forceReloadFromDisk && ShaderCache::IsEntryValid(cachedFilePath, cacheKey))
+			return ShaderCache::LoadEntry(cachedFilePath);
+
+		//a hot reload writes the entry as well, otherwise the next start would compile the edited stage again
+		std::vector<uint32_t> data = CompileSPIRVData(source, path, compiler, options, kind);
+		if (!data.empty())
+			ShaderCache::WriteEntry(cachedFilePath, data, cacheKey, path);
+		return data;
+	}
+
+	std::string Shader::LoadStageSource(const std::filesystem::path& path, shaderc_shader_kind kind) const {
 		using Iter = std::vector<std::string>::iterator;
 
 		std::vector<std::string> lines;
 		FileSystem::ReadFileLine<std::string>(path, lines);
 
-		std::string shaderType = "";
 		Iter from, to;
 		switch (kind) {
 			case shaderc_shader_kind::shaderc_vertex_shader:
-				shaderType = "Vertex";
 				from = std::find(lines.begin(), lines.end(), "//type vertex");
 				to = std::find(lines.begin(), lines.end(), "//type fragment");
 				break;
 			case shaderc_shader_kind::shaderc_fragment_shader:
-				shaderType = "Fragment";
 				from = std::find(lines.begin(), lines.end(), "//type fragment");
 				to = lines.end();
 				break;
 			case shaderc_shader_kind::shaderc_compute_shader:
-				shaderType = "Compute";
 				from = lines.begin();
 				to = lines.end();
 				break;
 		}
 
-		std::string data = Utils::CombineDataToSingleBuffer(lines, from, to);
+		return Utils::CombineDataToSingleBuffer(lines, from, to);
+	}
+
+	std::vector<uint32_t> Shader::CompileSPIRVData(const std::string& source, const std::filesystem::path& path, shaderc::Compiler& compiler,
+												   shaderc::CompileOptions& options, shaderc_shader_kind kind) const {
+		std::string shaderType = "";
+		switch (kind) {
+			case shaderc_shader_kind::shaderc_vertex_shader:
+				shaderType = "Vertex";
+				break;
+			case shaderc_shader_kind::shaderc_fragment_shader:
+				shaderType = "Fragment";
+				break;
+			case shaderc_shader_kind::shaderc_compute_shader:
+				shaderType = "Compute";
+				break;
+		}
 
-		shaderc::SpvCompilationResult result = compiler.CompileGlslToSpv(data, kind, FileSystem::GetFileName(path).c_str(), options);
+		shaderc::SpvCompilationResult result = compiler.CompileGlslToSpv(source, kind, FileSystem::GetFileName(path).c_str(), options);
 		uint32_t status = result.GetCompilationStatus();
 		LUCY_ASSERT(status == shaderc_compilation_status_success, "{0} Shader; Status: {1}, Message: {2}", shaderType, status, result.GetErrorMessage());
 		std::vector<uint32_t> dataAsSPIRV(result.cbegin(), result.cend());
@@ -155,12 +312,6 @@ namespace Lucy {
 		return dataAsSPIRV;
 	}
 
-	std::vector<uint32_t> Shader::LoadSPIRVDataFromCache(const std::filesystem::path& cachedFilePath) {
-		std::vector<uint32_t> data;
-		FileSystem::ReadFile<uint32_t>(cachedFilePath, data, OpenMode::Binary);
-		return data;
-	}
-
 	CustomShaderIncluder::CustomShaderIncluder(Ref<RenderDevice> renderDevice) 
 		: m_RenderDevice(renderDevice) {
 	}
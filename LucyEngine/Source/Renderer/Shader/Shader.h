@@ -2,6 +2,7 @@
 #include "shaderc/shaderc.hpp"
 
 #include "ShaderReflect.h"
+#include "ShaderBindingTable.h"
 #include "Renderer/Descriptors/DescriptorSet.h"
 
 #include "Renderer/Memory/Buffer/UniformBuffer.h"
@@ -11,7 +12,7 @@
 
 namespace Lucy {
 
-	class VulkanDescriptorPool;
+	struct VulkanUniformImageSampler;
 
 	class CustomShaderIncluder final : public shaderc::CompileOptions::IncluderInterface {
 	public:
@@ -52,32 +53,44 @@ namespace Lucy {
 		inline const std::vector<VulkanPushConstant>& GetPushConstants() const { return m_PushConstants; }
 		inline const VertexShaderLayout& GetVertexShaderLayout() const { return m_Reflect.GetVertexShaderLayout(); }
 
+		//resolves the name once, the handle can be cached by the caller and stays valid when the shader is reloaded. Invalid, if the shader has no such binding.
+		//can be called from any thread
+		ShaderBindingHandle GetBindingHandle(const std::string& name) const;
+
 		template <typename TUniformBuffer = UniformBuffer>
 		inline Ref<TUniformBuffer> GetUniformBufferIfExists(const std::string& name) {
-			for (auto handle : m_DescriptorSetHandles) {
-				Ref<DescriptorSet> set = GetDescriptorSetFromHandle(handle);
-
-				const auto& uniformBuffers = set->GetAllUniformBufferHandles();
-				if (!uniformBuffers.contains(name))
-					continue;
-				return Renderer::AccessResource<UniformBuffer>(uniformBuffers.at(name))->As<TUniformBuffer>();
-			}
-			LUCY_ASSERT(false, "Could not find a suitable UBO for the given name: {0}", name);
-			return nullptr;
+			RenderResourceHandle bufferHandle = GetBufferHandle(GetBindingHandle(name), false);
+			LUCY_ASSERT(bufferHandle != InvalidRenderResourceHandle, "Could not find a suitable UBO for the given name: {0}", name);
+			if (bufferHandle == InvalidRenderResourceHandle)
+				return nullptr;
+			return Renderer::AccessResource<UniformBuffer>(bufferHandle)->As<TUniformBuffer>();
+		}
+
+		template <typename TUniformBuffer = UniformBuffer>
+		inline Ref<TUniformBuffer> GetUniformBuffer(ShaderBindingHandle bindingHandle) {
+			RenderResourceHandle bufferHandle = GetBufferHandle(bindingHandle, false);
+			LUCY_ASSERT(bufferHandle != InvalidRenderResourceHandle, "Binding {0} of shader {1} is not a UBO!", bindingHandle.Index, m_Name);
+			if (bufferHandle == InvalidRenderResourceHandle)
+				return nullptr;
+			return Renderer::AccessResource<UniformBuffer>(bufferHandle)->As<TUniformBuffer>();
 		}
 
 		template <typename TSharedStorageBuffer = SharedStorageBuffer>
 		inline Ref<TSharedStorageBuffer> GetSharedStorageBufferIfExists(const std::string& name) {
-			for (auto handle : m_DescriptorSetHandles) {
-				Ref<DescriptorSet> set = GetDescriptorSetFromHandle(handle);
-				
-				const auto& ssbos = set->GetAllSharedStorageBufferHandles();
-				if (!ssbos.contains(name))
-					continue;
-				return Renderer::AccessResource<SharedStorageBuffer>(ssbos.at(name))->As<TSharedStorageBuffer>();
-			}
-			LUCY_ASSERT(false, "Could not find a suitable SSBO for the given name: {0}", name);
-			return nullptr;
+			RenderResourceHandle bufferHandle = GetBufferHandle(GetBindingHandle(name), true);
+			LUCY_ASSERT(bufferHandle != InvalidRenderResourceHandle, "Could not find a suitable SSBO for the given name: {0}", name);
+			if (bufferHandle == InvalidRenderResourceHandle)
+				return nullptr;
+			return Renderer::AccessResource<SharedStorageBuffer>(bufferHandle)->As<TSharedStorageBuffer>();
+		}
+
+		template <typename TSharedStorageBuffer = SharedStorageBuffer>
+		inline Ref<TSharedStorageBuffer> GetSharedStorageBuffer(ShaderBindingHandle bindingHandle) {
+			RenderResourceHandle bufferHandle = GetBufferHandle(bindingHandle, true);
+			LUCY_ASSERT(bufferHandle != InvalidRenderResourceHandle, "Binding {0} of shader {1} is not a SSBO!", bindingHandle.Index, m_Name);
+			if (bufferHandle == InvalidRenderResourceHandle)
+				return nullptr;
+			return Renderer::AccessResource<SharedStorageBuffer>(bufferHandle)->As<TSharedStorageBuffer>();
 		}
 #pragma region VulkanInternals
 		VulkanPushConstant& GetPushConstants(const std::string& name);
@@ -86,24 +99,61 @@ namespace Lucy {
 		virtual void RTLoad(const Ref<RenderDevice>& device, bool forceReloadFromDisk = false) = 0;
 		virtual void RTDestroyResource(const Ref<RenderDevice>& device);
 
-		uint32_t BindImageHandleTo(const std::string& imageBufferName, const Ref<Image>& image);
+		//overwrites the given array element of the sampler, binding it again in the same frame replaces the image instead of appending it.
+		//the elements of an array have to be bound without holes, starting from 0
+		void BindImageHandleTo(const std::string& imageBufferName, const Ref<Image>& image, uint32_t arrayElement = 0);
+		void BindImageHandleTo(ShaderBindingHandle bindingHandle, const Ref<Image>& image, uint32_t arrayElement = 0);
 		bool HasImageHandleBoundTo(const std::string& imageBufferName) const;
-		void RTLoadDescriptors(const Ref<RenderDevice>& device, const Ref<VulkanDescriptorPool>& descriptorPool);
+		bool HasImageHandleBoundTo(ShaderBindingHandle bindingHandle) const;
+		//for SSBO's that are written by another shader (e.g. a compute pass) and read by this one. has to be bound every frame, like the images
+		void BindSharedStorageBufferTo(const std::string& ssboName, const Ref<SharedStorageBuffer>& ssbo);
+		void BindSharedStorageBufferTo(ShaderBindingHandle bindingHandle, const Ref<SharedStorageBuffer>& ssbo);
+		void RTLoadDescriptors(const Ref<RenderDevice>& device);
 	protected:
 		void RunReflect(const std::vector<uint32_t>& data, int32_t flags = 0);
-		std::vector<uint32_t> LoadSPIRVData(const std::filesystem::path& path, shaderc::Compiler& compiler, shaderc::CompileOptions& options,
-						   shaderc_shader_kind kind);
-		std::vector<uint32_t> LoadSPIRVDataFromCache(const std::filesystem::path& cachedFilePath);
+		//adds the bindings of every reflected stage to the binding table, once the stages have been reflected
+		void AddReflectedBindings();
+		//sets the options every shader is compiled with. Returns a hash of the compiler settings, that are not part of the preprocessed source
+		uint64_t SetCompileOptions(const Ref<RenderDevice>& device, shaderc::CompileOptions& options, shaderc_optimization_level optimizationLevel);
+		//the cached entry is only used, if it was compiled from the same preprocessed source and settings (see ShaderCache).
+		//otherwise the stage is compiled and the entry is rewritten. forceReloadFromDisk always compiles, the entry is rewritten as well
+		std::vector<uint32_t> LoadSPIRVData(const std::filesystem::path& path, const std::filesystem::path& cachedFilePath, shaderc::Compiler& compiler,
+											shaderc::CompileOptions& options, shaderc_shader_kind kind, uint64_t optionsHash, bool forceReloadFromDisk);
 	private:
 		inline Ref<DescriptorSet> GetDescriptorSetFromHandle(RenderResourceHandle handle) const {
 			return Renderer::AccessResource<DescriptorSet>(handle);
 		}
 
+		//the lines of the stage inside the shader file
+		std::string LoadStageSource(const std::filesystem::path& path, shaderc_shader_kind kind) const;
+		std::vector<uint32_t> CompileSPIRVData(const std::string& source, const std::filesystem::path& path, shaderc::Compiler& compiler,
+											   shaderc::CompileOptions& options, shaderc_shader_kind kind) const;
+
+		struct ShaderBinding {
+			std::string Name;
+			uint32_t Set = 0;
+			uint32_t Binding = 0;
+			DescriptorType Type = DescriptorType::Undefined;
+			RenderResourceHandle DescriptorSetHandle = InvalidRenderResourceHandle; //invalid while the shader is not loaded
+			RenderResourceHandle BufferHandle = InvalidRenderResourceHandle; //only for ubos and ssbos
+			Ref<VulkanUniformImageSampler> ImageSampler = nullptr; //only for images
+		};
+
+		//null, if the handle is invalid or the shader is not loaded
+		const ShaderBinding* GetBinding(ShaderBindingHandle bindingHandle) const;
+		RenderResourceHandle GetBufferHandle(ShaderBindingHandle bindingHandle, bool isSharedStorageBuffer) const;
+		//points the bindings of the set to its descriptor set and resources
+		void ResolveBindings(uint32_t set, const std::vector<ShaderUniformBlock>& uniformBlocks, RenderResourceHandle descriptorSetHandle);
+
 		std::filesystem::path m_Path = "";
 		std::string m_Name = "Unnamed";
 		ShaderReflect m_Reflect;
 
 		std::vector<RenderResourceHandle> m_DescriptorSetHandles;
+		//the entries are never removed, so that the handles of a binding stay the same across reloads.
+		//m_Bindings only grows in RTLoad and is accessed on the render thread, the names are looked up from any thread
+		std::vector<ShaderBinding> m_Bindings;
+		ShaderBindingTable m_BindingTable;
 #pragma region VulkanInternals
 		std::vector<VulkanPushConstant> m_PushConstants;
 #pragma endregion VulkanInternals
@@ -0,0 +1,21 @@
+#include "lypch.h"
+#include "ShaderBindingTable.h"
+
+namespace Lucy {
+
+	ShaderBindingHandle ShaderBindingTable::Add(const std::string& name) {
+		std::scoped_lock lock(m_Mutex);
+		return m_Handles.try_emplace(name, ShaderBindingHandle{ (uint32_t)m_Handles.size() }).first->second;
+	}
+
+	ShaderBindingHandle ShaderBindingTable::Find(const std::string& name) const {
+		std::scoped_lock lock(m_Mutex);
+		auto it = m_Handles.find(name);
+		return it != m_Handles.end() ? it->second : ShaderBindingHandle{};
+	}
+
+	size_t ShaderBindingTable::GetSize() const {
+		std::scoped_lock lock(m_Mutex);
+		return m_Handles.size();
+	}
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <mutex>
+
+namespace Lucy {
+
+	//an index into the binding table of a shader
+	struct ShaderBindingHandle {
+		uint32_t Index = UINT32_MAX;
+
+		inline bool IsValid() const { return Index != UINT32_MAX; }
+	};
+
+	/*
+	* The names of the bindings of a shader. They are added, when the shader is loaded (before it is published) or reloaded on the render thread,
+	* while the passes resolve their handles from the main thread. A name keeps its handle across reloads, the names are never removed.
+	*/
+	class ShaderBindingTable final {
+	public:
+		ShaderBindingTable() = default;
+		~ShaderBindingTable() = default;
+
+		//the handle of the name, a new name gets the next index
+		ShaderBindingHandle Add(const std::string& name);
+		//invalid, if there is no binding with the name
+		ShaderBindingHandle Find(const std::string& name) const;
+		size_t GetSize() const;
+	private:
+		mutable std::mutex m_Mutex;
+		std::unordered_map<std::string, ShaderBindingHandle> m_Handles;
+	};
+}
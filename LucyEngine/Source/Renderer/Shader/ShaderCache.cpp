@@ -0,0 +1,49 @@
+#include "lypch.h"
+#include "ShaderCache.h"
+
+#include "Core/FileSystem.h"
+#include "Utilities/Utilities.h"
+
+#include "vulkan/vulkan.h"
+
+namespace Lucy {
+
+	uint64_t ShaderCache::ComputeKey(std::string_view preprocessedSource, uint64_t optionsHash, uint32_t stageKind) {
+		uint64_t cacheKey = Utils::HashBytes(preprocessedSource.data(), preprocessedSource.size());
+		cacheKey = Utils::HashBytes(&optionsHash, sizeof(optionsHash), cacheKey);
+		return Utils::HashBytes(&stageKind, sizeof(stageKind), cacheKey);
+	}
+
+	uint64_t ShaderCache::ComputeOptionsHash(std::string_view settings) {
+		return Utils::HashBytes(settings.data(), settings.size());
+	}
+
+	bool ShaderCache::IsEntryValid(const std::filesystem::path& cachedFilePath, uint64_t cacheKey) {
+		const std::filesystem::path metadataPath = std::filesystem::path(cachedFilePath).concat(".meta");
+		if (!FileSystem::FileExists(cachedFilePath) || !FileSystem::FileExists(metadataPath))
+			return false;
+
+		std::string metadata;
+		FileSystem::ReadFile(metadataPath, metadata);
+
+		//the key is the first line, the rest is only there for debugging
+		const std::string expectedKey = std::format("key {:016x}", cacheKey);
+		return metadata.starts_with(expectedKey) && (metadata.size() == expectedKey.size() || metadata[expectedKey.size()] == '\n');
+	}
+
+	void ShaderCache::WriteEntry(const std::filesystem::path& cachedFilePath, const std::vector<uint32_t>& data, uint64_t cacheKey, const std::filesystem::path& sourcePath) {
+		FileSystem::WriteToFile<uint32_t>(cachedFilePath, data, OpenMode::Binary);
+
+		//written last, so an interrupted write never leaves a matching key next to a partial entry
+		const std::string metadata = std::format("key {:016x}\nsource {}\nformat {}\nsdk {}.{}.{}\n", cacheKey, sourcePath.generic_string(),
+												 s_FormatVersion, VK_API_VERSION_MAJOR(VK_HEADER_VERSION_COMPLETE),
+												 VK_API_VERSION_MINOR(VK_HEADER_VERSION_COMPLETE), VK_HEADER_VERSION);
+		FileSystem::WriteToFile<char>(std::filesystem::path(cachedFilePath).concat(".meta"), std::vector<char>(metadata.begin(), metadata.end()), OpenMode::Binary);
+	}
+
+	std::vector<uint32_t> ShaderCache::LoadEntry(const std::filesystem::path& cachedFilePath) {
+		std::vector<uint32_t> data;
+		FileSystem::ReadFile<uint32_t>(cachedFilePath, data, OpenMode::Binary);
+		return data;
+	}
+}
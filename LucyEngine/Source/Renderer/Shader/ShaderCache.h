@@ -0,0 +1,26 @@
+#pragma once
+
+namespace Lucy {
+
+	/*
+	* The compiled SPIR-V of the shader stages, stored in the cache folder of the shaders with their metadata next to them (<entry>.meta).
+	* An entry is only used, if it was compiled from the same preprocessed source (with every include and macro resolved) and settings.
+	*/
+	class ShaderCache final {
+	private:
+		ShaderCache() = delete;
+		~ShaderCache() = delete;
+	public:
+		//the keys are stored in the metadata, so they are the same for every run and platform (unlike std::hash)
+		static uint64_t ComputeKey(std::string_view preprocessedSource, uint64_t optionsHash, uint32_t stageKind);
+		static uint64_t ComputeOptionsHash(std::string_view settings);
+
+		static bool IsEntryValid(const std::filesystem::path& cachedFilePath, uint64_t cacheKey);
+		static void WriteEntry(const std::filesystem::path& cachedFilePath, const std::vector<uint32_t>& data, uint64_t cacheKey, const std::filesystem::path& sourcePath);
+		static std::vector<uint32_t> LoadEntry(const std::filesystem::path& cachedFilePath);
+
+		//has to be increased, if the cached entries or their metadata change in a way the cache key does not cover.
+		//the key only knows the Vulkan SDK version, so this has to be increased as well, when shaderc is updated on its own (e.g. built from source)
+		static constexpr uint32_t s_FormatVersion = 2;
+	};
+}
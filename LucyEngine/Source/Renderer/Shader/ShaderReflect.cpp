@@ -156,6 +156,9 @@ namespace Lucy {
 					//descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
 			}
 
+			if (descriptorType == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER)
+				uniformBlock.IsWrittenByShader = !compiler->get_buffer_block_flags(ub.id).get(spv::DecorationNonWritable);
+
 			uniformBlock.Binding = binding;
 			uniformBlock.BufferSize = bufferSize;
 			uniformBlock.Type = ConvertDescriptorType(descriptorType);
@@ -167,7 +170,7 @@ namespace Lucy {
 				m_ShaderUniformBlockMap.emplace(set, buffer);
 			} else {
 				const auto& it = m_ShaderUniformBlockMap.find(set);
-				if (CheckIfAlreadyPresent(uniformBlock.Name, it->second))
+				if (CheckIfAlreadyPresent(uniformBlock, it->second))
 					continue;
 				it->second.push_back(uniformBlock);
 			}
@@ -199,7 +202,7 @@ namespace Lucy {
 			if (uniformBlock.Name.empty())
 				uniformBlock.Name = ub.name;
 
-			if (CheckIfAlreadyPresent(uniformBlock.Name, m_ShaderPushConstants))
+			if (CheckIfAlreadyPresent(uniformBlock, m_ShaderPushConstants))
 				return;
 
 			const auto& type = compiler->get_type(ub.base_type_id);
@@ -219,14 +222,16 @@ namespace Lucy {
 	}
 
 	//if there are multiple occurences between the 2 shader stages (vertex and fragment), dont add a another one but combine them together
-	bool ShaderReflect::CheckIfAlreadyPresent(std::string_view uniformBlockName, std::vector<ShaderUniformBlock>& buffer) {
-		auto result = std::find_if(buffer.begin(), buffer.end(), [uniformBlockName](const ShaderUniformBlock& uniformBlock) {
-			return uniformBlockName == uniformBlock.Name;
+	bool ShaderReflect::CheckIfAlreadyPresent(const ShaderUniformBlock& uniformBlock, std::vector<ShaderUniformBlock>& buffer) {
+		auto result = std::find_if(buffer.begin(), buffer.end(), [&uniformBlock](const ShaderUniformBlock& presentBlock) {
+			return uniformBlock.Name == presentBlock.Name;
 		});
 
 		if (result != buffer.end()) {
 			size_t index = result - buffer.begin();
 			buffer[index].StageFlag = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+			//written by the other stage
+			buffer[index].IsWrittenByShader |= uniformBlock.IsWrittenByShader;
 			return true;
 		}
 		return false;
@@ -55,6 +55,7 @@ namespace Lucy {
 		uint32_t BufferSize = 0;
 		uint32_t ArraySize = 0; //default is 0, which means no array
 		bool DynamicallyAllocated = false; //only for ssbos or ubos
+		bool IsWrittenByShader = false; //only for ssbos, that are not declared as readonly (in any stage)
 		DescriptorType Type = DescriptorType::Undefined;
 		VkShaderStageFlags StageFlag = VK_SHADER_STAGE_FLAG_BITS_MAX_ENUM;
 		std::vector<ShaderMemberVariable> Members;
@@ -93,7 +94,7 @@ namespace Lucy {
 		//Push constants get their own function, since their implementation is a bit different than other uniform buffer types
 		void SearchForPushConstants(spirv_cross::CompilerGLSL* compiler, const spirv_cross::ShaderResources& resource, VkShaderStageFlags stageFlag);
 
-		bool CheckIfAlreadyPresent(std::string_view uniformBlockName, std::vector<ShaderUniformBlock>& buffer);
+		bool CheckIfAlreadyPresent(const ShaderUniformBlock& uniformBlock, std::vector<ShaderUniformBlock>& buffer);
 
 		//key = individual set
 		//value = uniform blocks
@@ -11,6 +11,7 @@ namespace Lucy {
 		uint32_t Binding = 0;
 		std::string Name = "Undefined";
 		std::vector<VkDescriptorImageInfo> ImageInfos;
+		std::vector<uint64_t> ImageViewIDs; //of the image infos, see VulkanImageView::GetID
 		DescriptorType DescriptorType;
 	};
 }
\ No newline at end of file
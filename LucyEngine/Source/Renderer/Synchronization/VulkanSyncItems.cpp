@@ -49,6 +49,15 @@ namespace Lucy {
 		vkCmdPipelineBarrier(commandBuffer, sourceStage, destStage, 0, 0, nullptr, 0, nullptr, 1, &m_Barrier);
 	}
 
+	BufferMemoryBarrier::BufferMemoryBarrier(const BufferMemoryBarrierCreateInfo& createInfo)
+		: m_CreateInfo(createInfo),
+		m_Barrier(VulkanAPI::BufferMemoryBarrier(m_CreateInfo.BufferHandle, m_CreateInfo.Offset, m_CreateInfo.Size, m_CreateInfo.SrcAccessMask, m_CreateInfo.DstAccessMask)) {
+	}
+
+	void BufferMemoryBarrier::RunBarrier(VkCommandBuffer commandBuffer) {
+		vkCmdPipelineBarrier(commandBuffer, m_CreateInfo.SrcStage, m_CreateInfo.DstStage, 0, 0, nullptr, 1, &m_Barrier, 0, nullptr);
+	}
+
 	void DefineMasksByLayout(VkImageLayout oldLayout, VkImageLayout newLayout, VkAccessFlags& srcAccessMask,
 												 VkAccessFlags& destAccessMask, VkPipelineStageFlags& sourceStage, VkPipelineStageFlags& destStage) {
 		switch (oldLayout) {
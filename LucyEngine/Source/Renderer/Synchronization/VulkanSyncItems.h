@@ -56,4 +56,28 @@ namespace Lucy {
 		ImageMemoryBarrierCreateInfo m_CreateInfo;
 		VkImageMemoryBarrier m_Barrier{};
 	};
+
+	struct BufferMemoryBarrierCreateInfo {
+		VkBuffer BufferHandle = VK_NULL_HANDLE;
+		VkDeviceSize Offset = 0;
+		VkDeviceSize Size = VK_WHOLE_SIZE;
+
+		VkAccessFlags SrcAccessMask = VK_ACCESS_NONE_KHR;
+		VkAccessFlags DstAccessMask = VK_ACCESS_NONE_KHR;
+
+		VkPipelineStageFlags SrcStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+		VkPipelineStageFlags DstStage = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+	};
+
+	//for buffers that are written by one stage and consumed by another (e.g. compute written indirect commands)
+	class BufferMemoryBarrier final {
+	public:
+		BufferMemoryBarrier(const BufferMemoryBarrierCreateInfo& createInfo);
+		~BufferMemoryBarrier() = default;
+
+		void RunBarrier(VkCommandBuffer commandBuffer);
+	private:
+		BufferMemoryBarrierCreateInfo m_CreateInfo;
+		VkBufferMemoryBarrier m_Barrier{};
+	};
 }
\ No newline at end of file
@@ -592,6 +592,21 @@ namespace Lucy::VulkanAPI {
 		return barrier;
 	}
 
+	VkBufferMemoryBarrier VulkanAPI::BufferMemoryBarrier(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize size, VkAccessFlags srcAccessMask, VkAccessFlags dstAccessMask,
+														 uint32_t srcQueueFamilyIndex, uint32_t dstQueueFamilyIndex) {
+		VkBufferMemoryBarrier barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+		barrier.buffer = buffer;
+		barrier.offset = offset;
+		barrier.size = size;
+		barrier.srcAccessMask = srcAccessMask;
+		barrier.dstAccessMask = dstAccessMask;
+		barrier.srcQueueFamilyIndex = srcQueueFamilyIndex;
+		barrier.dstQueueFamilyIndex = dstQueueFamilyIndex;
+
+		return barrier;
+	}
+
 	VkRenderPassCreateInfo VulkanAPI::RenderPassCreateInfo(uint32_t attachmentCount, const VkAttachmentDescription* const attachments,
 														   uint32_t subpassCount, const VkSubpassDescription* const subpasses,
 														   uint32_t dependencyCount, const VkSubpassDependency* const dependencies) {
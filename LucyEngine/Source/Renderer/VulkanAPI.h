@@ -93,6 +93,8 @@ namespace Lucy::VulkanAPI {
 	VkImageMemoryBarrier ImageMemoryBarrier(VkImage image, VkImageLayout oldLayout, VkImageLayout newLayout, VkImageSubresourceRange subresourceRange,
 											VkAccessFlags srcAccessMask = VK_ACCESS_NONE_KHR, VkAccessFlags dstAccessMask = VK_ACCESS_NONE_KHR,
 											uint32_t srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED, uint32_t dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED);
+	VkBufferMemoryBarrier BufferMemoryBarrier(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize size, VkAccessFlags srcAccessMask, VkAccessFlags dstAccessMask,
+											  uint32_t srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED, uint32_t dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED);
 
 	VkRenderPassCreateInfo RenderPassCreateInfo(uint32_t attachmentCount, const VkAttachmentDescription* const attachments,
 												uint32_t subpassCount, const VkSubpassDescription* const subpasses,
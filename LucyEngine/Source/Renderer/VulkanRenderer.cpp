@@ -9,7 +9,10 @@
 #include "Device/VulkanRenderDevice.h"
 
 #include "Memory/Buffer/Buffer.h"
+#include "Memory/Buffer/Vulkan/VulkanMappedBuffer.h"
+#include "Memory/Buffer/Vulkan/VulkanSharedStorageBuffer.h"
 #include "Commands/VulkanCommandPool.h"
+#include "Descriptors/VulkanDescriptorSet.h"
 
 #include "Events/InputEvent.h"
 
@@ -41,6 +44,7 @@ namespace Lucy {
 		m_WaitSemaphoresCompute.reserve(m_MaxFramesInFlight);
 		m_SignalSemaphoresCompute.reserve(m_MaxFramesInFlight);
 		m_InFlightFencesCompute.reserve(m_MaxFramesInFlight);
+		m_SubmittedFrames = std::vector<std::atomic<bool>>(m_MaxFramesInFlight);
 
 		for (size_t i = 0; i < m_MaxFramesInFlight; i++) {
 			m_WaitSemaphores.emplace_back(vulkanDevice);
@@ -64,12 +68,16 @@ namespace Lucy {
 
 		vkWaitForFences(deviceVulkanHandle, 1, &m_InFlightFences[m_CurrentFrameIndex].GetFence(), VK_TRUE, UINT64_MAX);
 		vkResetFences(deviceVulkanHandle, 1, &m_InFlightFences[m_CurrentFrameIndex].GetFence());
+		m_SubmittedFrames[m_CurrentFrameIndex] = false;
 
 		if (!m_RenderComputeCommandQueue->IsEmpty()) {
 			vkWaitForFences(deviceVulkanHandle, 1, &m_InFlightFencesCompute[m_CurrentFrameIndex].GetFence(), VK_TRUE, UINT64_MAX);
 			vkResetFences(deviceVulkanHandle, 1, &m_InFlightFencesCompute[m_CurrentFrameIndex].GetFence());
 		}
 
+		//the transient sets of this frame slot are no longer in use
+		renderDevice->GetDescriptorAllocator().RTResetFramePools(m_CurrentFrameIndex);
+
 		m_UseComputeSemaphore = false;
 
 		const auto& swapChain = GetSwapChain()->As<VulkanSwapChain>();
@@ -95,6 +103,16 @@ namespace Lucy {
 		const auto& graphicsCmdLists = m_RenderCommandQueue->GetCommandLists();
 		const auto& computeCmdLists = m_RenderComputeCommandQueue->GetCommandLists();
 
+		//the uniform and storage buffers have been written while recording the frame
+		LUCY_PROFILE_PLOT("Mapped Buffer Upload Bytes", (int64_t)VulkanMappedBuffer::ConsumeUploadedBytes());
+		LUCY_PROFILE_PLOT("Storage Buffer Memory", (int64_t)VulkanSharedStorageBuffer::GetAllocatedSize());
+		LUCY_PROFILE_PLOT("Descriptor Set Updates", (int64_t)VulkanDescriptorSet::ConsumeUpdateCount());
+
+		const VulkanDescriptorAllocatorStats descriptorStats = GetRenderDevice()->As<VulkanRenderDevice>()->GetDescriptorAllocator().GetStats();
+		LUCY_PROFILE_PLOT("Descriptor Pools", (int64_t)(descriptorStats.PersistentPoolCount + descriptorStats.FramePoolCount));
+		LUCY_PROFILE_PLOT("Descriptor Sets", (int64_t)(descriptorStats.PersistentSetCount + descriptorStats.FrameSetCount));
+		LUCY_PROFILE_PLOT("Descriptor Frame Set Cache Hits", (int64_t)descriptorStats.FrameSetCacheHits);
+
 		std::vector<Ref<CommandPool>> graphicsCmdPools;
 		graphicsCmdPools.reserve(graphicsCmdLists.size());
 
@@ -105,6 +123,7 @@ namespace Lucy {
 
 		const auto& renderDevice = GetRenderDevice()->As<VulkanRenderDevice>();
 		renderDevice->SubmitWorkToGPU(TargetQueueFamily::Graphics, graphicsCmdPools, &currentFrameFence, &currentFrameWaitSemaphore, &currentFrameSignalSemaphore);
+		m_SubmittedFrames[m_CurrentFrameIndex] = true;
 
 		if (!m_RenderComputeCommandQueue->IsEmpty()) {
 			std::vector<Ref<CommandPool>> computeCmdPools;
@@ -194,8 +213,12 @@ namespace Lucy {
 	}
 
 	void VulkanRenderer::Destroy() {
-		auto& allocator = GetRenderDevice()->As<VulkanRenderDevice>()->GetAllocator();
-		allocator.DestroyBuffer(s_IDBuffer, s_IDBufferVma);
+		if (s_IDReadbackBuffer) {
+			auto& allocator = GetRenderDevice()->As<VulkanRenderDevice>()->GetAllocator();
+			allocator.UnmapMemory(s_IDReadbackBufferVma);
+			allocator.DestroyBuffer(s_IDReadbackBuffer, s_IDReadbackBufferVma);
+			s_IDReadbackData = nullptr;
+		}
 
 		m_TransientCommandPool->Destroy();
 
@@ -243,12 +266,6 @@ namespace Lucy {
 		swapChain->Recreate();
 
 		RecreateCommandQueue();
-
-		auto& allocator = renderDevice->GetAllocator();
-		allocator.DestroyBuffer(s_IDBuffer, s_IDBufferVma);
-
-		s_IDBuffer = VK_NULL_HANDLE;
-		s_IDBufferVma = VK_NULL_HANDLE;
 	}
 
 	void VulkanRenderer::OnViewportResize() {
@@ -256,53 +273,52 @@ namespace Lucy {
 
 		const auto& renderDevice = GetRenderDevice()->As<VulkanRenderDevice>();
 		renderDevice->WaitForDevice();
-
-		auto& allocator = renderDevice->GetAllocator();
-		allocator.DestroyBuffer(s_IDBuffer, s_IDBufferVma);
-
-		s_IDBuffer = VK_NULL_HANDLE;	
-		s_IDBufferVma = VK_NULL_HANDLE;
 	}
 	
-	glm::vec3 VulkanRenderer::OnMousePicking(const EntityPickedEvent& e, const Ref<Image>& currentFrameBufferImage) {
-		LUCY_PROFILE_NEW_EVENT("VulkanRenderer::OnMousePicking");
+	void VulkanRenderer::RTRecordIDReadback(const Ref<CommandPool>& cmdPool, const Ref<Image>& idImage, const glm::uvec2& pixel) {
+		LUCY_PROFILE_NEW_EVENT("VulkanRenderer::RTRecordIDReadback");
 
-		float viewportMouseX = e.GetViewportMouseX();
-		float viewportMouseY = e.GetViewportMouseY();
-
-		if (viewportMouseX < 0 && viewportMouseY < 0)
-			return glm::vec3(-1.0f);
+		const auto& image = idImage->As<VulkanImage2D>();
+		if (pixel.x >= image->GetWidth() || pixel.y >= image->GetHeight())
+			return;
 
-		const auto& image = currentFrameBufferImage->As<VulkanImage2D>();
-		uint32_t imageWidth = image->GetWidth();
-		uint32_t imageHeight = image->GetHeight();
-		VkDeviceSize imageSize = (VkDeviceSize)imageWidth * imageHeight * 4;
+		if (!s_IDReadbackBuffer) {
+			auto& allocator = GetRenderDevice()->As<VulkanRenderDevice>()->GetAllocator();
+			allocator.CreateVulkanBufferVma(VulkanBufferUsage::Readback, s_IDReadbackTexelSize * m_MaxFramesInFlight, VK_BUFFER_USAGE_TRANSFER_DST_BIT, 
+											s_IDReadbackBuffer, s_IDReadbackBufferVma);
+			void* mappedData = nullptr;
+			allocator.MapMemory(s_IDReadbackBufferVma, mappedData);
+			s_IDReadbackData = (uint8_t*)mappedData;
+		}
 
-		auto& allocator = GetRenderDevice()->As<VulkanRenderDevice>()->GetAllocator();
-		if (!s_IDBuffer)
-			allocator.CreateVulkanBufferVma(VulkanBufferUsage::CPUOnly, imageSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT, s_IDBuffer, s_IDBufferVma);
+		VkCommandBuffer commandBuffer = (VkCommandBuffer)cmdPool->GetCurrentFrameCommandBuffer();
 
-		image->SetLayoutImmediate(VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
-		image->CopyImageToBufferImmediate(s_IDBuffer);
+		//only the picked texel, into the slot of this frame. The slot is not touched again, until the frame's fence has been waited on
+		VkImageSubresourceLayers imageSubresource = VulkanAPI::ImageSubresourceLayers(VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1);
+		VkBufferImageCopy region = VulkanAPI::BufferImageCopy(s_IDReadbackTexelSize * m_CurrentFrameIndex, 0, 0, imageSubresource, 
+															  { (int32_t)pixel.x, (int32_t)pixel.y, 0 }, { 1, 1, 1 });
 
-		ByteBuffer rawData;
+		image->SetLayout(commandBuffer, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, 0, 0, 1, 1);
+		image->CopyImageToBuffer(commandBuffer, s_IDReadbackBuffer, { region });
+		image->SetLayout(commandBuffer, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, 0, 0, 1, 1);
 
-		void* rawDataMapped;
-		allocator.MapMemory(s_IDBufferVma, rawDataMapped);
-		rawData.SetData((uint8_t*)rawDataMapped, imageSize);
-		allocator.UnmapMemory(s_IDBufferVma);
+		VkMemoryBarrier barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+	}
 
-		uint32_t flippedY = imageHeight - 1 - (uint32_t)(viewportMouseY);
-		uint32_t bufferPos = (uint32_t) (4 * ((flippedY * imageWidth) + viewportMouseX));
-		glm::vec3 meshID = glm::vec3(rawData[bufferPos], rawData[bufferPos + 1], rawData[bufferPos + 2]);
+	glm::vec3 VulkanRenderer::ReadIDReadback(uint32_t frameIndex) {
+		LUCY_PROFILE_NEW_EVENT("VulkanRenderer::ReadIDReadback");
+		if (!s_IDReadbackData)
+			return glm::vec3(-1.0f);
 
-		image->SetLayoutImmediate(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+		auto& allocator = GetRenderDevice()->As<VulkanRenderDevice>()->GetAllocator();
+		allocator.InvalidateMemory(s_IDReadbackBufferVma, s_IDReadbackTexelSize * frameIndex, s_IDReadbackTexelSize);
 
-		//checking if the data that is being read make sense
-		if ((meshID.x > 255.0f || meshID.x < 0.0f) ||
-			(meshID.y > 255.0f || meshID.y < 0.0f) ||
-			(meshID.z > 255.0f || meshID.z < 0.0f))
-			return glm::vec3(-1.0f);
+		const uint8_t* texel = s_IDReadbackData + s_IDReadbackTexelSize * frameIndex;
+		glm::vec3 meshID = glm::vec3(texel[0], texel[1], texel[2]);
 
 		//checking if we clicked on the void
 		if (meshID.x == 0 && meshID.y == 0 && meshID.z == 0)
@@ -311,6 +327,15 @@ namespace Lucy {
 		return meshID;
 	}
 
+	bool VulkanRenderer::IsFrameCompleted(uint32_t frameIndex) {
+		const auto& renderDevice = GetRenderDevice()->As<VulkanRenderDevice>();
+		return vkGetFenceStatus(renderDevice->GetLogicalDevice(), m_InFlightFences[frameIndex].GetFence()) == VK_SUCCESS;
+	}
+
+	bool VulkanRenderer::IsFrameSubmitted(uint32_t frameIndex) {
+		return m_SubmittedFrames[frameIndex].load();
+	}
+
 	void VulkanRenderer::InitializeImGui() {
 		m_ImGuiPass.Init(this);
 	}
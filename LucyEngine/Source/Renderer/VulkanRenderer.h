@@ -1,5 +1,7 @@
 #pragma once
 
+#include <atomic>
+
 #include "RendererBackend.h"
 #include "Context/VulkanSwapChain.h"
 #include "Synchronization/VulkanSyncItems.h"
@@ -29,7 +31,10 @@ namespace Lucy {
 
 		void OnWindowResize() final override;
 		void OnViewportResize() final override;
-		glm::vec3 OnMousePicking(const EntityPickedEvent& e, const Ref<Image>& currentFrameBufferImage) final override;
+		void RTRecordIDReadback(const Ref<CommandPool>& cmdPool, const Ref<Image>& idImage, const glm::uvec2& pixel) final override;
+		glm::vec3 ReadIDReadback(uint32_t frameIndex) final override;
+		bool IsFrameCompleted(uint32_t frameIndex) final override;
+		bool IsFrameSubmitted(uint32_t frameIndex) final override;
 
 		void InitializeImGui() final override;
 		void RTRenderImGui() final override;
@@ -49,6 +54,7 @@ namespace Lucy {
 		std::vector<Semaphore> m_WaitSemaphoresCompute;
 		std::vector<Semaphore> m_SignalSemaphoresCompute;
 		std::vector<Fence> m_InFlightFencesCompute;
+		std::vector<std::atomic<bool>> m_SubmittedFrames; //per frame in flight, written on the render thread and read by the main thread in Renderer::Flush
 
 		bool m_UseComputeSemaphore = false;
 
@@ -58,7 +64,10 @@ namespace Lucy {
 
 		ImGuiVulkanImpl m_ImGuiPass;
 
-		static inline VkBuffer s_IDBuffer = VK_NULL_HANDLE;
-		static inline VmaAllocation s_IDBufferVma = VK_NULL_HANDLE;
+		//ring of one ID texel per frame in flight, persistently mapped
+		static inline constexpr const VkDeviceSize s_IDReadbackTexelSize = 4; //R8G8B8A8
+		static inline VkBuffer s_IDReadbackBuffer = VK_NULL_HANDLE;
+		static inline VmaAllocation s_IDReadbackBufferVma = VK_NULL_HANDLE;
+		static inline uint8_t* s_IDReadbackData = nullptr;
 	};
 }
\ No newline at end of file
@@ -15,6 +15,25 @@ namespace Lucy {
 
 	void MeshComponent::LoadMesh(const std::string& path) {
 		m_Mesh = std::move(Mesh::Create(path));
+		m_SubmeshLODs.clear();
+	}
+
+	bool BoundsComponent::Update(const Maths::AABB& meshBounds, const glm::mat4& transform) {
+		if (m_Transform == transform && m_MeshBounds.Min == meshBounds.Min && m_MeshBounds.Max == meshBounds.Max)
+			return false;
+
+		m_Transform = transform;
+		m_MeshBounds = meshBounds;
+
+		if (!meshBounds.IsValid()) {
+			m_AABB = Maths::AABB();
+			return true;
+		}
+
+		m_AABB = Maths::TransformAABB(meshBounds, transform);
+		m_SphereCenter = m_AABB.GetCenter();
+		m_SphereRadius = glm::length(m_AABB.GetExtents());
+		return true;
 	}
 
 	void HDRCubemapComponent::LoadCubemap(const std::filesystem::path& path) {
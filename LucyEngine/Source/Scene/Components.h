@@ -4,6 +4,8 @@
 #include "Renderer/Mesh.h"
 #include "Renderer/Renderer.h"
 
+#include "DynamicAABBTree.h"
+
 namespace Lucy {
 
 	struct TransformComponent {
@@ -39,8 +41,56 @@ namespace Lucy {
 
 		inline Ref<Mesh> GetMesh() { return m_Mesh; }
 		inline bool IsValid() { return m_Mesh.get() != nullptr && !m_Mesh->GetSubmeshes().empty(); }
+
+		//selected LOD per submesh, kept across frames for the hysteresis
+		inline std::vector<uint32_t>& GetSubmeshLODs() { return m_SubmeshLODs; }
 	private:
 		Ref<Mesh> m_Mesh = nullptr;
+		std::vector<uint32_t> m_SubmeshLODs;
+	};
+
+	//world space bounds of the mesh of the entity, updated by the scene, once the mesh or the transform changes
+	struct BoundsComponent {
+		BoundsComponent() = default;
+		//the proxy belongs to the tree entry of the other entity, the copy gets its own with the next update
+		BoundsComponent(const BoundsComponent& other)
+			: m_AABB(other.m_AABB), m_SphereCenter(other.m_SphereCenter), m_SphereRadius(other.m_SphereRadius) {
+		}
+
+		//the components are moved within the storage of the scene, they stay with their entity
+		BoundsComponent(BoundsComponent&& other) noexcept = default;
+		BoundsComponent& operator=(BoundsComponent&& other) noexcept = default;
+
+		BoundsComponent& operator=(const BoundsComponent& other) {
+			m_AABB = other.m_AABB;
+			m_SphereCenter = other.m_SphereCenter;
+			m_SphereRadius = other.m_SphereRadius;
+			//the own proxy is moved to the new bounds with the next update
+			m_MeshBounds = Maths::AABB();
+			m_Transform = glm::mat4(0.0f);
+			return *this;
+		}
+
+		//returns true, if the bounds have changed
+		bool Update(const Maths::AABB& meshBounds, const glm::mat4& transform);
+
+		inline const Maths::AABB& GetAABB() const { return m_AABB; }
+		inline const glm::vec3& GetSphereCenter() const { return m_SphereCenter; }
+		inline float GetSphereRadius() const { return m_SphereRadius; }
+
+		inline bool IsValid() const { return m_AABB.IsValid(); }
+	private:
+		Maths::AABB m_AABB;
+		glm::vec3 m_SphereCenter = glm::vec3(0.0f);
+		float m_SphereRadius = 0.0f;
+
+		//inputs of the last update, to skip entities that haven't moved
+		Maths::AABB m_MeshBounds;
+		glm::mat4 m_Transform = glm::mat4(0.0f);
+
+		int32_t m_ProxyID = DynamicAABBTree::NullNode;
+
+		friend class Scene;
 	};
 
 	struct UUIDComponent {
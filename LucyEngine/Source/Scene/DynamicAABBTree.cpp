@@ -0,0 +1,284 @@
+#include "lypch.h"
+#include "DynamicAABBTree.h"
+
+namespace Lucy {
+
+	int32_t DynamicAABBTree::CreateProxy(const Maths::AABB& aabb, uint32_t userData) {
+		const int32_t proxyID = AllocateNode();
+
+		Node& node = m_Nodes[proxyID];
+		node.AABB = Maths::AABB{ aabb.Min - glm::vec3(s_AABBMargin), aabb.Max + glm::vec3(s_AABBMargin) };
+		node.UserData = userData;
+		node.Height = 0;
+
+		InsertLeaf(proxyID);
+		m_ProxyCount++;
+		return proxyID;
+	}
+
+	void DynamicAABBTree::DestroyProxy(int32_t proxyID) {
+		LUCY_ASSERT(proxyID >= 0 && proxyID < (int32_t)m_Nodes.size() && m_Nodes[proxyID].IsLeaf(), "Invalid proxy {0}", proxyID);
+
+		RemoveLeaf(proxyID);
+		FreeNode(proxyID);
+		m_ProxyCount--;
+	}
+
+	bool DynamicAABBTree::MoveProxy(int32_t proxyID, const Maths::AABB& aabb) {
+		LUCY_ASSERT(proxyID >= 0 && proxyID < (int32_t)m_Nodes.size() && m_Nodes[proxyID].IsLeaf(), "Invalid proxy {0}", proxyID);
+
+		if (m_Nodes[proxyID].AABB.Contains(aabb))
+			return false;
+
+		RemoveLeaf(proxyID);
+		m_Nodes[proxyID].AABB = Maths::AABB{ aabb.Min - glm::vec3(s_AABBMargin), aabb.Max + glm::vec3(s_AABBMargin) };
+		InsertLeaf(proxyID);
+		return true;
+	}
+
+	void DynamicAABBTree::Clear() {
+		m_Nodes.clear();
+		m_Root = NullNode;
+		m_FreeList = NullNode;
+		m_ProxyCount = 0;
+	}
+
+	int32_t DynamicAABBTree::AllocateNode() {
+		if (m_FreeList == NullNode) {
+			m_Nodes.emplace_back();
+			return (int32_t)m_Nodes.size() - 1;
+		}
+
+		const int32_t nodeID = m_FreeList;
+		m_FreeList = m_Nodes[nodeID].Next;
+		m_Nodes[nodeID] = Node();
+		return nodeID;
+	}
+
+	void DynamicAABBTree::FreeNode(int32_t nodeID) {
+		Node& node = m_Nodes[nodeID];
+		node.Next = m_FreeList;
+		node.Height = -1;
+		m_FreeList = nodeID;
+	}
+
+	void DynamicAABBTree::InsertLeaf(int32_t leaf) {
+		if (m_Root == NullNode) {
+			m_Root = leaf;
+			m_Nodes[leaf].Parent = NullNode;
+			return;
+		}
+
+		//descend to the sibling with the lowest cost, the cost of a node is its surface area.
+		//inheritanceCost is what every ancestor of the new node pays additionally, when it is enlarged
+		const Maths::AABB leafAABB = m_Nodes[leaf].AABB;
+		int32_t index = m_Root;
+		while (!m_Nodes[index].IsLeaf()) {
+			const Node& node = m_Nodes[index];
+
+			const float area = node.AABB.GetSurfaceArea();
+			const float combinedArea = Maths::AABB::Union(node.AABB, leafAABB).GetSurfaceArea();
+
+			//creating a new parent for this node and the new leaf
+			const float cost = 2.0f * combinedArea;
+			const float inheritanceCost = 2.0f * (combinedArea - area);
+
+			const auto DescendCost = [&](int32_t childID) {
+				const Node& child = m_Nodes[childID];
+				const float newArea = Maths::AABB::Union(child.AABB, leafAABB).GetSurfaceArea();
+				if (child.IsLeaf())
+					return newArea + inheritanceCost;
+				return (newArea - child.AABB.GetSurfaceArea()) + inheritanceCost;
+			};
+
+			const float cost1 = DescendCost(node.Child1);
+			const float cost2 = DescendCost(node.Child2);
+
+			if (cost < cost1 && cost < cost2)
+				break;
+			index = cost1 < cost2 ? node.Child1 : node.Child2;
+		}
+
+		const int32_t sibling = index;
+		const int32_t oldParent = m_Nodes[sibling].Parent;
+		const int32_t newParent = AllocateNode();
+
+		m_Nodes[newParent].Parent = oldParent;
+		m_Nodes[newParent].AABB = Maths::AABB::Union(leafAABB, m_Nodes[sibling].AABB);
+		m_Nodes[newParent].Height = m_Nodes[sibling].Height + 1;
+		m_Nodes[newParent].Child1 = sibling;
+		m_Nodes[newParent].Child2 = leaf;
+		m_Nodes[sibling].Parent = newParent;
+		m_Nodes[leaf].Parent = newParent;
+
+		if (oldParent != NullNode) {
+			if (m_Nodes[oldParent].Child1 == sibling)
+				m_Nodes[oldParent].Child1 = newParent;
+			else
+				m_Nodes[oldParent].Child2 = newParent;
+		} else {
+			m_Root = newParent;
+		}
+
+		//refit and rebalance the ancestors
+		index = m_Nodes[leaf].Parent;
+		while (index != NullNode) {
+			index = Balance(index);
+
+			Node& node = m_Nodes[index];
+			node.Height = 1 + glm::max(m_Nodes[node.Child1].Height, m_Nodes[node.Child2].Height);
+			node.AABB = Maths::AABB::Union(m_Nodes[node.Child1].AABB, m_Nodes[node.Child2].AABB);
+
+			index = node.Parent;
+		}
+	}
+
+	void DynamicAABBTree::RemoveLeaf(int32_t leaf) {
+		if (leaf == m_Root) {
+			m_Root = NullNode;
+			return;
+		}
+
+		const int32_t parent = m_Nodes[leaf].Parent;
+		const int32_t grandParent = m_Nodes[parent].Parent;
+		const int32_t sibling = m_Nodes[parent].Child1 == leaf ? m_Nodes[parent].Child2 : m_Nodes[parent].Child1;
+
+		if (grandParent == NullNode) {
+			m_Root = sibling;
+			m_Nodes[sibling].Parent = NullNode;
+			FreeNode(parent);
+			return;
+		}
+
+		//the sibling takes the place of the parent
+		if (m_Nodes[grandParent].Child1 == parent)
+			m_Nodes[grandParent].Child1 = sibling;
+		else
+			m_Nodes[grandParent].Child2 = sibling;
+		m_Nodes[sibling].Parent = grandParent;
+		FreeNode(parent);
+
+		int32_t index = grandParent;
+		while (index != NullNode) {
+			index = Balance(index);
+
+			Node& node = m_Nodes[index];
+			node.Height = 1 + glm::max(m_Nodes[node.Child1].Height, m_Nodes[node.Child2].Height);
+			node.AABB = Maths::AABB::Union(m_Nodes[node.Child1].AABB, m_Nodes[node.Child2].AABB);
+
+			index = node.Parent;
+		}
+	}
+
+	//if the subtrees of A differ in height by more than one, the higher child (B or C) is rotated up and becomes the parent of A.
+	//returns the new root of the subtree
+	int32_t DynamicAABBTree::Balance(int32_t iA) {
+		Node& A = m_Nodes[iA];
+		if (A.IsLeaf() || A.Height < 2)
+			return iA;
+
+		const int32_t iB = A.Child1;
+		const int32_t iC = A.Child2;
+		Node& B = m_Nodes[iB];
+		Node& C = m_Nodes[iC];
+
+		const int32_t balance = C.Height - B.Height;
+
+		const auto ReplaceChild = [&](int32_t parent, int32_t oldChild, int32_t newChild) {
+			if (parent == NullNode) {
+				m_Root = newChild;
+				return;
+			}
+			if (m_Nodes[parent].Child1 == oldChild)
+				m_Nodes[parent].Child1 = newChild;
+			else
+				m_Nodes[parent].Child2 = newChild;
+		};
+
+		//rotate C up
+		if (balance > 1) {
+			const int32_t iF = C.Child1;
+			const int32_t iG = C.Child2;
+			Node& F = m_Nodes[iF];
+			Node& G = m_Nodes[iG];
+
+			C.Child1 = iA;
+			C.Parent = A.Parent;
+			A.Parent = iC;
+			ReplaceChild(C.Parent, iA, iC);
+
+			//the higher grandchild stays with C, the other one moves to A
+			if (F.Height > G.Height) {
+				C.Child2 = iF;
+				A.Child2 = iG;
+				G.Parent = iA;
+				A.AABB = Maths::AABB::Union(B.AABB, G.AABB);
+				C.AABB = Maths::AABB::Union(A.AABB, F.AABB);
+				A.Height = 1 + glm::max(B.Height, G.Height);
+				C.Height = 1 + glm::max(A.Height, F.Height);
+			} else {
+				C.Child2 = iG;
+				A.Child2 = iF;
+				F.Parent = iA;
+				A.AABB = Maths::AABB::Union(B.AABB, F.AABB);
+				C.AABB = Maths::AABB::Union(A.AABB, G.AABB);
+				A.Height = 1 + glm::max(B.Height, F.Height);
+				C.Height = 1 + glm::max(A.Height, G.Height);
+			}
+			return iC;
+		}
+
+		//rotate B up
+		if (balance < -1) {
+			const int32_t iD = B.Child1;
+			const int32_t iE = B.Child2;
+			Node& D = m_Nodes[iD];
+			Node& E = m_Nodes[iE];
+
+			B.Child1 = iA;
+			B.Parent = A.Parent;
+			A.Parent = iB;
+			ReplaceChild(B.Parent, iA, iB);
+
+			if (D.Height > E.Height) {
+				B.Child2 = iD;
+				A.Child1 = iE;
+				E.Parent = iA;
+				A.AABB = Maths::AABB::Union(C.AABB, E.AABB);
+				B.AABB = Maths::AABB::Union(A.AABB, D.AABB);
+				A.Height = 1 + glm::max(C.Height, E.Height);
+				B.Height = 1 + glm::max(A.Height, D.Height);
+			} else {
+				B.Child2 = iE;
+				A.Child1 = iD;
+				D.Parent = iA;
+				A.AABB = Maths::AABB::Union(C.AABB, D.AABB);
+				B.AABB = Maths::AABB::Union(A.AABB, E.AABB);
+				A.Height = 1 + glm::max(C.Height, D.Height);
+				B.Height = 1 + glm::max(A.Height, E.Height);
+			}
+			return iB;
+		}
+
+		return iA;
+	}
+
+	DynamicAABBTree::FrustumTest DynamicAABBTree::TestFrustum(const Maths::Frustum& frustum, const Maths::AABB& aabb) {
+		FrustumTest result = FrustumTest::Inside;
+		for (const glm::vec4& plane : frustum.Planes) {
+			const glm::vec3 normal = glm::vec3(plane);
+			const glm::vec3 positive = glm::vec3(normal.x >= 0.0f ? aabb.Max.x : aabb.Min.x,
+												 normal.y >= 0.0f ? aabb.Max.y : aabb.Min.y,
+												 normal.z >= 0.0f ? aabb.Max.z : aabb.Min.z);
+			if (glm::dot(normal, positive) + plane.w < 0.0f)
+				return FrustumTest::Outside;
+
+			const glm::vec3 negative = glm::vec3(normal.x >= 0.0f ? aabb.Min.x : aabb.Max.x,
+												 normal.y >= 0.0f ? aabb.Min.y : aabb.Max.y,
+												 normal.z >= 0.0f ? aabb.Min.z : aabb.Max.z);
+			if (glm::dot(normal, negative) + plane.w < 0.0f)
+				result = FrustumTest::Intersecting;
+		}
+		return result;
+	}
+}
@@ -0,0 +1,174 @@
+#pragma once
+
+#include "Utilities/Utilities.h"
+
+namespace Lucy {
+
+	/*
+	* Dynamic bounding volume hierarchy (the same idea as the b2DynamicTree of Box2D).
+	* Leaves store a fattened AABB, so that small movements don't change the tree at all.
+	* Leaves are inserted next to the sibling with the lowest surface area cost (SAH) and
+	* the tree is kept balanced with AVL style rotations on the way back up.
+	*/
+	class DynamicAABBTree final {
+	public:
+		static inline constexpr const int32_t NullNode = -1;
+
+		DynamicAABBTree() = default;
+		~DynamicAABBTree() = default;
+
+		int32_t CreateProxy(const Maths::AABB& aabb, uint32_t userData);
+		void DestroyProxy(int32_t proxyID);
+		//returns true, if the proxy has been reinserted (the box left its fat AABB)
+		bool MoveProxy(int32_t proxyID, const Maths::AABB& aabb);
+		void Clear();
+
+		inline uint32_t GetUserData(int32_t proxyID) const { return m_Nodes[proxyID].UserData; }
+		inline const Maths::AABB& GetFatAABB(int32_t proxyID) const { return m_Nodes[proxyID].AABB; }
+		inline int32_t GetHeight() const { return m_Root == NullNode ? 0 : m_Nodes[m_Root].Height; }
+		inline uint32_t GetProxyCount() const { return m_ProxyCount; }
+
+		//func(uint32_t userData) -> bool, return false to stop the query
+		template <typename TFunc>
+		void QueryOverlap(const Maths::AABB& aabb, TFunc func) const;
+		template <typename TFunc>
+		void QueryFrustum(const Maths::Frustum& frustum, TFunc func) const;
+		//func(uint32_t userData, float distance) -> float, returns the new max distance (clips the ray), a negative value stops the query.
+		//distance is the entry distance to the fat AABB, func has to do the exact test
+		template <typename TFunc>
+		void RayCast(const Maths::Ray& ray, float maxDistance, TFunc func) const;
+	private:
+		struct Node {
+			Maths::AABB AABB;
+			union {
+				int32_t Parent = NullNode;
+				int32_t Next; //free list
+			};
+			int32_t Child1 = NullNode;
+			int32_t Child2 = NullNode;
+			int32_t Height = -1; //leaf = 0, free node = -1
+			uint32_t UserData = 0;
+
+			inline bool IsLeaf() const { return Child1 == NullNode; }
+		};
+
+		enum class FrustumTest : uint8_t {
+			Outside,
+			Intersecting,
+			Inside
+		};
+
+		int32_t AllocateNode();
+		void FreeNode(int32_t nodeID);
+
+		void InsertLeaf(int32_t leaf);
+		void RemoveLeaf(int32_t leaf);
+		int32_t Balance(int32_t nodeID);
+
+		static FrustumTest TestFrustum(const Maths::Frustum& frustum, const Maths::AABB& aabb);
+		template <typename TFunc>
+		bool ReportSubtree(int32_t nodeID, TFunc& func) const;
+
+		std::vector<Node> m_Nodes;
+		int32_t m_Root = NullNode;
+		int32_t m_FreeList = NullNode;
+		uint32_t m_ProxyCount = 0;
+
+		//absolute (in world units), the fat AABBs are enlarged by this on every side
+		static inline constexpr const float s_AABBMargin = 0.1f;
+	};
+
+	template <typename TFunc>
+	void DynamicAABBTree::QueryOverlap(const Maths::AABB& aabb, TFunc func) const {
+		if (m_Root == NullNode)
+			return;
+
+		std::vector<int32_t> stack;
+		stack.reserve(64);
+		stack.push_back(m_Root);
+
+		while (!stack.empty()) {
+			const int32_t nodeID = stack.back();
+			stack.pop_back();
+
+			const Node& node = m_Nodes[nodeID];
+			if (!node.AABB.Overlaps(aabb))
+				continue;
+
+			if (node.IsLeaf()) {
+				if (!func(node.UserData))
+					return;
+				continue;
+			}
+			stack.push_back(node.Child1);
+			stack.push_back(node.Child2);
+		}
+	}
+
+	template <typename TFunc>
+	void DynamicAABBTree::QueryFrustum(const Maths::Frustum& frustum, TFunc func) const {
+		if (m_Root == NullNode)
+			return;
+
+		std::vector<int32_t> stack;
+		stack.reserve(64);
+		stack.push_back(m_Root);
+
+		while (!stack.empty()) {
+			const int32_t nodeID = stack.back();
+			stack.pop_back();
+
+			const Node& node = m_Nodes[nodeID];
+			const FrustumTest result = TestFrustum(frustum, node.AABB);
+			if (result == FrustumTest::Outside)
+				continue;
+
+			//the whole subtree is visible, no need to test the children
+			if (result == FrustumTest::Inside || node.IsLeaf()) {
+				if (!ReportSubtree(nodeID, func))
+					return;
+				continue;
+			}
+			stack.push_back(node.Child1);
+			stack.push_back(node.Child2);
+		}
+	}
+
+	template <typename TFunc>
+	void DynamicAABBTree::RayCast(const Maths::Ray& ray, float maxDistance, TFunc func) const {
+		if (m_Root == NullNode)
+			return;
+
+		std::vector<int32_t> stack;
+		stack.reserve(64);
+		stack.push_back(m_Root);
+
+		while (!stack.empty()) {
+			const int32_t nodeID = stack.back();
+			stack.pop_back();
+
+			const Node& node = m_Nodes[nodeID];
+			float distance = 0.0f;
+			if (!Maths::RayAABBIntersection(ray, node.AABB, maxDistance, distance))
+				continue;
+
+			if (node.IsLeaf()) {
+				const float newMaxDistance = func(node.UserData, distance);
+				if (newMaxDistance < 0.0f)
+					return;
+				maxDistance = glm::min(maxDistance, newMaxDistance);
+				continue;
+			}
+			stack.push_back(node.Child1);
+			stack.push_back(node.Child2);
+		}
+	}
+
+	template <typename TFunc>
+	bool DynamicAABBTree::ReportSubtree(int32_t nodeID, TFunc& func) const {
+		const Node& node = m_Nodes[nodeID];
+		if (node.IsLeaf())
+			return func(node.UserData);
+		return ReportSubtree(node.Child1, func) && ReportSubtree(node.Child2, func);
+	}
+}
@@ -47,6 +47,13 @@ namespace Lucy {
 			LUCY_ASSERT(IsValid());
 			return m_Scene->m_Registry.get<TComponent>(m_Entity);
 		}
+
+		//changes the component in place and lets the scene know (e.g. the bounds of a moved mesh are updated with the next Scene::Update)
+		template <typename TComponent, typename ... TFuncs>
+		inline TComponent& PatchComponent(TFuncs&& ... funcs) {
+			LUCY_ASSERT(IsValid());
+			return m_Scene->m_Registry.patch<TComponent>(m_Entity, std::forward<TFuncs>(funcs)...);
+		}
 	private:
 		entt::entity m_Entity = (entt::entity) std::numeric_limits<uint32_t>::max();
 		Scene* m_Scene = nullptr;
@@ -6,6 +6,17 @@
 #include "Events/EventHandler.h"
 
 namespace Lucy {
+
+	Scene::Scene() {
+		m_BoundsObserver.connect(m_Registry, entt::collector
+			.group<MeshComponent, TransformComponent>()
+			.update<MeshComponent>().where<TransformComponent>()
+			.update<TransformComponent>().where<MeshComponent>());
+	}
+
+	Scene::~Scene() {
+		m_BoundsObserver.disconnect();
+	}
 	
 	Entity Scene::CreateMesh(std::string& path) {
 		Entity e = CreateEntity();
@@ -32,6 +43,8 @@ namespace Lucy {
 
 	void Scene::RemoveEntity(Entity& e) {
 		//TODO: free all resources depending on the entity
+		if (BoundsComponent* boundsComponent = m_Registry.try_get<BoundsComponent>(e.m_Entity); boundsComponent && boundsComponent->m_ProxyID != DynamicAABBTree::NullNode)
+			m_BVH.DestroyProxy(boundsComponent->m_ProxyID);
 		m_Registry.destroy(e.m_Entity);
 	}
 
@@ -55,6 +68,125 @@ namespace Lucy {
 	void Scene::Update() {
 		LUCY_PROFILE_NEW_EVENT("Scene::Update");
 		m_Camera.Update();
+		UpdateBounds();
+	}
+
+	void Scene::UpdateBounds() {
+		LUCY_PROFILE_NEW_EVENT("Scene::UpdateBounds");
+
+		//the components are changed through Entity::PatchComponent, the other entities haven't moved
+		for (const entt::entity entity : m_BoundsObserver) {
+			auto [meshComponent, transformComponent] = m_Registry.get<MeshComponent, TransformComponent>(entity);
+			BoundsComponent& boundsComponent = m_Registry.get_or_emplace<BoundsComponent>(entity);
+
+			const Maths::AABB meshBounds = meshComponent.IsValid() ? meshComponent.GetMesh()->GetBoundingBox() : Maths::AABB();
+			if (!boundsComponent.Update(meshBounds, transformComponent.GetMatrix()))
+				continue;
+
+			int32_t& proxyID = boundsComponent.m_ProxyID;
+			if (!boundsComponent.IsValid()) {
+				if (proxyID != DynamicAABBTree::NullNode)
+					m_BVH.DestroyProxy(proxyID);
+				proxyID = DynamicAABBTree::NullNode;
+				continue;
+			}
+
+			if (proxyID == DynamicAABBTree::NullNode)
+				proxyID = m_BVH.CreateProxy(boundsComponent.GetAABB(), entt::to_integral(entity));
+			else
+				m_BVH.MoveProxy(proxyID, boundsComponent.GetAABB());
+		}
+		m_BoundsObserver.clear();
+	}
+
+	void Scene::QueryFrustum(const Maths::Frustum& frustum, std::vector<Entity>& outEntities) {
+		outEntities.clear();
+		m_BVH.QueryFrustum(frustum, [&](uint32_t userData) {
+			outEntities.emplace_back(this, (entt::entity)userData);
+			return true;
+		});
+	}
+
+	void Scene::QueryOverlap(const Maths::AABB& aabb, std::vector<Entity>& outEntities) {
+		outEntities.clear();
+		m_BVH.QueryOverlap(aabb, [&](uint32_t userData) {
+			outEntities.emplace_back(this, (entt::entity)userData);
+			return true;
+		});
+	}
+
+	void Scene::RayCast(const Maths::Ray& ray, float maxDistance, std::vector<Entity>& outEntities) {
+		std::vector<std::pair<float, uint32_t>> hits;
+		m_BVH.RayCast(ray, maxDistance, [&](uint32_t userData, float distance) {
+			hits.emplace_back(distance, userData);
+			return maxDistance;
+		});
+		std::sort(hits.begin(), hits.end());
+
+		outEntities.clear();
+		for (const auto& [distance, userData] : hits)
+			outEntities.emplace_back(this, (entt::entity)userData);
+	}
+
+	Entity Scene::PickEntity(const Maths::Ray& ray, float maxDistance) {
+		LUCY_PROFILE_NEW_EVENT("Scene::PickEntity");
+
+		uint32_t pickedUserData = 0;
+		float distance = 0.0f;
+		const bool isHit = PickMesh(m_BVH, ray, maxDistance, [&](uint32_t userData, glm::mat4& outMeshTransform) -> const std::vector<Submesh>* {
+			const entt::entity entity = (entt::entity)userData;
+			MeshComponent* meshComponent = m_Registry.try_get<MeshComponent>(entity);
+			if (!meshComponent || !meshComponent->IsValid())
+				return nullptr;
+
+			outMeshTransform = m_Registry.get<TransformComponent>(entity).GetMatrix();
+			return &meshComponent->GetMesh()->GetSubmeshes();
+		}, pickedUserData, distance);
+
+		return isHit ? Entity{ this, (entt::entity)pickedUserData } : Entity{};
+	}
+
+	bool Scene::PickMesh(const DynamicAABBTree& bvh, const Maths::Ray& ray, float maxDistance, const PickMeshFunc& getMesh, uint32_t& outUserData, float& outDistance) {
+		bool isHit = false;
+		float closestDistance = maxDistance;
+
+		//the BVH only returns candidates, the triangles decide. every hit clips the ray for the remaining candidates
+		bvh.RayCast(ray, maxDistance, [&](uint32_t userData, float distance) {
+			glm::mat4 meshTransform;
+			const std::vector<Submesh>* submeshes = getMesh(userData, meshTransform);
+			if (!submeshes)
+				return closestDistance;
+
+			for (const Submesh& submesh : *submeshes) {
+				const glm::mat4 modelMatrix = meshTransform * submesh.Transform;
+				const glm::mat4 inverseModelMatrix = glm::inverse(modelMatrix);
+
+				//the direction is not normalized, so that t is the same in both spaces
+				const Maths::Ray localRay{ glm::vec3(inverseModelMatrix * glm::vec4(ray.Origin, 1.0f)), glm::vec3(inverseModelMatrix * glm::vec4(ray.Dir, 0.0f)) };
+
+				const std::vector<glm::vec3>& vertices = submesh.Vertices;
+				const std::vector<uint32_t>& faces = submesh.Faces;
+				for (size_t i = 0; i + 2 < faces.size(); i += 3) {
+					const glm::vec3& v0 = vertices[faces[i]];
+					const glm::vec3& v1 = vertices[faces[i + 1]];
+					const glm::vec3& v2 = vertices[faces[i + 2]];
+
+					float t = 0.0f, u = 0.0f, v = 0.0f;
+					if (!Maths::RayTriangleIntersection(localRay, v0, v1, v2, t, u, v) && !Maths::RayTriangleIntersection(localRay, v0, v2, v1, t, u, v))
+						continue;
+					if (t < 0.0f || t >= closestDistance)
+						continue;
+
+					closestDistance = t;
+					outUserData = userData;
+					isHit = true;
+				}
+			}
+			return closestDistance;
+		});
+
+		outDistance = closestDistance;
+		return isHit;
 	}
 
 	void Scene::UpdateCamera(int32_t viewportWidth, int32_t viewportHeight) {
@@ -80,5 +212,7 @@ namespace Lucy {
 		ViewForEach<HDRCubemapComponent>([&](HDRCubemapComponent& cubemapComponent) {
 			cubemapComponent.Destroy();
 		});
+
+		m_BVH.Clear();
 	}
 }
\ No newline at end of file
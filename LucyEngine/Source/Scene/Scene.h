@@ -2,12 +2,15 @@
 
 #include "entt/entt.hpp"
 #include "Camera.h"
+#include "DynamicAABBTree.h"
 
 #include <ranges>
 
 namespace Lucy {
 
 	class Entity;
+	struct Event;
+	struct Submesh;
 
 	template <typename TComponent>
 	concept IsComponent = requires(TComponent&& component) {
@@ -16,8 +19,8 @@ namespace Lucy {
 
 	class Scene final {
 	public:
-		Scene() = default;
-		~Scene() = default;
+		Scene();
+		~Scene();
 
 		Entity CreateMesh(std::string& path);
 		Entity CreateMesh();
@@ -26,6 +29,20 @@ namespace Lucy {
 		Entity GetEntityByMeshID(const glm::vec3& meshID);
 
 		inline EditorCamera& GetEditorCamera() { return m_Camera; }
+		//world space bounds of every mesh entity, the user data is the entity
+		inline const DynamicAABBTree& GetBVH() const { return m_BVH; }
+
+		void QueryFrustum(const Maths::Frustum& frustum, std::vector<Entity>& outEntities);
+		void QueryOverlap(const Maths::AABB& aabb, std::vector<Entity>& outEntities);
+		//entities whose bounds are hit by the ray, sorted by distance
+		void RayCast(const Maths::Ray& ray, float maxDistance, std::vector<Entity>& outEntities);
+		//the closest mesh entity, whose triangles are hit by the ray (both sides). invalid entity, if nothing is hit
+		Entity PickEntity(const Maths::Ray& ray, float maxDistance = FLT_MAX);
+
+		//returns the submeshes (and the transform) of a mesh in the BVH by its user data, nullptr if it can't be picked
+		using PickMeshFunc = std::function<const std::vector<Submesh>*(uint32_t userData, glm::mat4& outMeshTransform)>;
+		//the closest mesh in the BVH, whose triangles are hit by the ray (both sides). false, if nothing is hit
+		static bool PickMesh(const DynamicAABBTree& bvh, const Maths::Ray& ray, float maxDistance, const PickMeshFunc& getMesh, uint32_t& outUserData, float& outDistance);
 
 		void OnEvent(Event& e);
 		void Update();
@@ -68,9 +85,13 @@ namespace Lucy {
 		}
 	private:
 		void UpdateCamera(int32_t viewportWidth, int32_t viewportHeight);
+		void UpdateBounds();
 
 		entt::registry m_Registry;
 		EditorCamera m_Camera { 0.25f, 250.0f, 90.0f };
+		DynamicAABBTree m_BVH;
+		//the mesh entities, that have been created or whose mesh or transform has been replaced or patched since the last bounds update
+		entt::observer m_BoundsObserver;
 
 		friend class Entity;
 	};
@@ -35,9 +35,8 @@ namespace Lucy {
 				}
 			};
 
+			[[maybe_unused]] std::thread& thread = m_WorkerPool.emplace_back(WorkerThreadFunc);
 #ifdef LUCY_WINDOWS
-			std::thread& thread = m_WorkerPool.emplace_back(WorkerThreadFunc);
-
 			HANDLE handle = thread.native_handle();
 			uint32_t affinity = m_CreateInfo.AllAffinity;
 
@@ -65,7 +64,9 @@ namespace Lucy {
 		task.IsBatch = false;
 		task.Func = std::move(taskFunc);
 
-		return ScheduleInternal(task, priority, launch != Async);
+		TaskId taskId = ScheduleInternal(task, priority, launch != Async);
+		s_WorkerSleepCondition.notify_one();
+		return taskId;
 	}
 
 	std::vector<TaskId> TaskScheduler::ScheduleBatch(Launch launch, TaskPriority priority, TaskBatchFunc&& taskBatchFunc, size_t taskCount, size_t batchSize) {
@@ -117,6 +118,8 @@ namespace Lucy {
 		while (m_CurrentTaskCounter.load(std::memory_order_relaxed) != 0) {
 			/* Wait for all the tasks to finish */
 			s_WorkerSleepCondition.notify_all();
+			//the waiting thread would otherwise take the core from a worker, if there are more threads than cores
+			std::this_thread::yield();
 		}
 	}
 
@@ -125,6 +128,8 @@ namespace Lucy {
 		while (m_CurrentTaskCounter.load(std::memory_order_relaxed) > taskId) {
 			/* Wait for the task to finish */
 			s_WorkerSleepCondition.notify_all();
+			//the waiting thread would otherwise take the core from a worker, if there are more threads than cores
+			std::this_thread::yield();
 		}
 	}
 
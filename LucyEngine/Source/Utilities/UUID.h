@@ -1,5 +1,8 @@
 #pragma once
 
+#include <bit>
+#include <mutex>
+
 namespace Lucy {
 
 	static constexpr inline const char* DefaultUUID = "00000000-0000-0000-0000-000000000000";
@@ -22,9 +25,16 @@ namespace Lucy {
 	template <typename T>
 	inline static constexpr const T InvalidID = T(~0);
 
+	/*
+	* Hands out the lowest free id, ids are reused once they have been returned.
+	* The used ids are stored as a bitset, a free id is found with a single find-first-zero over the first word, that is not full.
+	* Thread safe, every call locks the provider. A lock free version would still need a lock to grow the words, and the lowest free id
+	* could not be kept, while the hint and the words are updated by separate atomics. The ids are requested once per created material,
+	* a request or return costs a few dozen nanoseconds including the lock (see IDProviderBenchmark).
+	*/
 	template <typename TID = LucyID>
 	class IDProvider final {
-		static inline constexpr const size_t s_PoolResizeStep = 100;
+		static_assert(std::is_integral_v<TID>, "IDProvider only supports integral ids!");
 	public:
 		IDProvider() = default;
 		~IDProvider() = default;
@@ -33,51 +43,64 @@ namespace Lucy {
 		void ReturnID(TID id);
 		TID Renew(TID oldId);
 	private:
-		void IncreasePool(size_t step);
+		TID RequestIDUnlocked();
+		void ReturnIDUnlocked(TID id);
+
+		static inline constexpr const size_t s_BitsPerWord = 64;
 
-		std::vector<TID> s_IDCount;
+		std::vector<uint64_t> m_UsedIDs; //a set bit is an id in use
+		size_t m_FirstNonFullWord = 0; //every word before this one is full
+		std::mutex m_Mutex;
 	};
 
 	template<typename TID>
 	TID IDProvider<TID>::RequestID() {
-		//basically, init
-		if (s_IDCount.empty())
-			IncreasePool(s_PoolResizeStep);
-
-		const auto& result = std::find(s_IDCount.begin(), s_IDCount.end(), 0);
-
-		if (result == s_IDCount.end()) {
-			IncreasePool(s_PoolResizeStep);
-			return RequestID();
-		}
-
-		ptrdiff_t index = std::distance(s_IDCount.begin(), result);
-		s_IDCount[index] = index + 1;
-
-		return index;
+		std::scoped_lock lock(m_Mutex);
+		return RequestIDUnlocked();
 	}
 
 	template<typename TID>
 	void IDProvider<TID>::ReturnID(TID id) {
-		const auto& result = std::find(s_IDCount.begin(), s_IDCount.end(), id);
-
-		if (result != s_IDCount.end()) {
-			s_IDCount.erase(result);
-			return;
-		}
-
-		LUCY_ASSERT(false, "IDProvider: {0} does not exist!", id);
+		std::scoped_lock lock(m_Mutex);
+		ReturnIDUnlocked(id);
 	}
 
 	template<typename TID>
 	TID IDProvider<TID>::Renew(TID oldId) {
-		ReturnID(oldId);
-		return RequestID();
+		std::scoped_lock lock(m_Mutex);
+		ReturnIDUnlocked(oldId);
+		return RequestIDUnlocked();
 	}
 
 	template<typename TID>
-	void IDProvider<TID>::IncreasePool(size_t step) {
-		s_IDCount.resize(s_IDCount.size() + step);
+	TID IDProvider<TID>::RequestIDUnlocked() {
+		while (m_FirstNonFullWord < m_UsedIDs.size() && m_UsedIDs[m_FirstNonFullWord] == ~0ull)
+			m_FirstNonFullWord++;
+
+		if (m_FirstNonFullWord == m_UsedIDs.size())
+			m_UsedIDs.push_back(0);
+
+		uint64_t& word = m_UsedIDs[m_FirstNonFullWord];
+		const int bit = std::countr_one(word); //the lowest free id of the word
+		word |= 1ull << bit;
+
+		const size_t id = m_FirstNonFullWord * s_BitsPerWord + bit;
+		LUCY_ASSERT(id < (size_t)InvalidID<TID>, "IDProvider: the ids are exhausted!");
+		return (TID)id;
+	}
+
+	template<typename TID>
+	void IDProvider<TID>::ReturnIDUnlocked(TID id) {
+		const size_t wordIndex = (size_t)id / s_BitsPerWord;
+		const uint64_t mask = 1ull << ((size_t)id % s_BitsPerWord);
+
+		if (wordIndex >= m_UsedIDs.size() || !(m_UsedIDs[wordIndex] & mask)) {
+			LUCY_ASSERT(false, "IDProvider: {0} does not exist!", id);
+			return;
+		}
+
+		m_UsedIDs[wordIndex] &= ~mask;
+		m_FirstNonFullWord = std::min(m_FirstNonFullWord, wordIndex);
 	}
 }
 
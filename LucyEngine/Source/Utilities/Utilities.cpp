@@ -7,6 +7,8 @@
 
 #include "../ImGui/imgui.h"
 
+#include "glm/gtc/matrix_access.hpp"
+
 namespace Utils {
 
 	std::vector<std::string> Split(const std::string& s, const std::string& delimiter) {
@@ -153,6 +155,90 @@ namespace Maths {
 		return finalOrientation * baseDirection;
 	}
 
+	//Gribb/Hartmann: https://www.gamedevs.org/uploads/fast-extraction-viewing-frustum-planes-from-world-view-projection-matrix.pdf
+	Frustum ExtractFrustum(const glm::mat4& viewProjection) {
+		const glm::vec4 row0 = glm::row(viewProjection, 0);
+		const glm::vec4 row1 = glm::row(viewProjection, 1);
+		const glm::vec4 row2 = glm::row(viewProjection, 2);
+		const glm::vec4 row3 = glm::row(viewProjection, 3);
+
+		Frustum frustum;
+		frustum.Planes[0] = row3 + row0; //left
+		frustum.Planes[1] = row3 - row0; //right
+		frustum.Planes[2] = row3 + row1; //bottom
+		frustum.Planes[3] = row3 - row1; //top
+		frustum.Planes[Frustum::NearPlaneIndex] = row2; //near (depth range [0, 1])
+		frustum.Planes[5] = row3 - row2; //far
+
+		for (glm::vec4& plane : frustum.Planes)
+			plane /= glm::length(glm::vec3(plane));
+		return frustum;
+	}
+
+	Frustum ExtractShadowCasterFrustum(const glm::mat4& viewProjection) {
+		Frustum frustum = ExtractFrustum(viewProjection);
+		//a plane that every point is in front of
+		frustum.Planes[Frustum::NearPlaneIndex] = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+		return frustum;
+	}
+
+	bool SphereInFrustum(const Frustum& frustum, const glm::vec3& center, float radius) {
+		for (const glm::vec4& plane : frustum.Planes) {
+			if (glm::dot(glm::vec3(plane), center) + plane.w < -radius)
+				return false;
+		}
+		return true;
+	}
+
+	bool AABBInFrustum(const Frustum& frustum, const AABB& aabb) {
+		for (const glm::vec4& plane : frustum.Planes) {
+			//the corner that is the furthest along the plane normal
+			const glm::vec3 positive = glm::vec3(plane.x >= 0.0f ? aabb.Max.x : aabb.Min.x,
+												 plane.y >= 0.0f ? aabb.Max.y : aabb.Min.y,
+												 plane.z >= 0.0f ? aabb.Max.z : aabb.Min.z);
+			if (glm::dot(glm::vec3(plane), positive) + plane.w < 0.0f)
+				return false;
+		}
+		return true;
+	}
+
+	AABB TransformAABB(const AABB& aabb, const glm::mat4& transform) {
+		const glm::vec3 center = glm::vec3(transform * glm::vec4(aabb.GetCenter(), 1.0f));
+		const glm::vec3 extents = aabb.GetExtents();
+
+		const glm::mat3 absolute = glm::mat3(glm::abs(glm::vec3(transform[0])), glm::abs(glm::vec3(transform[1])), glm::abs(glm::vec3(transform[2])));
+		const glm::vec3 transformedExtents = absolute * extents;
+
+		return AABB{ center - transformedExtents, center + transformedExtents };
+	}
+
+	bool RayAABBIntersection(const Ray& r, const AABB& aabb, float maxDistance, float& distance) {
+		//divisions by zero result in +-inf, which the slab test handles correctly
+		const glm::vec3 inverseDir = 1.0f / r.Dir;
+		const glm::vec3 t0 = (aabb.Min - r.Origin) * inverseDir;
+		const glm::vec3 t1 = (aabb.Max - r.Origin) * inverseDir;
+
+		const glm::vec3 tNear = glm::min(t0, t1);
+		const glm::vec3 tFar = glm::max(t0, t1);
+
+		const float entry = glm::max(glm::max(tNear.x, tNear.y), glm::max(tNear.z, 0.0f));
+		const float exit = glm::min(glm::min(tFar.x, tFar.y), glm::min(tFar.z, maxDistance));
+		if (entry > exit)
+			return false;
+
+		distance = entry;
+		return true;
+	}
+
+	Ray NDCToRay(const glm::vec2& ndc, const glm::mat4& viewProjection) {
+		const glm::mat4 inverseViewProjection = glm::inverse(viewProjection);
+		const glm::vec4 nearPoint = inverseViewProjection * glm::vec4(ndc, 0.0f, 1.0f);
+		const glm::vec4 farPoint = inverseViewProjection * glm::vec4(ndc, 1.0f, 1.0f);
+
+		const glm::vec3 origin = glm::vec3(nearPoint) / nearPoint.w;
+		return Ray{ origin, glm::normalize(glm::vec3(farPoint) / farPoint.w - origin) };
+	}
+
 	//From: https://www.scratchapixel.com/lessons/3d-basic-rendering/ray-tracing-rendering-a-triangle/moller-trumbore-ray-triangle-intersection
 	bool RayTriangleIntersection(const Ray& r, const glm::vec3& v0, const glm::vec3& v1, const glm::vec3& v2, float& t, float& u, float& v) {
 		glm::vec3 v0v1 = v1 - v0;
@@ -25,6 +25,22 @@ namespace Utils {
 		return CombineDataToSingleBuffer(lines, lines.begin(), lines.end());
 	}
 
+	//mixes the hash of value into hash (boost::hash_combine)
+	template <typename T>
+	inline void HashCombine(size_t& hash, const T& value) {
+		hash ^= std::hash<T>{}(value) + 0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2);
+	}
+
+	//64 bit FNV-1a, unlike std::hash the same for every run, compiler and platform (for keys that end up in files)
+	inline uint64_t HashBytes(const void* data, size_t size, uint64_t hash = 0xcbf29ce484222325ull) {
+		const uint8_t* bytes = (const uint8_t*)data;
+		for (size_t i = 0; i < size; i++) {
+			hash ^= bytes[i];
+			hash *= 0x100000001b3ull;
+		}
+		return hash;
+	}
+
 	Attribute ReadAttributeFromIni(const char* windowName, const char* attributeName);
 
 	struct DialogFilter {
@@ -57,6 +73,64 @@ namespace Maths {
 		glm::vec3 Dir;
 	};
 
+	//planes are stored as (normal, distance) and point inwards: left, right, bottom, top, near, far
+	struct Frustum {
+		static constexpr const uint32_t PlaneCount = 6;
+		static constexpr const uint32_t NearPlaneIndex = 4;
+		glm::vec4 Planes[PlaneCount];
+	};
+
+	struct AABB {
+		glm::vec3 Min = glm::vec3(FLT_MAX);
+		glm::vec3 Max = glm::vec3(-FLT_MAX);
+
+		inline bool IsValid() const { return Min.x <= Max.x && Min.y <= Max.y && Min.z <= Max.z; }
+		inline glm::vec3 GetCenter() const { return (Min + Max) * 0.5f; }
+		inline glm::vec3 GetExtents() const { return (Max - Min) * 0.5f; }
+
+		inline void Expand(const glm::vec3& point) {
+			Min = glm::min(Min, point);
+			Max = glm::max(Max, point);
+		}
+
+		inline void Expand(const AABB& other) {
+			Min = glm::min(Min, other.Min);
+			Max = glm::max(Max, other.Max);
+		}
+
+		inline float GetSurfaceArea() const {
+			const glm::vec3 size = Max - Min;
+			return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+		}
+
+		inline bool Contains(const AABB& other) const {
+			return glm::all(glm::lessThanEqual(Min, other.Min)) && glm::all(glm::greaterThanEqual(Max, other.Max));
+		}
+
+		inline bool Overlaps(const AABB& other) const {
+			return glm::all(glm::lessThanEqual(Min, other.Max)) && glm::all(glm::greaterThanEqual(Max, other.Min));
+		}
+
+		static inline AABB Union(const AABB& a, const AABB& b) {
+			return AABB{ glm::min(a.Min, b.Min), glm::max(a.Max, b.Max) };
+		}
+	};
+
+	//expects a projection with a depth range of [0, 1] (GLM_FORCE_DEPTH_ZERO_TO_ONE)
+	Frustum ExtractFrustum(const glm::mat4& viewProjection);
+	//without the near plane, casters in front of it still cast shadows with depth clamping (pancaking), so they must not be culled by it
+	Frustum ExtractShadowCasterFrustum(const glm::mat4& viewProjection);
+	bool SphereInFrustum(const Frustum& frustum, const glm::vec3& center, float radius);
+	//conservative, boxes that intersect the planes outside of the frustum (near the corners) are not culled
+	bool AABBInFrustum(const Frustum& frustum, const AABB& aabb);
+
+	//the AABB of the transformed box (Arvo)
+	AABB TransformAABB(const AABB& aabb, const glm::mat4& transform);
+	//slab test, distance is the entry distance along the ray (0, if the origin is inside of the box)
+	bool RayAABBIntersection(const Ray& r, const AABB& aabb, float maxDistance, float& distance);
+	//world space ray through a point in normalized device coordinates, from the near to the far plane (depth range [0, 1])
+	Ray NDCToRay(const glm::vec2& ndc, const glm::mat4& viewProjection);
+
 	glm::vec3 EulerDegreesToLightDirection(const glm::vec3& eulerDegrees);
 
 	bool RayTriangleIntersection(const Ray& r, const glm::vec3& v0, const glm::vec3& v1, const glm::vec3& v2, float& t, float& u, float& v);
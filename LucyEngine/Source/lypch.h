@@ -17,6 +17,7 @@
 #include <memory>
 #include <utility>
 #include <algorithm>
+#include <numeric>
 #include <functional>
 #include <set>
 #include <ranges>
@@ -30,6 +31,7 @@
 #include <filesystem>
 #include <fstream>
 #include <any>
+#include <optional>
 
 #include "Core/Base.h"
 
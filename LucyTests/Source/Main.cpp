@@ -0,0 +1,25 @@
+#include "lypch.h"
+#include "Test.h"
+
+//runs every registered test and returns the number of failed tests, so that a build script can check the exit code
+int main(int argc, char** argv) {
+	Lucy::Logger::Init();
+
+	const auto& testCases = Lucy::Tests::GetTestCases();
+
+	uint32_t failedTests = 0;
+	for (const Lucy::Tests::TestCase& testCase : testCases) {
+		Lucy::Tests::s_FailedChecks = 0;
+		testCase.Func();
+
+		if (Lucy::Tests::s_FailedChecks == 0) {
+			LUCY_INFO("[PASSED] {0}", testCase.Name);
+			continue;
+		}
+		LUCY_CRITICAL("[FAILED] {0} ({1} checks)", testCase.Name, Lucy::Tests::s_FailedChecks);
+		failedTests++;
+	}
+
+	LUCY_INFO("{0} of {1} tests passed", testCases.size() - failedTests, testCases.size());
+	return (int)failedTests;
+}
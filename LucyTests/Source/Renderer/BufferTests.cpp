@@ -0,0 +1,153 @@
+#include "lypch.h"
+#include "Test.h"
+
+#include <random>
+
+#include "Renderer/Memory/Buffer/Buffer.h"
+
+namespace Lucy::Tests {
+
+	//uploads like VulkanUniformBuffer::RTLoadToDevice, into a CPU copy per frame in flight
+	class TestUploadBuffer : public ByteBuffer {
+	public:
+		TestUploadBuffer(uint32_t framesInFlight)
+			: m_DeviceBuffers(framesInFlight) {
+		}
+
+		//returns the uploaded bytes
+		size_t Upload(uint32_t frameIndex) {
+			for (const BufferRange& range : ConsumeDirtyRanges()) {
+				for (DeviceBuffer& buffer : m_DeviceBuffers)
+					AddBufferRange(buffer.DirtyRanges, range.Begin, range.End);
+			}
+
+			DeviceBuffer& buffer = m_DeviceBuffers[frameIndex];
+			if (buffer.Data.size() < m_Data.size())
+				buffer.Data.resize(m_Data.size());
+
+			size_t uploadedBytes = 0;
+			for (const BufferRange& range : buffer.DirtyRanges) {
+				if (range.Begin >= m_Data.size())
+					break;
+				const size_t end = glm::min(range.End, m_Data.size());
+				std::copy(m_Data.begin() + range.Begin, m_Data.begin() + end, buffer.Data.begin() + range.Begin);
+				uploadedBytes += end - range.Begin;
+			}
+			buffer.DirtyRanges.clear();
+			return uploadedBytes;
+		}
+
+		bool IsUploaded(uint32_t frameIndex) const {
+			const std::vector<uint8_t>& deviceData = m_DeviceBuffers[frameIndex].Data;
+			return deviceData.size() >= m_Data.size() && std::equal(m_Data.begin(), m_Data.end(), deviceData.begin());
+		}
+
+		std::vector<BufferRange> GetDirtyRanges() { return ConsumeDirtyRanges(); }
+	private:
+		struct DeviceBuffer {
+			std::vector<uint8_t> Data;
+			std::vector<BufferRange> DirtyRanges = { BufferRange{ 0, SIZE_MAX } }; //a new buffer is entirely dirty
+		};
+		std::vector<DeviceBuffer> m_DeviceBuffers;
+	};
+
+	LUCY_TEST(BufferMarksEveryWriteDirty) {
+		TestUploadBuffer buffer(1);
+		buffer.Append(std::vector<uint8_t>(16, 1));
+		LUCY_CHECK((buffer.GetDirtyRanges() == std::vector<BufferRange>{ { 0, 16 } }));
+
+		ByteBuffer other;
+		other.Append(std::vector<uint8_t>(8, 2));
+		buffer.Append(other);
+		uint8_t data[4] = { 3, 3, 3, 3 };
+		buffer.SetData(32, data, 4);
+		LUCY_CHECK((buffer.GetDirtyRanges() == std::vector<BufferRange>{ { 16, 36 } }));
+
+		buffer.Clear();
+		LUCY_CHECK(buffer.GetDirtyRanges().empty());
+		buffer.SetData(data, 4);
+		LUCY_CHECK((buffer.GetDirtyRanges() == std::vector<BufferRange>{ { 0, 4 } }));
+	}
+
+	LUCY_TEST(BufferRewriteOnlyMarksTheChangedBytes) {
+		TestUploadBuffer buffer(1);
+		std::vector<uint8_t> content(64, 0);
+		buffer.SetData(content.data(), content.size());
+		buffer.Upload(0);
+
+		//the same content again
+		buffer.BeginRewrite();
+		buffer.SetData(content.data(), content.size());
+		LUCY_CHECK(buffer.GetDirtyRanges().empty());
+
+		//the unchanged bytes at both ends are left out
+		buffer.BeginRewrite();
+		content[10] = 1;
+		content[20] = 1;
+		buffer.SetData(content.data(), content.size());
+		LUCY_CHECK((buffer.GetDirtyRanges() == std::vector<BufferRange>{ { 10, 21 } }));
+		buffer.Upload(0);
+
+		//appended after the old content
+		buffer.BeginRewrite();
+		buffer.SetData(content.data(), content.size());
+		buffer.Append(std::vector<uint8_t>(8, 0));
+		LUCY_CHECK((buffer.GetDirtyRanges() == std::vector<BufferRange>{ { 64, 72 } }));
+	}
+
+	//a camera and a light that change every few frames in a uniform buffer, and per draw data with a single moving object in a storage buffer,
+	//rewritten every frame like the render passes do. Compares the uploaded bytes of a cleared buffer with a rewritten one
+	LUCY_TEST(BufferRewriteUploadedBytes) {
+		static constexpr uint32_t framesInFlight = 2;
+		static constexpr uint32_t frameCount = 600;
+		static constexpr size_t drawCount = 4096;
+
+		struct DrawData {
+			glm::mat4 Transform;
+			uint32_t MaterialID;
+			uint32_t Padding[3];
+		};
+
+		size_t uploadedBytes[2] = {};
+		for (bool rewrite : { false, true }) {
+			TestUploadBuffer uniformBuffer(framesInFlight);
+			TestUploadBuffer storageBuffer(framesInFlight);
+
+			std::mt19937 random(42);
+			std::vector<DrawData> drawData(drawCount);
+			for (uint32_t i = 0; i < drawCount; i++)
+				drawData[i] = DrawData{ glm::translate(glm::mat4(1.0f), glm::vec3((float)i, 0.0f, 0.0f)), i % 16 };
+			glm::mat4 viewProjection(1.0f);
+			glm::vec4 lightDirection(0.0f, -1.0f, 0.0f, 0.0f);
+
+			for (uint32_t frame = 0; frame < frameCount; frame++) {
+				if (frame % 4 == 0)
+					viewProjection = glm::rotate(viewProjection, 0.01f, glm::vec3(0.0f, 1.0f, 0.0f));
+				if (frame % 60 == 0)
+					lightDirection.x += 0.1f;
+				drawData[random() % drawCount].Transform[3].y += 1.0f;
+
+				uniformBuffer.SetData((uint8_t*)&viewProjection, sizeof(viewProjection));
+				uniformBuffer.Append((uint8_t*)&lightDirection, sizeof(lightDirection));
+				storageBuffer.SetData((uint8_t*)drawData.data(), drawData.size() * sizeof(DrawData));
+
+				const uint32_t frameIndex = frame % framesInFlight;
+				uploadedBytes[rewrite] += uniformBuffer.Upload(frameIndex) + storageBuffer.Upload(frameIndex);
+				LUCY_CHECK(uniformBuffer.IsUploaded(frameIndex));
+				LUCY_CHECK(storageBuffer.IsUploaded(frameIndex));
+
+				if (rewrite) {
+					uniformBuffer.BeginRewrite();
+					storageBuffer.BeginRewrite();
+				} else {
+					uniformBuffer.Clear();
+					storageBuffer.Clear();
+				}
+			}
+		}
+
+		LUCY_INFO("Uploaded bytes in {0} frames: {1} cleared, {2} rewritten", frameCount, uploadedBytes[0], uploadedBytes[1]);
+		LUCY_CHECK(uploadedBytes[0] == frameCount * (sizeof(glm::mat4) + sizeof(glm::vec4) + drawCount * sizeof(DrawData)));
+		LUCY_CHECK(uploadedBytes[1] * 100 < uploadedBytes[0]);
+	}
+}
@@ -0,0 +1,266 @@
+#include "lypch.h"
+#include "Test.h"
+
+#include "Renderer/Descriptors/VulkanDescriptorAllocator.h"
+
+namespace Lucy::Tests {
+
+	//a device, that only keeps track of the pools and how many sets and descriptors they have left, like a driver that reports
+	//VK_ERROR_OUT_OF_POOL_MEMORY as soon as either is exhausted
+	struct FakeDescriptorDevice {
+		struct Pool {
+			uint32_t MaxSets = 0;
+			uint32_t AllocatedSets = 0;
+			std::vector<VkDescriptorPoolSize> FreeDescriptors;
+			std::vector<VkDescriptorPoolSize> PoolSizes;
+			uint32_t ResetCount = 0;
+			bool Destroyed = false;
+		};
+
+		std::vector<Pool> Pools; //the handle is the index + 1
+		std::vector<std::vector<VkDescriptorSetLayoutBinding>> Layouts; //the same for the layouts
+		std::unordered_map<VkDescriptorSet, uint64_t> SetPools;
+		uint64_t NextSet = 1;
+		uint32_t UpdateCalls = 0;
+
+		Pool& GetPool(VkDescriptorPool pool) { return Pools[(uint64_t)pool - 1]; }
+	};
+	static FakeDescriptorDevice* s_Device = nullptr;
+
+	template <typename THandle>
+	static THandle CreateFakeHandle(uint64_t value) {
+		return reinterpret_cast<THandle>(value);
+	}
+
+	static VKAPI_ATTR VkResult VKAPI_CALL FakeCreateDescriptorPool(VkDevice, const VkDescriptorPoolCreateInfo* createInfo, const VkAllocationCallbacks*, VkDescriptorPool* pool) {
+		std::vector<VkDescriptorPoolSize> poolSizes(createInfo->pPoolSizes, createInfo->pPoolSizes + createInfo->poolSizeCount);
+		s_Device->Pools.push_back(FakeDescriptorDevice::Pool{ createInfo->maxSets, 0, poolSizes, poolSizes });
+		*pool = CreateFakeHandle<VkDescriptorPool>(s_Device->Pools.size());
+		return VK_SUCCESS;
+	}
+
+	static VKAPI_ATTR void VKAPI_CALL FakeDestroyDescriptorPool(VkDevice, VkDescriptorPool pool, const VkAllocationCallbacks*) {
+		s_Device->GetPool(pool).Destroyed = true;
+	}
+
+	static VKAPI_ATTR VkResult VKAPI_CALL FakeCreateDescriptorSetLayout(VkDevice, const VkDescriptorSetLayoutCreateInfo* createInfo, const VkAllocationCallbacks*, VkDescriptorSetLayout* layout) {
+		s_Device->Layouts.emplace_back(createInfo->pBindings, createInfo->pBindings + createInfo->bindingCount);
+		*layout = CreateFakeHandle<VkDescriptorSetLayout>(s_Device->Layouts.size());
+		return VK_SUCCESS;
+	}
+
+	static VKAPI_ATTR void VKAPI_CALL FakeDestroyDescriptorSetLayout(VkDevice, VkDescriptorSetLayout, const VkAllocationCallbacks*) {
+	}
+
+	static VKAPI_ATTR VkResult VKAPI_CALL FakeAllocateDescriptorSets(VkDevice, const VkDescriptorSetAllocateInfo* allocateInfo, VkDescriptorSet* descriptorSets) {
+		FakeDescriptorDevice::Pool& pool = s_Device->GetPool(allocateInfo->descriptorPool);
+		LUCY_CHECK(!pool.Destroyed);
+		if (pool.AllocatedSets + allocateInfo->descriptorSetCount > pool.MaxSets)
+			return VK_ERROR_OUT_OF_POOL_MEMORY;
+
+		//the bindless bindings take their upper bound, which is what the allocator sizes the pools with
+		std::vector<VkDescriptorPoolSize> freeDescriptors = pool.FreeDescriptors;
+		for (uint32_t i = 0; i < allocateInfo->descriptorSetCount; i++) {
+			for (const VkDescriptorSetLayoutBinding& binding : s_Device->Layouts[(uint64_t)allocateInfo->pSetLayouts[i] - 1]) {
+				auto it = std::ranges::find(freeDescriptors, binding.descriptorType, &VkDescriptorPoolSize::type);
+				if (it == freeDescriptors.end() || it->descriptorCount < binding.descriptorCount)
+					return VK_ERROR_OUT_OF_POOL_MEMORY;
+				it->descriptorCount -= binding.descriptorCount;
+			}
+		}
+
+		pool.FreeDescriptors = std::move(freeDescriptors);
+		pool.AllocatedSets += allocateInfo->descriptorSetCount;
+		for (uint32_t i = 0; i < allocateInfo->descriptorSetCount; i++) {
+			descriptorSets[i] = CreateFakeHandle<VkDescriptorSet>(s_Device->NextSet++);
+			s_Device->SetPools[descriptorSets[i]] = (uint64_t)allocateInfo->descriptorPool;
+		}
+		return VK_SUCCESS;
+	}
+
+	static VKAPI_ATTR VkResult VKAPI_CALL FakeFreeDescriptorSets(VkDevice, VkDescriptorPool pool, uint32_t count, const VkDescriptorSet* descriptorSets) {
+		for (uint32_t i = 0; i < count; i++) {
+			LUCY_CHECK(s_Device->SetPools.at(descriptorSets[i]) == (uint64_t)pool);
+			s_Device->SetPools.erase(descriptorSets[i]);
+		}
+		//the descriptors of the freed sets are not tracked, a layout is not known by its set
+		s_Device->GetPool(pool).AllocatedSets -= count;
+		return VK_SUCCESS;
+	}
+
+	static VKAPI_ATTR VkResult VKAPI_CALL FakeResetDescriptorPool(VkDevice, VkDescriptorPool descriptorPool, VkDescriptorPoolResetFlags) {
+		FakeDescriptorDevice::Pool& pool = s_Device->GetPool(descriptorPool);
+		pool.AllocatedSets = 0;
+		pool.FreeDescriptors = pool.PoolSizes;
+		pool.ResetCount++;
+		return VK_SUCCESS;
+	}
+
+	static VKAPI_ATTR void VKAPI_CALL FakeUpdateDescriptorSets(VkDevice, uint32_t, const VkWriteDescriptorSet*, uint32_t, const VkCopyDescriptorSet*) {
+		s_Device->UpdateCalls++;
+	}
+
+	//replaces the device functions for the lifetime of the test
+	class FakeDescriptorDeviceScope {
+	public:
+		FakeDescriptorDeviceScope() {
+			s_Device = &m_Device;
+			m_CreateDescriptorPool = std::exchange(VulkanDescriptorPool::s_CreateDescriptorPool, &FakeCreateDescriptorPool);
+			m_DestroyDescriptorPool = std::exchange(VulkanDescriptorPool::s_DestroyDescriptorPool, &FakeDestroyDescriptorPool);
+			m_CreateDescriptorSetLayout = std::exchange(VulkanDescriptorAllocator::s_CreateDescriptorSetLayout, &FakeCreateDescriptorSetLayout);
+			m_DestroyDescriptorSetLayout = std::exchange(VulkanDescriptorAllocator::s_DestroyDescriptorSetLayout, &FakeDestroyDescriptorSetLayout);
+			m_AllocateDescriptorSets = std::exchange(VulkanDescriptorAllocator::s_AllocateDescriptorSets, &FakeAllocateDescriptorSets);
+			m_FreeDescriptorSets = std::exchange(VulkanDescriptorAllocator::s_FreeDescriptorSets, &FakeFreeDescriptorSets);
+			m_ResetDescriptorPool = std::exchange(VulkanDescriptorAllocator::s_ResetDescriptorPool, &FakeResetDescriptorPool);
+			m_UpdateDescriptorSets = std::exchange(VulkanDescriptorAllocator::s_UpdateDescriptorSets, &FakeUpdateDescriptorSets);
+		}
+
+		~FakeDescriptorDeviceScope() {
+			VulkanDescriptorPool::s_CreateDescriptorPool = m_CreateDescriptorPool;
+			VulkanDescriptorPool::s_DestroyDescriptorPool = m_DestroyDescriptorPool;
+			VulkanDescriptorAllocator::s_CreateDescriptorSetLayout = m_CreateDescriptorSetLayout;
+			VulkanDescriptorAllocator::s_DestroyDescriptorSetLayout = m_DestroyDescriptorSetLayout;
+			VulkanDescriptorAllocator::s_AllocateDescriptorSets = m_AllocateDescriptorSets;
+			VulkanDescriptorAllocator::s_FreeDescriptorSets = m_FreeDescriptorSets;
+			VulkanDescriptorAllocator::s_ResetDescriptorPool = m_ResetDescriptorPool;
+			VulkanDescriptorAllocator::s_UpdateDescriptorSets = m_UpdateDescriptorSets;
+			s_Device = nullptr;
+		}
+
+		FakeDescriptorDevice& GetDevice() { return m_Device; }
+	private:
+		FakeDescriptorDevice m_Device;
+
+		PFN_vkCreateDescriptorPool m_CreateDescriptorPool;
+		PFN_vkDestroyDescriptorPool m_DestroyDescriptorPool;
+		PFN_vkCreateDescriptorSetLayout m_CreateDescriptorSetLayout;
+		PFN_vkDestroyDescriptorSetLayout m_DestroyDescriptorSetLayout;
+		PFN_vkAllocateDescriptorSets m_AllocateDescriptorSets;
+		PFN_vkFreeDescriptorSets m_FreeDescriptorSets;
+		PFN_vkResetDescriptorPool m_ResetDescriptorPool;
+		PFN_vkUpdateDescriptorSets m_UpdateDescriptorSets;
+	};
+
+	//the layout of the mip generation: a sampled source and a storage image per level
+	static VkDescriptorSetLayout GetTestLayout(VulkanDescriptorAllocator& allocator, uint32_t storageImageCount = 12) {
+		std::vector<VkDescriptorSetLayoutBinding> bindings = {
+			{ 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr },
+			{ 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, storageImageCount, VK_SHADER_STAGE_COMPUTE_BIT, nullptr },
+		};
+		return allocator.RTGetLayout(bindings, std::vector<VkDescriptorBindingFlags>(bindings.size(), 0));
+	}
+
+	//a write of the sampled image, different image views make different sets
+	struct TestFrameSetWrite {
+		VkDescriptorImageInfo ImageInfo;
+		VkWriteDescriptorSet Write;
+
+		TestFrameSetWrite(uint64_t imageView)
+			: ImageInfo{ CreateFakeHandle<VkSampler>(0x200), CreateFakeHandle<VkImageView>(imageView), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL } {
+			Write = VkWriteDescriptorSet{ .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, .dstBinding = 0, .descriptorCount = 1,
+										  .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, .pImageInfo = &ImageInfo };
+		}
+	};
+
+	static VkDescriptorSet AllocateTestFrameSet(VulkanDescriptorAllocator& allocator, uint32_t frameIndex, VkDescriptorSetLayout layout, uint64_t imageView) {
+		TestFrameSetWrite write(imageView);
+		return allocator.RTAllocateFrameSet(frameIndex, layout, std::span<VkWriteDescriptorSet>(&write.Write, 1));
+	}
+
+	LUCY_TEST(DescriptorAllocatorGrowsExhaustedPools) {
+		FakeDescriptorDeviceScope scope;
+		FakeDescriptorDevice& device = scope.GetDevice();
+		static constexpr uint32_t initialSets = VulkanDescriptorAllocator::s_InitialSetsPerPool;
+
+		VulkanDescriptorAllocator allocator;
+		allocator.Init(VK_NULL_HANDLE);
+		VkDescriptorSetLayout layout = GetTestLayout(allocator);
+		LUCY_CHECK(GetTestLayout(allocator) == layout);
+
+		//the first pool is exhausted by its sets
+		std::vector<VkDescriptorSet> sets(initialSets);
+		VkDescriptorPool firstPool = allocator.RTAllocatePersistent(layout, initialSets, sets.data());
+		LUCY_CHECK(allocator.GetStats().PersistentPoolCount == 1);
+		LUCY_CHECK(device.GetPool(firstPool).AllocatedSets == initialSets);
+
+		//the next set fails on it and goes into a new pool with twice the sets
+		VkDescriptorSet set = VK_NULL_HANDLE;
+		VkDescriptorPool secondPool = allocator.RTAllocatePersistent(layout, 1, &set);
+		LUCY_CHECK(secondPool != firstPool);
+		LUCY_CHECK(device.GetPool(secondPool).MaxSets == 2 * initialSets);
+		LUCY_CHECK(allocator.GetStats().PersistentPoolCount == 2);
+		LUCY_CHECK(allocator.GetStats().PersistentSetCount == initialSets + 1);
+
+		//the sets are freed with the pool they came from
+		allocator.RTFreePersistent(firstPool, initialSets, sets.data());
+		allocator.RTFreePersistent(secondPool, 1, &set);
+		LUCY_CHECK(allocator.GetStats().PersistentSetCount == 0);
+		LUCY_CHECK(device.SetPools.empty());
+
+		//a bindless set, that exceeds the descriptors of the default pool sizes, gets a pool that fits it
+		VkDescriptorSetLayout bindlessLayout = GetTestLayout(allocator, 4096 * 2);
+		VkDescriptorPool bindlessPool = allocator.RTAllocatePersistent(bindlessLayout, 1, &set, 4096 * 2);
+		LUCY_CHECK(bindlessPool != secondPool);
+		LUCY_CHECK(allocator.GetStats().PersistentPoolCount == 3);
+
+		//the pool sizes double up to the maximum
+		for (uint32_t i = 0; i < 16; i++) {
+			std::vector<VkDescriptorSet> moreSets(VulkanDescriptorAllocator::s_MaxSetsPerPool);
+			allocator.RTAllocatePersistent(layout, VulkanDescriptorAllocator::s_MaxSetsPerPool, moreSets.data());
+		}
+		for (const FakeDescriptorDevice::Pool& pool : device.Pools)
+			LUCY_CHECK(pool.MaxSets <= VulkanDescriptorAllocator::s_MaxSetsPerPool);
+		LUCY_CHECK(device.Pools.back().MaxSets == VulkanDescriptorAllocator::s_MaxSetsPerPool);
+
+		allocator.Destroy();
+		for (const FakeDescriptorDevice::Pool& pool : device.Pools)
+			LUCY_CHECK(pool.Destroyed);
+	}
+
+	LUCY_TEST(DescriptorAllocatorReusesFramePoolsAfterReset) {
+		FakeDescriptorDeviceScope scope;
+		FakeDescriptorDevice& device = scope.GetDevice();
+		static constexpr uint32_t framesInFlight = 2;
+		static constexpr uint32_t setsPerFrame = VulkanDescriptorAllocator::s_InitialSetsPerPool + 1;
+
+		VulkanDescriptorAllocator allocator;
+		allocator.Init(VK_NULL_HANDLE);
+		VkDescriptorSetLayout layout = GetTestLayout(allocator);
+
+		//the first frames grow a pool list of their own, each pool fits all of its sets (the layout needs more storage images than the default sizes)
+		for (uint32_t frameIndex = 0; frameIndex < framesInFlight; frameIndex++) {
+			allocator.RTResetFramePools(frameIndex);
+			for (uint32_t i = 0; i < setsPerFrame; i++)
+				AllocateTestFrameSet(allocator, frameIndex, layout, 0x300 + i);
+		}
+		const size_t poolCount = device.Pools.size();
+		LUCY_CHECK(poolCount == 2 * framesInFlight);
+		LUCY_CHECK(allocator.GetStats().FramePoolCount == poolCount);
+
+		//the following frames reset their pools and allocate from them again, no pool is created
+		for (uint32_t frame = framesInFlight; frame < 100; frame++) {
+			const uint32_t frameIndex = frame % framesInFlight;
+			allocator.RTResetFramePools(frameIndex);
+
+			device.UpdateCalls = 0;
+			for (uint32_t i = 0; i < setsPerFrame; i++)
+				AllocateTestFrameSet(allocator, frameIndex, layout, 0x300 + i);
+			LUCY_CHECK(device.UpdateCalls == setsPerFrame);
+			LUCY_CHECK(allocator.GetStats().FrameSetCount == setsPerFrame);
+		}
+		LUCY_CHECK(device.Pools.size() == poolCount);
+		for (const FakeDescriptorDevice::Pool& pool : device.Pools)
+			LUCY_CHECK(pool.ResetCount == (100 - framesInFlight) / framesInFlight);
+
+		//the same writes within a frame share a set, a reset frame allocates it again
+		allocator.RTResetFramePools(0);
+		VkDescriptorSet set = AllocateTestFrameSet(allocator, 0, layout, 0x400);
+		LUCY_CHECK(AllocateTestFrameSet(allocator, 0, layout, 0x400) == set);
+		LUCY_CHECK(AllocateTestFrameSet(allocator, 1, layout, 0x400) != set);
+		LUCY_CHECK(allocator.GetStats().FrameSetCacheHits == 1);
+		allocator.RTResetFramePools(0);
+		LUCY_CHECK(AllocateTestFrameSet(allocator, 0, layout, 0x400) != set);
+
+		allocator.Destroy();
+	}
+}
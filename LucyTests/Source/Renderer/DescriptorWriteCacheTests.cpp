@@ -0,0 +1,105 @@
+#include "lypch.h"
+#include "Test.h"
+
+#include "Renderer/Descriptors/VulkanDescriptorWriteCache.h"
+
+namespace Lucy::Tests {
+
+	static uint32_t s_UpdateCalls = 0;
+
+	static VKAPI_ATTR void VKAPI_CALL CountUpdateDescriptorSets(VkDevice, uint32_t, const VkWriteDescriptorSet*, uint32_t, const VkCopyDescriptorSet*) {
+		s_UpdateCalls++;
+	}
+
+	//the handles are never dereferenced, the calls only go to the counter
+	template <typename THandle>
+	static THandle CreateFakeHandle(uint64_t value) {
+		return reinterpret_cast<THandle>(value);
+	}
+
+	//the writes of a set with a uniform buffer and two combined image samplers, like VulkanDescriptorSet::RTUpdate creates them
+	struct FakeSetWrites {
+		VkDescriptorBufferInfo BufferInfo = { CreateFakeHandle<VkBuffer>(0x100), 0, VK_WHOLE_SIZE };
+		VkDescriptorImageInfo ImageInfos[2] = {
+			{ CreateFakeHandle<VkSampler>(0x200), CreateFakeHandle<VkImageView>(0x300), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL },
+			{ CreateFakeHandle<VkSampler>(0x200), CreateFakeHandle<VkImageView>(0x301), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL },
+		};
+		std::vector<uint64_t> ResourceIDs = { 1, 2, 3 }; //buffer, image view, image view
+
+		std::vector<VkWriteDescriptorSet> GetWrites() const {
+			VkWriteDescriptorSet bufferWrite{ .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, .dstBinding = 0, .descriptorCount = 1,
+											  .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, .pBufferInfo = &BufferInfo };
+			VkWriteDescriptorSet imageWrite{ .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, .dstBinding = 1, .descriptorCount = 2,
+											 .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, .pImageInfo = ImageInfos };
+			return { bufferWrite, imageWrite };
+		}
+	};
+
+	static uint32_t CountWrites(VulkanDescriptorWriteCache& cache, uint32_t frameIndex, const FakeSetWrites& setWrites) {
+		s_UpdateCalls = 0;
+		const std::vector<VkWriteDescriptorSet> writes = setWrites.GetWrites();
+		const bool written = cache.RTWrite(VK_NULL_HANDLE, frameIndex, writes, setWrites.ResourceIDs);
+		LUCY_CHECK(written == (s_UpdateCalls == 1));
+		return s_UpdateCalls;
+	}
+
+	LUCY_TEST(DescriptorWriteCacheSkipsUnchangedSets) {
+		const PFN_vkUpdateDescriptorSets updateDescriptorSets = std::exchange(VulkanDescriptorWriteCache::s_UpdateDescriptorSets, &CountUpdateDescriptorSets);
+
+		VulkanDescriptorWriteCache cache;
+		cache.Reset(2);
+		FakeSetWrites setWrites;
+
+		//every frame in flight has its own set, each one is written once
+		uint32_t updateCalls = 0;
+		for (uint32_t frame = 0; frame < 16; frame++)
+			updateCalls += CountWrites(cache, frame % 2, setWrites);
+		LUCY_CHECK(updateCalls == 2);
+
+		//nothing to write
+		s_UpdateCalls = 0;
+		LUCY_CHECK(!cache.RTWrite(VK_NULL_HANDLE, 0, {}, {}));
+		LUCY_CHECK(s_UpdateCalls == 0);
+
+		//reallocated sets are empty
+		cache.Reset(2);
+		LUCY_CHECK(CountWrites(cache, 0, setWrites) == 1);
+		LUCY_CHECK(CountWrites(cache, 0, setWrites) == 0);
+
+		VulkanDescriptorWriteCache::s_UpdateDescriptorSets = updateDescriptorSets;
+	}
+
+	LUCY_TEST(DescriptorWriteCacheDetectsEveryChange) {
+		const PFN_vkUpdateDescriptorSets updateDescriptorSets = std::exchange(VulkanDescriptorWriteCache::s_UpdateDescriptorSets, &CountUpdateDescriptorSets);
+
+		VulkanDescriptorWriteCache cache;
+		cache.Reset(1);
+		FakeSetWrites setWrites;
+		CountWrites(cache, 0, setWrites);
+
+		//a grown buffer, that got the handle of the one it replaced
+		setWrites.ResourceIDs[0] = 4;
+		LUCY_CHECK(CountWrites(cache, 0, setWrites) == 1);
+		LUCY_CHECK(CountWrites(cache, 0, setWrites) == 0);
+
+		//the same for an image view
+		setWrites.ResourceIDs[2] = 5;
+		LUCY_CHECK(CountWrites(cache, 0, setWrites) == 1);
+
+		setWrites.ImageInfos[1].sampler = CreateFakeHandle<VkSampler>(0x201);
+		LUCY_CHECK(CountWrites(cache, 0, setWrites) == 1);
+
+		setWrites.ImageInfos[0].imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+		LUCY_CHECK(CountWrites(cache, 0, setWrites) == 1);
+
+		setWrites.BufferInfo.range = 256;
+		LUCY_CHECK(CountWrites(cache, 0, setWrites) == 1);
+
+		//swapping two image views changes the descriptors, although the same resources are written
+		std::swap(setWrites.ResourceIDs[1], setWrites.ResourceIDs[2]);
+		LUCY_CHECK(CountWrites(cache, 0, setWrites) == 1);
+		LUCY_CHECK(CountWrites(cache, 0, setWrites) == 0);
+
+		VulkanDescriptorWriteCache::s_UpdateDescriptorSets = updateDescriptorSets;
+	}
+}
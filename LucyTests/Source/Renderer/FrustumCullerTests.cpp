@@ -0,0 +1,145 @@
+#include "lypch.h"
+#include "Test.h"
+
+#include <random>
+
+#include "Renderer/FrustumCuller.h"
+
+namespace Lucy::Tests {
+
+	static std::vector<uint32_t> CullSIMD(const FrustumCuller& culler, const Maths::Frustum& frustum) {
+		std::vector<uint32_t> visible;
+		culler.Cull(frustum, visible);
+		return visible;
+	}
+
+	static std::vector<uint32_t> CullScalar(const FrustumCuller& culler, const Maths::Frustum& frustum) {
+		std::vector<uint32_t> visible;
+		culler.CullReference(frustum, visible);
+		return visible;
+	}
+
+	LUCY_TEST(FrustumCullerMatchesScalarReference) {
+		std::mt19937 random(30);
+		std::uniform_real_distribution<float> position(-60.0f, 60.0f);
+		std::uniform_real_distribution<float> extent(0.0f, 8.0f);
+
+		const glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 5.0f, 20.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+		const Maths::Frustum frustums[] = {
+			Maths::ExtractFrustum(glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 100.0f) * view),
+			Maths::ExtractFrustum(glm::perspective(glm::radians(20.0f), 1.0f, 5.0f, 30.0f) * view),
+			Maths::ExtractFrustum(glm::ortho(-15.0f, 15.0f, -10.0f, 10.0f, 1.0f, 50.0f) * view),
+			Maths::ExtractShadowCasterFrustum(glm::ortho(-15.0f, 15.0f, -10.0f, 10.0f, 1.0f, 50.0f) * view),
+		};
+
+		//every count from 0 to a few times the SIMD width, so that each amount of padding is covered
+		for (uint32_t count : { 0u, 1u, 2u, 3u, 4u, 5u, 7u, 8u, 9u, 1000u, 1003u }) {
+			FrustumCuller culler;
+			culler.Reserve(count);
+			for (uint32_t i = 0; i < count; i++) {
+				const glm::vec3 center = glm::vec3(position(random), position(random), position(random));
+				const glm::vec3 extents = glm::vec3(extent(random), extent(random), extent(random));
+				LUCY_CHECK(culler.Add(Maths::AABB{ center - extents, center + extents }) == i);
+			}
+			LUCY_CHECK(culler.GetCount() == count);
+
+			for (const Maths::Frustum& frustum : frustums)
+				LUCY_CHECK(CullSIMD(culler, frustum) == CullScalar(culler, frustum));
+		}
+	}
+
+	LUCY_TEST(FrustumCullerKeepsBoxesAroundVisiblePoints) {
+		const glm::vec3 cameraPosition = glm::vec3(3.0f, 2.0f, 10.0f);
+		const glm::mat4 viewProjection = glm::perspective(glm::radians(70.0f), 1.5f, 0.5f, 40.0f) *
+			glm::lookAt(cameraPosition, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+		const glm::mat4 inverseViewProjection = glm::inverse(viewProjection);
+		const Maths::Frustum frustum = Maths::ExtractFrustum(viewProjection);
+
+		//small boxes around points, that are inside of the view volume (depth range [0, 1]), can never be culled
+		std::mt19937 random(31);
+		std::uniform_real_distribution<float> ndc(-0.99f, 0.99f);
+		std::uniform_real_distribution<float> depth(0.01f, 0.99f);
+
+		FrustumCuller culler;
+		for (uint32_t i = 0; i < 256; i++) {
+			const glm::vec4 point = inverseViewProjection * glm::vec4(ndc(random), ndc(random), depth(random), 1.0f);
+			const glm::vec3 center = glm::vec3(point) / point.w;
+			culler.Add(Maths::AABB{ center - 0.01f, center + 0.01f });
+		}
+
+		LUCY_CHECK(CullSIMD(culler, frustum).size() == culler.GetCount());
+		LUCY_CHECK(CullScalar(culler, frustum).size() == culler.GetCount());
+	}
+
+	LUCY_TEST(FrustumCullerInvalidBoxesAreNeverCulled) {
+		FrustumCuller culler;
+		culler.Add(Maths::AABB{}); //never expanded
+		culler.Add(Maths::AABB{ glm::vec3(1000.0f), glm::vec3(1001.0f) });
+
+		const Maths::Frustum frustum = Maths::ExtractFrustum(glm::perspective(glm::radians(60.0f), 1.0f, 0.1f, 10.0f));
+		LUCY_CHECK(CullSIMD(culler, frustum) == std::vector<uint32_t>{ 0 });
+		LUCY_CHECK(CullScalar(culler, frustum) == std::vector<uint32_t>{ 0 });
+	}
+
+	//a cascade looks down from the light, casters between the light and the near plane are pancaked onto it by the depth clamp
+	LUCY_TEST(FrustumCullerShadowCastersInFrontOfTheNearPlane) {
+		const glm::vec3 lightPosition = glm::vec3(0.0f, 50.0f, 0.0f);
+		const glm::mat4 lightViewProjection = glm::ortho(-10.0f, 10.0f, -10.0f, 10.0f, 20.0f, 80.0f) *
+			glm::lookAt(lightPosition, glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f));
+
+		FrustumCuller culler;
+		const uint32_t receiver = culler.Add(Maths::AABB{ glm::vec3(-1.0f, 0.0f, -1.0f), glm::vec3(1.0f, 1.0f, 1.0f) });
+		const uint32_t betweenLightAndNearPlane = culler.Add(Maths::AABB{ glm::vec3(-1.0f, 38.0f, -1.0f), glm::vec3(1.0f, 40.0f, 1.0f) });
+		const uint32_t behindTheLight = culler.Add(Maths::AABB{ glm::vec3(-1.0f, 60.0f, -1.0f), glm::vec3(1.0f, 62.0f, 1.0f) });
+		const uint32_t besideTheCascade = culler.Add(Maths::AABB{ glm::vec3(30.0f, 38.0f, -1.0f), glm::vec3(32.0f, 40.0f, 1.0f) });
+		const uint32_t behindTheFarPlane = culler.Add(Maths::AABB{ glm::vec3(-1.0f, -40.0f, -1.0f), glm::vec3(1.0f, -38.0f, 1.0f) });
+
+		const Maths::Frustum cameraFrustum = Maths::ExtractFrustum(lightViewProjection);
+		const std::vector<uint32_t> cameraExpected = { receiver };
+		LUCY_CHECK(CullSIMD(culler, cameraFrustum) == cameraExpected);
+		LUCY_CHECK(CullScalar(culler, cameraFrustum) == cameraExpected);
+
+		const Maths::Frustum casterFrustum = Maths::ExtractShadowCasterFrustum(lightViewProjection);
+		const std::vector<uint32_t> casterExpected = { receiver, betweenLightAndNearPlane, behindTheLight };
+		LUCY_CHECK(CullSIMD(culler, casterFrustum) == casterExpected);
+		LUCY_CHECK(CullScalar(culler, casterFrustum) == casterExpected);
+
+		(void)besideTheCascade;
+		(void)behindTheFarPlane;
+	}
+
+	//100k boxes spread around the camera, culled like CulledMeshList culls the candidates of a view
+	LUCY_TEST(FrustumCullerBenchmark) {
+		static constexpr uint32_t boxCount = 100000;
+		static constexpr uint32_t cullCount = 100;
+
+		std::mt19937 random(32);
+		std::uniform_real_distribution<float> position(-200.0f, 200.0f);
+		std::uniform_real_distribution<float> extent(0.1f, 4.0f);
+
+		FrustumCuller culler;
+		culler.Reserve(boxCount);
+		for (uint32_t i = 0; i < boxCount; i++) {
+			const glm::vec3 center = glm::vec3(position(random), position(random), position(random));
+			const glm::vec3 extents = glm::vec3(extent(random), extent(random), extent(random));
+			culler.Add(Maths::AABB{ center - extents, center + extents });
+		}
+
+		const Maths::Frustum frustum = Maths::ExtractFrustum(glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 250.0f) *
+			glm::lookAt(glm::vec3(0.0f, 10.0f, 0.0f), glm::vec3(100.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f)));
+
+		std::vector<uint32_t> simdVisible, scalarVisible;
+		const double simdMilliseconds = MeasureMilliseconds([&]() {
+			for (uint32_t i = 0; i < cullCount; i++)
+				culler.Cull(frustum, simdVisible);
+		});
+		const double scalarMilliseconds = MeasureMilliseconds([&]() {
+			for (uint32_t i = 0; i < cullCount; i++)
+				culler.CullReference(frustum, scalarVisible);
+		});
+
+		LUCY_INFO("Culling {0} boxes ({1} visible): {2:.3f} ms with SSE, {3:.3f} ms scalar ({4:.1f}x)", boxCount, simdVisible.size(),
+				  simdMilliseconds / cullCount, scalarMilliseconds / cullCount, scalarMilliseconds / simdMilliseconds);
+		LUCY_CHECK(simdVisible == scalarVisible);
+	}
+}
@@ -0,0 +1,161 @@
+#include "lypch.h"
+#include "Test.h"
+
+#include <random>
+
+#include "Renderer/HiZPyramid.h"
+
+namespace Lucy::Tests {
+
+	//the pyramid expects a depth range of [0, 1]
+	static glm::mat4 CreateProjection(float aspectRatio) {
+		return glm::perspectiveRH_ZO(glm::radians(60.0f), aspectRatio, 0.1f, 100.0f);
+	}
+
+	static float GetDepth(const glm::mat4& projection, float viewDistance) {
+		const glm::vec4 clip = projection * glm::vec4(0.0f, 0.0f, -viewDistance, 1.0f);
+		return clip.z / clip.w;
+	}
+
+	//the depth buffer of walls facing the camera, each one covers a rectangle in NDC
+	struct Wall {
+		glm::vec2 NDCMin;
+		glm::vec2 NDCMax;
+		float Depth;
+	};
+
+	static std::vector<float> RasterizeWalls(const std::vector<Wall>& walls, uint32_t width, uint32_t height) {
+		std::vector<float> depth((size_t)width * height, 1.0f);
+		for (uint32_t y = 0; y < height; y++) {
+			for (uint32_t x = 0; x < width; x++) {
+				const glm::vec2 ndc = (glm::vec2(x, y) + 0.5f) / glm::vec2(width, height) * 2.0f - 1.0f;
+				for (const Wall& wall : walls) {
+					if (glm::all(glm::greaterThanEqual(ndc, wall.NDCMin)) && glm::all(glm::lessThanEqual(ndc, wall.NDCMax)))
+						depth[(size_t)y * width + x] = glm::min(depth[(size_t)y * width + x], wall.Depth);
+				}
+			}
+		}
+		return depth;
+	}
+
+	static Maths::AABB CreateBox(const glm::vec3& center, float extent) {
+		return Maths::AABB{ center - extent, center + extent };
+	}
+
+	LUCY_TEST(HiZPyramidLevelsStoreTheMaximum) {
+		std::mt19937 random(32);
+		std::uniform_real_distribution<float> distribution(0.0f, 1.0f);
+
+		//odd sizes leave partial texels at the border
+		for (const glm::uvec2& size : { glm::uvec2(1, 1), glm::uvec2(1, 7), glm::uvec2(37, 23), glm::uvec2(64, 64), glm::uvec2(160, 90) }) {
+			std::vector<float> depth((size_t)size.x * size.y);
+			for (float& d : depth)
+				d = distribution(random);
+
+			HiZPyramid pyramid;
+			pyramid.Build(depth.data(), size.x, size.y);
+
+			LUCY_CHECK(pyramid.GetMipCount() == HiZPyramid::GetMipCount(size.x, size.y));
+			LUCY_CHECK(pyramid.GetTexels().size() == HiZPyramid::GetTexelCount(size.x, size.y));
+			LUCY_CHECK(HiZPyramid::GetMipSize(size.x, size.y, pyramid.GetMipCount() - 1) == glm::uvec2(1));
+
+			//every texel is the maximum of the depth pixels in its footprint
+			for (uint32_t level = 0; level < pyramid.GetMipCount(); level++) {
+				const glm::uvec2 mipSize = HiZPyramid::GetMipSize(size.x, size.y, level);
+				const uint32_t footprint = 2u << level;
+				for (uint32_t y = 0; y < mipSize.y; y++) {
+					for (uint32_t x = 0; x < mipSize.x; x++) {
+						float expected = 0.0f;
+						for (uint32_t py = y * footprint; py < glm::min((y + 1) * footprint, size.y); py++) {
+							for (uint32_t px = x * footprint; px < glm::min((x + 1) * footprint, size.x); px++)
+								expected = glm::max(expected, depth[(size_t)py * size.x + px]);
+						}
+						LUCY_CHECK(pyramid.GetTexel(level, x, y) == expected);
+					}
+				}
+			}
+		}
+	}
+
+	LUCY_TEST(HiZPyramidOcclusionBehindAWall) {
+		static constexpr uint32_t width = 160;
+		static constexpr uint32_t height = 90;
+		const glm::mat4 projection = CreateProjection((float)width / (float)height);
+
+		//the camera sits in the origin and looks down -z, the wall is 10 units away
+		const std::vector<float> depth = RasterizeWalls({ Wall{ glm::vec2(-0.5f), glm::vec2(0.5f), GetDepth(projection, 10.0f) } }, width, height);
+
+		HiZPyramid empty;
+		LUCY_CHECK(!empty.IsOccluded(CreateBox(glm::vec3(0.0f, 0.0f, -20.0f), 0.5f), projection));
+
+		HiZPyramid pyramid;
+		pyramid.Build(depth.data(), width, height);
+
+		LUCY_CHECK(pyramid.IsOccluded(CreateBox(glm::vec3(0.0f, 0.0f, -20.0f), 0.5f), projection));
+		LUCY_CHECK(pyramid.IsOccluded(CreateBox(glm::vec3(1.0f, -0.5f, -30.0f), 2.0f), projection));
+		//in front of the wall
+		LUCY_CHECK(!pyramid.IsOccluded(CreateBox(glm::vec3(0.0f, 0.0f, -5.0f), 0.5f), projection));
+		//reaches through the wall
+		LUCY_CHECK(!pyramid.IsOccluded(Maths::AABB{ glm::vec3(-0.5f, -0.5f, -20.0f), glm::vec3(0.5f, 0.5f, -9.0f) }, projection));
+		//behind the wall, but the projection sticks out at the side
+		LUCY_CHECK(!pyramid.IsOccluded(CreateBox(glm::vec3(10.0f, 0.0f, -20.0f), 0.5f), projection));
+		//crosses the near plane and behind the camera
+		LUCY_CHECK(!pyramid.IsOccluded(Maths::AABB{ glm::vec3(-0.5f, -0.5f, -20.0f), glm::vec3(0.5f, 0.5f, 1.0f) }, projection));
+		LUCY_CHECK(!pyramid.IsOccluded(CreateBox(glm::vec3(0.0f, 0.0f, 20.0f), 0.5f), projection));
+		LUCY_CHECK(!pyramid.IsOccluded(Maths::AABB{}, projection));
+	}
+
+	//the pyramid may miss occluded boxes, but a box is only occluded, if every depth pixel it covers is in front of it
+	LUCY_TEST(HiZPyramidOcclusionIsConservative) {
+		static constexpr uint32_t width = 123;
+		static constexpr uint32_t height = 77;
+		const glm::mat4 projection = CreateProjection((float)width / (float)height);
+
+		std::mt19937 random(32);
+		std::uniform_real_distribution<float> ndc(-1.2f, 1.2f);
+		std::uniform_real_distribution<float> distance(2.0f, 40.0f);
+		std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+		std::vector<Wall> walls;
+		for (uint32_t i = 0; i < 12; i++) {
+			const glm::vec2 a = glm::vec2(ndc(random), ndc(random));
+			const glm::vec2 b = glm::vec2(ndc(random), ndc(random));
+			walls.push_back(Wall{ glm::min(a, b), glm::max(a, b), GetDepth(projection, distance(random)) });
+		}
+		const std::vector<float> depth = RasterizeWalls(walls, width, height);
+
+		HiZPyramid pyramid;
+		pyramid.Build(depth.data(), width, height);
+
+		uint32_t occludedCount = 0;
+		for (uint32_t i = 0; i < 4096; i++) {
+			const float z = -distance(random) * 1.5f;
+			const glm::vec3 center = glm::vec3(unit(random) * -z * 0.6f, unit(random) * -z * 0.4f, z);
+			const Maths::AABB aabb = CreateBox(center, 0.1f + glm::abs(unit(random)) * 2.0f);
+			if (!pyramid.IsOccluded(aabb, projection))
+				continue;
+			occludedCount++;
+
+			//the screen rectangle and the nearest depth of the box
+			glm::vec2 uvMin = glm::vec2(FLT_MAX);
+			glm::vec2 uvMax = glm::vec2(-FLT_MAX);
+			float minDepth = FLT_MAX;
+			for (uint32_t c = 0; c < 8; c++) {
+				const glm::vec3 corner = glm::vec3(c & 1 ? aabb.Max.x : aabb.Min.x, c & 2 ? aabb.Max.y : aabb.Min.y, c & 4 ? aabb.Max.z : aabb.Min.z);
+				const glm::vec4 clip = projection * glm::vec4(corner, 1.0f);
+				uvMin = glm::min(uvMin, glm::vec2(clip) / clip.w * 0.5f + 0.5f);
+				uvMax = glm::max(uvMax, glm::vec2(clip) / clip.w * 0.5f + 0.5f);
+				minDepth = glm::min(minDepth, clip.z / clip.w);
+			}
+
+			const glm::ivec2 pixelMin = glm::clamp(glm::ivec2(glm::floor(uvMin * glm::vec2(width, height))), glm::ivec2(0), glm::ivec2(width - 1, height - 1));
+			const glm::ivec2 pixelMax = glm::clamp(glm::ivec2(glm::floor(uvMax * glm::vec2(width, height))), glm::ivec2(0), glm::ivec2(width - 1, height - 1));
+			for (int32_t y = pixelMin.y; y <= pixelMax.y; y++) {
+				for (int32_t x = pixelMin.x; x <= pixelMax.x; x++)
+					LUCY_CHECK(depth[(size_t)y * width + x] < minDepth);
+			}
+		}
+		//the test would pass trivially, if nothing was occluded
+		LUCY_CHECK(occludedCount > 0);
+	}
+}
@@ -0,0 +1,79 @@
+#include "lypch.h"
+#include "Test.h"
+
+#include "Core/FileSystem.h"
+#include "Threading/TaskScheduler.h"
+#include "Utilities/Utilities.h"
+
+#include "stb/stb_image.h"
+
+namespace Lucy::Tests {
+
+	//the texture set of the Sponza asset, relative to the working directory (LucyTests)
+	static const std::filesystem::path s_SponzaDirectory = "../LucyEditor/Assets/Models/Sponza";
+
+	struct DecodedImage {
+		std::vector<uint8_t> FileData;
+		std::vector<uint8_t> StagingMemory; //stands in for the mapped staging memory of VulkanImage2D
+		uint64_t Hash = 0;
+	};
+
+	//like the decode tasks of VulkanImage2D: rgba8, written straight into the staging memory
+	static bool DecodeImage(DecodedImage& image) {
+		int32_t width = 0, height = 0, channels = 0;
+		uint8_t* data = stbi_load_from_memory(image.FileData.data(), (int32_t)image.FileData.size(), &width, &height, &channels, STBI_rgb_alpha);
+		if (!data)
+			return false;
+
+		image.StagingMemory.resize((size_t)width * height * 4);
+		memcpy(image.StagingMemory.data(), data, image.StagingMemory.size());
+		stbi_image_free(data);
+		image.Hash = Utils::HashBytes(image.StagingMemory.data(), image.StagingMemory.size());
+		return true;
+	}
+
+	//the files are read up front, so that only the decode is measured
+	LUCY_TEST(ImageDecodeBenchmark) {
+		if (!FileSystem::DirectoryExists(s_SponzaDirectory)) {
+			LUCY_WARN("Skipping the image decode benchmark, {0} does not exist", s_SponzaDirectory.generic_string());
+			return;
+		}
+
+		std::vector<DecodedImage> images[2];
+		for (const auto& entry : std::filesystem::directory_iterator(s_SponzaDirectory)) {
+			const std::filesystem::path extension = entry.path().extension();
+			if (extension != ".jpg" && extension != ".png")
+				continue;
+			DecodedImage& image = images[0].emplace_back();
+			FileSystem::ReadFile(entry.path(), image.FileData, OpenMode::Binary);
+		}
+		for (const DecodedImage& image : images[0])
+			images[1].emplace_back().FileData = image.FileData;
+		LUCY_CHECK(!images[0].empty());
+
+		uint32_t failedDecodes = 0;
+		const double serialMilliseconds = MeasureMilliseconds([&]() {
+			for (DecodedImage& image : images[0])
+				failedDecodes += DecodeImage(image) ? 0 : 1;
+		});
+
+		//one task per image, like VulkanImage2D::ScheduleDecode
+		TaskScheduler taskScheduler(TaskSchedulerCreateInfo{});
+		std::atomic<uint32_t> failedParallelDecodes = 0;
+		const double parallelMilliseconds = MeasureMilliseconds([&]() {
+			for (DecodedImage& image : images[1]) {
+				taskScheduler.Schedule(TaskScheduler::Launch::Async, TaskPriority::Medium, [&image, &failedParallelDecodes]([[maybe_unused]] const TaskArgs& args) {
+					if (!DecodeImage(image))
+						failedParallelDecodes.fetch_add(1, std::memory_order_relaxed);
+				});
+			}
+			taskScheduler.WaitForAllTasks();
+		});
+
+		LUCY_INFO("Decoding {0} Sponza textures: {1:.1f} ms serial, {2:.1f} ms on {3} workers ({4:.2f}x)", images[0].size(), serialMilliseconds,
+				  parallelMilliseconds, taskScheduler.GetNumWorkers(), serialMilliseconds / parallelMilliseconds);
+		LUCY_CHECK(failedDecodes == 0 && failedParallelDecodes == 0);
+		for (size_t i = 0; i < images[0].size(); i++)
+			LUCY_CHECK(images[0][i].Hash == images[1][i].Hash);
+	}
+}
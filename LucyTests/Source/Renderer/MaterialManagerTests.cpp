@@ -0,0 +1,102 @@
+#include "lypch.h"
+#include "Test.h"
+
+#include "Renderer/Material/MaterialManager.h"
+
+namespace Lucy::Tests {
+
+	//writes its id and a value into the shader data, like PBRMaterial without the textures
+	class TestMaterial final : public Material {
+	public:
+		TestMaterial(MaterialID materialID)
+			: Material(materialID) {
+		}
+
+		bool Update(uint8_t* shaderData) final override {
+			memset(shaderData, 0, MaterialManager::s_MaterialShaderDataSize);
+			const MaterialID materialID = GetMaterialID();
+			memcpy(shaderData, &materialID, sizeof(materialID));
+			memcpy(shaderData + sizeof(materialID), &m_Value, sizeof(m_Value));
+			return m_TexturesLoaded;
+		}
+		void RequestTextureMips(float) final override {}
+		void RTDestroyResource() final override {}
+
+		void SetValue(float value) { m_Value = value; MarkDirty(); }
+		void SetTexturesLoaded(bool texturesLoaded) { m_TexturesLoaded = texturesLoaded; }
+	private:
+		float m_Value = 0.0f;
+		bool m_TexturesLoaded = true;
+	};
+
+	//the material buffer without a device, the dirty ranges are what VulkanSharedStorageBuffer would upload
+	class TestMaterialBuffer : public ByteBuffer {
+	public:
+		//returns the uploaded bytes
+		size_t Upload() {
+			size_t uploadedBytes = 0;
+			for (const BufferRange& range : ConsumeDirtyRanges())
+				uploadedBytes += range.End - range.Begin;
+			return uploadedBytes;
+		}
+	};
+
+	static std::map<MaterialID, Ref<Material>> CreateTestMaterials(uint32_t count) {
+		std::map<MaterialID, Ref<Material>> materials;
+		for (MaterialID materialID = 0; materialID < count; materialID++)
+			materials.try_emplace(materialID, Memory::CreateRef<TestMaterial>(materialID));
+		return materials;
+	}
+
+	LUCY_TEST(MaterialManagerSkipsUnchangedMaterials) {
+		static constexpr uint32_t materialCount = 64;
+		const size_t stride = MaterialManager::s_MaterialShaderDataSize;
+
+		std::map<MaterialID, Ref<Material>> materials = CreateTestMaterials(materialCount);
+		TestMaterialBuffer materialBuffer;
+
+		//new materials are dirty
+		LUCY_CHECK(MaterialManager::WriteMaterials(materials, materialBuffer, materialBuffer.IsEmpty()) == materialCount);
+		LUCY_CHECK(materialBuffer.Upload() == materialCount * stride);
+
+		//the same set twice, nothing is written or uploaded
+		for (uint32_t i = 0; i < 2; i++) {
+			LUCY_CHECK(MaterialManager::WriteMaterials(materials, materialBuffer, materialBuffer.IsEmpty()) == 0);
+			LUCY_CHECK(materialBuffer.Upload() == 0);
+		}
+		LUCY_CHECK(materialBuffer.GetSize() == materialCount * stride);
+	}
+
+	LUCY_TEST(MaterialManagerWritesOnlyTheChangedMaterials) {
+		const size_t stride = MaterialManager::s_MaterialShaderDataSize;
+
+		std::map<MaterialID, Ref<Material>> materials = CreateTestMaterials(16);
+		TestMaterialBuffer materialBuffer;
+		MaterialManager::WriteMaterials(materials, materialBuffer, true);
+		materialBuffer.Upload();
+
+		//only the entry of the changed material
+		materials[5]->As<TestMaterial>()->SetValue(1.0f);
+		LUCY_CHECK(MaterialManager::WriteMaterials(materials, materialBuffer, false) == 1);
+		LUCY_CHECK(materialBuffer.Upload() == stride);
+		float value = 0.0f;
+		memcpy(&value, &materialBuffer[5 * stride + sizeof(MaterialID)], sizeof(value));
+		LUCY_CHECK(value == 1.0f);
+
+		//a material, whose textures are still loading, is written again until they are loaded
+		const Ref<TestMaterial>& loadingMaterial = materials[9]->As<TestMaterial>();
+		loadingMaterial->SetTexturesLoaded(false);
+		loadingMaterial->SetValue(2.0f);
+		LUCY_CHECK(MaterialManager::WriteMaterials(materials, materialBuffer, false) == 1);
+		LUCY_CHECK(MaterialManager::WriteMaterials(materials, materialBuffer, false) == 1);
+		loadingMaterial->SetTexturesLoaded(true);
+		LUCY_CHECK(MaterialManager::WriteMaterials(materials, materialBuffer, false) == 1);
+		LUCY_CHECK(MaterialManager::WriteMaterials(materials, materialBuffer, false) == 0);
+		materialBuffer.Upload();
+
+		//a recreated buffer (the shader has been reloaded) gets every material
+		TestMaterialBuffer reloadedBuffer;
+		LUCY_CHECK(MaterialManager::WriteMaterials(materials, reloadedBuffer, reloadedBuffer.IsEmpty()) == 16);
+		LUCY_CHECK(reloadedBuffer.Upload() == 16 * stride);
+	}
+}
@@ -0,0 +1,158 @@
+#include "lypch.h"
+#include "Test.h"
+
+#include <random>
+
+#include "Renderer/Mesh.h"
+#include "Renderer/Memory/Buffer/Buffer.h"
+
+//counts every allocation of the test binary, the benchmark below only looks at the difference around the measured code
+static std::atomic<size_t> s_AllocationCount = 0;
+
+void* operator new(size_t size) {
+	s_AllocationCount.fetch_add(1, std::memory_order_relaxed);
+	if (void* memory = malloc(size ? size : 1))
+		return memory;
+	throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept {
+	free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept {
+	free(memory);
+}
+
+namespace Lucy::Tests {
+
+	static constexpr uint32_t floatCount = Mesh::s_InterleavedVertexFloatCount;
+
+	template <typename TFunc>
+	static size_t CountAllocations(TFunc&& func) {
+		const size_t allocationCount = s_AllocationCount.load(std::memory_order_relaxed);
+		func();
+		return s_AllocationCount.load(std::memory_order_relaxed) - allocationCount;
+	}
+
+	//random attributes, the submeshes without texture coordinates (or normals, ...) have them zeroed
+	static Submesh CreateTestSubmesh(uint32_t vertexCount, std::mt19937& random, bool hasTextureCoords = true, bool hasTangents = true) {
+		std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+		auto randomVec3 = [&]() { return glm::vec3(distribution(random), distribution(random), distribution(random)); };
+
+		Submesh submesh;
+		submesh.VertexCount = vertexCount;
+		for (uint32_t i = 0; i < vertexCount; i++) {
+			submesh.Vertices.push_back(randomVec3());
+			submesh.Normals.push_back(randomVec3());
+			if (hasTextureCoords)
+				submesh.TextureCoords.emplace_back(distribution(random), distribution(random));
+			if (hasTangents) {
+				submesh.Tangents.push_back(randomVec3());
+				submesh.BiTangents.push_back(randomVec3());
+			}
+		}
+		return submesh;
+	}
+
+	//the upload loop before the vertices were interleaved into the staging memory: a vector per vertex, copied element by element
+	static void InterleaveVerticesPerVertexVector(const std::vector<Submesh>& submeshes, const glm::vec3& meshID, FloatBuffer& vertexBuffer) {
+		size_t from = 0;
+		for (const Submesh& submesh : submeshes) {
+			for (uint32_t i = 0; i < submesh.VertexCount; i++) {
+				glm::vec2 textureCoords = { 0.0f, 0.0f };
+				if (!submesh.TextureCoords.empty())
+					textureCoords = submesh.TextureCoords[i];
+				glm::vec3 normals = { 0.0f, 0.0f, 0.0f };
+				if (!submesh.Normals.empty())
+					normals = submesh.Normals[i];
+				glm::vec3 tangents = { 0.0f, 0.0f, 0.0f };
+				if (!submesh.Tangents.empty())
+					tangents = submesh.Tangents[i];
+				glm::vec3 biTangents = { 0.0f, 0.0f, 0.0f };
+				if (!submesh.BiTangents.empty())
+					biTangents = submesh.BiTangents[i];
+
+				std::vector<float> vertex = {
+					submesh.Vertices[i].x, submesh.Vertices[i].y, submesh.Vertices[i].z,
+					meshID.x, meshID.y, meshID.z,
+					textureCoords.x, textureCoords.y,
+					normals.x, normals.y, normals.z,
+					tangents.x, tangents.y, tangents.z,
+					biTangents.x, biTangents.y, biTangents.z
+				};
+				vertexBuffer.SetData(vertex, from);
+				from += vertex.size();
+			}
+		}
+	}
+
+	static glm::vec3 ReadVec3(const float* data) {
+		return glm::vec3(data[0], data[1], data[2]);
+	}
+
+	LUCY_TEST(MeshInterleavesTheSubmeshAttributes) {
+		std::mt19937 random(42);
+		std::vector<Submesh> submeshes;
+		submeshes.push_back(CreateTestSubmesh(5, random));
+		submeshes.push_back(CreateTestSubmesh(3, random, false, false));
+		const glm::vec3 meshID(1.0f, 2.0f, 3.0f);
+
+		std::vector<float> interleaved(8 * floatCount + 1, -1.0f);
+		Mesh::InterleaveVertices(submeshes, meshID, interleaved.data());
+		LUCY_CHECK(interleaved.back() == -1.0f); //nothing is written past the last vertex
+
+		FloatBuffer expected;
+		expected.Resize(8 * floatCount);
+		InterleaveVerticesPerVertexVector(submeshes, meshID, expected);
+		LUCY_CHECK(memcmp(interleaved.data(), &expected[0], 8 * floatCount * sizeof(float)) == 0);
+
+		//the missing attributes of the second submesh are zeroed, not left over from the first one
+		const float* vertex = &interleaved[6 * floatCount];
+		LUCY_CHECK(ReadVec3(vertex) == submeshes[1].Vertices[1]);
+		LUCY_CHECK(ReadVec3(vertex + 3) == meshID);
+		LUCY_CHECK(vertex[6] == 0.0f && vertex[7] == 0.0f);
+		LUCY_CHECK(ReadVec3(vertex + 8) == submeshes[1].Normals[1]);
+		LUCY_CHECK(ReadVec3(vertex + 11) == glm::vec3(0.0f));
+		LUCY_CHECK(ReadVec3(vertex + 14) == glm::vec3(0.0f));
+	}
+
+	//the vertex counts of Sponza (LucyEditor/Assets/Models/Sponza): 103 submeshes with 192496 vertices
+	LUCY_TEST(MeshInterleaveBenchmark) {
+		static constexpr uint32_t submeshCount = 103;
+		static constexpr uint32_t vertexCount = 192496;
+		static constexpr uint32_t runCount = 10;
+
+		std::mt19937 random(42);
+		std::vector<Submesh> submeshes;
+		for (uint32_t i = 0; i < submeshCount; i++) {
+			const uint32_t submeshVertexCount = vertexCount / submeshCount + (i < vertexCount % submeshCount ? 1 : 0);
+			//a few of the submeshes have no texture coordinates and tangents
+			submeshes.push_back(CreateTestSubmesh(submeshVertexCount, random, i % 10 != 0, i % 10 != 0));
+		}
+		const glm::vec3 meshID(1.0f, 0.0f, 0.0f);
+
+		//the mapped staging memory
+		std::vector<float> stagingMemory(vertexCount * (size_t)floatCount);
+		FloatBuffer vertexBuffer;
+		vertexBuffer.Resize(stagingMemory.size());
+
+		double milliseconds[2] = {};
+		size_t allocationCount[2] = {};
+		for (uint32_t run = 0; run < runCount; run++) {
+			allocationCount[0] += CountAllocations([&]() {
+				milliseconds[0] += MeasureMilliseconds([&]() { InterleaveVerticesPerVertexVector(submeshes, meshID, vertexBuffer); });
+			});
+			allocationCount[1] += CountAllocations([&]() {
+				milliseconds[1] += MeasureMilliseconds([&]() { Mesh::InterleaveVertices(submeshes, meshID, stagingMemory.data()); });
+			});
+		}
+
+		LUCY_INFO("Interleaving {0} vertices of {1} submeshes: {2:.2f} ms and {3} allocations with a vector per vertex, {4:.2f} ms and {5} allocations in place ({6:.1f}x)",
+				  vertexCount, submeshCount, milliseconds[0] / runCount, allocationCount[0] / runCount, milliseconds[1] / runCount, allocationCount[1] / runCount,
+				  milliseconds[0] / milliseconds[1]);
+		LUCY_CHECK(memcmp(stagingMemory.data(), &vertexBuffer[0], stagingMemory.size() * sizeof(float)) == 0);
+		LUCY_CHECK(allocationCount[0] >= (size_t)vertexCount * runCount);
+		LUCY_CHECK(allocationCount[1] == 0);
+	}
+}
@@ -0,0 +1,155 @@
+#include "lypch.h"
+#include "Test.h"
+#include "TestMeshes.h"
+
+#include "Renderer/MeshLOD.h"
+
+namespace Lucy::Tests {
+
+	//closest point on the triangle (Ericson, Real-Time Collision Detection 5.1.5)
+	static glm::vec3 ClosestPointOnTriangle(const glm::vec3& p, const glm::vec3& a, const glm::vec3& b, const glm::vec3& c) {
+		const glm::vec3 ab = b - a;
+		const glm::vec3 ac = c - a;
+
+		const glm::vec3 ap = p - a;
+		const float d1 = glm::dot(ab, ap);
+		const float d2 = glm::dot(ac, ap);
+		if (d1 <= 0.0f && d2 <= 0.0f)
+			return a;
+
+		const glm::vec3 bp = p - b;
+		const float d3 = glm::dot(ab, bp);
+		const float d4 = glm::dot(ac, bp);
+		if (d3 >= 0.0f && d4 <= d3)
+			return b;
+
+		const float vc = d1 * d4 - d3 * d2;
+		if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f)
+			return a + ab * (d1 / (d1 - d3));
+
+		const glm::vec3 cp = p - c;
+		const float d5 = glm::dot(ab, cp);
+		const float d6 = glm::dot(ac, cp);
+		if (d6 >= 0.0f && d5 <= d6)
+			return c;
+
+		const float vb = d5 * d2 - d1 * d6;
+		if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f)
+			return a + ac * (d2 / (d2 - d6));
+
+		const float va = d3 * d6 - d5 * d4;
+		if (va <= 0.0f && d4 - d3 >= 0.0f && d5 - d6 >= 0.0f)
+			return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+
+		const float denominator = 1.0f / (va + vb + vc);
+		return a + ab * (vb * denominator) + ac * (vc * denominator);
+	}
+
+	static float DistanceToSurface(const glm::vec3& point, const std::vector<glm::vec3>& positions, const std::vector<uint32_t>& indices) {
+		float distance = FLT_MAX;
+		for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+			const glm::vec3 closest = ClosestPointOnTriangle(point, positions[indices[i]], positions[indices[i + 1]], positions[indices[i + 2]]);
+			distance = glm::min(distance, glm::length(point - closest));
+		}
+		return distance;
+	}
+
+	//the deviation between both surfaces, measured at the vertices of the original and at samples of the simplified triangles
+	static float MeasureDeviation(const TestMesh& mesh, const std::vector<uint32_t>& simplifiedIndices) {
+		float deviation = 0.0f;
+		for (const glm::vec3& position : mesh.Positions)
+			deviation = glm::max(deviation, DistanceToSurface(position, mesh.Positions, simplifiedIndices));
+
+		static constexpr glm::vec2 samples[] = { { 1.0f / 3.0f, 1.0f / 3.0f }, { 0.5f, 0.0f }, { 0.0f, 0.5f }, { 0.5f, 0.5f }, { 0.25f, 0.25f } };
+		for (size_t i = 0; i + 2 < simplifiedIndices.size(); i += 3) {
+			const glm::vec3& p0 = mesh.Positions[simplifiedIndices[i]];
+			const glm::vec3& p1 = mesh.Positions[simplifiedIndices[i + 1]];
+			const glm::vec3& p2 = mesh.Positions[simplifiedIndices[i + 2]];
+			for (const glm::vec2& uv : samples)
+				deviation = glm::max(deviation, DistanceToSurface(p0 * (1.0f - uv.x - uv.y) + p1 * uv.x + p2 * uv.y, mesh.Positions, mesh.Indices));
+		}
+		return deviation;
+	}
+
+	LUCY_TEST(MeshSimplifierStaysWithinTheErrorBound) {
+		const TestMesh mesh = CreateSphereMesh(24, 48);
+
+		for (float targetError : { 0.01f, 0.02f, 0.05f, 0.1f }) {
+			std::vector<uint32_t> simplified;
+			const float error = MeshSimplifier::Simplify(mesh.Positions, mesh.Indices, mesh.Indices.size() / 8, targetError, simplified);
+
+			LUCY_CHECK(error <= targetError);
+			LUCY_CHECK(simplified.size() < mesh.Indices.size());
+			LUCY_CHECK(simplified.size() % 3 == 0);
+			//the reported error is an upper bound of what actually changed
+			LUCY_CHECK(MeasureDeviation(mesh, simplified) <= error + 1e-4f);
+
+			//no triangle has been turned around
+			for (size_t i = 0; i + 2 < simplified.size(); i += 3) {
+				const glm::vec3 centroid = (mesh.Positions[simplified[i]] + mesh.Positions[simplified[i + 1]] + mesh.Positions[simplified[i + 2]]) / 3.0f;
+				const glm::vec3 normal = glm::cross(mesh.Positions[simplified[i + 1]] - mesh.Positions[simplified[i]],
+													mesh.Positions[simplified[i + 2]] - mesh.Positions[simplified[i]]);
+				LUCY_CHECK(glm::dot(normal, centroid) > 0.0f);
+			}
+		}
+	}
+
+	LUCY_TEST(MeshSimplifierKeepsAFlatPatch) {
+		const TestMesh mesh = CreateGridMesh(16);
+
+		std::vector<uint32_t> simplified;
+		const float error = MeshSimplifier::Simplify(mesh.Positions, mesh.Indices, mesh.Indices.size() / 4, 0.001f, simplified);
+
+		//the interior of a plane collapses without any error, the locked border keeps the outline
+		LUCY_CHECK(error <= 1e-5f);
+		LUCY_CHECK(simplified.size() <= mesh.Indices.size() / 2);
+
+		float area = 0.0f;
+		for (size_t i = 0; i + 2 < simplified.size(); i += 3) {
+			const glm::vec3 normal = glm::cross(mesh.Positions[simplified[i + 1]] - mesh.Positions[simplified[i]],
+												mesh.Positions[simplified[i + 2]] - mesh.Positions[simplified[i]]);
+			LUCY_CHECK(normal.z > 0.0f);
+			area += glm::length(normal) * 0.5f;
+		}
+		LUCY_CHECK(glm::abs(area - 1.0f) < 1e-4f);
+	}
+
+	LUCY_TEST(MeshSimplifierWithoutErrorBudget) {
+		const TestMesh mesh = CreateSphereMesh(8, 16);
+
+		std::vector<uint32_t> simplified;
+		const float error = MeshSimplifier::Simplify(mesh.Positions, mesh.Indices, mesh.Indices.size() / 2, 0.0f, simplified);
+
+		//every collapse on a curved surface has a cost, so nothing changes
+		LUCY_CHECK(error == 0.0f);
+		LUCY_CHECK(simplified == mesh.Indices);
+	}
+
+	LUCY_TEST(LODSelectorHysteresis) {
+		static constexpr uint32_t lodCount = 3;
+
+		LUCY_CHECK(LODSelector::Select(1.0f, 0, lodCount) == 0);
+		LUCY_CHECK(LODSelector::Select(0.01f, 0, lodCount) == lodCount - 1);
+		LUCY_CHECK(LODSelector::Select(0.01f, 0, 1) == 0);
+
+		//just below the threshold of LOD 1 (0.5), but still inside of the band
+		LUCY_CHECK(LODSelector::Select(0.48f, 0, lodCount) == 0);
+		LUCY_CHECK(LODSelector::Select(0.40f, 0, lodCount) == 1);
+		//just above it, LOD 1 is kept until the screen size leaves the band
+		LUCY_CHECK(LODSelector::Select(0.52f, 1, lodCount) == 1);
+		LUCY_CHECK(LODSelector::Select(0.60f, 1, lodCount) == 0);
+
+		//a LOD that does not exist (anymore) is clamped
+		LUCY_CHECK(LODSelector::Select(0.01f, 4, lodCount) == lodCount - 1);
+	}
+
+	LUCY_TEST(LODSelectorScreenSize) {
+		const float projectionScaleY = 1.0f / glm::tan(glm::radians(45.0f) * 0.5f);
+
+		const float nearSize = LODSelector::ComputeScreenSize(glm::vec3(0.0f, 0.0f, -10.0f), 1.0f, glm::vec3(0.0f), projectionScaleY);
+		const float farSize = LODSelector::ComputeScreenSize(glm::vec3(0.0f, 0.0f, -20.0f), 1.0f, glm::vec3(0.0f), projectionScaleY);
+		LUCY_CHECK(glm::abs(nearSize - 2.0f * farSize) < 1e-5f);
+		//the camera is inside of the bounds
+		LUCY_CHECK(LODSelector::ComputeScreenSize(glm::vec3(0.0f), 1.0f, glm::vec3(0.5f, 0.0f, 0.0f), projectionScaleY) == FLT_MAX);
+	}
+}
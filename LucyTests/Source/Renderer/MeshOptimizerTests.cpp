@@ -0,0 +1,91 @@
+#include "lypch.h"
+#include "Test.h"
+#include "TestMeshes.h"
+
+#include <random>
+#include <deque>
+
+#include "Renderer/MeshOptimizer.h"
+
+namespace Lucy::Tests {
+
+	static std::vector<uint32_t> ShuffleTriangles(const std::vector<uint32_t>& indices, uint32_t seed) {
+		std::vector<uint32_t> triangles(indices.size() / 3);
+		std::iota(triangles.begin(), triangles.end(), 0u);
+		std::shuffle(triangles.begin(), triangles.end(), std::mt19937(seed));
+
+		std::vector<uint32_t> shuffled;
+		shuffled.reserve(indices.size());
+		for (uint32_t t : triangles)
+			shuffled.insert(shuffled.end(), { indices[t * 3 + 0], indices[t * 3 + 1], indices[t * 3 + 2] });
+		return shuffled;
+	}
+
+	//every triangle is rotated so that it starts with its smallest index, which keeps the winding
+	static std::vector<std::array<uint32_t, 3>> GetSortedTriangles(const std::vector<uint32_t>& indices) {
+		std::vector<std::array<uint32_t, 3>> triangles;
+		for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+			std::array<uint32_t, 3> triangle = { indices[i], indices[i + 1], indices[i + 2] };
+			std::rotate(triangle.begin(), std::min_element(triangle.begin(), triangle.end()), triangle.end());
+			triangles.push_back(triangle);
+		}
+		std::sort(triangles.begin(), triangles.end());
+		return triangles;
+	}
+
+	//straightforward FIFO cache, to check the timestamp based simulation against
+	static float ComputeReferenceACMR(const std::vector<uint32_t>& indices, uint32_t cacheSize) {
+		std::deque<uint32_t> cache;
+		uint32_t misses = 0;
+		for (uint32_t index : indices) {
+			if (std::find(cache.begin(), cache.end(), index) != cache.end())
+				continue;
+			misses++;
+			cache.push_back(index);
+			if (cache.size() > cacheSize)
+				cache.pop_front();
+		}
+		return (float)misses / (float)(indices.size() / 3);
+	}
+
+	LUCY_TEST(MeshOptimizerCacheSimulation) {
+		const TestMesh mesh = CreateSphereMesh(16, 32);
+
+		for (uint32_t seed = 0; seed < 4; seed++) {
+			const std::vector<uint32_t> shuffled = ShuffleTriangles(mesh.Indices, seed);
+			for (uint32_t cacheSize : { 4u, MESH_VERTEX_CACHE_SIZE, 32u }) {
+				const VertexCacheStatistics statistics = MeshOptimizer::AnalyzeVertexCache(shuffled, mesh.Positions.size(), cacheSize);
+				LUCY_CHECK(statistics.ACMR == ComputeReferenceACMR(shuffled, cacheSize));
+				LUCY_CHECK(statistics.ATVR >= 1.0f);
+			}
+		}
+
+		//a single triangle misses with every vertex
+		const VertexCacheStatistics single = MeshOptimizer::AnalyzeVertexCache({ 0, 1, 2 }, 3, MESH_VERTEX_CACHE_SIZE);
+		LUCY_CHECK(single.ACMR == 3.0f && single.ATVR == 1.0f);
+	}
+
+	LUCY_TEST(MeshOptimizerReducesACMR) {
+		for (const TestMesh& mesh : { CreateGridMesh(32), CreateSphereMesh(32, 64) }) {
+			std::vector<uint32_t> indices = ShuffleTriangles(mesh.Indices, 29);
+			const float shuffledACMR = MeshOptimizer::AnalyzeVertexCache(indices, mesh.Positions.size(), MESH_VERTEX_CACHE_SIZE).ACMR;
+
+			MeshOptimizer::OptimizeVertexCache(indices, mesh.Positions.size());
+			const float cacheACMR = MeshOptimizer::AnalyzeVertexCache(indices, mesh.Positions.size(), MESH_VERTEX_CACHE_SIZE).ACMR;
+
+			//a regular grid can reach ~0.5 with an infinite cache, a random order is close to 3
+			LUCY_CHECK(shuffledACMR > 2.5f);
+			LUCY_CHECK(cacheACMR < 0.8f);
+			LUCY_CHECK(cacheACMR <= ComputeReferenceACMR(mesh.Indices, MESH_VERTEX_CACHE_SIZE));
+			LUCY_CHECK(GetSortedTriangles(indices) == GetSortedTriangles(mesh.Indices));
+
+			static constexpr float threshold = 1.05f;
+			MeshOptimizer::OptimizeOverdraw(indices, mesh.Positions, threshold);
+			const float overdrawACMR = MeshOptimizer::AnalyzeVertexCache(indices, mesh.Positions.size(), MESH_VERTEX_CACHE_SIZE).ACMR;
+
+			//the threshold bounds each split off part of a cluster, the remainder of a cluster isn't split any further, hence the small slack
+			LUCY_CHECK(overdrawACMR <= cacheACMR * threshold + 0.01f);
+			LUCY_CHECK(GetSortedTriangles(indices) == GetSortedTriangles(mesh.Indices));
+		}
+	}
+}
@@ -0,0 +1,129 @@
+#include "lypch.h"
+#include "Test.h"
+#include "TestMeshes.h"
+
+#include <random>
+
+#include "Renderer/Meshlet.h"
+
+namespace Lucy::Tests {
+
+	LUCY_TEST(MeshletBuilderRespectsLimits) {
+		const TestMesh mesh = CreateSphereMesh(32, 64);
+
+		std::vector<Meshlet> meshlets;
+		MeshletBuilder::Build(mesh.Positions, mesh.Indices, meshlets);
+		LUCY_CHECK(!meshlets.empty());
+
+		uint32_t nextIndex = 0;
+		for (const Meshlet& meshlet : meshlets) {
+			//the meshlets are contiguous ranges of the index buffer
+			LUCY_CHECK(meshlet.FirstIndex == nextIndex);
+			LUCY_CHECK(meshlet.IndexCount > 0 && meshlet.IndexCount % 3 == 0);
+			LUCY_CHECK(meshlet.IndexCount / 3 <= MESHLET_MAX_TRIANGLES);
+			nextIndex += meshlet.IndexCount;
+
+			std::unordered_set<uint32_t> uniqueVertices(mesh.Indices.begin() + meshlet.FirstIndex, mesh.Indices.begin() + meshlet.FirstIndex + meshlet.IndexCount);
+			LUCY_CHECK(meshlet.VertexCount == uniqueVertices.size());
+			LUCY_CHECK(meshlet.VertexCount <= MESHLET_MAX_VERTICES);
+		}
+		LUCY_CHECK(nextIndex == mesh.Indices.size());
+	}
+
+	LUCY_TEST(MeshletBoundsContainTheirVertices) {
+		const TestMesh mesh = CreateSphereMesh(16, 32);
+
+		std::vector<Meshlet> meshlets;
+		MeshletBuilder::Build(mesh.Positions, mesh.Indices, meshlets);
+
+		for (const Meshlet& meshlet : meshlets) {
+			for (uint32_t i = meshlet.FirstIndex; i < meshlet.FirstIndex + meshlet.IndexCount; i++)
+				LUCY_CHECK(glm::length(mesh.Positions[mesh.Indices[i]] - meshlet.Center) <= meshlet.Radius * 1.0001f + 1e-5f);
+		}
+	}
+
+	LUCY_TEST(MeshletConeOfAFlatPatch) {
+		const TestMesh mesh = CreateGridMesh(4);
+
+		std::vector<Meshlet> meshlets;
+		MeshletBuilder::Build(mesh.Positions, mesh.Indices, meshlets);
+		LUCY_CHECK(meshlets.size() == 1);
+		if (meshlets.empty())
+			return;
+
+		const Meshlet& meshlet = meshlets[0];
+		LUCY_CHECK(glm::dot(meshlet.ConeAxis, glm::vec3(0.0f, 0.0f, 1.0f)) > 0.999f);
+		LUCY_CHECK(meshlet.ConeCutoff < 0.01f);
+
+		const Maths::Frustum everything = Maths::ExtractFrustum(glm::ortho(-100.0f, 100.0f, -100.0f, 100.0f, -100.0f, 100.0f));
+		const glm::vec3 inFront = glm::vec3(0.5f, 0.5f, 5.0f);
+		const glm::vec3 behind = glm::vec3(0.5f, 0.5f, -5.0f);
+
+		LUCY_CHECK(MeshletCuller::IsVisible(meshlet, glm::mat4(1.0f), everything, inFront));
+		LUCY_CHECK(!MeshletCuller::IsVisible(meshlet, glm::mat4(1.0f), everything, behind));
+		//without cone culling, only the frustum decides
+		LUCY_CHECK(MeshletCuller::IsVisible(meshlet, glm::mat4(1.0f), everything, behind, false));
+
+		//the patch is flipped by the model matrix, so the camera behind it looks at its front
+		const glm::mat4 flipped = glm::rotate(glm::mat4(1.0f), glm::pi<float>(), glm::vec3(0.0f, 1.0f, 0.0f));
+		LUCY_CHECK(MeshletCuller::IsVisible(meshlet, flipped, everything, glm::vec3(-0.5f, 0.5f, -5.0f)));
+	}
+
+	LUCY_TEST(MeshletFrustumCulling) {
+		const TestMesh mesh = CreateGridMesh(2);
+
+		std::vector<Meshlet> meshlets;
+		MeshletBuilder::Build(mesh.Positions, mesh.Indices, meshlets);
+		if (meshlets.empty()) {
+			LUCY_CHECK(!meshlets.empty());
+			return;
+		}
+
+		const glm::mat4 proj = glm::perspective(glm::radians(60.0f), 1.0f, 0.1f, 100.0f);
+		const glm::vec3 cameraPosition = glm::vec3(0.5f, 0.5f, 10.0f);
+		const glm::mat4 view = glm::lookAt(cameraPosition, glm::vec3(0.5f, 0.5f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+		const Maths::Frustum frustum = Maths::ExtractFrustum(proj * view);
+
+		LUCY_CHECK(MeshletCuller::IsVisible(meshlets[0], glm::mat4(1.0f), frustum, cameraPosition));
+		//moved far to the side and behind the far plane
+		LUCY_CHECK(!MeshletCuller::IsVisible(meshlets[0], glm::translate(glm::mat4(1.0f), glm::vec3(50.0f, 0.0f, 0.0f)), frustum, cameraPosition, false));
+		LUCY_CHECK(!MeshletCuller::IsVisible(meshlets[0], glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -200.0f)), frustum, cameraPosition, false));
+	}
+
+	//the cone test has to be conservative: a meshlet is only culled, if every one of its triangles faces away from the camera
+	LUCY_TEST(MeshletConeCullingIsConservative) {
+		const TestMesh mesh = CreateSphereMesh(24, 48);
+
+		std::vector<Meshlet> meshlets;
+		MeshletBuilder::Build(mesh.Positions, mesh.Indices, meshlets);
+
+		const Maths::Frustum everything = Maths::ExtractFrustum(glm::ortho(-100.0f, 100.0f, -100.0f, 100.0f, -100.0f, 100.0f));
+
+		std::mt19937 random(27);
+		std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+
+		uint32_t culledCount = 0;
+		for (uint32_t i = 0; i < 64; i++) {
+			glm::vec3 direction = glm::vec3(distribution(random), distribution(random), distribution(random));
+			if (glm::length(direction) < 0.01f)
+				continue;
+			const glm::vec3 cameraPosition = glm::normalize(direction) * (1.5f + 8.0f * glm::abs(distribution(random)));
+
+			for (const Meshlet& meshlet : meshlets) {
+				if (MeshletCuller::IsVisible(meshlet, glm::mat4(1.0f), everything, cameraPosition))
+					continue;
+				culledCount++;
+
+				for (uint32_t index = meshlet.FirstIndex; index < meshlet.FirstIndex + meshlet.IndexCount; index += 3) {
+					const glm::vec3 normal = GetTriangleNormal(mesh, index);
+					if (glm::length(normal) <= FLT_EPSILON)
+						continue;
+					const glm::vec3& p0 = mesh.Positions[mesh.Indices[index]];
+					LUCY_CHECK(glm::dot(normal, cameraPosition - p0) <= 0.0f);
+				}
+			}
+		}
+		//the test would pass trivially, if nothing was culled
+		LUCY_CHECK(culledCount > 0);
+	}
+}
@@ -0,0 +1,68 @@
+#include "lypch.h"
+#include "Test.h"
+
+#include <atomic>
+#include <thread>
+
+#include "Renderer/Shader/ShaderBindingTable.h"
+
+namespace Lucy::Tests {
+
+	LUCY_TEST(ShaderBindingTableResolvesNames) {
+		ShaderBindingTable table;
+		const ShaderBindingHandle camera = table.Add("LucyCamera");
+		const ShaderBindingHandle textures = table.Add("u_Textures");
+		LUCY_CHECK(camera.IsValid() && textures.IsValid());
+		LUCY_CHECK(camera.Index == 0 && textures.Index == 1);
+
+		LUCY_CHECK(table.Find("LucyCamera").Index == camera.Index);
+		LUCY_CHECK(table.Find("u_Textures").Index == textures.Index);
+
+		//a reload adds the same names again, they keep their handles. A new binding is appended
+		LUCY_CHECK(table.Add("u_Textures").Index == textures.Index);
+		LUCY_CHECK(table.Add("LucyCamera").Index == camera.Index);
+		LUCY_CHECK(table.Add("u_ShadowMap").Index == 2);
+		LUCY_CHECK(table.GetSize() == 3);
+	}
+
+	LUCY_TEST(ShaderBindingTableRejectsUnknownNames) {
+		ShaderBindingTable table;
+		LUCY_CHECK(!table.Find("LucyCamera").IsValid());
+
+		table.Add("LucyCamera");
+		LUCY_CHECK(!table.Find("lucyCamera").IsValid());
+		LUCY_CHECK(!table.Find("").IsValid());
+		LUCY_CHECK(!ShaderBindingHandle{}.IsValid());
+		LUCY_CHECK(table.GetSize() == 1);
+	}
+
+	//a shader reload adds its bindings on the render thread, while the passes resolve theirs on the main thread
+	LUCY_TEST(ShaderBindingTableConcurrentLookups) {
+		static constexpr uint32_t nameCount = 2000;
+		ShaderBindingTable table;
+		table.Add("LucyCamera");
+
+		std::atomic<bool> isAdding = true;
+		std::thread renderThread([&]() {
+			for (uint32_t i = 0; i < nameCount; i++)
+				table.Add(std::format("Binding{}", i));
+			isAdding = false;
+		});
+
+		uint32_t lookups = 0;
+		bool isConsistent = true;
+		while (isAdding || lookups == 0) {
+			isConsistent &= table.Find("LucyCamera").Index == 0;
+			//either not added yet or at its final index
+			const ShaderBindingHandle handle = table.Find(std::format("Binding{}", lookups % nameCount));
+			isConsistent &= !handle.IsValid() || handle.Index == lookups % nameCount + 1;
+			lookups++;
+		}
+		renderThread.join();
+
+		LUCY_CHECK(isConsistent);
+		LUCY_CHECK(table.GetSize() == nameCount + 1);
+		for (uint32_t i = 0; i < nameCount; i++)
+			LUCY_CHECK(table.Find(std::format("Binding{}", i)).Index == i + 1);
+	}
+}
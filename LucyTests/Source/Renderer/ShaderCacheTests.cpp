@@ -0,0 +1,132 @@
+#include "lypch.h"
+#include "Test.h"
+
+#include "shaderc/shaderc.hpp"
+
+#include "Renderer/Shader/ShaderCache.h"
+
+namespace Lucy::Tests {
+
+	//resolves the includes from the folder of the test, like CustomShaderIncluder does from the shader folder
+	class TestShaderIncluder final : public shaderc::CompileOptions::IncluderInterface {
+	public:
+		TestShaderIncluder(const std::filesystem::path& folder)
+			: m_Folder(folder) {
+		}
+		virtual ~TestShaderIncluder() = default;
+
+		shaderc_include_result* GetInclude(const char* requestedSource, shaderc_include_type, const char*, size_t) final override {
+			IncludeData* data = new IncludeData();
+			data->SourceName = requestedSource;
+			std::ifstream file(m_Folder / requestedSource, std::ios::in | std::ios::binary);
+			data->Content.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+			data->Result = { data->SourceName.c_str(), data->SourceName.size(), data->Content.c_str(), data->Content.size(), data };
+			return &data->Result;
+		}
+
+		void ReleaseInclude(shaderc_include_result* result) final override {
+			delete (IncludeData*)result->user_data;
+		}
+	private:
+		struct IncludeData {
+			std::string SourceName;
+			std::string Content;
+			shaderc_include_result Result;
+		};
+		std::filesystem::path m_Folder;
+	};
+
+	struct ShaderCacheTestFolder {
+		std::filesystem::path Folder = std::filesystem::temp_directory_path() / "LucyTests" / "ShaderCache";
+
+		ShaderCacheTestFolder() {
+			std::filesystem::create_directories(Folder);
+			WriteFile("Common.glsl", "layout(binding = 0) buffer Output { uint Values[]; };\nvoid Store(uint value) { Values[gl_GlobalInvocationID.x] = value; }\n");
+			WriteFile("Test.comp", "#version 450\n#include \"Common.glsl\"\nlayout(local_size_x = LOCAL_SIZE) in;\nvoid main() { Store(1); }\n");
+		}
+
+		~ShaderCacheTestFolder() {
+			std::error_code errorCode;
+			std::filesystem::remove_all(Folder, errorCode);
+		}
+
+		void WriteFile(const std::string& name, const std::string& content) const {
+			std::ofstream(Folder / name, std::ios::out | std::ios::binary | std::ios::trunc) << content;
+		}
+
+		//the key, that Shader::LoadSPIRVData looks the compute stage up with
+		uint64_t ComputeKey(const std::string& localSize = "64") const {
+			std::ifstream file(Folder / "Test.comp", std::ios::in | std::ios::binary);
+			const std::string source((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+			shaderc::Compiler compiler;
+			shaderc::CompileOptions options;
+			options.SetIncluder(std::make_unique<TestShaderIncluder>(Folder));
+			options.AddMacroDefinition("LOCAL_SIZE", localSize);
+
+			const shaderc::PreprocessedSourceCompilationResult preprocessed = compiler.PreprocessGlsl(source, shaderc_compute_shader, "Test.comp", options);
+			LUCY_CHECK(preprocessed.GetCompilationStatus() == shaderc_compilation_status_success);
+			return ShaderCache::ComputeKey(std::string_view(preprocessed.cbegin(), preprocessed.cend()), ShaderCache::ComputeOptionsHash("settings"),
+										   (uint32_t)shaderc_compute_shader);
+		}
+	};
+
+	LUCY_TEST(ShaderCacheHitsUnchangedSource) {
+		const ShaderCacheTestFolder test;
+		const std::filesystem::path entryPath = test.Folder / "Test.comp.spv";
+		const std::vector<uint32_t> spirv = { 0x07230203, 0x00010500, 1, 2, 3 };
+
+		const uint64_t key = test.ComputeKey();
+		LUCY_CHECK(key == test.ComputeKey());
+		LUCY_CHECK(!ShaderCache::IsEntryValid(entryPath, key));
+
+		ShaderCache::WriteEntry(entryPath, spirv, key, test.Folder / "Test.comp");
+		LUCY_CHECK(ShaderCache::IsEntryValid(entryPath, key));
+		LUCY_CHECK(ShaderCache::LoadEntry(entryPath) == spirv);
+
+		LUCY_CHECK(!ShaderCache::IsEntryValid(entryPath, key ^ 1));
+		//an entry without its metadata is never used
+		std::filesystem::remove(std::filesystem::path(entryPath).concat(".meta"));
+		LUCY_CHECK(!ShaderCache::IsEntryValid(entryPath, key));
+	}
+
+	LUCY_TEST(ShaderCacheMissesChangedSource) {
+		const ShaderCacheTestFolder test;
+		const std::filesystem::path entryPath = test.Folder / "Test.comp.spv";
+
+		const uint64_t key = test.ComputeKey();
+		ShaderCache::WriteEntry(entryPath, { 0x07230203 }, key, test.Folder / "Test.comp");
+
+		//an edited stage
+		test.WriteFile("Test.comp", "#version 450\n#include \"Common.glsl\"\nlayout(local_size_x = LOCAL_SIZE) in;\nvoid main() { Store(2); }\n");
+		const uint64_t editedSourceKey = test.ComputeKey();
+		LUCY_CHECK(editedSourceKey != key);
+		LUCY_CHECK(!ShaderCache::IsEntryValid(entryPath, editedSourceKey));
+
+		//an edited include, the stage itself is the same
+		test.WriteFile("Test.comp", "#version 450\n#include \"Common.glsl\"\nlayout(local_size_x = LOCAL_SIZE) in;\nvoid main() { Store(1); }\n");
+		LUCY_CHECK(test.ComputeKey() == key);
+		test.WriteFile("Common.glsl", "layout(binding = 0) buffer Output { uint Values[]; };\nvoid Store(uint value) { Values[gl_GlobalInvocationID.x] = value + 1; }\n");
+		const uint64_t editedIncludeKey = test.ComputeKey();
+		LUCY_CHECK(editedIncludeKey != key);
+		LUCY_CHECK(!ShaderCache::IsEntryValid(entryPath, editedIncludeKey));
+
+		//another value of a macro, that the stage uses
+		const uint64_t defineKey = test.ComputeKey("32");
+		LUCY_CHECK(defineKey != editedIncludeKey);
+		LUCY_CHECK(!ShaderCache::IsEntryValid(entryPath, defineKey));
+
+		//the rewritten entry (also after a hot reload) is used from then on
+		ShaderCache::WriteEntry(entryPath, { 0x07230203 }, defineKey, test.Folder / "Test.comp");
+		LUCY_CHECK(ShaderCache::IsEntryValid(entryPath, defineKey));
+		LUCY_CHECK(!ShaderCache::IsEntryValid(entryPath, key));
+	}
+
+	LUCY_TEST(ShaderCacheKeyIsStable) {
+		//written into the metadata by one run and compared by the next, so the key may not depend on the process or the standard library
+		LUCY_CHECK(ShaderCache::ComputeOptionsHash("") == 0xcbf29ce484222325ull);
+		LUCY_CHECK(ShaderCache::ComputeKey("void main() {}", 1, 2) == ShaderCache::ComputeKey("void main() {}", 1, 2));
+		LUCY_CHECK(ShaderCache::ComputeKey("void main() {}", 1, 2) != ShaderCache::ComputeKey("void main() {}", 1, 3));
+		LUCY_CHECK(ShaderCache::ComputeKey("void main() {}", 1, 2) != ShaderCache::ComputeKey("void main() {}", 2, 2));
+	}
+}
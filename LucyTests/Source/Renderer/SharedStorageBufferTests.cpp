@@ -0,0 +1,70 @@
+#include "lypch.h"
+#include "Test.h"
+
+#include "Renderer/Shader/ShaderReflect.h" //for ShaderMemberVariable
+#include "Renderer/Memory/Buffer/SharedStorageBuffer.h"
+
+namespace Lucy::Tests {
+
+	LUCY_TEST(SharedStorageBufferGrows) {
+		uint32_t underusedUploadCount = 0;
+
+		//never below the minimum, always a multiple of it
+		LUCY_CHECK(SharedStorageBuffer::AlignCapacity(0) == SharedStorageBuffer::s_MinCapacity);
+		LUCY_CHECK(SharedStorageBuffer::AlignCapacity(SharedStorageBuffer::s_MinCapacity + 1) == 2 * SharedStorageBuffer::s_MinCapacity);
+
+		//a little more than fits doubles the capacity, a lot more takes the required size
+		LUCY_CHECK(SharedStorageBuffer::GetNewCapacity(1024, 1025, underusedUploadCount) == 2048);
+		LUCY_CHECK(SharedStorageBuffer::GetNewCapacity(1024, 5000, underusedUploadCount) == SharedStorageBuffer::AlignCapacity(5000));
+		LUCY_CHECK(SharedStorageBuffer::GetNewCapacity(1024, 1024, underusedUploadCount) == 1024);
+
+		//growing by a few bytes every upload only recreates the buffer a logarithmic number of times
+		size_t capacity = SharedStorageBuffer::s_MinCapacity;
+		uint32_t recreationCount = 0;
+		for (size_t requiredSize = 0; requiredSize <= 1024 * 1024; requiredSize += 64) {
+			const size_t newCapacity = SharedStorageBuffer::GetNewCapacity(capacity, requiredSize, underusedUploadCount);
+			LUCY_CHECK(newCapacity >= requiredSize);
+			recreationCount += newCapacity != capacity;
+			capacity = newCapacity;
+		}
+		LUCY_CHECK(recreationCount == 12);
+	}
+
+	LUCY_TEST(SharedStorageBufferShrinksAfterUnderusedUploads) {
+		static constexpr size_t capacity = 64 * 1024;
+		static constexpr size_t requiredSize = capacity / SharedStorageBuffer::s_ShrinkFactor;
+		uint32_t underusedUploadCount = 0;
+
+		for (uint32_t upload = 1; upload < SharedStorageBuffer::s_ShrinkAfterUploadCount; upload++)
+			LUCY_CHECK(SharedStorageBuffer::GetNewCapacity(capacity, requiredSize, underusedUploadCount) == capacity);
+		LUCY_CHECK(underusedUploadCount == SharedStorageBuffer::s_ShrinkAfterUploadCount - 1);
+
+		//twice of what is used, so that it isn't grown again right away
+		const size_t shrunkCapacity = SharedStorageBuffer::GetNewCapacity(capacity, requiredSize, underusedUploadCount);
+		LUCY_CHECK(shrunkCapacity == SharedStorageBuffer::AlignCapacity(requiredSize * SharedStorageBuffer::s_GrowthFactor));
+		LUCY_CHECK(shrunkCapacity < capacity);
+		LUCY_CHECK(underusedUploadCount == 0);
+
+		//the minimum capacity is never shrunk
+		for (uint32_t upload = 0; upload < 2 * SharedStorageBuffer::s_ShrinkAfterUploadCount; upload++)
+			LUCY_CHECK(SharedStorageBuffer::GetNewCapacity(SharedStorageBuffer::s_MinCapacity, 0, underusedUploadCount) == SharedStorageBuffer::s_MinCapacity);
+	}
+
+	LUCY_TEST(SharedStorageBufferKeepsCapacityInsideTheHysteresisBand) {
+		static constexpr size_t capacity = 64 * 1024;
+		uint32_t underusedUploadCount = 0;
+
+		//anything above a quarter, up to the capacity, is not underused
+		for (size_t requiredSize : { capacity / SharedStorageBuffer::s_ShrinkFactor + 1, capacity / 2, capacity }) {
+			for (uint32_t upload = 0; upload < 2 * SharedStorageBuffer::s_ShrinkAfterUploadCount; upload++)
+				LUCY_CHECK(SharedStorageBuffer::GetNewCapacity(capacity, requiredSize, underusedUploadCount) == capacity);
+			LUCY_CHECK(underusedUploadCount == 0);
+		}
+
+		//a single upload inside the band restarts the count, alternating spikes never shrink the buffer
+		for (uint32_t upload = 0; upload < 4 * SharedStorageBuffer::s_ShrinkAfterUploadCount; upload++) {
+			const size_t requiredSize = upload % 100 == 99 ? capacity / 2 : 16;
+			LUCY_CHECK(SharedStorageBuffer::GetNewCapacity(capacity, requiredSize, underusedUploadCount) == capacity);
+		}
+	}
+}
@@ -0,0 +1,158 @@
+#include "lypch.h"
+#include "Test.h"
+
+#include <random>
+
+#include "Renderer/Memory/VulkanStagingRing.h"
+
+namespace Lucy::Tests {
+
+	//the staging buffers are CPU memory, the handles are indices into it (starting at 1, so that they are never null)
+	class TestStagingRing final : public VulkanStagingRing {
+	public:
+		TestStagingRing(VkDeviceSize ringSize)
+			: VulkanStagingRing(ringSize) {
+			InitRing();
+		}
+
+		inline size_t GetLiveDedicatedBufferCount() const { return m_Buffers.size() - 1; } //without the ring
+		inline size_t GetCreatedBufferCount() const { return m_CreatedBufferCount; }
+	private:
+		void CreateStagingBuffer(VkDeviceSize size, VkBuffer& buffer, VmaAllocation& bufferVma, uint8_t*& mappedData) final override {
+			const uintptr_t handle = ++m_CreatedBufferCount;
+			std::vector<uint8_t>& memory = m_Buffers[handle];
+			memory.resize(size);
+
+			buffer = (VkBuffer)handle;
+			//never null, like a VMA allocation
+			bufferVma = (VmaAllocation)handle;
+			mappedData = memory.data();
+		}
+
+		void DestroyStagingBuffer(VkBuffer buffer, VmaAllocation bufferVma) final override {
+			LUCY_CHECK((uintptr_t)buffer == (uintptr_t)bufferVma);
+			LUCY_CHECK(m_Buffers.erase((uintptr_t)buffer) == 1);
+		}
+
+		std::unordered_map<uintptr_t, std::vector<uint8_t>> m_Buffers;
+		size_t m_CreatedBufferCount = 0;
+	};
+
+	static bool IsDedicated(const StagingAllocation& allocation) {
+		return allocation.DedicatedBufferVma != VK_NULL_HANDLE;
+	}
+
+	LUCY_TEST(StagingRingAllocatesInOrderAndWraps) {
+		TestStagingRing ring(1024);
+
+		//aligned and back to back
+		StagingAllocation a = ring.Allocate(100);
+		StagingAllocation b = ring.Allocate(200, 64);
+		StagingAllocation c = ring.Allocate(300);
+		LUCY_CHECK(!IsDedicated(a) && !IsDedicated(b) && !IsDedicated(c));
+		LUCY_CHECK(a.Offset == 0 && b.Offset == 128 && c.Offset == 336);
+		LUCY_CHECK(a.Buffer == b.Buffer && b.MappedData == a.MappedData + 128);
+
+		//more than half of the ring, nothing of it or an empty allocation get their own buffer
+		StagingAllocation large = ring.Allocate(513);
+		StagingAllocation empty = ring.Allocate(0);
+		LUCY_CHECK(IsDedicated(large) && large.Offset == 0 && large.Size == 513);
+		LUCY_CHECK(IsDedicated(empty) && empty.IsValid());
+		LUCY_CHECK(ring.GetLiveDedicatedBufferCount() == 2);
+		ring.Free(large);
+		ring.Free(empty);
+		LUCY_CHECK(ring.GetLiveDedicatedBufferCount() == 0);
+
+		//the rest of the ring [640, 1024), a range that does not fit into it does not wrap while the front is still in use
+		StagingAllocation d = ring.Allocate(384);
+		LUCY_CHECK(!IsDedicated(d) && d.Offset == 640);
+		StagingAllocation full = ring.Allocate(16);
+		LUCY_CHECK(IsDedicated(full));
+		ring.Free(full);
+
+		//the ranges are reclaimed in allocation order, b is completed but kept until a is completed as well
+		ring.Free(b);
+		StagingAllocation stalled = ring.Allocate(16);
+		LUCY_CHECK(IsDedicated(stalled));
+		ring.Free(stalled);
+		ring.Free(a);
+
+		//wraps around to the front [0, 328), that a and b have been using
+		StagingAllocation tooLarge = ring.Allocate(336);
+		LUCY_CHECK(IsDedicated(tooLarge));
+		ring.Free(tooLarge);
+		StagingAllocation e = ring.Allocate(320);
+		LUCY_CHECK(!IsDedicated(e) && e.Offset == 0);
+		//the gap up to c is too small
+		StagingAllocation f = ring.Allocate(16);
+		LUCY_CHECK(IsDedicated(f));
+		ring.Free(f);
+
+		//everything completed, the ring starts at the front again
+		ring.Free(c);
+		ring.Free(d);
+		ring.Free(e);
+		StagingAllocation g = ring.Allocate(512);
+		LUCY_CHECK(!IsDedicated(g) && g.Offset == 0);
+		ring.Free(g);
+	}
+
+	//frames with random upload sizes, each frame's allocations are completed two frames later (like Renderer::EnqueueDeletion).
+	//every allocation is filled with its own pattern, which is still intact when it is completed, if no other allocation has overlapped it
+	LUCY_TEST(StagingRingNeverOverlapsLiveAllocations) {
+		static constexpr VkDeviceSize ringSize = 64 * 1024;
+		static constexpr uint32_t framesInFlight = 2;
+		static constexpr uint32_t frameCount = 2000;
+
+		TestStagingRing ring(ringSize);
+		std::mt19937 random(11);
+		std::uniform_int_distribution<uint32_t> uploadCount(0, 8);
+		std::uniform_int_distribution<VkDeviceSize> uploadSize(1, ringSize / 8);
+		const VkDeviceSize alignments[] = { 4, 16, 48, 256 };
+
+		struct LiveAllocation {
+			StagingAllocation Allocation;
+			uint8_t Pattern = 0;
+		};
+		std::vector<std::vector<LiveAllocation>> frames(framesInFlight + 1);
+
+		uint32_t wrapCount = 0, dedicatedCount = 0, ringCount = 0;
+		VkDeviceSize lastOffset = 0;
+		for (uint32_t frame = 0; frame < frameCount; frame++) {
+			//the frame, that has been completed
+			std::vector<LiveAllocation>& allocations = frames[frame % frames.size()];
+			for (const LiveAllocation& live : allocations) {
+				const StagingAllocation& allocation = live.Allocation;
+				LUCY_CHECK(std::all_of(allocation.MappedData, allocation.MappedData + allocation.Size, [&](uint8_t value) { return value == live.Pattern; }));
+				ring.Free(allocation);
+			}
+			allocations.clear();
+
+			const uint32_t count = uploadCount(random);
+			for (uint32_t i = 0; i < count; i++) {
+				const VkDeviceSize alignment = alignments[random() % std::size(alignments)];
+				const StagingAllocation allocation = ring.Allocate(uploadSize(random), alignment);
+				LUCY_CHECK(allocation.IsValid());
+
+				if (IsDedicated(allocation)) {
+					dedicatedCount++;
+				} else {
+					ringCount++;
+					LUCY_CHECK(allocation.Offset % alignment == 0);
+					LUCY_CHECK(allocation.Offset + allocation.Size <= ringSize);
+					wrapCount += allocation.Offset < lastOffset ? 1 : 0;
+					lastOffset = allocation.Offset;
+				}
+
+				const uint8_t pattern = (uint8_t)random();
+				memset(allocation.MappedData, pattern, allocation.Size);
+				allocations.push_back(LiveAllocation{ allocation, pattern });
+			}
+		}
+
+		LUCY_INFO("Staging ring of {0} KiB: {1} ring allocations, {2} wraps, {3} dedicated buffers", ringSize / 1024, ringCount, wrapCount, dedicatedCount);
+		LUCY_CHECK(wrapCount > 100);
+		LUCY_CHECK(ringCount > 10 * dedicatedCount);
+		LUCY_CHECK(ring.GetCreatedBufferCount() == dedicatedCount + 1);
+	}
+}
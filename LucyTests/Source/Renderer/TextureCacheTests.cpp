@@ -0,0 +1,138 @@
+#include "lypch.h"
+#include "Test.h"
+
+#include "Renderer/Image/TextureCache.h"
+
+namespace Lucy::Tests {
+
+	//creates handles instead of images, every path has a memory size of a megabyte unless it is set
+	class TestTextureCache final : public TextureCache {
+	public:
+		TestTextureCache(size_t memoryBudget = s_DefaultMemoryBudget)
+			: TextureCache(nullptr, memoryBudget) {
+		}
+
+		void SetImageMemorySize(const std::string& path, size_t memorySize) { m_MemorySizes[path] = memorySize; }
+		bool IsDestroyed(RenderResourceHandle handle) const { return std::ranges::find(m_DestroyedImages, handle) != m_DestroyedImages.end(); }
+		size_t GetDestroyedCount() const { return m_DestroyedImages.size(); }
+	private:
+		RenderResourceHandle RTCreateImage(const std::filesystem::path& path, const ImageCreateInfo&) final override {
+			m_Paths.push_back(path.filename().string());
+			return m_Paths.size() - 1;
+		}
+
+		void RTDestroyImage(RenderResourceHandle handle) final override {
+			LUCY_CHECK(!IsDestroyed(handle));
+			m_DestroyedImages.push_back(handle);
+		}
+
+		size_t GetImageMemorySize(RenderResourceHandle handle) final override {
+			auto it = m_MemorySizes.find(m_Paths[handle]);
+			return it != m_MemorySizes.end() ? it->second : 1024 * 1024;
+		}
+
+		std::vector<std::string> m_Paths; //by handle
+		std::unordered_map<std::string, size_t> m_MemorySizes;
+		std::vector<RenderResourceHandle> m_DestroyedImages;
+	};
+
+	static ImageCreateInfo CreateTextureInfo() {
+		ImageCreateInfo createInfo;
+		createInfo.ImageType = ImageType::Type2D;
+		createInfo.Format = ImageFormat::BC7_UNORM;
+		createInfo.ImageUsage = ImageUsage::AsSampledTexture;
+		createInfo.GenerateSampler = true;
+		createInfo.GenerateMipmap = true;
+		return createInfo;
+	}
+
+	LUCY_TEST(TextureCacheUploadsATextureOnce) {
+		TestTextureCache cache;
+		const ImageCreateInfo createInfo = CreateTextureInfo();
+
+		RenderResourceHandle handle = cache.RTAcquire("Textures/Brick.png", createInfo);
+		LUCY_CHECK(cache.RTAcquire("Textures/Brick.png", createInfo) == handle);
+		//another spelling of the same file
+		LUCY_CHECK(cache.RTAcquire("Textures/../Textures/./Brick.png", createInfo) == handle);
+		LUCY_CHECK(cache.GetUploadCount() == 1);
+		LUCY_CHECK(cache.GetCachedTextureCount() == 1);
+
+		//the same file with another sampler is another image
+		ImageCreateInfo clampedInfo = createInfo;
+		clampedInfo.Parameter.U = ImageAddressMode::CLAMP_TO_EDGE;
+		RenderResourceHandle clampedHandle = cache.RTAcquire("Textures/Brick.png", clampedInfo);
+		LUCY_CHECK(clampedHandle != handle);
+		LUCY_CHECK(cache.GetUploadCount() == 2);
+		LUCY_CHECK(cache.GetBindlessIndex(handle) != cache.GetBindlessIndex(clampedHandle));
+
+		//the image stays, until every reference has been released
+		cache.RTRelease(handle);
+		cache.RTRelease(handle);
+		cache.RTRelease(handle);
+		cache.RTRelease(clampedHandle);
+		LUCY_CHECK(cache.GetDestroyedCount() == 0);
+
+		//a texture, that is loaded again after its release, is not uploaded again
+		LUCY_CHECK(cache.RTAcquire("Textures/Brick.png", createInfo) == handle);
+		LUCY_CHECK(cache.GetUploadCount() == 2);
+
+		cache.DestroyAll();
+		LUCY_CHECK(cache.IsDestroyed(handle) && cache.IsDestroyed(clampedHandle));
+		LUCY_CHECK(cache.GetMemorySize() == 0);
+	}
+
+	LUCY_TEST(TextureCacheEvictsUnreferencedTexturesOverBudget) {
+		static constexpr size_t megabyte = 1024 * 1024;
+		TestTextureCache cache(3 * megabyte);
+		const ImageCreateInfo createInfo = CreateTextureInfo();
+
+		RenderResourceHandle a = cache.RTAcquire("A.png", createInfo);
+		RenderResourceHandle b = cache.RTAcquire("B.png", createInfo);
+		RenderResourceHandle c = cache.RTAcquire("C.png", createInfo);
+		LUCY_CHECK(cache.GetMemorySize() == 3 * megabyte);
+
+		//referenced images are never evicted, although they exceed the budget
+		RenderResourceHandle d = cache.RTAcquire("D.png", createInfo);
+		LUCY_CHECK(cache.GetMemorySize() == 4 * megabyte);
+		LUCY_CHECK(cache.GetDestroyedCount() == 0);
+
+		//the first released image is evicted first
+		cache.RTRelease(b);
+		LUCY_CHECK(cache.IsDestroyed(b));
+		LUCY_CHECK(cache.GetMemorySize() == 3 * megabyte);
+
+		//within the budget, the released images stay cached
+		cache.RTRelease(a);
+		cache.RTRelease(c);
+		LUCY_CHECK(cache.GetDestroyedCount() == 1);
+		LUCY_CHECK(cache.GetCachedTextureCount() == 3);
+
+		//a reacquired image is referenced again, the least recently released one (a) makes room for a new one
+		LUCY_CHECK(cache.RTAcquire("C.png", createInfo) == c);
+		const uint32_t bindlessIndexOfA = cache.GetBindlessIndex(a);
+		RenderResourceHandle e = cache.RTAcquire("E.png", createInfo);
+		LUCY_CHECK(cache.IsDestroyed(a) && !cache.IsDestroyed(c));
+		LUCY_CHECK(cache.GetMemorySize() == 3 * megabyte);
+		LUCY_CHECK(cache.GetUploadCount() == 5);
+		LUCY_CHECK(cache.GetBindlessIndex(a) == TextureCache::InvalidBindlessIndex);
+
+		//an evicted image is uploaded again, it reuses a free bindless index
+		RenderResourceHandle reloadedA = cache.RTAcquire("A.png", createInfo);
+		LUCY_CHECK(reloadedA != a);
+		LUCY_CHECK(cache.GetUploadCount() == 6);
+		LUCY_CHECK(cache.GetBindlessIndex(reloadedA) < 4);
+		LUCY_CHECK(cache.GetBindlessIndex(e) == bindlessIndexOfA || cache.GetBindlessIndex(reloadedA) == bindlessIndexOfA);
+
+		//a larger budget keeps more released images, a smaller one evicts them right away
+		cache.RTSetMemoryBudget(8 * megabyte);
+		cache.SetImageMemorySize("F.png", 2 * megabyte);
+		RenderResourceHandle f = cache.RTAcquire("F.png", createInfo);
+		cache.RTRelease(f);
+		cache.RTRelease(d);
+		LUCY_CHECK(!cache.IsDestroyed(d) && !cache.IsDestroyed(f));
+		LUCY_CHECK(cache.GetMemorySize() == 6 * megabyte);
+		cache.RTSetMemoryBudget(0);
+		LUCY_CHECK(cache.IsDestroyed(d) && cache.IsDestroyed(f));
+		LUCY_CHECK(cache.GetMemorySize() == 3 * megabyte); //c, e and the reloaded a are referenced
+	}
+}
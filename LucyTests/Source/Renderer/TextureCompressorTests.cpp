@@ -0,0 +1,415 @@
+#include "lypch.h"
+#include "Test.h"
+
+#include <random>
+
+#include "Renderer/Image/KTX2.h"
+#include "Utilities/Utilities.h"
+
+#include "stb/stb_image.h"
+
+namespace Lucy::Tests {
+
+	//reads the bits starting from the least significant bit of the block
+	struct BlockBitReader {
+		const uint8_t* Data = nullptr;
+		uint32_t Offset = 0;
+
+		uint32_t Read(uint32_t bitCount) {
+			uint32_t value = 0;
+			for (uint32_t i = 0; i < bitCount; i++, Offset++)
+				value |= (uint32_t)((Data[Offset / 8] >> (Offset % 8)) & 1) << i;
+			return value;
+		}
+	};
+
+	//reference decoder of BC7 mode 6 (see the BC7 format in the Khronos Data Format Specification)
+	static bool DecodeBlockBC7Mode6(const uint8_t* block, uint8_t* rgba) {
+		static constexpr uint32_t weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+		BlockBitReader reader{ .Data = block };
+		if (reader.Read(7) != 1u << 6)
+			return false;
+
+		glm::uvec4 endpoints[2];
+		for (uint32_t c = 0; c < 4; c++) {
+			endpoints[0][c] = reader.Read(7);
+			endpoints[1][c] = reader.Read(7);
+		}
+		endpoints[0] = endpoints[0] << 1u | glm::uvec4(reader.Read(1));
+		endpoints[1] = endpoints[1] << 1u | glm::uvec4(reader.Read(1));
+
+		for (uint32_t i = 0; i < 16; i++) {
+			const uint32_t weight = weights[reader.Read(i == 0 ? 3 : 4)];
+			for (uint32_t c = 0; c < 4; c++)
+				rgba[i * 4 + c] = (uint8_t)(((64 - weight) * endpoints[0][c] + weight * endpoints[1][c] + 32) >> 6);
+		}
+		return true;
+	}
+
+	static glm::uvec3 UnpackRGB565(uint16_t color) {
+		const glm::uvec3 value = glm::uvec3(color >> 11, (color >> 5) & 0x3F, color & 0x1F);
+		return glm::uvec3(value.r << 3 | value.r >> 2, value.g << 2 | value.g >> 4, value.b << 3 | value.b >> 2);
+	}
+
+	//reference decoder of BC1, the color block of BC3 always uses the four color mode
+	static void DecodeBlockBC1(const uint8_t* block, uint8_t* rgba, bool allowThreeColorMode) {
+		uint16_t color0, color1;
+		uint32_t indices;
+		memcpy(&color0, block, 2);
+		memcpy(&color1, block + 2, 2);
+		memcpy(&indices, block + 4, 4);
+
+		glm::uvec4 palette[4];
+		palette[0] = glm::uvec4(UnpackRGB565(color0), 255);
+		palette[1] = glm::uvec4(UnpackRGB565(color1), 255);
+		if (color0 > color1 || !allowThreeColorMode) {
+			palette[2] = (palette[0] * 2u + palette[1]) / 3u;
+			palette[3] = (palette[0] + palette[1] * 2u) / 3u;
+		} else {
+			palette[2] = (palette[0] + palette[1]) / 2u;
+			palette[3] = glm::uvec4(0);
+		}
+
+		for (uint32_t i = 0; i < 16; i++) {
+			for (uint32_t c = 0; c < 4; c++)
+				rgba[i * 4 + c] = (uint8_t)palette[(indices >> (i * 2)) & 3][c];
+		}
+	}
+
+	//reference decoder of a BC4 block (BC3 alpha, both BC5 channels), writes every stride-th byte
+	static void DecodeBlockBC4(const uint8_t* block, uint8_t* values, uint32_t stride) {
+		uint32_t palette[8];
+		palette[0] = block[0];
+		palette[1] = block[1];
+		if (palette[0] > palette[1]) {
+			for (uint32_t p = 2; p < 8; p++)
+				palette[p] = ((8 - p) * palette[0] + (p - 1) * palette[1]) / 7;
+		} else {
+			for (uint32_t p = 2; p < 6; p++)
+				palette[p] = ((6 - p) * palette[0] + (p - 1) * palette[1]) / 5;
+			palette[6] = 0;
+			palette[7] = 255;
+		}
+
+		uint64_t indices = 0;
+		memcpy(&indices, block + 2, 6);
+		for (uint32_t i = 0; i < 16; i++)
+			values[i * stride] = (uint8_t)palette[(indices >> (i * 3)) & 7];
+	}
+
+	//the channels, that a format doesn't store, are decoded as 0 (red and green) and 255 (alpha)
+	static void DecodeBlock(ImageFormat format, const uint8_t* block, uint8_t* rgba) {
+		for (uint32_t i = 0; i < 16; i++) {
+			rgba[i * 4 + 0] = rgba[i * 4 + 1] = rgba[i * 4 + 2] = 0;
+			rgba[i * 4 + 3] = 255;
+		}
+
+		switch (format) {
+			case ImageFormat::BC1_RGBA_UNORM:
+			case ImageFormat::BC1_RGBA_SRGB:
+				DecodeBlockBC1(block, rgba, true);
+				break;
+			case ImageFormat::BC3_UNORM:
+			case ImageFormat::BC3_SRGB:
+				DecodeBlockBC1(block + 8, rgba, false);
+				DecodeBlockBC4(block, rgba + 3, 4);
+				break;
+			case ImageFormat::BC4_UNORM:
+				DecodeBlockBC4(block, rgba, 4);
+				break;
+			case ImageFormat::BC5_UNORM:
+				DecodeBlockBC4(block, rgba, 4);
+				DecodeBlockBC4(block + 8, rgba + 1, 4);
+				break;
+			case ImageFormat::BC7_UNORM:
+			case ImageFormat::BC7_SRGB:
+				LUCY_CHECK(DecodeBlockBC7Mode6(block, rgba));
+				break;
+			default:
+				LUCY_CHECK(false);
+				break;
+		}
+	}
+
+	static std::vector<uint8_t> DecodeLevel(const CompressedTexture& texture, uint32_t level) {
+		const CompressedLevel& compressedLevel = texture.Levels[level];
+		const uint32_t blockSize = TextureCompressor::GetBlockSize(texture.Format);
+		const uint32_t blockCountX = (compressedLevel.Width + 3) / 4;
+		const uint32_t blockCountY = (compressedLevel.Height + 3) / 4;
+
+		std::vector<uint8_t> rgba((size_t)compressedLevel.Width * compressedLevel.Height * 4);
+		uint8_t block[16 * 4];
+		for (uint32_t by = 0; by < blockCountY; by++) {
+			for (uint32_t bx = 0; bx < blockCountX; bx++) {
+				const uint8_t* source = texture.Data.data() + compressedLevel.Offset + ((size_t)by * blockCountX + bx) * blockSize;
+				DecodeBlock(texture.Format, source, block);
+
+				for (uint32_t y = 0; y < 4 && by * 4 + y < compressedLevel.Height; y++) {
+					for (uint32_t x = 0; x < 4 && bx * 4 + x < compressedLevel.Width; x++)
+						memcpy(rgba.data() + ((size_t)(by * 4 + y) * compressedLevel.Width + bx * 4 + x) * 4, block + (y * 4 + x) * 4, 4);
+				}
+			}
+		}
+		return rgba;
+	}
+
+	//over the first channelCount channels of every texel
+	static float ComputePSNR(const std::vector<uint8_t>& a, const std::vector<uint8_t>& b, uint32_t channelCount = 4) {
+		double squaredError = 0.0;
+		for (size_t i = 0; i < a.size(); i++) {
+			if (i % 4 >= channelCount)
+				continue;
+			const double delta = (double)a[i] - (double)b[i];
+			squaredError += delta * delta;
+		}
+		const double meanSquaredError = squaredError / (double)(a.size() / 4 * channelCount);
+		return meanSquaredError == 0.0 ? FLT_MAX : (float)(10.0 * std::log10(255.0 * 255.0 / meanSquaredError));
+	}
+
+	//smooth gradients with a bit of noise, roughly what an albedo texture looks like
+	static std::vector<uint8_t> CreateTestImage(uint32_t width, uint32_t height, uint32_t seed) {
+		std::mt19937 random(seed);
+		std::uniform_int_distribution<int32_t> noise(-4, 4);
+
+		std::vector<uint8_t> rgba((size_t)width * height * 4);
+		for (uint32_t y = 0; y < height; y++) {
+			for (uint32_t x = 0; x < width; x++) {
+				const float u = (float)x / (float)width;
+				const float v = (float)y / (float)height;
+				const glm::vec4 color = glm::vec4(u, v, 0.5f + 0.5f * glm::sin(u * 6.0f), 1.0f - 0.5f * v) * 255.0f;
+				for (uint32_t c = 0; c < 4; c++)
+					rgba[((size_t)y * width + x) * 4 + c] = (uint8_t)glm::clamp((int32_t)color[c] + noise(random), 0, 255);
+			}
+		}
+		return rgba;
+	}
+
+	LUCY_TEST(TextureCompressorLevelLayout) {
+		//neither side is a multiple of the block size, the last levels are smaller than a block
+		static constexpr uint32_t width = 13;
+		static constexpr uint32_t height = 7;
+		const std::vector<uint8_t> rgba = CreateTestImage(width, height, 37);
+
+		const uint32_t levelCount = TextureCompressor::GetLevelCount(width, height, true);
+		LUCY_CHECK(levelCount == 4);
+		LUCY_CHECK(TextureCompressor::GetLevelCount(width, height, false) == 1);
+
+		for (ImageFormat format : { ImageFormat::BC1_RGBA_UNORM, ImageFormat::BC4_UNORM, ImageFormat::BC7_SRGB }) {
+			const CompressedTexture texture = TextureCompressor::Compress(rgba.data(), width, height, format, levelCount);
+			LUCY_CHECK(texture.Levels.size() == levelCount);
+			LUCY_CHECK(texture.Data.size() == TextureCompressor::GetTextureSize(format, width, height, levelCount));
+
+			size_t offset = 0;
+			for (uint32_t level = 0; level < texture.Levels.size(); level++) {
+				const CompressedLevel& compressedLevel = texture.Levels[level];
+				LUCY_CHECK(compressedLevel.Width == glm::max(width >> level, 1u) && compressedLevel.Height == glm::max(height >> level, 1u));
+				LUCY_CHECK(compressedLevel.Offset == offset);
+				LUCY_CHECK(compressedLevel.Size == TextureCompressor::GetLevelSize(format, compressedLevel.Width, compressedLevel.Height));
+				offset += compressedLevel.Size;
+			}
+		}
+	}
+
+	LUCY_TEST(TextureCompressorBC7Quality) {
+		static constexpr uint32_t width = 64;
+		static constexpr uint32_t height = 48;
+		const std::vector<uint8_t> rgba = CreateTestImage(width, height, 37);
+
+		const CompressedTexture texture = TextureCompressor::Compress(rgba.data(), width, height, ImageFormat::BC7_UNORM, 1);
+		const std::vector<uint8_t> decoded = DecodeLevel(texture, 0);
+		LUCY_CHECK(ComputePSNR(rgba, decoded) > 33.0f);
+
+		//a uniform block only loses the least significant bit of the channels, that disagree with the shared p-bit
+		std::mt19937 random(37);
+		for (uint32_t i = 0; i < 256; i++) {
+			const uint32_t color = random();
+			std::vector<uint8_t> uniform(16 * 4);
+			for (uint32_t t = 0; t < 16; t++)
+				memcpy(uniform.data() + t * 4, &color, 4);
+
+			const CompressedTexture block = TextureCompressor::Compress(uniform.data(), 4, 4, ImageFormat::BC7_UNORM, 1);
+			const std::vector<uint8_t> decodedBlock = DecodeLevel(block, 0);
+			for (size_t t = 0; t < uniform.size(); t++)
+				LUCY_CHECK(glm::abs((int32_t)decodedBlock[t] - (int32_t)uniform[t]) <= 1);
+		}
+	}
+
+	LUCY_TEST(TextureCompressorQuality) {
+		static constexpr uint32_t width = 64;
+		static constexpr uint32_t height = 48;
+		const std::vector<uint8_t> rgba = CreateTestImage(width, height, 37);
+
+		struct FormatQuality {
+			ImageFormat Format;
+			uint32_t ChannelCount;
+			float MinPSNR;
+		};
+		//BC1 stores the alpha as a single bit, it is compared on an opaque image
+		static constexpr FormatQuality formats[] = {
+			{ ImageFormat::BC1_RGBA_UNORM, 3, 33.0f },
+			{ ImageFormat::BC3_UNORM, 4, 33.0f },
+			{ ImageFormat::BC4_UNORM, 1, 45.0f },
+			{ ImageFormat::BC5_UNORM, 2, 45.0f },
+			{ ImageFormat::BC7_UNORM, 4, 33.0f },
+		};
+		std::vector<uint8_t> opaque = rgba;
+		for (size_t i = 0; i < opaque.size() / 4; i++)
+			opaque[i * 4 + 3] = 255;
+
+		for (const FormatQuality& quality : formats) {
+			const std::vector<uint8_t>& source = quality.ChannelCount == 3 ? opaque : rgba;
+			const CompressedTexture texture = TextureCompressor::Compress(source.data(), width, height, quality.Format, 1);
+			LUCY_CHECK(texture.Format == quality.Format);
+			const float psnr = ComputePSNR(source, DecodeLevel(texture, 0), quality.ChannelCount);
+			LUCY_INFO("Format {0}: {1:.2f} dB", (int32_t)quality.Format, psnr);
+			LUCY_CHECK(psnr > quality.MinPSNR);
+		}
+
+		//the texels below half alpha are transparent black in BC1
+		std::vector<uint8_t> cutout = opaque;
+		for (size_t i = 0; i < cutout.size() / 4; i++)
+			cutout[i * 4 + 3] = (i / 3) % 2 ? 255 : 0;
+		const CompressedTexture texture = TextureCompressor::Compress(cutout.data(), width, height, ImageFormat::BC1_RGBA_UNORM, 1);
+		const std::vector<uint8_t> decoded = DecodeLevel(texture, 0);
+		for (size_t i = 0; i < cutout.size() / 4; i++) {
+			LUCY_CHECK(decoded[i * 4 + 3] == cutout[i * 4 + 3]);
+			if (cutout[i * 4 + 3] == 0)
+				LUCY_CHECK(decoded[i * 4 + 0] == 0 && decoded[i * 4 + 1] == 0 && decoded[i * 4 + 2] == 0);
+		}
+	}
+
+	LUCY_TEST(TextureCompressorUniformMips) {
+		//the box filter of a uniform image is the same color, in both linear and sRGB space
+		static constexpr uint32_t width = 32;
+		static constexpr uint32_t height = 20;
+		const uint8_t color[4] = { 200, 100, 31, 255 };
+		std::vector<uint8_t> rgba((size_t)width * height * 4);
+		for (size_t i = 0; i < rgba.size(); i++)
+			rgba[i] = color[i % 4];
+
+		for (ImageFormat format : { ImageFormat::BC7_UNORM, ImageFormat::BC7_SRGB }) {
+			const CompressedTexture texture = TextureCompressor::Compress(rgba.data(), width, height, format, TextureCompressor::GetLevelCount(width, height, true));
+			for (uint32_t level = 0; level < texture.Levels.size(); level++) {
+				const std::vector<uint8_t> decoded = DecodeLevel(texture, level);
+				for (size_t i = 0; i < decoded.size(); i++)
+					LUCY_CHECK(glm::abs((int32_t)decoded[i] - (int32_t)color[i % 4]) <= 1);
+			}
+		}
+	}
+
+	LUCY_TEST(TextureCompressorCacheEntries) {
+		//FNV-1a test vectors, the cache entries of a previous run are only found with the same hashes
+		LUCY_CHECK(Utils::HashBytes("", 0) == 0xcbf29ce484222325ull);
+		LUCY_CHECK(Utils::HashBytes("a", 1) == 0xaf63dc4c8601ec8cull);
+		LUCY_CHECK(Utils::HashBytes("foobar", 6) == 0x85944171f73967e8ull);
+
+		const std::filesystem::path folder = std::filesystem::temp_directory_path() / "LucyTests";
+		std::filesystem::create_directories(folder);
+		const std::filesystem::path sourcePath = folder / "Source.png";
+		std::ofstream(sourcePath, std::ios::out | std::ios::binary | std::ios::trunc) << "pixels";
+
+		const std::filesystem::path cachePath = TextureCompressor::GetCachePath(sourcePath, ImageFormat::BC7_UNORM);
+		LUCY_CHECK(cachePath == TextureCompressor::GetCachePath(sourcePath, ImageFormat::BC7_UNORM));
+		LUCY_CHECK(cachePath != TextureCompressor::GetCachePath(sourcePath, ImageFormat::BC7_SRGB));
+
+		//an edited source image gets a new entry with the same prefix
+		std::filesystem::last_write_time(sourcePath, std::filesystem::last_write_time(sourcePath) + std::chrono::hours(1));
+		const std::filesystem::path editedCachePath = TextureCompressor::GetCachePath(sourcePath, ImageFormat::BC7_UNORM);
+		const std::filesystem::path otherFormatCachePath = TextureCompressor::GetCachePath(sourcePath, ImageFormat::BC7_SRGB);
+		LUCY_CHECK(editedCachePath != cachePath);
+
+		const auto GetPrefix = [](const std::filesystem::path& path) {
+			const std::string fileName = path.filename().string();
+			return fileName.substr(0, fileName.find_last_of('_'));
+		};
+		LUCY_CHECK(GetPrefix(editedCachePath) == GetPrefix(cachePath));
+		LUCY_CHECK(GetPrefix(otherFormatCachePath) != GetPrefix(cachePath));
+
+		//writing the new entry removes the old one, the entries of the other format stay
+		const std::filesystem::path cacheFolder = folder / "Cached";
+		std::filesystem::create_directories(cacheFolder);
+		for (const std::filesystem::path& path : { cachePath, editedCachePath, otherFormatCachePath })
+			std::ofstream(cacheFolder / path.filename(), std::ios::out | std::ios::binary | std::ios::trunc) << "entry";
+
+		TextureCompressor::RemoveStaleCacheEntries(cacheFolder / editedCachePath.filename());
+		LUCY_CHECK(!std::filesystem::exists(cacheFolder / cachePath.filename()));
+		LUCY_CHECK(std::filesystem::exists(cacheFolder / editedCachePath.filename()));
+		LUCY_CHECK(std::filesystem::exists(cacheFolder / otherFormatCachePath.filename()));
+
+		std::error_code errorCode;
+		std::filesystem::remove_all(folder, errorCode);
+	}
+
+	//the material textures of Sponza as RGBA8 with mips and as BC7, like MaterialManager loads them (USE_BLOCK_COMPRESSED_TEXTURES).
+	//only the image headers are read, the sizes don't depend on the content
+	LUCY_TEST(TextureCompressorSponzaMemory) {
+		const std::filesystem::path sponzaFolder = "../LucyEditor/Assets/Models/Sponza";
+		if (!std::filesystem::exists(sponzaFolder)) {
+			LUCY_WARN("Sponza is not in {0}, skipping the texture memory report.", std::filesystem::absolute(sponzaFolder).generic_string());
+			return;
+		}
+
+		uint32_t textureCount = 0;
+		size_t uncompressedSize = 0, compressedSize = 0;
+		for (const auto& entry : std::filesystem::directory_iterator(sponzaFolder)) {
+			const std::string extension = entry.path().extension().string();
+			if (extension != ".png" && extension != ".jpg")
+				continue;
+
+			int32_t width = 0, height = 0, channels = 0;
+			if (!stbi_info(entry.path().string().c_str(), &width, &height, &channels))
+				continue;
+
+			const uint32_t levelCount = TextureCompressor::GetLevelCount((uint32_t)width, (uint32_t)height, true);
+			for (uint32_t level = 0; level < levelCount; level++)
+				uncompressedSize += (size_t)glm::max(width >> level, 1) * glm::max(height >> level, 1) * 4;
+			compressedSize += TextureCompressor::GetTextureSize(ImageFormat::BC7_UNORM, (uint32_t)width, (uint32_t)height, levelCount);
+			textureCount++;
+		}
+
+		static constexpr double mebibyte = 1024.0 * 1024.0;
+		LUCY_INFO("Sponza, {0} textures: {1:.1f} MiB as RGBA8, {2:.1f} MiB as BC7 ({3:.1f} MiB saved)", textureCount,
+				  uncompressedSize / mebibyte, compressedSize / mebibyte, (uncompressedSize - compressedSize) / mebibyte);
+		LUCY_CHECK(textureCount > 0);
+		//a BC7 block holds 16 texels in 16 bytes, only the levels below 4x4 texels are padded
+		LUCY_CHECK(compressedSize * 4 >= uncompressedSize && compressedSize * 3 < uncompressedSize);
+	}
+
+	LUCY_TEST(KTX2RoundTrip) {
+		const std::filesystem::path folder = std::filesystem::temp_directory_path() / "LucyTests";
+		const std::vector<uint8_t> rgba = CreateTestImage(37, 20, 37);
+
+		//the block sizes differ (8 and 16 bytes), so does the alignment of the levels in the file
+		for (ImageFormat format : { ImageFormat::BC1_RGBA_SRGB, ImageFormat::BC4_UNORM, ImageFormat::BC5_UNORM, ImageFormat::BC7_UNORM }) {
+			const CompressedTexture texture = TextureCompressor::Compress(rgba.data(), 37, 20, format, TextureCompressor::GetLevelCount(37, 20, true));
+			const std::filesystem::path path = folder / std::format("RoundTrip{}.ktx2", (int32_t)format);
+			LUCY_CHECK(KTX2::Write(path, texture));
+
+			KTX2Info info;
+			LUCY_CHECK(KTX2::ReadInfo(path, info));
+			LUCY_CHECK(info.Format == format && info.Width == texture.Width && info.Height == texture.Height);
+			LUCY_CHECK(info.Levels.size() == texture.Levels.size());
+			LUCY_CHECK(info.GetDataSize() == texture.Data.size());
+			for (size_t level = 0; level < glm::min(info.Levels.size(), texture.Levels.size()); level++) {
+				LUCY_CHECK(info.Levels[level].Width == texture.Levels[level].Width && info.Levels[level].Height == texture.Levels[level].Height);
+				LUCY_CHECK(info.Levels[level].Size == texture.Levels[level].Size);
+				LUCY_CHECK(info.Levels[level].Offset % TextureCompressor::GetBlockSize(format) == 0);
+			}
+
+			std::vector<uint8_t> data(info.GetDataSize());
+			LUCY_CHECK(KTX2::ReadLevels(path, info, data.data()));
+			LUCY_CHECK(data == texture.Data);
+		}
+
+		//anything else is rejected
+		const std::filesystem::path invalidPath = folder / "Invalid.ktx2";
+		std::ofstream(invalidPath, std::ios::out | std::ios::binary | std::ios::trunc) << "not a ktx2 file, just some text";
+		KTX2Info info;
+		LUCY_CHECK(!KTX2::ReadInfo(invalidPath, info));
+		LUCY_CHECK(!KTX2::ReadInfo(folder / "DoesNotExist.ktx2", info));
+
+		std::error_code errorCode;
+		std::filesystem::remove_all(folder, errorCode);
+	}
+}
@@ -0,0 +1,193 @@
+#include "lypch.h"
+#include "Test.h"
+
+#include <random>
+
+#include "Renderer/Image/TextureStreamer.h"
+
+namespace Lucy::Tests {
+
+	//a 64x64 texture with 4 levels, the sizes are in (made up) bytes
+	static const std::vector<size_t> s_LevelSizes = { 64, 16, 4, 1 };
+	static constexpr uint32_t s_BaseMip = 3;
+	static constexpr size_t s_FullSize = 64 + 16 + 4 + 1;
+
+	//applies every change, as if the loads had finished right away
+	static std::vector<TextureResidencyChange> UpdateAndApply(TextureStreamer& streamer) {
+		std::vector<TextureResidencyChange> changes = streamer.Update();
+		for (const TextureResidencyChange& change : changes)
+			streamer.OnResidencyChanged(change.Handle, change.ResidentMip);
+		return changes;
+	}
+
+	static uint32_t FindChange(const std::vector<TextureResidencyChange>& changes, RenderResourceHandle handle) {
+		for (const TextureResidencyChange& change : changes) {
+			if (change.Handle == handle)
+				return change.ResidentMip;
+		}
+		return UINT32_MAX;
+	}
+
+	LUCY_TEST(TextureStreamerDesiredMip) {
+		LUCY_CHECK(TextureStreamer::ComputeDesiredMip(1024, 1024.0f, 11) == 0);
+		LUCY_CHECK(TextureStreamer::ComputeDesiredMip(1024, 2000.0f, 11) == 0);
+		LUCY_CHECK(TextureStreamer::ComputeDesiredMip(1024, 512.0f, 11) == 1);
+		LUCY_CHECK(TextureStreamer::ComputeDesiredMip(1024, 300.0f, 11) == 1);
+		LUCY_CHECK(TextureStreamer::ComputeDesiredMip(1024, 0.5f, 11) == 10);
+		LUCY_CHECK(TextureStreamer::ComputeDesiredMip(1024, 8.0f, 3) == 2);
+		LUCY_CHECK(TextureStreamer::ComputeDesiredMip(1024, 8.0f, 0) == 0);
+	}
+
+	LUCY_TEST(TextureStreamerStreamsOneLevelPerUpdate) {
+		TextureStreamer streamer(1024);
+		streamer.Register(1, 64, 64, s_LevelSizes, s_BaseMip);
+		LUCY_CHECK(streamer.GetResidentSize() == 1);
+
+		//nothing happens, until the low mips have been uploaded
+		streamer.RequestMip(1, 0);
+		LUCY_CHECK(streamer.Update().empty());
+		LUCY_CHECK(streamer.GetPendingHandles() == std::vector<RenderResourceHandle>{ 1 });
+		streamer.OnResidencyChanged(1, s_BaseMip);
+
+		for (uint32_t mip = s_BaseMip; mip-- > 0;) {
+			streamer.RequestMip(1, 0);
+			//a handle, that hasn't been registered, is ignored
+			streamer.RequestMip(2, 0);
+			const std::vector<TextureResidencyChange> changes = UpdateAndApply(streamer);
+			LUCY_CHECK(changes.size() == 1 && FindChange(changes, 1) == mip);
+		}
+		LUCY_CHECK(streamer.GetResidentSize() == s_FullSize);
+
+		streamer.RequestMip(1, 0);
+		LUCY_CHECK(streamer.Update().empty());
+
+		streamer.Unregister(1);
+		LUCY_CHECK(streamer.GetResidentSize() == 0);
+	}
+
+	LUCY_TEST(TextureStreamerFailedLoad) {
+		TextureStreamer streamer(1024);
+		streamer.Register(1, 64, 64, s_LevelSizes, s_BaseMip);
+		streamer.OnResidencyChanged(1, s_BaseMip);
+
+		streamer.RequestMip(1, 0);
+		LUCY_CHECK(FindChange(streamer.Update(), 1) == 2);
+		LUCY_CHECK(streamer.GetResidentSize() == 1 + 4);
+
+		//the load failed, the old mip is reported back
+		streamer.OnResidencyChanged(1, s_BaseMip);
+		LUCY_CHECK(streamer.GetResidentSize() == 1);
+		LUCY_CHECK(streamer.GetPendingHandles().empty());
+	}
+
+	LUCY_TEST(TextureStreamerEvictsTheLeastRecentlyUsed) {
+		//enough for one texture with all levels and the base mips of the others
+		TextureStreamer streamer(s_FullSize + 2);
+		for (RenderResourceHandle handle : { 1, 2, 3 }) {
+			streamer.Register(handle, 64, 64, s_LevelSizes, s_BaseMip);
+			streamer.OnResidencyChanged(handle, s_BaseMip);
+		}
+
+		for (uint32_t i = 0; i < s_BaseMip; i++) {
+			streamer.RequestMip(1, 0);
+			UpdateAndApply(streamer);
+		}
+		LUCY_CHECK(streamer.GetResidentSize() == s_FullSize + 2);
+
+		//texture 1 is still visible, but hasn't been requested as recently as texture 2, so it makes room
+		streamer.RequestMip(1, 0);
+		UpdateAndApply(streamer);
+		for (uint32_t i = 0; i < s_BaseMip; i++) {
+			streamer.RequestMip(2, 0);
+			const std::vector<TextureResidencyChange> changes = UpdateAndApply(streamer);
+			LUCY_CHECK(FindChange(changes, 2) == s_BaseMip - 1 - i);
+			LUCY_CHECK(FindChange(changes, 3) == UINT32_MAX);
+			LUCY_CHECK(streamer.GetResidentSize() <= streamer.GetBudget());
+		}
+		LUCY_CHECK(streamer.GetResidentSize() == s_FullSize + 2);
+
+		//requested within the same update, texture 3 can't take the levels of texture 2, it is only streamed in once 2 isn't used anymore
+		streamer.RequestMip(2, 0);
+		streamer.RequestMip(3, 0);
+		LUCY_CHECK(FindChange(UpdateAndApply(streamer), 3) == UINT32_MAX);
+
+		streamer.RequestMip(3, 0);
+		const std::vector<TextureResidencyChange> changes = UpdateAndApply(streamer);
+		LUCY_CHECK(FindChange(changes, 3) == s_BaseMip - 1);
+		LUCY_CHECK(FindChange(changes, 2) != UINT32_MAX);
+
+		//a lower budget evicts down to the base mips, but never below them
+		streamer.SetBudget(0);
+		UpdateAndApply(streamer);
+		LUCY_CHECK(streamer.GetResidentSize() == 3);
+	}
+
+	//random requests, checked against a model of the residency and the last use of every texture
+	LUCY_TEST(TextureStreamerRandomRequests) {
+		static constexpr uint32_t textureCount = 16;
+		static constexpr size_t budget = s_FullSize * 4;
+
+		struct TextureModel {
+			uint32_t ResidentMip = s_BaseMip;
+			uint32_t DesiredMip = s_BaseMip;
+			uint64_t LastUsedFrame = 0;
+		};
+		std::vector<TextureModel> models(textureCount);
+
+		TextureStreamer streamer(budget);
+		streamer.SetMaxChangesPerUpdate(4);
+		for (uint32_t i = 0; i < textureCount; i++) {
+			streamer.Register(i, 64, 64, s_LevelSizes, s_BaseMip);
+			streamer.OnResidencyChanged(i, s_BaseMip);
+		}
+
+		std::mt19937 random(38);
+		for (uint64_t frame = 1; frame <= 500; frame++) {
+			//a few textures are visible, a few of them twice with different mips
+			std::vector<uint32_t> requestedMips(textureCount, UINT32_MAX);
+			for (uint32_t r = 0; r < 6; r++) {
+				const uint32_t texture = random() % (textureCount / 2 + frame / 50 % (textureCount / 2));
+				const uint32_t mip = random() % 4;
+				streamer.RequestMip(texture, mip);
+				requestedMips[texture] = glm::min(requestedMips[texture], mip);
+			}
+			for (uint32_t i = 0; i < textureCount; i++) {
+				if (requestedMips[i] == UINT32_MAX)
+					continue;
+				models[i].DesiredMip = glm::min(requestedMips[i], s_BaseMip);
+				models[i].LastUsedFrame = frame;
+			}
+
+			const std::vector<TextureResidencyChange> changes = UpdateAndApply(streamer);
+
+			//the textures are streamed in one level at a time, the most recently used ones first
+			uint64_t mostRecentStreamIn = 0;
+			for (const TextureResidencyChange& change : changes) {
+				const TextureModel& model = models[change.Handle];
+				if (change.ResidentMip < model.ResidentMip) {
+					LUCY_CHECK(change.ResidentMip + 1 == model.ResidentMip);
+					LUCY_CHECK(change.ResidentMip >= model.DesiredMip);
+					mostRecentStreamIn = glm::max(mostRecentStreamIn, model.LastUsedFrame);
+				}
+			}
+
+			//a victim has been used less recently, or it only gives up the levels it doesn't need
+			for (const TextureResidencyChange& change : changes) {
+				const TextureModel& model = models[change.Handle];
+				if (change.ResidentMip > model.ResidentMip) {
+					LUCY_CHECK(change.ResidentMip <= s_BaseMip);
+					LUCY_CHECK(model.LastUsedFrame < mostRecentStreamIn || change.ResidentMip <= model.DesiredMip || mostRecentStreamIn == 0);
+				}
+			}
+
+			for (const TextureResidencyChange& change : changes)
+				models[change.Handle].ResidentMip = change.ResidentMip;
+
+			size_t residentSize = 0;
+			for (const TextureModel& model : models)
+				residentSize += std::accumulate(s_LevelSizes.begin() + model.ResidentMip, s_LevelSizes.end(), (size_t)0);
+			LUCY_CHECK(streamer.GetResidentSize() == residentSize);
+			LUCY_CHECK(residentSize <= budget);
+		}
+	}
+}
@@ -0,0 +1,223 @@
+#include "lypch.h"
+#include "Test.h"
+
+#include <random>
+#include <map>
+
+#include "Scene/DynamicAABBTree.h"
+
+namespace Lucy::Tests {
+
+	//keeps the live proxies next to the tree, every query is checked against a linear search over their fat AABBs
+	struct TreeFixture {
+		DynamicAABBTree Tree;
+		std::map<uint32_t, int32_t> Proxies; //user data -> proxy id
+
+		std::mt19937 Random = std::mt19937(31);
+		std::uniform_real_distribution<float> Position = std::uniform_real_distribution<float>(-100.0f, 100.0f);
+		std::uniform_real_distribution<float> Extent = std::uniform_real_distribution<float>(0.1f, 5.0f);
+
+		Maths::AABB CreateRandomAABB() {
+			const glm::vec3 center = glm::vec3(Position(Random), Position(Random), Position(Random));
+			const glm::vec3 extents = glm::vec3(Extent(Random), Extent(Random), Extent(Random));
+			return Maths::AABB{ center - extents, center + extents };
+		}
+
+		//creates, moves and destroys proxies in a random order
+		void Populate(uint32_t count) {
+			uint32_t nextUserData = 0;
+			for (uint32_t i = 0; i < count; i++) {
+				const uint32_t userData = nextUserData++;
+				Proxies[userData] = Tree.CreateProxy(CreateRandomAABB(), userData);
+			}
+
+			for (uint32_t i = 0; i < count; i++) {
+				auto it = Proxies.begin();
+				std::advance(it, Random() % Proxies.size());
+				switch (Random() % 3) {
+					case 0:
+						Tree.DestroyProxy(it->second);
+						Proxies.erase(it);
+						break;
+					case 1: {
+						//a small move stays within the fat AABB and doesn't touch the tree
+						const Maths::AABB fatAABB = Tree.GetFatAABB(it->second);
+						LUCY_CHECK(!Tree.MoveProxy(it->second, Maths::AABB{ fatAABB.Min + 0.1f, fatAABB.Max - 0.1f }));
+						LUCY_CHECK(Tree.GetFatAABB(it->second).Min == fatAABB.Min);
+						break;
+					}
+					default:
+						Tree.MoveProxy(it->second, CreateRandomAABB());
+						break;
+				}
+			}
+		}
+
+		template <typename TPredicate>
+		std::set<uint32_t> BruteForce(TPredicate predicate) const {
+			std::set<uint32_t> result;
+			for (const auto& [userData, proxyID] : Proxies) {
+				if (predicate(Tree.GetFatAABB(proxyID)))
+					result.insert(userData);
+			}
+			return result;
+		}
+	};
+
+	LUCY_TEST(DynamicAABBTreeStructure) {
+		TreeFixture fixture;
+		fixture.Populate(2000);
+
+		LUCY_CHECK(fixture.Tree.GetProxyCount() == fixture.Proxies.size());
+		for (const auto& [userData, proxyID] : fixture.Proxies)
+			LUCY_CHECK(fixture.Tree.GetUserData(proxyID) == userData);
+
+		//AVL balanced: ~1.44 * log2(n), a degenerate tree would be as high as the proxy count
+		const float maxHeight = 2.0f * glm::log2((float)fixture.Proxies.size()) + 2.0f;
+		LUCY_CHECK((float)fixture.Tree.GetHeight() <= maxHeight);
+	}
+
+	LUCY_TEST(DynamicAABBTreeOverlapQuery) {
+		TreeFixture fixture;
+		fixture.Populate(1000);
+
+		for (uint32_t i = 0; i < 64; i++) {
+			const Maths::AABB query = fixture.CreateRandomAABB();
+
+			std::set<uint32_t> found;
+			fixture.Tree.QueryOverlap(query, [&](uint32_t userData) {
+				//every proxy is reported once
+				LUCY_CHECK(found.insert(userData).second);
+				return true;
+			});
+			LUCY_CHECK(found == fixture.BruteForce([&](const Maths::AABB& aabb) { return aabb.Overlaps(query); }));
+		}
+
+		//the query stops, once the callback returns false
+		uint32_t reported = 0;
+		fixture.Tree.QueryOverlap(Maths::AABB{ glm::vec3(-1000.0f), glm::vec3(1000.0f) }, [&](uint32_t) { return ++reported < 3; });
+		LUCY_CHECK(reported == glm::min(3u, (uint32_t)fixture.Proxies.size()));
+	}
+
+	LUCY_TEST(DynamicAABBTreeFrustumQuery) {
+		TreeFixture fixture;
+		fixture.Populate(1000);
+
+		for (uint32_t i = 0; i < 16; i++) {
+			const glm::vec3 eye = glm::vec3(fixture.Position(fixture.Random), fixture.Position(fixture.Random), fixture.Position(fixture.Random));
+			const glm::mat4 viewProjection = glm::perspective(glm::radians(60.0f), 1.5f, 0.1f, 80.0f) *
+				glm::lookAt(eye, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+			const Maths::Frustum frustum = Maths::ExtractFrustum(viewProjection);
+
+			std::set<uint32_t> found;
+			fixture.Tree.QueryFrustum(frustum, [&](uint32_t userData) {
+				LUCY_CHECK(found.insert(userData).second);
+				return true;
+			});
+			LUCY_CHECK(found == fixture.BruteForce([&](const Maths::AABB& aabb) { return Maths::AABBInFrustum(frustum, aabb); }));
+		}
+	}
+
+	LUCY_TEST(DynamicAABBTreeRayCast) {
+		TreeFixture fixture;
+		fixture.Populate(1000);
+
+		std::uniform_real_distribution<float> direction(-1.0f, 1.0f);
+		for (uint32_t i = 0; i < 64; i++) {
+			glm::vec3 dir = glm::vec3(direction(fixture.Random), direction(fixture.Random), direction(fixture.Random));
+			if (glm::length(dir) < 0.01f)
+				dir = glm::vec3(1.0f, 0.0f, 0.0f);
+			const Maths::Ray ray = { glm::vec3(fixture.Position(fixture.Random), fixture.Position(fixture.Random), fixture.Position(fixture.Random)), glm::normalize(dir) };
+			static constexpr float maxDistance = 150.0f;
+
+			//without clipping, every proxy along the ray is reported
+			std::set<uint32_t> found;
+			fixture.Tree.RayCast(ray, maxDistance, [&](uint32_t userData, float) {
+				found.insert(userData);
+				return maxDistance;
+			});
+			float distance = 0.0f;
+			LUCY_CHECK(found == fixture.BruteForce([&](const Maths::AABB& aabb) { return Maths::RayAABBIntersection(ray, aabb, maxDistance, distance); }));
+
+			//clipped to each hit, the closest one has to be found
+			float closestHit = maxDistance;
+			fixture.Tree.RayCast(ray, maxDistance, [&](uint32_t, float hitDistance) {
+				closestHit = glm::min(closestHit, hitDistance);
+				return hitDistance;
+			});
+
+			float expectedClosestHit = maxDistance;
+			for (const auto& [userData, proxyID] : fixture.Proxies) {
+				if (Maths::RayAABBIntersection(ray, fixture.Tree.GetFatAABB(proxyID), maxDistance, distance))
+					expectedClosestHit = glm::min(expectedClosestHit, distance);
+			}
+			LUCY_CHECK(closestHit == expectedClosestHit);
+		}
+	}
+
+	//20k objects, that drift a bit every move (most of them stay within their fat AABB), and a camera that looks at a part of them
+	LUCY_TEST(DynamicAABBTreeMoveAndCullBenchmark) {
+		static constexpr uint32_t proxyCount = 20000;
+		static constexpr uint32_t moveCount = 1000000;
+
+		TreeFixture fixture;
+		std::vector<Maths::AABB> aabbs(proxyCount);
+		std::vector<int32_t> proxyIDs(proxyCount);
+		for (uint32_t i = 0; i < proxyCount; i++) {
+			aabbs[i] = fixture.CreateRandomAABB();
+			proxyIDs[i] = fixture.Tree.CreateProxy(aabbs[i], i);
+		}
+
+		std::uniform_real_distribution<float> drift(-0.05f, 0.05f);
+		std::vector<glm::vec3> offsets(4096);
+		for (glm::vec3& offset : offsets)
+			offset = glm::vec3(drift(fixture.Random), drift(fixture.Random), drift(fixture.Random));
+
+		uint32_t reinsertCount = 0;
+		const double moveMilliseconds = MeasureMilliseconds([&]() {
+			for (uint32_t i = 0; i < moveCount; i++) {
+				const uint32_t index = i % proxyCount;
+				const glm::vec3& offset = offsets[i % offsets.size()];
+				aabbs[index] = Maths::AABB{ aabbs[index].Min + offset, aabbs[index].Max + offset };
+				reinsertCount += fixture.Tree.MoveProxy(proxyIDs[index], aabbs[index]);
+			}
+		});
+		LUCY_INFO("{0} moves of {1} proxies took {2:.1f} ms ({3:.2f}M moves per second, {4} reinsertions), the tree has a height of {5}", 
+				  moveCount, proxyCount, moveMilliseconds, moveCount / moveMilliseconds / 1000.0, reinsertCount, fixture.Tree.GetHeight());
+		LUCY_CHECK(fixture.Tree.GetHeight() <= 2 * (int32_t)std::ceil(std::log2((double)proxyCount)));
+
+		const glm::mat4 viewProjection = glm::perspective(glm::radians(60.0f), 1.5f, 0.1f, 60.0f) *
+			glm::lookAt(glm::vec3(-100.0f, 0.0f, 0.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+		const Maths::Frustum frustum = Maths::ExtractFrustum(viewProjection);
+		static constexpr uint32_t cullCount = 100;
+
+		//like CulledMeshList::Cull: the candidates of the tree, tested with their tight bounds
+		std::vector<uint32_t> treeVisible;
+		const double treeMilliseconds = MeasureMilliseconds([&]() {
+			for (uint32_t i = 0; i < cullCount; i++) {
+				treeVisible.clear();
+				fixture.Tree.QueryFrustum(frustum, [&](uint32_t userData) {
+					if (Maths::AABBInFrustum(frustum, aabbs[userData]))
+						treeVisible.push_back(userData);
+					return true;
+				});
+			}
+		});
+
+		std::vector<uint32_t> linearVisible;
+		const double linearMilliseconds = MeasureMilliseconds([&]() {
+			for (uint32_t i = 0; i < cullCount; i++) {
+				linearVisible.clear();
+				for (uint32_t j = 0; j < proxyCount; j++) {
+					if (Maths::AABBInFrustum(frustum, aabbs[j]))
+						linearVisible.push_back(j);
+				}
+			}
+		});
+		LUCY_INFO("Culling {0} proxies ({1} visible): {2:.3f} ms with the tree, {3:.3f} ms with a linear scan", 
+				  proxyCount, linearVisible.size(), treeMilliseconds / cullCount, linearMilliseconds / cullCount);
+
+		std::sort(treeVisible.begin(), treeVisible.end());
+		LUCY_CHECK(treeVisible == linearVisible);
+	}
+}
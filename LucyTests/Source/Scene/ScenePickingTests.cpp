@@ -0,0 +1,197 @@
+#include "lypch.h"
+#include "Test.h"
+#include "TestMeshes.h"
+
+#include <random>
+
+#include "Scene/Scene.h"
+#include "Renderer/Mesh.h"
+
+namespace Lucy::Tests {
+
+	struct PickingMesh {
+		std::vector<Submesh> Submeshes;
+		glm::mat4 Transform = glm::mat4(1.0f);
+		bool IsPickable = true;
+	};
+
+	static Submesh CreateTestSubmesh(const TestMesh& mesh, const glm::mat4& transform) {
+		Submesh submesh;
+		submesh.Vertices = mesh.Positions;
+		submesh.Faces = mesh.Indices;
+		submesh.VertexCount = (uint32_t)mesh.Positions.size();
+		submesh.IndexCount = (uint32_t)mesh.Indices.size();
+		submesh.Transform = transform;
+		for (const glm::vec3& position : mesh.Positions)
+			submesh.BoundingBox.Expand(position);
+		return submesh;
+	}
+
+	//spheres and grids (one sided, in both windings) with random rotations and non uniform scales, the BVH contains their world space bounds like Scene::UpdateBounds
+	struct PickingFixture {
+		std::vector<PickingMesh> Meshes; //by user data
+		DynamicAABBTree BVH;
+
+		std::mt19937 Random = std::mt19937(17);
+		std::uniform_real_distribution<float> Position = std::uniform_real_distribution<float>(-50.0f, 50.0f);
+		std::uniform_real_distribution<float> Unit = std::uniform_real_distribution<float>(0.0f, 1.0f);
+
+		glm::vec3 CreateRandomDirection() {
+			const float z = Unit(Random) * 2.0f - 1.0f;
+			const float phi = Unit(Random) * glm::two_pi<float>();
+			const float r = glm::sqrt(1.0f - z * z);
+			return glm::vec3(r * glm::cos(phi), r * glm::sin(phi), z);
+		}
+
+		glm::mat4 CreateRandomTransform(float maxScale) {
+			const glm::vec3 position = glm::vec3(Position(Random), Position(Random), Position(Random));
+			const glm::vec3 scale = glm::vec3(0.5f) + glm::vec3(Unit(Random), Unit(Random), Unit(Random)) * maxScale;
+			return glm::translate(glm::mat4(1.0f), position) * glm::rotate(glm::mat4(1.0f), Unit(Random) * glm::two_pi<float>(), CreateRandomDirection())
+				* glm::scale(glm::mat4(1.0f), scale);
+		}
+
+		void Populate(uint32_t count) {
+			const TestMesh sphere = CreateSphereMesh(8, 12);
+			TestMesh grid = CreateGridMesh(4);
+			TestMesh flippedGrid = grid;
+			for (size_t i = 0; i < flippedGrid.Indices.size(); i += 3)
+				std::swap(flippedGrid.Indices[i + 1], flippedGrid.Indices[i + 2]);
+
+			for (uint32_t userData = 0; userData < count; userData++) {
+				PickingMesh& mesh = Meshes.emplace_back();
+				mesh.Transform = CreateRandomTransform(4.0f);
+				mesh.Submeshes.push_back(CreateTestSubmesh(sphere, glm::mat4(1.0f)));
+				mesh.Submeshes.push_back(CreateTestSubmesh(userData % 2 ? grid : flippedGrid, glm::translate(glm::mat4(1.0f), glm::vec3(2.0f, 0.0f, 0.0f))));
+				mesh.IsPickable = userData % 7 != 0;
+
+				Maths::AABB meshBounds;
+				for (const Submesh& submesh : mesh.Submeshes)
+					meshBounds.Expand(Maths::TransformAABB(submesh.BoundingBox, submesh.Transform));
+				BVH.CreateProxy(Maths::TransformAABB(meshBounds, mesh.Transform), userData);
+			}
+		}
+
+		bool Pick(const Maths::Ray& ray, float maxDistance, uint32_t& outUserData, float& outDistance) const {
+			return Scene::PickMesh(BVH, ray, maxDistance, [this](uint32_t userData, glm::mat4& outMeshTransform) -> const std::vector<Submesh>* {
+				const PickingMesh& mesh = Meshes[userData];
+				if (!mesh.IsPickable)
+					return nullptr;
+				outMeshTransform = mesh.Transform;
+				return &mesh.Submeshes;
+			}, outUserData, outDistance);
+		}
+
+		//every triangle of every mesh, in world space
+		bool PickBruteForce(const Maths::Ray& ray, float maxDistance, uint32_t& outUserData, float& outDistance) const {
+			bool isHit = false;
+			outDistance = maxDistance;
+			for (uint32_t userData = 0; userData < Meshes.size(); userData++) {
+				const float distance = IntersectBruteForce(ray, Meshes[userData]);
+				if (!Meshes[userData].IsPickable || distance >= outDistance)
+					continue;
+				outDistance = distance;
+				outUserData = userData;
+				isHit = true;
+			}
+			return isHit;
+		}
+
+		float IntersectBruteForce(const Maths::Ray& ray, const PickingMesh& mesh) const {
+			float closestDistance = FLT_MAX;
+			for (const Submesh& submesh : mesh.Submeshes) {
+				const glm::mat4 modelMatrix = mesh.Transform * submesh.Transform;
+				for (size_t i = 0; i + 2 < submesh.Faces.size(); i += 3) {
+					const glm::vec3 v0 = glm::vec3(modelMatrix * glm::vec4(submesh.Vertices[submesh.Faces[i]], 1.0f));
+					const glm::vec3 v1 = glm::vec3(modelMatrix * glm::vec4(submesh.Vertices[submesh.Faces[i + 1]], 1.0f));
+					const glm::vec3 v2 = glm::vec3(modelMatrix * glm::vec4(submesh.Vertices[submesh.Faces[i + 2]], 1.0f));
+
+					float t = 0.0f, u = 0.0f, v = 0.0f;
+					if (!Maths::RayTriangleIntersection(ray, v0, v1, v2, t, u, v) && !Maths::RayTriangleIntersection(ray, v0, v2, v1, t, u, v))
+						continue;
+					if (t >= 0.0f)
+						closestDistance = glm::min(closestDistance, t);
+				}
+			}
+			return closestDistance;
+		}
+
+		//from a random point towards a random point of a random mesh, so that most of the rays hit something
+		Maths::Ray CreateRandomRay() {
+			const glm::vec3 origin = glm::vec3(Position(Random), Position(Random), Position(Random)) * 1.5f;
+			const glm::vec3 target = glm::vec3(Meshes[Random() % Meshes.size()].Transform[3]) + CreateRandomDirection() * Unit(Random) * 3.0f;
+			return Maths::Ray{ origin, glm::normalize(target - origin) };
+		}
+	};
+
+	static bool IsSameDistance(float a, float b) {
+		return glm::abs(a - b) <= 1e-3f * glm::max(1.0f, glm::max(a, b));
+	}
+
+	LUCY_TEST(ScenePickMatchesBruteForce) {
+		static constexpr uint32_t rayCount = 2000;
+
+		PickingFixture fixture;
+		fixture.Populate(300);
+
+		uint32_t hitCount = 0;
+		for (uint32_t i = 0; i < rayCount; i++) {
+			const Maths::Ray ray = fixture.CreateRandomRay();
+			const float maxDistance = i % 4 == 0 ? 40.0f : FLT_MAX;
+
+			uint32_t userData = 0, expectedUserData = 0;
+			float distance = 0.0f, expectedDistance = 0.0f;
+			const bool isHit = fixture.Pick(ray, maxDistance, userData, distance);
+			const bool isExpectedHit = fixture.PickBruteForce(ray, maxDistance, expectedUserData, expectedDistance);
+
+			LUCY_CHECK(isHit == isExpectedHit);
+			if (!isHit || !isExpectedHit)
+				continue;
+			hitCount++;
+
+			LUCY_CHECK(IsSameDistance(distance, expectedDistance));
+			//another mesh may only be picked, if it is hit at the same distance
+			LUCY_CHECK(fixture.Meshes[userData].IsPickable);
+			LUCY_CHECK(userData == expectedUserData || IsSameDistance(fixture.IntersectBruteForce(ray, fixture.Meshes[userData]), expectedDistance));
+		}
+		LUCY_CHECK(hitCount > rayCount / 4);
+
+		//the max distance clips the ray
+		const Maths::Ray ray = fixture.CreateRandomRay();
+		uint32_t userData = 0;
+		float distance = 0.0f;
+		if (fixture.Pick(ray, FLT_MAX, userData, distance))
+			LUCY_CHECK(!fixture.Pick(ray, distance * 0.5f, userData, distance));
+	}
+
+	LUCY_TEST(ScenePickBenchmark) {
+		static constexpr uint32_t rayCount = 200;
+
+		PickingFixture fixture;
+		fixture.Populate(1000);
+		std::vector<Maths::Ray> rays;
+		for (uint32_t i = 0; i < rayCount; i++)
+			rays.push_back(fixture.CreateRandomRay());
+
+		uint32_t hitCounts[2] = {};
+		const double milliseconds[2] = {
+			MeasureMilliseconds([&]() {
+				for (const Maths::Ray& ray : rays) {
+					uint32_t userData = 0;
+					float distance = 0.0f;
+					hitCounts[0] += fixture.Pick(ray, FLT_MAX, userData, distance) ? 1 : 0;
+				}
+			}),
+			MeasureMilliseconds([&]() {
+				for (const Maths::Ray& ray : rays) {
+					uint32_t userData = 0;
+					float distance = 0.0f;
+					hitCounts[1] += fixture.PickBruteForce(ray, FLT_MAX, userData, distance) ? 1 : 0;
+				}
+			})
+		};
+
+		LUCY_INFO("Picking with {0} rays among {1} meshes: {2:.3f} ms per ray with the BVH, {3:.3f} ms per ray brute force ({4:.1f}x)", rayCount, fixture.Meshes.size(),
+				  milliseconds[0] / rayCount, milliseconds[1] / rayCount, milliseconds[1] / milliseconds[0]);
+		LUCY_CHECK(hitCounts[0] == hitCounts[1]);
+	}
+}
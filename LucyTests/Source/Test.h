@@ -0,0 +1,50 @@
+#pragma once
+
+#include <chrono>
+
+namespace Lucy::Tests {
+
+	using TestFunc = void(*)();
+
+	struct TestCase {
+		const char* Name = "";
+		TestFunc Func = nullptr;
+	};
+
+	//every test registers itself before main, through a static TestRegistrar (see LUCY_TEST)
+	inline std::vector<TestCase>& GetTestCases() {
+		static std::vector<TestCase> testCases;
+		return testCases;
+	}
+
+	struct TestRegistrar {
+		TestRegistrar(const char* name, TestFunc func) {
+			GetTestCases().push_back({ name, func });
+		}
+	};
+
+	//failed checks of the test, that is currently running
+	inline uint32_t s_FailedChecks = 0;
+
+	inline void ReportFailure(const char* expression, const char* file, int32_t line) {
+		s_FailedChecks++;
+		LUCY_CRITICAL("Check failed: {0}\nFile: {1}, Line: {2}", expression, file, line);
+	}
+
+	//for the benchmarks, they log their timings and only check the results
+	template <typename TFunc>
+	inline double MeasureMilliseconds(TFunc&& func) {
+		const auto begin = std::chrono::steady_clock::now();
+		func();
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+	}
+}
+
+#define LUCY_TEST(Name)																		\
+	static void Name();																		\
+	static const Lucy::Tests::TestRegistrar Name##Registrar(#Name, &Name);					\
+	static void Name()
+
+//does not abort the test, so that every failing check of a test is reported
+#define LUCY_CHECK(expression)																\
+	do { if (!(expression)) Lucy::Tests::ReportFailure(#expression, __FILE__, __LINE__); } while (false)
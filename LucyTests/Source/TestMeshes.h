@@ -0,0 +1,63 @@
+#pragma once
+
+namespace Lucy::Tests {
+
+	struct TestMesh {
+		std::vector<glm::vec3> Positions;
+		std::vector<uint32_t> Indices;
+	};
+
+	//a grid of size x size quads in the xy plane, [0, 1]^2, facing +z (counter clockwise)
+	inline TestMesh CreateGridMesh(uint32_t size) {
+		TestMesh mesh;
+		for (uint32_t y = 0; y <= size; y++) {
+			for (uint32_t x = 0; x <= size; x++)
+				mesh.Positions.emplace_back((float)x / size, (float)y / size, 0.0f);
+		}
+
+		for (uint32_t y = 0; y < size; y++) {
+			for (uint32_t x = 0; x < size; x++) {
+				const uint32_t i0 = y * (size + 1) + x;
+				const uint32_t i1 = i0 + 1;
+				const uint32_t i2 = i0 + size + 1;
+				const uint32_t i3 = i2 + 1;
+				mesh.Indices.insert(mesh.Indices.end(), { i0, i1, i3, i0, i3, i2 });
+			}
+		}
+		return mesh;
+	}
+
+	//a unit sphere around the origin, facing outwards (counter clockwise)
+	inline TestMesh CreateSphereMesh(uint32_t stacks, uint32_t slices) {
+		TestMesh mesh;
+		for (uint32_t stack = 0; stack <= stacks; stack++) {
+			const float theta = glm::pi<float>() * stack / stacks;
+			for (uint32_t slice = 0; slice <= slices; slice++) {
+				const float phi = glm::two_pi<float>() * slice / slices;
+				mesh.Positions.emplace_back(glm::sin(theta) * glm::cos(phi), glm::cos(theta), glm::sin(theta) * glm::sin(phi));
+			}
+		}
+
+		for (uint32_t stack = 0; stack < stacks; stack++) {
+			for (uint32_t slice = 0; slice < slices; slice++) {
+				const uint32_t i0 = stack * (slices + 1) + slice;
+				const uint32_t i1 = i0 + 1;
+				const uint32_t i2 = i0 + slices + 1;
+				const uint32_t i3 = i2 + 1;
+				//the triangles at the poles are degenerate, they are skipped
+				if (stack != 0)
+					mesh.Indices.insert(mesh.Indices.end(), { i0, i1, i2 });
+				if (stack != stacks - 1)
+					mesh.Indices.insert(mesh.Indices.end(), { i1, i3, i2 });
+			}
+		}
+		return mesh;
+	}
+
+	inline glm::vec3 GetTriangleNormal(const TestMesh& mesh, size_t firstIndex) {
+		const glm::vec3& p0 = mesh.Positions[mesh.Indices[firstIndex + 0]];
+		const glm::vec3& p1 = mesh.Positions[mesh.Indices[firstIndex + 1]];
+		const glm::vec3& p2 = mesh.Positions[mesh.Indices[firstIndex + 2]];
+		return glm::cross(p1 - p0, p2 - p0);
+	}
+}
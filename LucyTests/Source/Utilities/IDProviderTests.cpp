@@ -0,0 +1,155 @@
+#include "lypch.h"
+#include "Test.h"
+
+#include <random>
+#include <thread>
+
+#include "Utilities/UUID.h"
+
+namespace Lucy::Tests {
+
+	//the lowest id, that is not in use
+	template <typename TID>
+	static TID GetLowestFreeID(const std::set<TID>& usedIDs) {
+		TID id = 0;
+		for (TID usedID : usedIDs) {
+			if (usedID != id)
+				break;
+			id++;
+		}
+		return id;
+	}
+
+	LUCY_TEST(IDProviderHandsOutTheLowestFreeID) {
+		IDProvider<uint32_t> provider;
+		std::set<uint32_t> usedIDs;
+
+		//three words, so that the search has to skip full ones
+		for (uint32_t i = 0; i < 64 * 3 + 5; i++) {
+			LUCY_CHECK(provider.RequestID() == i);
+			usedIDs.insert(i);
+		}
+
+		std::mt19937 random(48);
+		for (uint32_t i = 0; i < 10000; i++) {
+			switch (random() % 3) {
+				case 0: {
+					const uint32_t id = provider.RequestID();
+					LUCY_CHECK(id == GetLowestFreeID(usedIDs));
+					usedIDs.insert(id);
+					break;
+				}
+				case 1: {
+					if (usedIDs.empty())
+						break;
+					auto it = usedIDs.begin();
+					std::advance(it, random() % usedIDs.size());
+					provider.ReturnID(*it);
+					usedIDs.erase(it);
+					break;
+				}
+				default: {
+					if (usedIDs.empty())
+						break;
+					auto it = usedIDs.begin();
+					std::advance(it, random() % usedIDs.size());
+					const uint32_t oldID = *it;
+					usedIDs.erase(it);
+
+					const uint32_t newID = provider.Renew(oldID);
+					LUCY_CHECK(newID == GetLowestFreeID(usedIDs));
+					usedIDs.insert(newID);
+					break;
+				}
+			}
+		}
+	}
+
+	LUCY_TEST(IDProviderReusesReturnedIDs) {
+		IDProvider<uint16_t> provider;
+		for (uint16_t i = 0; i < 200; i++)
+			provider.RequestID();
+
+		//returned out of order, they come back in ascending order
+		for (uint16_t id : { 130, 7, 64, 63, 199 })
+			provider.ReturnID(id);
+		for (uint16_t id : { 7, 63, 64, 130, 199, 200 })
+			LUCY_CHECK(provider.RequestID() == id);
+
+		//renewing the only free slot hands out the same id again
+		LUCY_CHECK(provider.Renew(100) == 100);
+	}
+
+	LUCY_TEST(IDProviderIsThreadSafe) {
+		static constexpr uint32_t threadCount = 8;
+		static constexpr uint32_t idsPerThread = 2000;
+
+		IDProvider<uint64_t> provider;
+		std::vector<std::vector<uint64_t>> ids(threadCount);
+
+		std::vector<std::thread> threads;
+		for (uint32_t t = 0; t < threadCount; t++) {
+			threads.emplace_back([&provider, &threadIDs = ids[t]]() {
+				for (uint32_t i = 0; i < idsPerThread; i++) {
+					threadIDs.push_back(provider.RequestID());
+					//return every other one, so that the threads compete for the same words
+					if (i % 2)
+						provider.ReturnID(threadIDs[i - 1]);
+				}
+			});
+		}
+		for (std::thread& thread : threads)
+			thread.join();
+
+		//every id, that is still held, has been handed out once
+		std::set<uint64_t> heldIDs;
+		for (const std::vector<uint64_t>& threadIDs : ids) {
+			for (uint32_t i = 1; i < threadIDs.size(); i += 2)
+				LUCY_CHECK(heldIDs.insert(threadIDs[i]).second);
+		}
+		LUCY_CHECK(heldIDs.size() == threadCount * idsPerThread / 2);
+		//the ids returned by the threads are free again
+		LUCY_CHECK(provider.RequestID() == GetLowestFreeID(heldIDs));
+	}
+
+	//allocates and frees a million ids on one thread, then the same number spread over threads that compete for the lock
+	LUCY_TEST(IDProviderBenchmark) {
+		static constexpr uint32_t idCount = 1000000;
+		static constexpr uint32_t threadCount = 8;
+
+		IDProvider<uint32_t> provider;
+		std::vector<uint32_t> ids(idCount);
+		const double requestMilliseconds = MeasureMilliseconds([&]() {
+			for (uint32_t i = 0; i < idCount; i++)
+				ids[i] = provider.RequestID();
+		});
+		LUCY_CHECK(ids.back() == idCount - 1);
+
+		std::shuffle(ids.begin(), ids.end(), std::mt19937(48));
+		const double returnMilliseconds = MeasureMilliseconds([&]() {
+			for (uint32_t id : ids)
+				provider.ReturnID(id);
+		});
+		LUCY_CHECK(provider.RequestID() == 0);
+		provider.ReturnID(0);
+
+		//a request and a return per iteration, every thread holds a single id at a time
+		const double contendedMilliseconds = MeasureMilliseconds([&]() {
+			std::vector<std::thread> threads;
+			for (uint32_t t = 0; t < threadCount; t++) {
+				threads.emplace_back([&provider]() {
+					for (uint32_t i = 0; i < idCount / threadCount; i++)
+						provider.ReturnID(provider.RequestID());
+				});
+			}
+			for (std::thread& thread : threads)
+				thread.join();
+		});
+		LUCY_CHECK(provider.RequestID() == 0);
+
+		LUCY_INFO("{0} ids: {1:.1f} ms to request ({2:.1f} ns each), {3:.1f} ms to return in random order ({4:.1f} ns each)",
+				  idCount, requestMilliseconds, requestMilliseconds * 1e6 / idCount, returnMilliseconds, returnMilliseconds * 1e6 / idCount);
+		LUCY_INFO("{0} requests and returns on {1} threads: {2:.1f} ms ({3:.1f} ns per pair)",
+				  idCount, threadCount, contendedMilliseconds, contendedMilliseconds * 1e6 / idCount);
+	}
+}
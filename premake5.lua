@@ -27,4 +27,5 @@ group "Libraries"
     include "LucyEditor/ThirdParty/ImGuizmo"
 group ""
 include "LucyEngine"
-include "LucyEditor"
\ No newline at end of file
+include "LucyEditor"
+include "LucyTests"
\ No newline at end of file